@@ -243,6 +243,9 @@ void bfd_session_apply(struct bfd_session *bs)
 		bfd_set_polling(bs);
 	}
 
+	/* Multiplier or echo interval may have changed the packet. */
+	bfd_rt_session_update(bs);
+
 	/* Send updated information to data plane. */
 	bfd_dplane_update_session(bs);
 }
@@ -369,6 +372,7 @@ int bfd_session_enable(struct bfd_session *bs)
 		if (bglobal.debug_peer_event)
 			zlog_debug("%s: previous socket open", __func__);
 
+		bfd_rt_session_del(bs);
 		close(bs->sock);
 		bs->sock = -1;
 	}
@@ -437,6 +441,7 @@ void bfd_session_disable(struct bfd_session *bs)
 		return;
 
 	/* Free up socket resources. */
+	bfd_rt_session_del(bs);
 	if (bs->sock != -1) {
 		close(bs->sock);
 		bs->sock = -1;
@@ -833,10 +838,8 @@ void sbfd_echo_xmt_cb(struct event *t)
 }
 
 /* Was ptm_bfd_detect_TO() */
-void bfd_recvtimer_cb(struct event *t)
+void ptm_bfd_detect_TO(struct bfd_session *bs)
 {
-	struct bfd_session *bs = EVENT_ARG(t);
-
 	switch (bs->ses_state) {
 	case PTM_BFD_INIT:
 	case PTM_BFD_UP:
@@ -845,6 +848,13 @@ void bfd_recvtimer_cb(struct event *t)
 	}
 }
 
+void bfd_recvtimer_cb(struct event *t)
+{
+	struct bfd_session *bs = EVENT_ARG(t);
+
+	ptm_bfd_detect_TO(bs);
+}
+
 /* Was ptm_bfd_echo_detect_TO() */
 void bfd_echo_recvtimer_cb(struct event *t)
 {
@@ -1012,6 +1022,7 @@ void bfd_session_free(struct bfd_session *bs)
 	struct bfd_session_observer *bso;
 
 	bfd_session_disable(bs);
+	bfd_rt_session_del(bs);
 
 	/* Remove session from data plane if any. */
 	bfd_dplane_delete_session(bs);
@@ -1167,6 +1178,7 @@ void bfd_set_polling(struct bfd_session *bs)
 		zlog_debug("[%s] Setting polling=1 to negotiate timer change", bs_to_string(bs));
 
 	bs->polling = 1;
+	bfd_rt_session_update(bs);
 }
 
 /*
@@ -2153,6 +2165,8 @@ void bfd_initialize(void)
 	sbfd_rflt_hash = hash_create(sbfd_discr_hash_do, sbfd_discr_hash_cmp,
 				     "SBFD reflector discriminator hash");
 	TAILQ_INIT(&bplist);
+
+	bfd_rt_init();
 }
 
 static void _bfd_free(struct hash_bucket *hb,
@@ -2513,18 +2527,8 @@ static int bfd_vrf_enable(struct vrf *vrf)
 	if (bvrf->bg_initv6 == -1)
 		bvrf->bg_initv6 = bp_initv6_socket(vrf);
 
-	if (bvrf->bg_ev[0] == NULL && bvrf->bg_shop != -1)
-		event_add_read(master, bfd_recv_cb, bvrf, bvrf->bg_shop,
-			       &bvrf->bg_ev[0]);
-	if (bvrf->bg_ev[1] == NULL && bvrf->bg_mhop != -1)
-		event_add_read(master, bfd_recv_cb, bvrf, bvrf->bg_mhop,
-			       &bvrf->bg_ev[1]);
-	if (bvrf->bg_ev[2] == NULL && bvrf->bg_shop6 != -1)
-		event_add_read(master, bfd_recv_cb, bvrf, bvrf->bg_shop6,
-			       &bvrf->bg_ev[2]);
-	if (bvrf->bg_ev[3] == NULL && bvrf->bg_mhop6 != -1)
-		event_add_read(master, bfd_recv_cb, bvrf, bvrf->bg_mhop6,
-			       &bvrf->bg_ev[3]);
+	/* Control packets are read by the packet engine. */
+	bfd_rt_vrf_enable(bvrf);
 	if (bvrf->bg_ev[6] == NULL && bvrf->bg_initv6 != -1)
 		event_add_read(master, bfd_recv_cb, bvrf, bvrf->bg_initv6, &bvrf->bg_ev[6]);
 
@@ -2557,10 +2561,7 @@ static int bfd_vrf_disable(struct vrf *vrf)
 		zlog_debug("VRF disable %s id %d", vrf->name, vrf->vrf_id);
 
 	/* Disable read/write poll triggering. */
-	event_cancel(&bvrf->bg_ev[0]);
-	event_cancel(&bvrf->bg_ev[1]);
-	event_cancel(&bvrf->bg_ev[2]);
-	event_cancel(&bvrf->bg_ev[3]);
+	bfd_rt_vrf_disable(bvrf);
 	event_cancel(&bvrf->bg_ev[4]);
 	event_cancel(&bvrf->bg_ev[5]);
 	event_cancel(&bvrf->bg_ev[6]);
@@ -14,6 +14,7 @@
 #include <stdarg.h>
 #include <stdint.h>
 
+#include "lib/frratomic.h"
 #include "lib/hash.h"
 #include "lib/libfrr.h"
 #include "lib/frrstr.h"
@@ -378,6 +379,8 @@ struct bfd_session {
 	struct vrf *vrf;
 
 	int sock;
+	/* Packet engine copy of the session, see bfd_rt.c. */
+	struct bfd_rt_session *rt;
 
 	/* BFD session flags */
 	enum bfd_session_flags flags;
@@ -479,9 +482,39 @@ struct bfd_vrf_global {
 	int bg_initv6;
 	struct vrf *vrf;
 
+	/* Control socket reads (0 to 3) run on the packet engine. */
 	struct event *bg_ev[7];
 };
 
+/*
+ * Software data path packet I/O statistics, updated by both the main and
+ * the packet engine pthread.
+ */
+struct bfd_io_stats {
+	/* recvmmsg() calls and control packets they returned. */
+	_Atomic uint64_t rx_calls;
+	_Atomic uint64_t rx_packets;
+	/* Largest batch seen. */
+	_Atomic uint32_t rx_batch_max;
+};
+
+#define BFD_RECV_BATCH	 32
+#define BFD_RECV_PKT_LEN 64
+
+/* A received control packet and where it came from. */
+struct bfd_recv_pkt {
+	int sd;
+	bool is_mhop;
+	uint8_t ttl;
+	ifindex_t ifindex;
+	vrf_id_t vrf_id;
+	struct sockaddr_any local;
+	struct sockaddr_any peer;
+	/* -1 if the packet could not be parsed. */
+	ssize_t len;
+	uint8_t data[BFD_RECV_PKT_LEN];
+};
+
 /* Forward declaration of data plane context struct. */
 struct bfd_dplane_ctx;
 TAILQ_HEAD(dplane_queue, bfd_dplane_ctx);
@@ -506,6 +539,8 @@ struct bfd_global {
 	struct event *bg_dplane_sockev;
 	struct dplane_queue bg_dplaneq;
 
+	struct bfd_io_stats bg_io_stats;
+
 	/* Debug options. */
 	/* Show distributed BFD debug messages. */
 	bool debug_dplane;
@@ -558,6 +593,10 @@ int bp_peer_srh_socketv6(struct bfd_session *bs);
 int bp_sbfd_socket(const struct vrf *vrf);
 int bp_initv6_socket(const struct vrf *vrf);
 
+bool bfd_pkt_build(const struct bfd_session *bfd, int fbit,
+		   struct bfd_pkt *cp);
+socklen_t bp_peer_sockaddr(const struct bfd_session *bs, uint16_t *port,
+			   struct sockaddr_any *sa);
 void ptm_bfd_snd(struct bfd_session *bfd, int fbit);
 void ptm_bfd_echo_snd(struct bfd_session *bfd);
 void ptm_bfd_echo_fp_snd(struct bfd_session *bfd);
@@ -565,6 +604,9 @@ void ptm_sbfd_echo_snd(struct bfd_session *bfd);
 void ptm_sbfd_initiator_snd(struct bfd_session *bfd, int fbit);
 
 void bfd_recv_cb(struct event *t);
+int bfd_recv_ctrl_batch(int sd, bool is_mhop, bool is_ipv6, vrf_id_t vrf_id,
+			struct bfd_recv_pkt *pkts, int max);
+struct bfd_session *bfd_recv_ctrl(struct bfd_recv_pkt *pkt);
 
 
 /*
@@ -612,6 +654,7 @@ void ptm_bfd_sess_up(struct bfd_session *bfd);
 void ptm_bfd_echo_stop(struct bfd_session *bfd);
 void ptm_bfd_echo_start(struct bfd_session *bfd);
 void ptm_bfd_xmt_TO(struct bfd_session *bfd, int fbit);
+void ptm_bfd_detect_TO(struct bfd_session *bfd);
 void ptm_bfd_start_xmt_timer(struct bfd_session *bfd, bool is_echo);
 void ptm_sbfd_init_xmt_TO(struct bfd_session *bfd, int fbit);
 void ptm_sbfd_init_reset(struct bfd_session *bfd);
@@ -816,6 +859,31 @@ void bfdd_sessions_disable_vrf(struct vrf *vrf);
 
 int ptm_bfd_notify(struct bfd_session *bs, uint8_t notify_state);
 
+/*
+ * bfd_rt.c
+ *
+ * Packet engine: a pthread receiving control packets, sending the periodic
+ * ones and running detection timers of software BFD sessions.
+ */
+void bfd_rt_init(void);
+void bfd_rt_run(void);
+void bfd_rt_finish(void);
+
+void bfd_rt_vrf_enable(struct bfd_vrf_global *bvrf);
+void bfd_rt_vrf_disable(struct bfd_vrf_global *bvrf);
+
+bool bfd_rt_session_eligible(const struct bfd_session *bs);
+void bfd_rt_session_update(struct bfd_session *bs);
+void bfd_rt_session_learn(struct bfd_session *bs,
+			  const struct bfd_recv_pkt *pkt);
+void bfd_rt_session_counters(struct bfd_session *bs);
+void bfd_rt_session_del(struct bfd_session *bs);
+void bfd_rt_xmt_start(struct bfd_session *bs);
+void bfd_rt_xmt_stop(struct bfd_session *bs);
+void bfd_rt_detect_start(struct bfd_session *bs);
+void bfd_rt_detect_stop(struct bfd_session *bs);
+void bfd_rt_show_scheduler(struct vty *vty);
+
 /*
  * dplane.c
  */
@@ -866,6 +934,14 @@ int bfd_dplane_delete_session(struct bfd_session *bs);
  */
 int bfd_dplane_update_session_counters(struct bfd_session *bs);
 
+/**
+ * Asks all data planes for the counters of all their sessions, pipelining
+ * the requests, and update the sessions data structures.
+ *
+ * \returns `0` on success otherwise `-1` if any data plane failed.
+ */
+int bfd_dplane_update_counters(void);
+
 void bfd_dplane_show_counters(struct vty *vty);
 
 /*sbfd relfector*/
@@ -34,6 +34,7 @@
 #include "lib/sockopt.h"
 #include "lib/checksum.h"
 #include "lib/network.h"
+#include "lib/frrsendmmsg.h"
 
 #include "bfd.h"
 #define BUF_SIZ		   1024
@@ -84,54 +85,71 @@ static void bp_set_ipv6opts(int sd);
 static void bp_bind_ipv6(int sd, uint16_t port);
 
 
+/*
+ * Control packets are read up to BFD_RECV_BATCH at a time with recvmmsg().
+ */
+static struct bfd_recv_batch {
+	struct mmsghdr mmh[BFD_RECV_BATCH];
+	struct iovec iov[BFD_RECV_BATCH];
+	struct sockaddr_any name[BFD_RECV_BATCH];
+	uint8_t msgbuf[BFD_RECV_BATCH][1516];
+	uint8_t cmsgbuf[BFD_RECV_BATCH][255];
+} bfd_recv_batch;
+
 /*
  * Functions
  */
-int _ptm_bfd_send(struct bfd_session *bs, uint16_t *port, const void *data,
-		  size_t datalen)
+/* Fill in the address control packets of a session are sent to */
+socklen_t bp_peer_sockaddr(const struct bfd_session *bs, uint16_t *port,
+			   struct sockaddr_any *sa)
 {
-	struct sockaddr *sa;
-	struct sockaddr_in sin;
-	struct sockaddr_in6 sin6;
+	struct sockaddr_in *sin = &sa->sa_sin;
+	struct sockaddr_in6 *sin6 = &sa->sa_sin6;
 	socklen_t slen;
-	ssize_t rv;
-	int sd = -1;
 
+	memset(sa, 0, sizeof(*sa));
 	if (CHECK_FLAG(bs->flags, BFD_SESS_FLAG_IPV6)) {
-		memset(&sin6, 0, sizeof(sin6));
-		sin6.sin6_family = AF_INET6;
-		memcpy(&sin6.sin6_addr, &bs->key.peer, sizeof(sin6.sin6_addr));
-		if (bs->ifp && IN6_IS_ADDR_LINKLOCAL(&sin6.sin6_addr))
-			sin6.sin6_scope_id = bs->ifp->ifindex;
+		sin6->sin6_family = AF_INET6;
+		memcpy(&sin6->sin6_addr, &bs->key.peer,
+		       sizeof(sin6->sin6_addr));
+		if (bs->ifp && IN6_IS_ADDR_LINKLOCAL(&sin6->sin6_addr))
+			sin6->sin6_scope_id = bs->ifp->ifindex;
 
-		sin6.sin6_port =
+		sin6->sin6_port =
 			(port) ? *port
 			       : (CHECK_FLAG(bs->flags, BFD_SESS_FLAG_MH))
 					 ? htons(BFD_DEF_MHOP_DEST_PORT)
 					 : htons(BFD_DEFDESTPORT);
 
-		sd = bs->sock;
-		sa = (struct sockaddr *)&sin6;
-		slen = sizeof(sin6);
+		slen = sizeof(*sin6);
 	} else {
-		memset(&sin, 0, sizeof(sin));
-		sin.sin_family = AF_INET;
-		memcpy(&sin.sin_addr, &bs->key.peer, sizeof(sin.sin_addr));
-		sin.sin_port =
+		sin->sin_family = AF_INET;
+		memcpy(&sin->sin_addr, &bs->key.peer, sizeof(sin->sin_addr));
+		sin->sin_port =
 			(port) ? *port
 			       : (CHECK_FLAG(bs->flags, BFD_SESS_FLAG_MH))
 					 ? htons(BFD_DEF_MHOP_DEST_PORT)
 					 : htons(BFD_DEFDESTPORT);
 
-		sd = bs->sock;
-		sa = (struct sockaddr *)&sin;
-		slen = sizeof(sin);
+		slen = sizeof(*sin);
 	}
 
 #ifdef HAVE_STRUCT_SOCKADDR_SA_LEN
-	sa->sa_len = slen;
+	((struct sockaddr *)sa)->sa_len = slen;
 #endif /* HAVE_STRUCT_SOCKADDR_SA_LEN */
-	rv = sendto(sd, data, datalen, 0, sa, slen);
+
+	return slen;
+}
+
+int _ptm_bfd_send(struct bfd_session *bs, uint16_t *port, const void *data,
+		  size_t datalen)
+{
+	struct sockaddr_any sa;
+	socklen_t slen;
+	ssize_t rv;
+
+	slen = bp_peer_sockaddr(bs, port, &sa);
+	rv = sendto(bs->sock, data, datalen, 0, (struct sockaddr *)&sa, slen);
 	if (rv <= 0) {
 		if (bglobal.debug_network)
 			zlog_debug("packet-send: send failure: %s",
@@ -413,43 +431,48 @@ static int ptm_bfd_process_echo_pkt(struct bfd_vrf_global *bvrf, int s)
 	return 0;
 }
 
-void ptm_bfd_snd(struct bfd_session *bfd, int fbit)
+/*
+ * Build the control packet for a session, returns false if nothing should
+ * be sent.
+ */
+bool bfd_pkt_build(const struct bfd_session *bfd, int fbit,
+		   struct bfd_pkt *cp)
 {
 	/* Check for passive mode with zero discriminator */
-	if (bfd->discrs.remote_discr == 0 && 
-		CHECK_FLAG(bfd->flags, BFD_SESS_FLAG_PASSIVE))
-		return;
+	if (bfd->discrs.remote_discr == 0 &&
+	    CHECK_FLAG(bfd->flags, BFD_SESS_FLAG_PASSIVE))
+		return false;
 
-	struct bfd_pkt cp = {};
+	memset(cp, 0, sizeof(*cp));
 
 	/* Set fields according to section 6.5.7 */
-	cp.diag = bfd->local_diag;
-	BFD_SETVER(cp.diag, BFD_VERSION);
-	cp.flags = 0;
-	BFD_SETSTATE(cp.flags, bfd->ses_state);
+	cp->diag = bfd->local_diag;
+	BFD_SETVER(cp->diag, BFD_VERSION);
+	cp->flags = 0;
+	BFD_SETSTATE(cp->flags, bfd->ses_state);
 
 	if (CHECK_FLAG(bfd->flags, BFD_SESS_FLAG_CBIT))
-		BFD_SETCBIT(cp.flags, BFD_CBIT);
+		BFD_SETCBIT(cp->flags, BFD_CBIT);
 
-	BFD_SETDEMANDBIT(cp.flags, BFD_DEF_DEMAND);
+	BFD_SETDEMANDBIT(cp->flags, BFD_DEF_DEMAND);
 
 	/*
 	 * Polling and Final can't be set at the same time.
 	 *
 	 * RFC 5880, Section 6.5.
 	 */
-	BFD_SETFBIT(cp.flags, fbit);
+	BFD_SETFBIT(cp->flags, fbit);
 	if (fbit == 0)
-		BFD_SETPBIT(cp.flags, bfd->polling);
+		BFD_SETPBIT(cp->flags, bfd->polling);
 
-	cp.detect_mult = bfd->detect_mult;
-	cp.len = BFD_PKT_LEN;
-	cp.discrs.my_discr = htonl(bfd->discrs.my_discr);
-	cp.discrs.remote_discr = htonl(bfd->discrs.remote_discr);
+	cp->detect_mult = bfd->detect_mult;
+	cp->len = BFD_PKT_LEN;
+	cp->discrs.my_discr = htonl(bfd->discrs.my_discr);
+	cp->discrs.remote_discr = htonl(bfd->discrs.remote_discr);
 	if (bfd->polling) {
-		cp.timers.desired_min_tx =
+		cp->timers.desired_min_tx =
 			htonl(bfd->timers.desired_min_tx);
-		cp.timers.required_min_rx =
+		cp->timers.required_min_rx =
 			htonl(bfd->timers.required_min_rx);
 	} else {
 		/*
@@ -458,12 +481,25 @@ void ptm_bfd_snd(struct bfd_session *bfd, int fbit)
 		 * the oportunity to learn. See `bs_final_handler` for
 		 * more information.
 		 */
-		cp.timers.desired_min_tx =
+		cp->timers.desired_min_tx =
 			htonl(bfd->cur_timers.desired_min_tx);
-		cp.timers.required_min_rx =
+		cp->timers.required_min_rx =
 			htonl(bfd->cur_timers.required_min_rx);
 	}
-	cp.timers.required_min_echo = htonl(bfd->timers.required_min_echo_rx);
+	cp->timers.required_min_echo = htonl(bfd->timers.required_min_echo_rx);
+
+	return true;
+}
+
+void ptm_bfd_snd(struct bfd_session *bfd, int fbit)
+{
+	struct bfd_pkt cp;
+
+	/* Whatever changed also changes the periodic packets. */
+	bfd_rt_session_update(bfd);
+
+	if (!bfd_pkt_build(bfd, fbit, &cp))
+		return;
 
 	if (_ptm_bfd_send(bfd, NULL, &cp, BFD_PKT_LEN) != 0)
 		return;
@@ -553,43 +589,19 @@ static ssize_t bfd_recv_ipv4_fp(int sd, uint8_t *msgbuf, size_t msgbuflen, uint8
 }
 #endif
 
-ssize_t bfd_recv_ipv4(int sd, uint8_t *msgbuf, size_t msgbuflen, uint8_t *ttl,
-		      ifindex_t *ifindex, struct sockaddr_any *local,
-		      struct sockaddr_any *peer)
+/* Extract the addresses, TTL and interface of a received IPv4 packet */
+static int bfd_recv_ipv4_msg(struct msghdr *msghdr, uint8_t *ttl,
+			     ifindex_t *ifindex, struct sockaddr_any *local,
+			     struct sockaddr_any *peer)
 {
 	struct cmsghdr *cm;
-	ssize_t mlen;
-	struct sockaddr_in msgaddr;
-	struct msghdr msghdr;
-	struct iovec iov[1];
-	uint8_t cmsgbuf[255];
-
-	/* Prepare the recvmsg params. */
-	iov[0].iov_base = msgbuf;
-	iov[0].iov_len = msgbuflen;
-
-	memset(&msghdr, 0, sizeof(msghdr));
-	msghdr.msg_name = &msgaddr;
-	msghdr.msg_namelen = sizeof(msgaddr);
-	msghdr.msg_iov = iov;
-	msghdr.msg_iovlen = 1;
-	msghdr.msg_control = cmsgbuf;
-	msghdr.msg_controllen = sizeof(cmsgbuf);
-
-	mlen = recvmsg(sd, &msghdr, MSG_DONTWAIT);
-	if (mlen == -1) {
-		if (errno != EAGAIN)
-			zlog_err("ipv4-recv: recv failed: %s", strerror(errno));
-
-		return -1;
-	}
 
 	/* Get source address */
-	peer->sa_sin = *((struct sockaddr_in *)(msghdr.msg_name));
+	peer->sa_sin = *((struct sockaddr_in *)(msghdr->msg_name));
 
 	/* Get and check TTL */
-	for (cm = CMSG_FIRSTHDR(&msghdr); cm != NULL;
-	     cm = CMSG_NXTHDR(&msghdr, cm)) {
+	for (cm = CMSG_FIRSTHDR(msghdr); cm != NULL;
+	     cm = CMSG_NXTHDR(msghdr, cm)) {
 		if (cm->cmsg_level != IPPROTO_IP)
 			continue;
 
@@ -658,50 +670,62 @@ ssize_t bfd_recv_ipv4(int sd, uint8_t *msgbuf, size_t msgbuflen, uint8_t *ttl,
 
 	/* OS agnostic way of getting interface name. */
 	if (*ifindex == IFINDEX_INTERNAL)
-		*ifindex = getsockopt_ifindex(AF_INET, &msghdr);
+		*ifindex = getsockopt_ifindex(AF_INET, msghdr);
 
-	return mlen;
+	return 0;
 }
 
-ssize_t bfd_recv_ipv6(int sd, uint8_t *msgbuf, size_t msgbuflen, uint8_t *ttl,
+ssize_t bfd_recv_ipv4(int sd, uint8_t *msgbuf, size_t msgbuflen, uint8_t *ttl,
 		      ifindex_t *ifindex, struct sockaddr_any *local,
 		      struct sockaddr_any *peer)
 {
-	struct cmsghdr *cm;
-	struct in6_pktinfo *pi6 = NULL;
 	ssize_t mlen;
-	uint32_t ttlval;
-	struct sockaddr_in6 msgaddr6;
-	struct msghdr msghdr6;
+	struct sockaddr_in msgaddr;
+	struct msghdr msghdr;
 	struct iovec iov[1];
-	uint8_t cmsgbuf6[255];
+	uint8_t cmsgbuf[255];
 
 	/* Prepare the recvmsg params. */
 	iov[0].iov_base = msgbuf;
 	iov[0].iov_len = msgbuflen;
 
-	memset(&msghdr6, 0, sizeof(msghdr6));
-	msghdr6.msg_name = &msgaddr6;
-	msghdr6.msg_namelen = sizeof(msgaddr6);
-	msghdr6.msg_iov = iov;
-	msghdr6.msg_iovlen = 1;
-	msghdr6.msg_control = cmsgbuf6;
-	msghdr6.msg_controllen = sizeof(cmsgbuf6);
+	memset(&msghdr, 0, sizeof(msghdr));
+	msghdr.msg_name = &msgaddr;
+	msghdr.msg_namelen = sizeof(msgaddr);
+	msghdr.msg_iov = iov;
+	msghdr.msg_iovlen = 1;
+	msghdr.msg_control = cmsgbuf;
+	msghdr.msg_controllen = sizeof(cmsgbuf);
 
-	mlen = recvmsg(sd, &msghdr6, MSG_DONTWAIT);
+	mlen = recvmsg(sd, &msghdr, MSG_DONTWAIT);
 	if (mlen == -1) {
 		if (errno != EAGAIN)
-			zlog_err("ipv6-recv: recv failed: %s", strerror(errno));
+			zlog_err("ipv4-recv: recv failed: %s", strerror(errno));
 
 		return -1;
 	}
 
+	if (bfd_recv_ipv4_msg(&msghdr, ttl, ifindex, local, peer) == -1)
+		return -1;
+
+	return mlen;
+}
+
+/* Extract the addresses, hop limit and interface of a received IPv6 packet */
+static int bfd_recv_ipv6_msg(struct msghdr *msghdr6, uint8_t *ttl,
+			     ifindex_t *ifindex, struct sockaddr_any *local,
+			     struct sockaddr_any *peer)
+{
+	struct cmsghdr *cm;
+	struct in6_pktinfo *pi6 = NULL;
+	uint32_t ttlval;
+
 	/* Get source address */
-	peer->sa_sin6 = *((struct sockaddr_in6 *)(msghdr6.msg_name));
+	peer->sa_sin6 = *((struct sockaddr_in6 *)(msghdr6->msg_name));
 
 	/* Get and check TTL */
-	for (cm = CMSG_FIRSTHDR(&msghdr6); cm != NULL;
-	     cm = CMSG_NXTHDR(&msghdr6, cm)) {
+	for (cm = CMSG_FIRSTHDR(msghdr6); cm != NULL;
+	     cm = CMSG_NXTHDR(msghdr6, cm)) {
 		if (cm->cmsg_level != IPPROTO_IPV6)
 			continue;
 
@@ -737,28 +761,49 @@ ssize_t bfd_recv_ipv6(int sd, uint8_t *msgbuf, size_t msgbuflen, uint8_t *ttl,
 		}
 	}
 
+	return 0;
+}
+
+ssize_t bfd_recv_ipv6(int sd, uint8_t *msgbuf, size_t msgbuflen, uint8_t *ttl,
+		      ifindex_t *ifindex, struct sockaddr_any *local,
+		      struct sockaddr_any *peer)
+{
+	ssize_t mlen;
+	struct sockaddr_in6 msgaddr6;
+	struct msghdr msghdr6;
+	struct iovec iov[1];
+	uint8_t cmsgbuf6[255];
+
+	/* Prepare the recvmsg params. */
+	iov[0].iov_base = msgbuf;
+	iov[0].iov_len = msgbuflen;
+
+	memset(&msghdr6, 0, sizeof(msghdr6));
+	msghdr6.msg_name = &msgaddr6;
+	msghdr6.msg_namelen = sizeof(msgaddr6);
+	msghdr6.msg_iov = iov;
+	msghdr6.msg_iovlen = 1;
+	msghdr6.msg_control = cmsgbuf6;
+	msghdr6.msg_controllen = sizeof(cmsgbuf6);
+
+	mlen = recvmsg(sd, &msghdr6, MSG_DONTWAIT);
+	if (mlen == -1) {
+		if (errno != EAGAIN)
+			zlog_err("ipv6-recv: recv failed: %s", strerror(errno));
+
+		return -1;
+	}
+
+	if (bfd_recv_ipv6_msg(&msghdr6, ttl, ifindex, local, peer) == -1)
+		return -1;
+
 	return mlen;
 }
 
+/* Control sockets are read by the packet engine, see bfd_rt.c. */
 static void bfd_sd_reschedule(struct bfd_vrf_global *bvrf, int sd)
 {
-	if (sd == bvrf->bg_shop) {
-		event_cancel(&bvrf->bg_ev[0]);
-		event_add_read(master, bfd_recv_cb, bvrf, bvrf->bg_shop,
-			       &bvrf->bg_ev[0]);
-	} else if (sd == bvrf->bg_mhop) {
-		event_cancel(&bvrf->bg_ev[1]);
-		event_add_read(master, bfd_recv_cb, bvrf, bvrf->bg_mhop,
-			       &bvrf->bg_ev[1]);
-	} else if (sd == bvrf->bg_shop6) {
-		event_cancel(&bvrf->bg_ev[2]);
-		event_add_read(master, bfd_recv_cb, bvrf, bvrf->bg_shop6,
-			       &bvrf->bg_ev[2]);
-	} else if (sd == bvrf->bg_mhop6) {
-		event_cancel(&bvrf->bg_ev[3]);
-		event_add_read(master, bfd_recv_cb, bvrf, bvrf->bg_mhop6,
-			       &bvrf->bg_ev[3]);
-	} else if (sd == bvrf->bg_echo) {
+	if (sd == bvrf->bg_echo) {
 		event_cancel(&bvrf->bg_ev[4]);
 		event_add_read(master, bfd_recv_cb, bvrf, bvrf->bg_echo,
 			       &bvrf->bg_ev[4]);
@@ -844,60 +889,33 @@ static bool bfd_check_auth(const struct bfd_session *bfd,
 	return true;
 }
 
-void bfd_recv_cb(struct event *t)
+/*
+ * Process one received control packet, returns the session it was accepted
+ * for.
+ */
+struct bfd_session *bfd_recv_ctrl(struct bfd_recv_pkt *pkt)
 {
-	int sd = EVENT_FD(t);
 	struct bfd_session *bfd;
 	struct bfd_pkt *cp;
-	bool is_mhop;
-	ssize_t mlen = 0;
-	uint8_t ttl = 0;
 	vrf_id_t vrfid;
-	ifindex_t ifindex = IFINDEX_INTERNAL;
-	struct sockaddr_any local, peer;
-	uint8_t msgbuf[1516];
 	struct interface *ifp = NULL;
-	struct bfd_vrf_global *bvrf = EVENT_ARG(t);
-
-	/* Schedule next read. */
-	bfd_sd_reschedule(bvrf, sd);
-
-	/* The reflector handle SBFD init packets. */
-	if (sd == bvrf->bg_initv6) {
-		ptm_bfd_reflector_process_init_packet(bvrf, sd);
-		return;
-	}
-	/* Handle echo packets. */
-	if (sd == bvrf->bg_echo || sd == bvrf->bg_echov6) {
-		ptm_bfd_process_echo_pkt(bvrf, sd);
-		return;
-	}
-
-	/* Sanitize input/output. */
-	memset(&local, 0, sizeof(local));
-	memset(&peer, 0, sizeof(peer));
-
-	/* Handle control packets. */
-	is_mhop = false;
-	if (sd == bvrf->bg_shop || sd == bvrf->bg_mhop) {
-		is_mhop = sd == bvrf->bg_mhop;
-		mlen = bfd_recv_ipv4(sd, msgbuf, sizeof(msgbuf), &ttl, &ifindex,
-				     &local, &peer);
-	} else if (sd == bvrf->bg_shop6 || sd == bvrf->bg_mhop6) {
-		is_mhop = sd == bvrf->bg_mhop6;
-		mlen = bfd_recv_ipv6(sd, msgbuf, sizeof(msgbuf), &ttl, &ifindex,
-				     &local, &peer);
-	}
+	bool is_mhop = pkt->is_mhop;
+	uint8_t *msgbuf = pkt->data;
+	ssize_t mlen = pkt->len;
+	uint8_t ttl = pkt->ttl;
+	ifindex_t ifindex = pkt->ifindex;
+	struct sockaddr_any *local = &pkt->local;
+	struct sockaddr_any *peer = &pkt->peer;
 
 	/*
 	 * With netns backend, we have a separate socket in each VRF. It means
-	 * that bvrf here is correct and we believe the bvrf->vrf->vrf_id.
+	 * that the socket's VRF is correct and we believe its vrf_id.
 	 * With VRF-lite backend, we have a single socket in the default VRF.
-	 * It means that we can't believe the bvrf->vrf->vrf_id. But in
+	 * It means that we can't believe the socket's vrf_id. But in
 	 * VRF-lite, the ifindex is globally unique, so we can retrieve the
 	 * correct vrf_id from the interface.
 	 */
-	vrfid = bvrf->vrf->vrf_id;
+	vrfid = pkt->vrf_id;
 	if (ifindex) {
 		ifp = if_lookup_by_index(ifindex, vrfid);
 		if (ifp)
@@ -906,16 +924,16 @@ void bfd_recv_cb(struct event *t)
 
 	/* Implement RFC 5880 6.8.6 */
 	if (mlen < BFD_PKT_LEN) {
-		cp_debug(is_mhop, &peer, &local, ifindex, vrfid,
+		cp_debug(is_mhop, peer, local, ifindex, vrfid,
 			 "too small (%zd bytes)", mlen);
-		return;
+		return NULL;
 	}
 
 	/* Validate single hop packet TTL. */
 	if ((!is_mhop) && (ttl != BFD_TTL_VAL)) {
-		cp_debug(is_mhop, &peer, &local, ifindex, vrfid,
+		cp_debug(is_mhop, peer, local, ifindex, vrfid,
 			 "invalid TTL: %d expected %d", ttl, BFD_TTL_VAL);
-		return;
+		return NULL;
 	}
 
 	/*
@@ -927,56 +945,56 @@ void bfd_recv_cb(struct event *t)
 	 */
 	cp = (struct bfd_pkt *)(msgbuf);
 	if (BFD_GETVER(cp->diag) != BFD_VERSION) {
-		cp_debug(is_mhop, &peer, &local, ifindex, vrfid,
+		cp_debug(is_mhop, peer, local, ifindex, vrfid,
 			 "bad version %d", BFD_GETVER(cp->diag));
-		return;
+		return NULL;
 	}
 
 	if (cp->detect_mult == 0) {
-		cp_debug(is_mhop, &peer, &local, ifindex, vrfid,
+		cp_debug(is_mhop, peer, local, ifindex, vrfid,
 			 "detect multiplier set to zero");
-		return;
+		return NULL;
 	}
 
 	if ((cp->len < BFD_PKT_LEN) || (cp->len > mlen)) {
-		cp_debug(is_mhop, &peer, &local, ifindex, vrfid, "too small");
-		return;
+		cp_debug(is_mhop, peer, local, ifindex, vrfid, "too small");
+		return NULL;
 	}
 
 	if (BFD_GETMBIT(cp->flags)) {
-		cp_debug(is_mhop, &peer, &local, ifindex, vrfid,
+		cp_debug(is_mhop, peer, local, ifindex, vrfid,
 			 "detect non-zero Multipoint (M) flag");
-		return;
+		return NULL;
 	}
 
 	if (cp->discrs.my_discr == 0) {
-		cp_debug(is_mhop, &peer, &local, ifindex, vrfid,
+		cp_debug(is_mhop, peer, local, ifindex, vrfid,
 			 "'my discriminator' is zero");
-		return;
+		return NULL;
 	}
 
 	/* Find the session that this packet belongs. */
-	bfd = ptm_bfd_sess_find(cp, &peer, &local, ifp, vrfid, is_mhop);
+	bfd = ptm_bfd_sess_find(cp, peer, local, ifp, vrfid, is_mhop);
 	if (bfd == NULL) {
-		cp_debug(is_mhop, &peer, &local, ifindex, vrfid,
+		cp_debug(is_mhop, peer, local, ifindex, vrfid,
 			 "no session found");
-		return;
+		return NULL;
 	}
 	/*
 	 * We may have a situation where received packet is on wrong vrf
 	 */
 	if (bfd && bfd->vrf && bfd->vrf->vrf_id != vrfid) {
-		cp_debug(is_mhop, &peer, &local, ifindex, vrfid,
+		cp_debug(is_mhop, peer, local, ifindex, vrfid,
 			 "wrong vrfid.");
-		return;
+		return NULL;
 	}
 
 	/* Ensure that existing good sessions are not overridden. */
 	if (!cp->discrs.remote_discr && bfd->ses_state != PTM_BFD_DOWN &&
 	    bfd->ses_state != PTM_BFD_ADM_DOWN) {
-		cp_debug(is_mhop, &peer, &local, ifindex, vrfid,
+		cp_debug(is_mhop, peer, local, ifindex, vrfid,
 			 "'remote discriminator' is zero, not overridden");
-		return;
+		return NULL;
 	}
 
 	/*
@@ -986,18 +1004,18 @@ void bfd_recv_cb(struct event *t)
 	 */
 	if (is_mhop) {
 		if (ttl < bfd->mh_ttl) {
-			cp_debug(is_mhop, &peer, &local, ifindex, vrfid,
+			cp_debug(is_mhop, peer, local, ifindex, vrfid,
 				 "exceeded max hop count (expected %d, got %d)",
 				 bfd->mh_ttl, ttl);
-			return;
+			return NULL;
 		}
 	} else {
 
 		if (bfd->local_address.sa_sin.sin_family == AF_UNSPEC)
-			bfd->local_address = local;
+			bfd->local_address = *local;
 #ifdef BFD_LINUX
 		if (ifp)
-			bfd_peer_mac_set(sd, bfd, &peer, ifp);
+			bfd_peer_mac_set(pkt->sd, bfd, peer, ifp);
 #endif
 	}
 
@@ -1013,7 +1031,7 @@ void bfd_recv_cb(struct event *t)
 	/* Log remote discriminator changes. */
 	if ((bfd->discrs.remote_discr != 0)
 	    && (bfd->discrs.remote_discr != ntohl(cp->discrs.my_discr)))
-		cp_debug(is_mhop, &peer, &local, ifindex, vrfid,
+		cp_debug(is_mhop, peer, local, ifindex, vrfid,
 			 "remote discriminator mismatch (expected %u, got %u)",
 			 bfd->discrs.remote_discr, ntohl(cp->discrs.my_discr));
 
@@ -1021,9 +1039,9 @@ void bfd_recv_cb(struct event *t)
 
 	/* Check authentication. */
 	if (!bfd_check_auth(bfd, cp)) {
-		cp_debug(is_mhop, &peer, &local, ifindex, vrfid,
+		cp_debug(is_mhop, peer, local, ifindex, vrfid,
 			 "Authentication failed");
-		return;
+		return NULL;
 	}
 
 	/* Save remote diagnostics before state switch. */
@@ -1061,7 +1079,7 @@ void bfd_recv_cb(struct event *t)
 			bfd->cur_timers.required_min_rx = bfd->timers.required_min_rx;
 		}
 
-		return;
+		return bfd;
 	}
 
 	/* State switch from section 6.2. */
@@ -1110,6 +1128,110 @@ void bfd_recv_cb(struct event *t)
 		/* Send the control packet with the final bit immediately. */
 		ptm_bfd_snd(bfd, 1);
 	}
+
+	return bfd;
+}
+
+void bfd_recv_cb(struct event *t)
+{
+	int sd = EVENT_FD(t);
+	struct bfd_vrf_global *bvrf = EVENT_ARG(t);
+
+	/* Schedule next read. */
+	bfd_sd_reschedule(bvrf, sd);
+
+	/* The reflector handle SBFD init packets. */
+	if (sd == bvrf->bg_initv6) {
+		ptm_bfd_reflector_process_init_packet(bvrf, sd);
+		return;
+	}
+	/* Handle echo packets. */
+	if (sd == bvrf->bg_echo || sd == bvrf->bg_echov6) {
+		ptm_bfd_process_echo_pkt(bvrf, sd);
+		return;
+	}
+}
+
+/*
+ * Read as many control packets as are queued, up to `max`, with a single
+ * recvmmsg().
+ *
+ * Only called from the packet engine pthread.
+ */
+int bfd_recv_ctrl_batch(int sd, bool is_mhop, bool is_ipv6, vrf_id_t vrf_id,
+			struct bfd_recv_pkt *pkts, int max)
+{
+	struct bfd_recv_batch *rb = &bfd_recv_batch;
+	struct bfd_io_stats *stats = &bglobal.bg_io_stats;
+	struct bfd_recv_pkt *pkt;
+	struct mmsghdr *mmh;
+	int i, n;
+
+	if (max > BFD_RECV_BATCH)
+		max = BFD_RECV_BATCH;
+
+	for (i = 0; i < max; i++) {
+		mmh = &rb->mmh[i];
+		memset(&mmh->msg_hdr, 0, sizeof(mmh->msg_hdr));
+		rb->iov[i].iov_base = rb->msgbuf[i];
+		rb->iov[i].iov_len = sizeof(rb->msgbuf[i]);
+		mmh->msg_hdr.msg_name = &rb->name[i];
+		mmh->msg_hdr.msg_namelen = is_ipv6 ? sizeof(rb->name[i].sa_sin6)
+						   : sizeof(rb->name[i].sa_sin);
+		mmh->msg_hdr.msg_iov = &rb->iov[i];
+		mmh->msg_hdr.msg_iovlen = 1;
+		mmh->msg_hdr.msg_control = rb->cmsgbuf[i];
+		mmh->msg_hdr.msg_controllen = sizeof(rb->cmsgbuf[i]);
+		mmh->msg_len = 0;
+	}
+
+	n = recvmmsg(sd, rb->mmh, max, MSG_DONTWAIT, NULL);
+	if (n == -1) {
+		if (errno != EAGAIN && errno != EWOULDBLOCK)
+			zlog_err("%s-recv: recv failed: %s",
+				 is_ipv6 ? "ipv6" : "ipv4", strerror(errno));
+		return 0;
+	}
+
+	atomic_fetch_add_explicit(&stats->rx_calls, 1, memory_order_relaxed);
+	atomic_fetch_add_explicit(&stats->rx_packets, n, memory_order_relaxed);
+	if ((uint32_t)n > atomic_load_explicit(&stats->rx_batch_max,
+					       memory_order_relaxed))
+		atomic_store_explicit(&stats->rx_batch_max, n,
+				      memory_order_relaxed);
+
+	for (i = 0; i < n; i++) {
+		mmh = &rb->mmh[i];
+		pkt = &pkts[i];
+
+		/* Sanitize input/output. */
+		memset(pkt, 0, sizeof(*pkt));
+		pkt->sd = sd;
+		pkt->is_mhop = is_mhop;
+		pkt->vrf_id = vrf_id;
+		pkt->ifindex = IFINDEX_INTERNAL;
+		pkt->len = mmh->msg_len;
+
+		if (is_ipv6) {
+			if (bfd_recv_ipv6_msg(&mmh->msg_hdr, &pkt->ttl,
+					      &pkt->ifindex, &pkt->local,
+					      &pkt->peer) == -1)
+				pkt->len = -1;
+		} else {
+			if (bfd_recv_ipv4_msg(&mmh->msg_hdr, &pkt->ttl,
+					      &pkt->ifindex, &pkt->local,
+					      &pkt->peer) == -1)
+				pkt->len = -1;
+		}
+
+		/* Nothing this long is a valid control packet. */
+		if (pkt->len > (ssize_t)sizeof(pkt->data))
+			pkt->len = -1;
+		if (pkt->len > 0)
+			memcpy(pkt->data, rb->msgbuf[i], pkt->len);
+	}
+
+	return n;
 }
 
 /*
@@ -0,0 +1,860 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * BFD packet engine.
+ *
+ * The periodic work of software BFD sessions - reading control packets,
+ * sending the scheduled ones and running detection timers - happens on a
+ * pthread of its own, so it keeps its timing while the main pthread is busy
+ * with configuration, zebra or northbound work.
+ *
+ * The main pthread stays in charge of the protocol: the engine keeps a copy
+ * of each session with
+ * - the control packet to send periodically (template),
+ * - transmit interval, detection multiplier and detection time,
+ * - the last control packet received in steady state.
+ *
+ * A received packet identical to the last one of an Up session can't change
+ * anything but the detection timer, the engine restarts the timer and counts
+ * it.  Everything else, as well as detection timer expiry, is handed to the
+ * main pthread through a lock-free queue.  The main pthread updates the
+ * engine copy whenever it changes something that goes into the packets.
+ *
+ * Timers are kept in a hashed timer wheel with BFD_RT_TICK_USEC resolution,
+ * arming and disarming is O(1) no matter how many sessions there are.  The
+ * engine only wakes up when the first timer on the wheel expires.
+ *
+ * Transmissions are spread over the wheel: the wheel counts the transmit
+ * timers in each slot, and a session picks the least loaded of a few random
+ * ticks inside its RFC 5880 jitter window.  Without that, sessions started
+ * together keep transmitting together and the bursts overflow socket
+ * buffers.  Everything due in a tick is copied out and sent outside of the
+ * lock.
+ */
+
+#include <zebra.h>
+
+#include "lib/atomlist.h"
+#include "lib/frr_pthread.h"
+#include "lib/jhash.h"
+#include "lib/network.h"
+#include "lib/typesafe.h"
+
+#include "bfd.h"
+
+DEFINE_MTYPE_STATIC(BFDD, BFDD_RT_SESSION, "BFD packet engine session");
+DEFINE_MTYPE_STATIC(BFDD, BFDD_RT_MSG, "BFD packet engine message");
+
+#define BFD_RT_TICK_USEC   1000
+#define BFD_RT_WHEEL_SLOTS 2048
+/* Random ticks of the jitter window a transmission picks from. */
+#define BFD_RT_TX_CHOICES  4
+/* Histogram of packets sent per tick: 0, 1, 2-3, 4-7, ... 512 and more. */
+#define BFD_RT_TX_HIST	   11
+/* Transmissions copied out of the sessions at a time. */
+#define BFD_RT_TX_BATCH	   64
+
+PREDECL_DLIST(bfd_rt_slot);
+PREDECL_HASH(bfd_rt_sessions);
+PREDECL_ATOMLIST(bfd_rt_msgq);
+
+struct bfd_rt_timer {
+	struct bfd_rt_slot_item item;
+	struct bfd_rt_session *rs;
+	/* Tick this timer expires at. */
+	uint64_t expire;
+	bool armed;
+	/* Counted in the slot load. */
+	bool is_tx;
+};
+
+DECLARE_DLIST(bfd_rt_slot, struct bfd_rt_timer, item);
+
+struct bfd_rt_wheel {
+	struct bfd_rt_slot_head slots[BFD_RT_WHEEL_SLOTS];
+	/* Transmit timers in each slot. */
+	uint32_t tx_load[BFD_RT_WHEEL_SLOTS];
+	/* Tick being processed. */
+	uint64_t cur;
+	size_t count;
+
+	/* Ticks processed, by number of packets sent. */
+	uint64_t tx_hist[BFD_RT_TX_HIST];
+};
+
+struct bfd_rt_session {
+	struct bfd_rt_sessions_item hitem;
+	uint32_t discr;
+
+	/* Transmit. */
+	int sd;
+	struct sockaddr_any dst;
+	socklen_t dstlen;
+	struct bfd_pkt pkt;
+	bool pkt_valid;
+	uint64_t xmt_TO;
+	uint8_t detect_mult;
+	struct bfd_rt_timer tx;
+
+	/* Detection. */
+	uint64_t detect_TO;
+	bool detect_on;
+	/* Bumped whenever the detection timer is (re)started or stopped. */
+	uint32_t detect_gen;
+	struct bfd_rt_timer detect;
+
+	/*
+	 * Last received packet.  It is only used for the fast path once it
+	 * was received twice without the template changing in between.
+	 */
+	struct bfd_recv_pkt rx;
+	uint32_t rx_gen;
+	bool rx_valid;
+	/* Bumped whenever the template changes. */
+	uint32_t tmpl_gen;
+
+	/* Packets not yet accounted in the session statistics. */
+	uint64_t rx_pkts;
+	uint64_t tx_pkts;
+};
+
+static int bfd_rt_session_cmp(const struct bfd_rt_session *a,
+			      const struct bfd_rt_session *b)
+{
+	return numcmp(a->discr, b->discr);
+}
+
+static uint32_t bfd_rt_session_hash(const struct bfd_rt_session *rs)
+{
+	return jhash_1word(rs->discr, 0xb4dbfd);
+}
+
+DECLARE_HASH(bfd_rt_sessions, struct bfd_rt_session, hitem,
+	     bfd_rt_session_cmp, bfd_rt_session_hash);
+
+/* A transmission copied out of a session. */
+struct bfd_rt_tx {
+	int sd;
+	struct sockaddr_any dst;
+	socklen_t dstlen;
+	struct bfd_pkt pkt;
+};
+
+enum bfd_rt_msg_type {
+	BFD_RT_MSG_RX,
+	BFD_RT_MSG_DETECT,
+};
+
+/* Work handed from the engine to the main pthread. */
+struct bfd_rt_msg {
+	struct bfd_rt_msgq_item item;
+	enum bfd_rt_msg_type type;
+	uint32_t discr;
+	uint32_t gen;
+	struct bfd_recv_pkt pkt;
+};
+
+DECLARE_ATOMLIST(bfd_rt_msgq, struct bfd_rt_msg, item);
+
+static struct bfd_rt {
+	struct frr_pthread *pth;
+
+	/* Protects sessions and wheel. */
+	pthread_mutex_t mtx;
+	/*
+	 * Set while the engine sends a batch outside of mtx.  The batch holds
+	 * copies of session sockets, so the main pthread must not close one
+	 * until the batch is out; tx_done is signalled when it is.
+	 */
+	bool tx_busy;
+	pthread_cond_t tx_done;
+	struct bfd_rt_sessions_head sessions;
+	struct bfd_rt_wheel wheel;
+	/* Armed for the first timer on the wheel. */
+	struct event *t_tick;
+	struct event *t_kick;
+
+	struct bfd_rt_msgq_head msgq;
+	struct event *t_msg;
+
+	/* Engine pthread only. */
+	struct bfd_recv_pkt rx[BFD_RECV_BATCH];
+	struct bfd_rt_tx tx[BFD_RT_TX_BATCH];
+} rt;
+
+static void bfd_rt_tick(struct event *t);
+
+/*
+ * Timer wheel.
+ */
+static uint64_t bfd_rt_now(void)
+{
+	struct timeval tv;
+
+	monotime(&tv);
+	return ((uint64_t)tv.tv_sec * 1000000 + tv.tv_usec) / BFD_RT_TICK_USEC;
+}
+
+static uint64_t bfd_rt_usec2ticks(uint64_t usec)
+{
+	uint64_t ticks = (usec + BFD_RT_TICK_USEC - 1) / BFD_RT_TICK_USEC;
+
+	return ticks ? ticks : 1;
+}
+
+static void bfd_rt_wheel_add_at(struct bfd_rt_wheel *w,
+				struct bfd_rt_timer *tm, uint64_t now,
+				uint64_t expire)
+{
+	size_t slot = expire % BFD_RT_WHEEL_SLOTS;
+
+	assert(!tm->armed);
+
+	if (!w->count)
+		w->cur = now;
+
+	tm->expire = expire;
+	tm->armed = true;
+	bfd_rt_slot_add_tail(&w->slots[slot], tm);
+	if (tm->is_tx)
+		w->tx_load[slot]++;
+	w->count++;
+}
+
+static void bfd_rt_wheel_add(struct bfd_rt_wheel *w, struct bfd_rt_timer *tm,
+			     uint64_t usec)
+{
+	uint64_t now = bfd_rt_now();
+
+	bfd_rt_wheel_add_at(w, tm, now, now + bfd_rt_usec2ticks(usec));
+}
+
+static void bfd_rt_wheel_unlink(struct bfd_rt_wheel *w,
+				struct bfd_rt_timer *tm)
+{
+	size_t slot = tm->expire % BFD_RT_WHEEL_SLOTS;
+
+	bfd_rt_slot_del(&w->slots[slot], tm);
+	if (tm->is_tx)
+		w->tx_load[slot]--;
+	tm->armed = false;
+	w->count--;
+}
+
+static void bfd_rt_wheel_del(struct bfd_rt_wheel *w, struct bfd_rt_timer *tm)
+{
+	if (tm->armed)
+		bfd_rt_wheel_unlink(w, tm);
+}
+
+/* Take the next timer expired by `now` off the wheel. */
+static struct bfd_rt_timer *bfd_rt_wheel_pop(struct bfd_rt_wheel *w,
+					     uint64_t now)
+{
+	struct bfd_rt_slot_head *slot;
+	struct bfd_rt_timer *tm;
+
+	while (w->count) {
+		slot = &w->slots[w->cur % BFD_RT_WHEEL_SLOTS];
+		frr_each (bfd_rt_slot, slot, tm) {
+			/* Later rounds stay in the slot. */
+			if (tm->expire > w->cur)
+				continue;
+
+			bfd_rt_wheel_unlink(w, tm);
+			return tm;
+		}
+
+		if (w->cur >= now)
+			break;
+		w->cur++;
+	}
+
+	return NULL;
+}
+
+/*
+ * Tick the first timer on the wheel expires at.  Only one turn of the wheel
+ * is looked at, a timer further away is found again on a later call.
+ */
+static uint64_t bfd_rt_wheel_next(struct bfd_rt_wheel *w)
+{
+	struct bfd_rt_timer *tm;
+	uint64_t tick;
+
+	for (tick = w->cur; tick < w->cur + BFD_RT_WHEEL_SLOTS; tick++) {
+		frr_each (bfd_rt_slot, &w->slots[tick % BFD_RT_WHEEL_SLOTS],
+			  tm) {
+			if (tm->expire <= tick)
+				return tick;
+		}
+	}
+
+	return tick;
+}
+
+/* Arm the tick for the first timer on the wheel, engine pthread only */
+static void bfd_rt_schedule(void)
+{
+	struct timeval tv = {};
+	uint64_t next = 0, now, usec;
+	bool pending;
+
+	frr_with_mutex (&rt.mtx) {
+		pending = rt.wheel.count > 0;
+		if (pending)
+			next = bfd_rt_wheel_next(&rt.wheel);
+	}
+
+	event_cancel(&rt.t_tick);
+	if (!pending)
+		return;
+
+	now = bfd_rt_now();
+	if (next > now) {
+		usec = (next - now) * BFD_RT_TICK_USEC;
+		tv.tv_sec = usec / 1000000;
+		tv.tv_usec = usec % 1000000;
+	}
+	event_add_timer_tv(rt.pth->master, bfd_rt_tick, NULL, &tv, &rt.t_tick);
+}
+
+static void bfd_rt_kick_cb(struct event *t)
+{
+	bfd_rt_schedule();
+}
+
+/* Have the engine look at the wheel again, callable from any pthread. */
+static void bfd_rt_kick(void)
+{
+	event_add_event(rt.pth->master, bfd_rt_kick_cb, NULL, 0, &rt.t_kick);
+}
+
+/*
+ * Schedule the next transmission of a session.
+ *
+ * RFC 5880 Section 6.5.2: the transmit interval is jittered between 75%
+ * and 100% of the nominal value, or 75% and 90% with a multiplier of 1.
+ * Of a few random points of that window the one whose slot has the least
+ * transmissions wins, which still is random but evens out the load.
+ */
+static void bfd_rt_tx_arm(struct bfd_rt_session *rs)
+{
+	struct bfd_rt_wheel *w = &rt.wheel;
+	int maxpercent = (rs->detect_mult == 1) ? 16 : 26;
+	uint64_t now = bfd_rt_now();
+	uint64_t best = 0, expire;
+	uint32_t load, best_load = UINT32_MAX;
+
+	for (int i = 0; i < BFD_RT_TX_CHOICES; i++) {
+		expire = now + bfd_rt_usec2ticks(
+				       (rs->xmt_TO
+					* (75 + (frr_weak_random() % maxpercent)))
+				       / 100);
+		load = w->tx_load[expire % BFD_RT_WHEEL_SLOTS];
+		if (load < best_load) {
+			best = expire;
+			best_load = load;
+		}
+	}
+
+	bfd_rt_wheel_del(w, &rs->tx);
+	bfd_rt_wheel_add_at(w, &rs->tx, now, best);
+}
+
+static void bfd_rt_detect_arm(struct bfd_rt_session *rs)
+{
+	bfd_rt_wheel_del(&rt.wheel, &rs->detect);
+	rs->detect_gen++;
+	if (rs->detect_on)
+		bfd_rt_wheel_add(&rt.wheel, &rs->detect, rs->detect_TO);
+}
+
+/*
+ * Main pthread to engine.
+ */
+static void bfd_rt_msg_cb(struct event *t);
+
+static bool bfd_rt_pkt_same(const struct bfd_recv_pkt *a,
+			    const struct bfd_recv_pkt *b)
+{
+	return a->sd == b->sd && a->is_mhop == b->is_mhop && a->ttl == b->ttl
+	       && a->ifindex == b->ifindex && a->vrf_id == b->vrf_id
+	       && a->len == b->len && a->len > 0
+	       && !memcmp(&a->local, &b->local, sizeof(a->local))
+	       && !memcmp(&a->peer, &b->peer, sizeof(a->peer))
+	       && !memcmp(a->data, b->data, a->len);
+}
+
+/* Copy what the engine needs from a session, called with the lock held */
+static struct bfd_rt_session *bfd_rt_session_sync(struct bfd_session *bs)
+{
+	struct bfd_rt_session *rs = bs->rt;
+	struct bfd_pkt cp;
+	bool valid;
+
+	if (!rs) {
+		rs = XCALLOC(MTYPE_BFDD_RT_SESSION, sizeof(*rs));
+		rs->discr = bs->discrs.my_discr;
+		rs->sd = -1;
+		rs->tx.rs = rs;
+		rs->tx.is_tx = true;
+		rs->detect.rs = rs;
+		bfd_rt_sessions_add(&rt.sessions, rs);
+		bs->rt = rs;
+	}
+
+	if (rs->sd != bs->sock) {
+		rs->sd = bs->sock;
+		rs->rx_valid = false;
+	}
+	rs->dstlen = bp_peer_sockaddr(bs, NULL, &rs->dst);
+	rs->xmt_TO = bs->xmt_TO;
+	rs->detect_mult = bs->detect_mult;
+	rs->detect_TO = bs->detect_TO;
+
+	valid = bfd_pkt_build(bs, 0, &cp);
+	if (valid != rs->pkt_valid
+	    || (valid && memcmp(&cp, &rs->pkt, sizeof(cp)))) {
+		rs->pkt = cp;
+		rs->pkt_valid = valid;
+		rs->tmpl_gen++;
+		rs->rx_valid = false;
+	}
+
+	return rs;
+}
+
+bool bfd_rt_session_eligible(const struct bfd_session *bs)
+{
+	/* S-BFD and data plane offloaded sessions stay where they are. */
+	return bs->bfd_mode == BFD_MODE_TYPE_BFD && bs->bdc == NULL;
+}
+
+void bfd_rt_session_update(struct bfd_session *bs)
+{
+	if (!bs->rt)
+		return;
+
+	frr_with_mutex (&rt.mtx) {
+		bfd_rt_session_sync(bs);
+	}
+}
+
+/*
+ * Called after the main pthread processed a packet for the session, a
+ * packet seen twice in a row with nothing changing in between is left to
+ * the engine from now on.
+ */
+void bfd_rt_session_learn(struct bfd_session *bs,
+			  const struct bfd_recv_pkt *pkt)
+{
+	struct bfd_rt_session *rs;
+
+	if (!bs->rt)
+		return;
+
+	frr_with_mutex (&rt.mtx) {
+		rs = bfd_rt_session_sync(bs);
+
+		if (bs->ses_state == PTM_BFD_UP && rs->rx_gen == rs->tmpl_gen
+		    && bfd_rt_pkt_same(&rs->rx, pkt)) {
+			rs->rx_valid = true;
+		} else {
+			rs->rx = *pkt;
+			rs->rx_gen = rs->tmpl_gen;
+			rs->rx_valid = false;
+		}
+	}
+}
+
+void bfd_rt_session_counters(struct bfd_session *bs)
+{
+	if (!bs->rt)
+		return;
+
+	frr_with_mutex (&rt.mtx) {
+		bs->stats.rx_ctrl_pkt += bs->rt->rx_pkts;
+		bs->stats.tx_ctrl_pkt += bs->rt->tx_pkts;
+		bs->rt->rx_pkts = 0;
+		bs->rt->tx_pkts = 0;
+	}
+}
+
+void bfd_rt_session_del(struct bfd_session *bs)
+{
+	struct bfd_rt_session *rs = bs->rt;
+
+	if (!rs)
+		return;
+
+	frr_with_mutex (&rt.mtx) {
+		bfd_rt_wheel_del(&rt.wheel, &rs->tx);
+		bfd_rt_wheel_del(&rt.wheel, &rs->detect);
+		bfd_rt_sessions_del(&rt.sessions, rs);
+		bs->stats.rx_ctrl_pkt += rs->rx_pkts;
+		bs->stats.tx_ctrl_pkt += rs->tx_pkts;
+
+		/* callers close bs->sock next, it may be in a batch */
+		while (rt.tx_busy)
+			pthread_cond_wait(&rt.tx_done, &rt.mtx);
+	}
+
+	XFREE(MTYPE_BFDD_RT_SESSION, rs);
+	bs->rt = NULL;
+}
+
+void bfd_rt_xmt_start(struct bfd_session *bs)
+{
+	struct bfd_rt_session *rs;
+
+	frr_with_mutex (&rt.mtx) {
+		rs = bfd_rt_session_sync(bs);
+		bfd_rt_tx_arm(rs);
+	}
+
+	bfd_rt_kick();
+}
+
+void bfd_rt_xmt_stop(struct bfd_session *bs)
+{
+	if (!bs->rt)
+		return;
+
+	frr_with_mutex (&rt.mtx) {
+		bfd_rt_wheel_del(&rt.wheel, &bs->rt->tx);
+	}
+}
+
+void bfd_rt_detect_start(struct bfd_session *bs)
+{
+	struct bfd_rt_session *rs;
+
+	frr_with_mutex (&rt.mtx) {
+		rs = bfd_rt_session_sync(bs);
+		rs->detect_on = true;
+		bfd_rt_detect_arm(rs);
+	}
+
+	bfd_rt_kick();
+}
+
+void bfd_rt_detect_stop(struct bfd_session *bs)
+{
+	if (!bs->rt)
+		return;
+
+	frr_with_mutex (&rt.mtx) {
+		bs->rt->detect_on = false;
+		bfd_rt_detect_arm(bs->rt);
+	}
+}
+
+/*
+ * Engine to main pthread.
+ */
+static void bfd_rt_post(struct bfd_rt_msg *msg)
+{
+	bfd_rt_msgq_add_tail(&rt.msgq, msg);
+}
+
+static void bfd_rt_post_flush(void)
+{
+	event_add_event(master, bfd_rt_msg_cb, NULL, 0, &rt.t_msg);
+}
+
+static void bfd_rt_msg_cb(struct event *t)
+{
+	struct bfd_rt_msg *msg;
+	struct bfd_session *bs;
+	bool expired;
+
+	while ((msg = bfd_rt_msgq_pop(&rt.msgq))) {
+		switch (msg->type) {
+		case BFD_RT_MSG_RX:
+			bs = bfd_recv_ctrl(&msg->pkt);
+			if (bs)
+				bfd_rt_session_learn(bs, &msg->pkt);
+			break;
+
+		case BFD_RT_MSG_DETECT:
+			/* Ignore expiry if a packet came in meanwhile. */
+			bs = bfd_id_lookup(msg->discr);
+			if (!bs || !bs->rt)
+				break;
+
+			frr_with_mutex (&rt.mtx) {
+				expired = bs->rt->detect_gen == msg->gen;
+			}
+			if (expired)
+				ptm_bfd_detect_TO(bs);
+			break;
+		}
+
+		XFREE(MTYPE_BFDD_RT_MSG, msg);
+	}
+}
+
+/*
+ * Engine pthread.
+ */
+
+/* Handle a packet without the main pthread, called with the lock held */
+static bool bfd_rt_recv_fast(const struct bfd_recv_pkt *pkt)
+{
+	const struct bfd_pkt *cp = (const struct bfd_pkt *)pkt->data;
+	struct bfd_rt_session *rs, ref;
+
+	/* Polls need an answer with the final bit. */
+	if (pkt->len < BFD_PKT_LEN || BFD_GETPBIT(cp->flags))
+		return false;
+
+	ref.discr = ntohl(cp->discrs.remote_discr);
+	rs = bfd_rt_sessions_find(&rt.sessions, &ref);
+	if (!rs || !rs->rx_valid || !bfd_rt_pkt_same(&rs->rx, pkt))
+		return false;
+
+	rs->rx_pkts++;
+	bfd_rt_detect_arm(rs);
+	return true;
+}
+
+static struct event **bfd_rt_sock_ev(struct bfd_vrf_global *bvrf, int sd)
+{
+	if (sd == bvrf->bg_shop)
+		return &bvrf->bg_ev[0];
+	if (sd == bvrf->bg_mhop)
+		return &bvrf->bg_ev[1];
+	if (sd == bvrf->bg_shop6)
+		return &bvrf->bg_ev[2];
+	if (sd == bvrf->bg_mhop6)
+		return &bvrf->bg_ev[3];
+
+	return NULL;
+}
+
+static void bfd_rt_recv_cb(struct event *t)
+{
+	struct bfd_vrf_global *bvrf = EVENT_ARG(t);
+	int sd = EVENT_FD(t);
+	bool is_mhop = sd == bvrf->bg_mhop || sd == bvrf->bg_mhop6;
+	bool is_ipv6 = sd == bvrf->bg_shop6 || sd == bvrf->bg_mhop6;
+	struct bfd_rt_msg *msg;
+	bool posted = false;
+	int i, n;
+
+	/* Schedule next read. */
+	event_add_read(rt.pth->master, bfd_rt_recv_cb, bvrf, sd,
+		       bfd_rt_sock_ev(bvrf, sd));
+
+	n = bfd_recv_ctrl_batch(sd, is_mhop, is_ipv6, bvrf->vrf->vrf_id, rt.rx,
+				array_size(rt.rx));
+
+	frr_with_mutex (&rt.mtx) {
+		for (i = 0; i < n; i++) {
+			if (bfd_rt_recv_fast(&rt.rx[i]))
+				continue;
+
+			msg = XMALLOC(MTYPE_BFDD_RT_MSG, sizeof(*msg));
+			msg->type = BFD_RT_MSG_RX;
+			msg->pkt = rt.rx[i];
+			bfd_rt_post(msg);
+			posted = true;
+		}
+	}
+
+	if (posted)
+		bfd_rt_post_flush();
+}
+
+/* Schedule reads on the control sockets of a VRF, runs on the engine */
+static void bfd_rt_vrf_enable_cb(struct event *t)
+{
+	struct bfd_vrf_global *bvrf = EVENT_ARG(t);
+	int socks[] = { bvrf->bg_shop, bvrf->bg_mhop, bvrf->bg_shop6,
+			bvrf->bg_mhop6 };
+
+	for (size_t i = 0; i < array_size(socks); i++) {
+		if (socks[i] == -1 || bvrf->bg_ev[i])
+			continue;
+
+		event_add_read(rt.pth->master, bfd_rt_recv_cb, bvrf, socks[i],
+			       &bvrf->bg_ev[i]);
+	}
+}
+
+static void bfd_rt_tick(struct event *t)
+{
+	struct bfd_rt_session *rs;
+	struct bfd_rt_timer *tm;
+	struct bfd_rt_msg *msg;
+	struct bfd_rt_tx *tx;
+	uint64_t now = bfd_rt_now();
+	unsigned int count, sent = 0, bucket;
+	bool posted = false, pending;
+
+	do {
+		count = 0;
+
+		frr_with_mutex (&rt.mtx) {
+			while (count < array_size(rt.tx)) {
+				tm = bfd_rt_wheel_pop(&rt.wheel, now);
+				if (!tm)
+					break;
+
+				rs = tm->rs;
+				if (tm == &rs->detect) {
+					msg = XMALLOC(MTYPE_BFDD_RT_MSG,
+						      sizeof(*msg));
+					msg->type = BFD_RT_MSG_DETECT;
+					msg->discr = rs->discr;
+					msg->gen = rs->detect_gen;
+					bfd_rt_post(msg);
+					posted = true;
+					continue;
+				}
+
+				if (rs->pkt_valid && rs->sd != -1) {
+					tx = &rt.tx[count++];
+					tx->sd = rs->sd;
+					tx->dst = rs->dst;
+					tx->dstlen = rs->dstlen;
+					tx->pkt = rs->pkt;
+					rs->tx_pkts++;
+				}
+				bfd_rt_tx_arm(rs);
+			}
+			pending = count == array_size(rt.tx);
+			rt.tx_busy = count > 0;
+		}
+
+		if (!count)
+			break;
+
+		/* Send outside of the lock. */
+		for (unsigned int i = 0; i < count; i++) {
+			tx = &rt.tx[i];
+			if (sendto(tx->sd, &tx->pkt, BFD_PKT_LEN, 0,
+				   (struct sockaddr *)&tx->dst, tx->dstlen)
+				    <= 0
+			    && bglobal.debug_network)
+				zlog_debug("packet-send: send failure: %s",
+					   strerror(errno));
+		}
+		sent += count;
+
+		frr_with_mutex (&rt.mtx) {
+			rt.tx_busy = false;
+			pthread_cond_broadcast(&rt.tx_done);
+		}
+	} while (pending);
+
+	for (bucket = 0; sent && bucket < BFD_RT_TX_HIST - 1; bucket++)
+		sent >>= 1;
+
+	frr_with_mutex (&rt.mtx) {
+		rt.wheel.tx_hist[bucket]++;
+	}
+
+	if (posted)
+		bfd_rt_post_flush();
+
+	bfd_rt_schedule();
+}
+
+void bfd_rt_show_scheduler(struct vty *vty)
+{
+	struct bfd_rt_wheel *w = &rt.wheel;
+	uint64_t hist[BFD_RT_TX_HIST];
+	uint64_t scheduled = 0;
+	uint32_t busiest = 0;
+	char label[32];
+
+	frr_with_mutex (&rt.mtx) {
+		for (size_t i = 0; i < array_size(w->tx_load); i++) {
+			scheduled += w->tx_load[i];
+			busiest = MAX(busiest, w->tx_load[i]);
+		}
+		memcpy(hist, w->tx_hist, sizeof(hist));
+	}
+
+	vty_out(vty, "Transmit scheduler:\n");
+	vty_out(vty, "\tTick: %u usec, slots: %u\n", BFD_RT_TICK_USEC,
+		BFD_RT_WHEEL_SLOTS);
+	vty_out(vty,
+		"\tScheduled transmissions: %" PRIu64
+		", average per slot: %" PRIu64 ", busiest slot: %u\n",
+		scheduled, scheduled / BFD_RT_WHEEL_SLOTS, busiest);
+	vty_out(vty, "\tPackets sent per tick:\n");
+	for (int i = 0; i < BFD_RT_TX_HIST; i++) {
+		if (i < 2)
+			snprintf(label, sizeof(label), "%d", i);
+		else if (i < BFD_RT_TX_HIST - 1)
+			snprintf(label, sizeof(label), "%d-%d", 1 << (i - 1),
+				 (1 << i) - 1);
+		else
+			snprintf(label, sizeof(label), "%d or more",
+				 1 << (i - 1));
+		vty_out(vty, "\t\t%12s: %" PRIu64 " ticks\n", label, hist[i]);
+	}
+}
+
+/*
+ * Setup.
+ */
+void bfd_rt_vrf_enable(struct bfd_vrf_global *bvrf)
+{
+	event_add_event(rt.pth->master, bfd_rt_vrf_enable_cb, bvrf, 0, NULL);
+}
+
+void bfd_rt_vrf_disable(struct bfd_vrf_global *bvrf)
+{
+	/* Waits for a running read to finish. */
+	if (frr_event_loop_get_pthread_owner(rt.pth->master) == pthread_self())
+		event_cancel_event(rt.pth->master, bvrf);
+	else
+		event_cancel_async(rt.pth->master, NULL, bvrf);
+}
+
+void bfd_rt_init(void)
+{
+	struct frr_pthread_attr attr = {
+		.start = frr_pthread_attr_default.start,
+		.stop = frr_pthread_attr_default.stop,
+	};
+
+	pthread_mutex_init(&rt.mtx, NULL);
+	pthread_cond_init(&rt.tx_done, NULL);
+	bfd_rt_sessions_init(&rt.sessions);
+	for (size_t i = 0; i < array_size(rt.wheel.slots); i++)
+		bfd_rt_slot_init(&rt.wheel.slots[i]);
+	bfd_rt_msgq_init(&rt.msgq);
+
+	rt.pth = frr_pthread_new(&attr, "BFD packet engine", "bfdd_rt");
+}
+
+void bfd_rt_run(void)
+{
+	frr_pthread_run(rt.pth, NULL);
+	frr_pthread_wait_running(rt.pth);
+}
+
+void bfd_rt_finish(void)
+{
+	struct bfd_rt_msg *msg;
+
+	frr_pthread_stop(rt.pth, NULL);
+	frr_pthread_destroy(rt.pth);
+	rt.pth = NULL;
+
+	event_cancel(&rt.t_msg);
+	while ((msg = bfd_rt_msgq_pop(&rt.msgq)))
+		XFREE(MTYPE_BFDD_RT_MSG, msg);
+	bfd_rt_msgq_fini(&rt.msgq);
+
+	assert(bfd_rt_sessions_count(&rt.sessions) == 0);
+	bfd_rt_sessions_fini(&rt.sessions);
+	for (size_t i = 0; i < array_size(rt.wheel.slots); i++)
+		bfd_rt_slot_fini(&rt.wheel.slots[i]);
+	pthread_cond_destroy(&rt.tx_done);
+	pthread_mutex_destroy(&rt.mtx);
+}
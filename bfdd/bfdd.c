@@ -73,6 +73,9 @@ static FRR_NORETURN void sigterm_handler(void)
 
 	bfd_vrf_terminate();
 
+	/* Nothing is left for the packet engine. */
+	bfd_rt_finish();
+
 	bfdd_zclient_terminate();
 
 	prefix_list_reset();
@@ -388,6 +391,9 @@ int main(int argc, char *argv[])
 	if (perm_vrfs)
 		free(perm_vrfs);
 
+	/* Must be started after fork(). */
+	bfd_rt_run();
+
 	frr_run(master);
 	/* NOTREACHED */
 
@@ -259,8 +259,9 @@ struct yang_data *
 bfdd_bfd_sessions_single_hop_stats_control_packet_input_count_get_elem(
 	struct nb_cb_get_elem_args *args)
 {
-	const struct bfd_session *bs = args->list_entry;
+	struct bfd_session *bs = (struct bfd_session *)args->list_entry;
 
+	bfd_rt_session_counters(bs);
 	return yang_data_new_uint64(args->xpath, bs->stats.rx_ctrl_pkt);
 }
 
@@ -272,8 +273,9 @@ struct yang_data *
 bfdd_bfd_sessions_single_hop_stats_control_packet_output_count_get_elem(
 	struct nb_cb_get_elem_args *args)
 {
-	const struct bfd_session *bs = args->list_entry;
+	struct bfd_session *bs = (struct bfd_session *)args->list_entry;
 
+	bfd_rt_session_counters(bs);
 	return yang_data_new_uint64(args->xpath, bs->stats.tx_ctrl_pkt);
 }
 
@@ -44,8 +44,10 @@ static void _display_peer(struct vty *vty, struct bfd_session *bs);
 static void _display_all_peers(struct vty *vty, char *vrfname, bool use_json);
 static void _display_peer_iter(struct hash_bucket *hb, void *arg);
 static void _display_peer_json_iter(struct hash_bucket *hb, void *arg);
-static void _display_peer_counter(struct vty *vty, struct bfd_session *bs);
-static struct json_object *__display_peer_counters_json(struct bfd_session *bs);
+static void _display_peer_counter(struct vty *vty, struct bfd_session *bs,
+				  bool query_dplane);
+static struct json_object *__display_peer_counters_json(struct bfd_session *bs,
+							bool query_dplane);
 static void _display_peer_counters_json(struct vty *vty, struct bfd_session *bs);
 static void _display_peer_counter_iter(struct hash_bucket *hb, void *arg);
 static void _display_peer_counter_json_iter(struct hash_bucket *hb, void *arg);
@@ -537,12 +539,14 @@ static void _display_all_peers(struct vty *vty, char *vrfname, bool use_json)
 	vty_json(vty, jo);
 }
 
-static void _display_peer_counter(struct vty *vty, struct bfd_session *bs)
+static void _display_peer_counter(struct vty *vty, struct bfd_session *bs,
+				  bool query_dplane)
 {
 	_display_peer_header(vty, bs);
 
-	/* Ask data plane for updated counters. */
-	if (bfd_dplane_update_session_counters(bs) == -1)
+	/* Ask data plane or packet engine for updated counters. */
+	bfd_rt_session_counters(bs);
+	if (query_dplane && bfd_dplane_update_session_counters(bs) == -1)
 		zlog_debug("%s: failed to update BFD session counters (%s)",
 			   __func__, bs_to_string(bs));
 
@@ -565,12 +569,14 @@ static void _display_peer_counter(struct vty *vty, struct bfd_session *bs)
 	vty_out(vty, "\n");
 }
 
-static struct json_object *__display_peer_counters_json(struct bfd_session *bs)
+static struct json_object *__display_peer_counters_json(struct bfd_session *bs,
+							bool query_dplane)
 {
 	struct json_object *jo = _peer_json_header(bs);
 
-	/* Ask data plane for updated counters. */
-	if (bfd_dplane_update_session_counters(bs) == -1)
+	/* Ask data plane or packet engine for updated counters. */
+	bfd_rt_session_counters(bs);
+	if (query_dplane && bfd_dplane_update_session_counters(bs) == -1)
 		zlog_debug("%s: failed to update BFD session counters (%s)",
 			   __func__, bs_to_string(bs));
 
@@ -591,7 +597,7 @@ static struct json_object *__display_peer_counters_json(struct bfd_session *bs)
 
 static void _display_peer_counters_json(struct vty *vty, struct bfd_session *bs)
 {
-	struct json_object *jo = __display_peer_counters_json(bs);
+	struct json_object *jo = __display_peer_counters_json(bs, true);
 
 	vty_json(vty, jo);
 }
@@ -612,7 +618,7 @@ static void _display_peer_counter_iter(struct hash_bucket *hb, void *arg)
 			return;
 	}
 
-	_display_peer_counter(vty, bs);
+	_display_peer_counter(vty, bs, false);
 }
 
 static void _display_peer_counter_json_iter(struct hash_bucket *hb, void *arg)
@@ -631,7 +637,7 @@ static void _display_peer_counter_json_iter(struct hash_bucket *hb, void *arg)
 			return;
 	}
 
-	jon = __display_peer_counters_json(bs);
+	jon = __display_peer_counters_json(bs, false);
 	if (jon == NULL) {
 		zlog_warn("%s: not enough memory", __func__);
 		return;
@@ -640,11 +646,43 @@ static void _display_peer_counter_json_iter(struct hash_bucket *hb, void *arg)
 	json_object_array_add(jo, jon);
 }
 
+static void _display_io_counters(struct vty *vty, bool use_json)
+{
+	const struct bfd_io_stats *stats = &bglobal.bg_io_stats;
+	uint64_t rx_calls, rx_packets;
+	uint32_t rx_batch_max;
+	struct json_object *jo;
+
+	rx_calls = atomic_load_explicit(&stats->rx_calls, memory_order_relaxed);
+	rx_packets = atomic_load_explicit(&stats->rx_packets,
+					  memory_order_relaxed);
+	rx_batch_max = atomic_load_explicit(&stats->rx_batch_max,
+					    memory_order_relaxed);
+
+	if (use_json) {
+		jo = json_object_new_object();
+		json_object_int_add(jo, "receive-calls", rx_calls);
+		json_object_int_add(jo, "receive-packets", rx_packets);
+		json_object_int_add(jo, "receive-largest-batch", rx_batch_max);
+		vty_json(vty, jo);
+		return;
+	}
+
+	vty_out(vty, "Packet I/O:\n");
+	vty_out(vty,
+		"\tReceive calls: %" PRIu64 ", packets: %" PRIu64
+		", largest batch: %u\n",
+		rx_calls, rx_packets, rx_batch_max);
+}
+
 static void _display_peers_counter(struct vty *vty, char *vrfname, bool use_json)
 {
 	struct json_object *jo;
 	struct bfd_vrf_tuple bvt = {0};
 
+	/* Ask the data planes for all sessions counters at once. */
+	bfd_dplane_update_counters();
+
 	bvt.vrfname = vrfname;
 	if (!use_json) {
 		bvt.vty = vty;
@@ -680,7 +718,7 @@ static void _display_bfd_counters_by_bfdname_iter(struct hash_bucket *hb, void *
 			return;
 	}
 
-	_display_peer_counter(vty, bs);
+	_display_peer_counter(vty, bs, false);
 }
 static void _display_bfd_counters_json_by_bfdname_iter(struct hash_bucket *hb, void *arg)
 {
@@ -702,7 +740,7 @@ static void _display_bfd_counters_json_by_bfdname_iter(struct hash_bucket *hb, v
 			return;
 	}
 
-	jon = __display_peer_counters_json(bs);
+	jon = __display_peer_counters_json(bs, false);
 	if (jon == NULL) {
 		zlog_warn("%s: not enough memory", __func__);
 		return;
@@ -716,6 +754,9 @@ static void _display_bfd_counters_by_bfdname(struct vty *vty, const char *vrfnam
 	struct json_object *jo;
 	struct bfd_vrf_tuple bvt = { 0 };
 
+	/* Ask the data planes for all sessions counters at once. */
+	bfd_dplane_update_counters();
+
 	bvt.vrfname = vrfname;
 	bvt.bfdname = bfdname;
 
@@ -767,6 +808,7 @@ static void _clear_peer_counter(struct bfd_session *bs)
 {
 	/* Clear only pkt stats, intention is not to loose system
 	   events counters */
+	bfd_rt_session_counters(bs);
 	bs->stats.rx_ctrl_pkt = 0;
 	bs->stats.tx_ctrl_pkt = 0;
 	bs->stats.rx_echo_pkt = 0;
@@ -1058,7 +1100,7 @@ DEFPY(bfd_show_peer_counters, bfd_show_peer_counters_cmd,
 	if (use_json(argc, argv))
 		_display_peer_counters_json(vty, bs);
 	else
-		_display_peer_counter(vty, bs);
+		_display_peer_counter(vty, bs, true);
 
 	return CMD_SUCCESS;
 }
@@ -1143,6 +1185,27 @@ DEFPY(show_bfd_distributed, show_bfd_distributed_cmd,
 	return CMD_SUCCESS;
 }
 
+DEFPY(show_bfd_counters, show_bfd_counters_cmd,
+      "show bfd counters [json]",
+      SHOW_STR
+      "Bidirection Forwarding Detection\n"
+      "Show BFD software data path packet I/O counters\n"
+      JSON_STR)
+{
+	_display_io_counters(vty, !!json);
+	return CMD_SUCCESS;
+}
+
+DEFPY(show_bfd_scheduler, show_bfd_scheduler_cmd,
+      "show bfd scheduler",
+      SHOW_STR
+      "Bidirection Forwarding Detection\n"
+      "Show BFD transmit scheduler load\n")
+{
+	bfd_rt_show_scheduler(vty);
+	return CMD_SUCCESS;
+}
+
 DEFPY(
 	bfd_debug_distributed, bfd_debug_distributed_cmd,
 	"[no] debug bfd distributed",
@@ -1391,6 +1454,8 @@ void bfdd_vty_init(void)
 	install_element(ENABLE_NODE, &bfd_show_peer_cmd);
 	install_element(ENABLE_NODE, &bfd_show_peers_brief_cmd);
 	install_element(ENABLE_NODE, &show_bfd_distributed_cmd);
+	install_element(ENABLE_NODE, &show_bfd_counters_cmd);
+	install_element(ENABLE_NODE, &show_bfd_scheduler_cmd);
 	install_element(ENABLE_NODE, &show_debugging_bfd_cmd);
 
 	install_element(ENABLE_NODE, &bfd_debug_distributed_cmd);
@@ -71,6 +71,15 @@ enum bfddp_message_type {
 	DP_REQUEST_SESSION_COUNTERS = 5,
 	/** Tell BFD daemon about counters values. */
 	BFD_SESSION_COUNTERS = 6,
+
+	/** Tell BFD daemon which optional messages data plane supports. */
+	BFD_CAPABILITIES = 7,
+	/** Add or update many BFD peer sessions at once. */
+	DP_ADD_SESSIONS = 8,
+	/** Ask for many BFD sessions counters at once. */
+	DP_REQUEST_COUNTERS_BULK = 9,
+	/** Tell BFD daemon about many sessions counters values. */
+	BFD_COUNTERS_BULK = 10,
 };
 
 /**
@@ -348,8 +357,82 @@ struct bfddp_session_counters {
 	uint64_t echo_output_packets;
 };
 
+/** Data plane optional features. */
+enum bfddp_capability_flag {
+	/**
+	 * Data plane understands `DP_ADD_SESSIONS` and
+	 * `DP_REQUEST_COUNTERS_BULK`.
+	 */
+	CAPABILITY_BULK = (1 << 0),
+};
+
+/**
+ * Data plane capabilities announcement.
+ *
+ * Message type: `BFD_CAPABILITIES`.
+ *
+ * Data planes supporting optional messages should send this right after the
+ * connection is established, before answering anything else. BFD daemon
+ * sends an `ECHO_REQUEST` on connection and waits for its `ECHO_REPLY`
+ * before registering sessions, so an announcement sent first is always seen
+ * in time. Data planes not sending it only get the original messages.
+ */
+struct bfddp_capabilities {
+	/** Supported features. \see bfddp_capability_flag. */
+	uint32_t flags;
+};
+
+/**
+ * Many sessions add or update.
+ *
+ * Message type: `DP_ADD_SESSIONS`.
+ *
+ * Each entry has exactly the same meaning as a `DP_ADD_SESSION` payload.
+ * The amount of sessions is limited by the header `length` field.
+ */
+struct bfddp_sessions {
+	/** Amount of sessions following. */
+	uint32_t count;
+	/** The sessions. */
+	struct bfddp_session sessions[];
+};
+
+/**
+ * Many sessions counters request.
+ *
+ * Message type: `DP_REQUEST_COUNTERS_BULK`.
+ *
+ * The answer is a single `BFD_COUNTERS_BULK` message with the same ID. BFD
+ * daemon never asks for more sessions than fit in the answer.
+ */
+struct bfddp_request_counters_bulk {
+	/** Amount of local discriminators following. */
+	uint32_t count;
+	/** Sessions local discriminators. */
+	uint32_t lid[];
+};
+
+/**
+ * Many sessions counters reply.
+ *
+ * Message type: `BFD_COUNTERS_BULK`.
+ *
+ * Sessions unknown to the data plane are left out of the answer.
+ */
+struct bfddp_counters_bulk {
+	/** Amount of counters following. */
+	uint32_t count;
+	/** Reserved / zeroed. */
+	uint32_t zero;
+	/** The counters. */
+	struct bfddp_session_counters counters[];
+};
+
 /**
  * The protocol wire messages structure.
+ *
+ * Bulk messages payloads (`DP_ADD_SESSIONS`, `DP_REQUEST_COUNTERS_BULK` and
+ * `BFD_COUNTERS_BULK`) don't fit here, they follow the header directly.
  */
 struct bfddp_message {
 	/** Message header. \see bfddp_message_header. */
@@ -363,6 +446,7 @@ struct bfddp_message {
 		struct bfddp_control_packet control;
 		struct bfddp_request_counters counters_req;
 		struct bfddp_session_counters session_counters;
+		struct bfddp_capabilities capabilities;
 	} data;
 };
 
@@ -20,6 +20,7 @@
 #endif /* __FreeBSD__ */
 
 #include <errno.h>
+#include <poll.h>
 #include <time.h>
 
 #include "lib/hook.h"
@@ -35,9 +36,45 @@
 
 DEFINE_MTYPE_STATIC(BFDD, BFDD_DPLANE_CTX,
 		    "Data plane client allocated memory");
+DEFINE_MTYPE_STATIC(BFDD, BFDD_DPLANE_REQ, "Data plane bulk request");
 
-/** Data plane client socket buffer size. */
-#define BFD_DPLANE_CLIENT_BUF_SIZE 8192
+/**
+ * Data plane client socket buffer size.
+ *
+ * Must hold at least two of the biggest messages (the header length field
+ * has 16 bits).
+ */
+#define BFD_DPLANE_CLIENT_BUF_SIZE (2 * 65536)
+
+/**
+ * Output buffer maximum size: it grows while the data plane catches up
+ * (e.g. all sessions being registered after a restart).
+ */
+#define BFD_DPLANE_CLIENT_BUF_MAX (16 * 1024 * 1024)
+
+/** Biggest message size. */
+#define BFD_DPLANE_MSG_MAX UINT16_MAX
+
+/** Amount of sessions fitting in a `DP_ADD_SESSIONS` message. */
+#define BFD_DPLANE_SESSIONS_MAX                                                \
+	((BFD_DPLANE_MSG_MAX - sizeof(struct bfddp_message_header)             \
+	  - sizeof(struct bfddp_sessions))                                     \
+	 / sizeof(struct bfddp_session))
+
+/** Amount of sessions counters fitting in a `BFD_COUNTERS_BULK` message. */
+#define BFD_DPLANE_COUNTERS_MAX                                                \
+	((BFD_DPLANE_MSG_MAX - sizeof(struct bfddp_message_header)             \
+	  - sizeof(struct bfddp_counters_bulk))                                \
+	 / sizeof(struct bfddp_session_counters))
+
+/** Maximum amount of requests waiting for answers at the same time. */
+#define BFD_DPLANE_PIPELINE_MAX 4096
+
+/** Seconds to wait for the echo reply before registering sessions. */
+#define BFD_DPLANE_SYNC_TIMEOUT 1
+
+/** Milliseconds to wait for answers of a synchronous query. */
+#define BFD_DPLANE_EXPECT_TIMEOUT 3000
 
 struct bfd_dplane_ctx {
 	/** Client file descriptor. */
@@ -57,6 +94,18 @@ struct bfd_dplane_ctx {
 	socklen_t addrlen;
 	/** Data plane current last used ID. */
 	uint16_t last_id;
+	/** Data plane capabilities. \see bfddp_capability_flag. */
+	uint32_t capabilities;
+	/** Waiting for the data plane echo reply to register sessions. */
+	bool syncing;
+
+	/**
+	 * Output buffer position of the `DP_ADD_SESSIONS` message still
+	 * accepting sessions.
+	 */
+	size_t bulk_pos;
+	/** Amount of sessions in that message (`0` means no open message). */
+	uint32_t bulk_count;
 
 	/** Input buffer data. */
 	struct stream *inbuf;
@@ -68,6 +117,8 @@ struct bfd_dplane_ctx {
 	struct event *outbufev;
 	/** Connection event. */
 	struct event *connectev;
+	/** Sessions registration timeout event. */
+	struct event *syncev;
 
 	/** Amount of bytes read. */
 	uint64_t in_bytes;
@@ -94,11 +145,35 @@ struct bfd_dplane_ctx {
  */
 typedef void (*bfd_dplane_expect_cb)(struct bfddp_message *msg, void *arg);
 
+/**
+ * Answers waited for by `bfd_dplane_expect`: requests are pipelined with
+ * consecutive IDs.
+ */
+struct bfd_dplane_expect {
+	/** First request ID. */
+	uint16_t id;
+	/** Amount of requests. */
+	uint16_t count;
+	/** Amount of answers still missing. */
+	uint16_t pending;
+
+	/** Answers handler. */
+	bfd_dplane_expect_cb cb;
+	/** Answers handler argument. */
+	void *arg;
+};
+
 static void bfd_dplane_client_connect(struct event *t);
 static bool bfd_dplane_client_connecting(struct bfd_dplane_ctx *bdc);
+static void bfd_dplane_write(struct event *t);
 static void bfd_dplane_ctx_free(struct bfd_dplane_ctx *bdc);
 static int _bfd_dplane_add_session(struct bfd_dplane_ctx *bdc,
 				   struct bfd_session *bs);
+static void _bfd_session_register_dplane(struct hash_bucket *hb, void *arg);
+static void _bfd_dplane_session_fill_data(const struct bfd_session *bs,
+					  struct bfddp_session *session);
+static void _bfd_dplane_session_fill(const struct bfd_session *bs,
+				     struct bfddp_message *msg);
 
 /*
  * BFD data plane helper functions.
@@ -120,18 +195,88 @@ static const char *bfd_dplane_messagetype2str(enum bfddp_message_type bmt)
 		return "DP_REQUEST_SESSION_COUNTERS";
 	case BFD_SESSION_COUNTERS:
 		return "BFD_SESSION_COUNTERS";
+	case BFD_CAPABILITIES:
+		return "BFD_CAPABILITIES";
+	case DP_ADD_SESSIONS:
+		return "DP_ADD_SESSIONS";
+	case DP_REQUEST_COUNTERS_BULK:
+		return "DP_REQUEST_COUNTERS_BULK";
+	case BFD_COUNTERS_BULK:
+		return "BFD_COUNTERS_BULK";
 	default:
 		return "UNKNOWN";
 	}
 }
 
-static void bfd_dplane_debug_message(const struct bfddp_message *msg)
+static void bfd_dplane_debug_session(const struct bfddp_session *session)
 {
-	enum bfddp_message_type bmt;
 	char buf[256], addrs[256];
 	uint32_t flags;
 	int rv;
 
+	flags = ntohl(session->flags);
+	if (flags & SESSION_IPV6)
+		snprintfrr(addrs, sizeof(addrs), "src=%pI6 dst=%pI6",
+			   &session->src, &session->dst);
+	else
+		snprintfrr(addrs, sizeof(addrs), "src=%pI4 dst=%pI4",
+			   (struct in_addr *)&session->src,
+			   (struct in_addr *)&session->dst);
+
+	buf[0] = 0;
+	if (flags & SESSION_CBIT)
+		strlcat(buf, "cpi ", sizeof(buf));
+	if (flags & SESSION_ECHO)
+		strlcat(buf, "echo ", sizeof(buf));
+	if (flags & SESSION_IPV6)
+		strlcat(buf, "ipv6 ", sizeof(buf));
+	if (flags & SESSION_DEMAND)
+		strlcat(buf, "demand ", sizeof(buf));
+	if (flags & SESSION_PASSIVE)
+		strlcat(buf, "passive ", sizeof(buf));
+	if (flags & SESSION_MULTIHOP)
+		strlcat(buf, "multihop ", sizeof(buf));
+	if (flags & SESSION_SHUTDOWN)
+		strlcat(buf, "shutdown ", sizeof(buf));
+
+	/* Remove the last space to make things prettier. */
+	rv = (int)strlen(buf);
+	if (rv > 0)
+		buf[rv - 1] = 0;
+
+	zlog_debug("  [flags=0x%08x{%s} %s ttl=%d detect_mult=%d "
+		   "ifindex=%d ifname=%s]",
+		   flags, buf, addrs, session->ttl, session->detect_mult,
+		   ntohl(session->ifindex), session->ifname);
+}
+
+static void
+bfd_dplane_debug_counters(const struct bfddp_session_counters *counters)
+{
+	zlog_debug("  [lid=%u "
+		   "control{in %" PRIu64 " bytes (%" PRIu64 " packets), "
+		   "out %" PRIu64 " bytes (%" PRIu64 " packets)} "
+		   "echo{in %" PRIu64 " bytes (%" PRIu64 " packets), "
+		   "out %" PRIu64 " bytes (%" PRIu64 " packets)}]",
+		   ntohl(counters->lid), be64toh(counters->control_input_bytes),
+		   be64toh(counters->control_input_packets),
+		   be64toh(counters->control_output_bytes),
+		   be64toh(counters->control_output_packets),
+		   be64toh(counters->echo_input_bytes),
+		   be64toh(counters->echo_input_packets),
+		   be64toh(counters->echo_output_bytes),
+		   be64toh(counters->echo_output_packets));
+}
+
+static void bfd_dplane_debug_message(const struct bfddp_message *msg)
+{
+	const struct bfddp_request_counters_bulk *req_bulk;
+	const struct bfddp_counters_bulk *counters_bulk;
+	enum bfddp_message_type bmt;
+	char buf[256];
+	uint32_t flags, count, i;
+	int rv;
+
 	if (!bglobal.debug_dplane)
 		return;
 
@@ -150,44 +295,7 @@ static void bfd_dplane_debug_message(const struct bfddp_message *msg)
 
 	case DP_ADD_SESSION:
 	case DP_DELETE_SESSION:
-		flags = ntohl(msg->data.session.flags);
-		if (flags & SESSION_IPV6)
-			snprintfrr(addrs, sizeof(addrs), "src=%pI6 dst=%pI6",
-				   &msg->data.session.src,
-				   &msg->data.session.dst);
-		else
-			snprintfrr(addrs, sizeof(addrs), "src=%pI4 dst=%pI4",
-				   (struct in_addr *)&msg->data.session.src,
-				   (struct in_addr *)&msg->data.session.dst);
-
-		buf[0] = 0;
-		if (flags & SESSION_CBIT)
-			strlcat(buf, "cpi ", sizeof(buf));
-		if (flags & SESSION_ECHO)
-			strlcat(buf, "echo ", sizeof(buf));
-		if (flags & SESSION_IPV6)
-			strlcat(buf, "ipv6 ", sizeof(buf));
-		if (flags & SESSION_DEMAND)
-			strlcat(buf, "demand ", sizeof(buf));
-		if (flags & SESSION_PASSIVE)
-			strlcat(buf, "passive ", sizeof(buf));
-		if (flags & SESSION_MULTIHOP)
-			strlcat(buf, "multihop ", sizeof(buf));
-		if (flags & SESSION_SHUTDOWN)
-			strlcat(buf, "shutdown ", sizeof(buf));
-
-		/* Remove the last space to make things prettier. */
-		rv = (int)strlen(buf);
-		if (rv > 0)
-			buf[rv - 1] = 0;
-
-		zlog_debug(
-			"  [flags=0x%08x{%s} %s ttl=%d detect_mult=%d "
-			"ifindex=%d ifname=%s]",
-			flags, buf, addrs, msg->data.session.ttl,
-			msg->data.session.detect_mult,
-			ntohl(msg->data.session.ifindex),
-			msg->data.session.ifname);
+		bfd_dplane_debug_session(&msg->data.session);
 		break;
 
 	case BFD_STATE_CHANGE:
@@ -222,28 +330,31 @@ static void bfd_dplane_debug_message(const struct bfddp_message *msg)
 		break;
 
 	case BFD_SESSION_COUNTERS:
-		zlog_debug(
-			"  [lid=%u "
-			"control{in %" PRIu64 " bytes (%" PRIu64
-			" packets), "
-			"out %" PRIu64 " bytes (%" PRIu64
-			" packets)} "
-			"echo{in %" PRIu64 " bytes (%" PRIu64
-			" packets), "
-			"out %" PRIu64 " bytes (%" PRIu64 " packets)}]",
-			ntohl(msg->data.session_counters.lid),
-			be64toh(msg->data.session_counters.control_input_bytes),
-			be64toh(msg->data.session_counters
-				.control_input_packets),
-			be64toh(msg->data.session_counters
-				.control_output_bytes),
-			be64toh(msg->data.session_counters
-				.control_output_packets),
-			be64toh(msg->data.session_counters.echo_input_bytes),
-			be64toh(msg->data.session_counters.echo_input_packets),
-			be64toh(msg->data.session_counters.echo_output_bytes),
-			be64toh(msg->data.session_counters
-				.echo_output_packets));
+		bfd_dplane_debug_counters(&msg->data.session_counters);
+		break;
+
+	case BFD_CAPABILITIES:
+		zlog_debug("  [flags=0x%08x]",
+			   ntohl(msg->data.capabilities.flags));
+		break;
+
+	case DP_ADD_SESSIONS:
+		/* Sessions are shown as they get added to the message. */
+		break;
+
+	case DP_REQUEST_COUNTERS_BULK:
+		req_bulk = (const struct bfddp_request_counters_bulk *)&msg->data;
+		zlog_debug("  [count=%u]", ntohl(req_bulk->count));
+		break;
+
+	case BFD_COUNTERS_BULK:
+		counters_bulk = (const struct bfddp_counters_bulk *)&msg->data;
+		count = ntohl(counters_bulk->count);
+		zlog_debug("  [count=%u]", count);
+		if (count > BFD_DPLANE_COUNTERS_MAX)
+			count = BFD_DPLANE_COUNTERS_MAX;
+		for (i = 0; i < count; i++)
+			bfd_dplane_debug_counters(&counters_bulk->counters[i]);
 		break;
 	}
 }
@@ -266,31 +377,68 @@ static uint16_t bfd_dplane_next_id(struct bfd_dplane_ctx *bdc)
 	return bdc->last_id;
 }
 
+/**
+ * Gets a block of consecutive unused non zero identifications for pipelined
+ * requests.
+ *
+ * \param bdc the data plane context.
+ * \param count the amount of identifications.
+ *
+ * \returns the first identification of the block.
+ */
+static uint16_t bfd_dplane_next_ids(struct bfd_dplane_ctx *bdc, uint16_t count)
+{
+	uint16_t id = bfd_dplane_next_id(bdc);
+
+	/* Don't wrap around in the middle of the block. */
+	if ((uint32_t)id + count - 1 > UINT16_MAX)
+		id = 1;
+
+	bdc->last_id = id + count - 1;
+
+	return id;
+}
+
+/**
+ * Writes the output buffer to the socket, everything buffered since the last
+ * call goes out with as few system calls as the socket allows.
+ *
+ * \param bdc the data plane context.
+ *
+ * \returns
+ * the amount of bytes written or `-1` if the connection failed (the context
+ * must not be used anymore).
+ */
 static ssize_t bfd_dplane_flush(struct bfd_dplane_ctx *bdc)
 {
 	ssize_t total = 0;
 	int rv;
 
+	/* Data is leaving: sessions can't be added to it anymore. */
+	bdc->bulk_count = 0;
+
 	while (STREAM_READABLE(bdc->outbuf)) {
 		/* Flush buffer contents to socket. */
 		rv = stream_flush(bdc->outbuf, bdc->sock);
 		if (rv == -1) {
 			/* Interruption: try again. */
-			if (errno == EAGAIN || errno == EWOULDBLOCK
-			    || errno == EINTR)
+			if (errno == EINTR)
 				continue;
+			/* Socket is full: wait for the write event. */
+			if (errno == EAGAIN || errno == EWOULDBLOCK)
+				break;
 
 			zlog_warn("%s: socket failed: %s", __func__,
 				  strerror(errno));
 			bfd_dplane_ctx_free(bdc);
-			return 0;
+			return -1;
 		}
 		if (rv == 0) {
 			if (bglobal.debug_dplane)
 				zlog_info("%s: connection closed", __func__);
 
 			bfd_dplane_ctx_free(bdc);
-			return 0;
+			return -1;
 		}
 
 		/* Account total written. */
@@ -306,8 +454,12 @@ static ssize_t bfd_dplane_flush(struct bfd_dplane_ctx *bdc)
 	/* Make more space for new data. */
 	stream_pulldown(bdc->outbuf);
 
-	/* Disable write ready events. */
-	event_cancel(&bdc->outbufev);
+	/* Only wait for write ready events if something is left. */
+	if (STREAM_READABLE(bdc->outbuf) == 0)
+		event_cancel(&bdc->outbufev);
+	else if (bdc->outbufev == NULL)
+		event_add_write(master, bfd_dplane_write, bdc, bdc->sock,
+				&bdc->outbufev);
 
 	return total;
 }
@@ -396,37 +548,53 @@ bfd_dplane_session_state_change(struct bfd_dplane_ctx *bdc,
 }
 
 /**
- * Enqueue message in output buffer.
+ * Makes room in the output buffer, writing to the socket if needed.
  *
  * \param[in,out] bdc data plane client context.
- * \param[in] buf the message to buffer.
- * \param[in] buflen the amount of bytes to buffer.
+ * \param[in] len the amount of bytes needed.
  *
  * \returns `-1` on failure (buffer full) or `0` on success.
  */
-static int bfd_dplane_enqueue(struct bfd_dplane_ctx *bdc, const void *buf,
-			      size_t buflen)
+static int bfd_dplane_reserve(struct bfd_dplane_ctx *bdc, size_t len)
 {
-	size_t rlen;
+	size_t size;
 
 	/* Handle not connected yet client. */
 	if (bdc->client && bdc->sock == -1)
 		return -1;
 
-	/* Not enough space. */
-	if (buflen > STREAM_WRITEABLE(bdc->outbuf)) {
-		bdc->out_fullev++;
+	if (len <= STREAM_WRITEABLE(bdc->outbuf))
+		return 0;
+
+	/* Not enough space: attempt to send what we have. */
+	if (!bdc->connecting && bfd_dplane_flush(bdc) == -1)
 		return -1;
+	if (len <= STREAM_WRITEABLE(bdc->outbuf))
+		return 0;
+
+	/* Data plane is not keeping up: buffer more. */
+	size = STREAM_SIZE(bdc->outbuf);
+	if (size < BFD_DPLANE_CLIENT_BUF_MAX) {
+		size = MAX(2 * size, stream_get_endp(bdc->outbuf) + len);
+		stream_resize_inplace(&bdc->outbuf,
+				      MIN(size, BFD_DPLANE_CLIENT_BUF_MAX));
+		if (len <= STREAM_WRITEABLE(bdc->outbuf))
+			return 0;
 	}
 
-	/* Show debug message if active. */
-	bfd_dplane_debug_message((struct bfddp_message *)buf);
+	bdc->out_fullev++;
+	return -1;
+}
 
-	/* Buffer the message. */
-	stream_write(bdc->outbuf, buf, buflen);
+/**
+ * Accounts buffered output and makes sure it will be written: the write
+ * happens once per event loop iteration, no matter how many messages were
+ * buffered.
+ */
+static void bfd_dplane_enqueued(struct bfd_dplane_ctx *bdc)
+{
+	size_t rlen;
 
-	/* Account message as sent. */
-	bdc->out_msgs++;
 	/* Register peak buffered bytes. */
 	rlen = STREAM_READABLE(bdc->outbuf);
 	if (bdc->out_bytes_peak < rlen)
@@ -436,6 +604,108 @@ static int bfd_dplane_enqueue(struct bfd_dplane_ctx *bdc, const void *buf,
 	if (bdc->outbufev == NULL)
 		event_add_write(master, bfd_dplane_write, bdc, bdc->sock,
 				&bdc->outbufev);
+}
+
+/**
+ * Enqueue message in output buffer.
+ *
+ * \param[in,out] bdc data plane client context.
+ * \param[in] buf the message to buffer.
+ * \param[in] buflen the amount of bytes to buffer.
+ *
+ * \returns `-1` on failure (buffer full) or `0` on success.
+ */
+static int bfd_dplane_enqueue(struct bfd_dplane_ctx *bdc, const void *buf,
+			      size_t buflen)
+{
+	if (bfd_dplane_reserve(bdc, buflen) == -1)
+		return -1;
+
+	/* Show debug message if active. */
+	bfd_dplane_debug_message((struct bfddp_message *)buf);
+
+	/* Keep messages order: no more sessions in a previous message. */
+	bdc->bulk_count = 0;
+
+	/* Buffer the message. */
+	stream_write(bdc->outbuf, buf, buflen);
+
+	/* Account message as sent. */
+	bdc->out_msgs++;
+
+	bfd_dplane_enqueued(bdc);
+
+	return 0;
+}
+
+/**
+ * Enqueue session add or update in output buffer.
+ *
+ * If the data plane supports it, the session is added to the last
+ * `DP_ADD_SESSIONS` message if that is still the last buffered message,
+ * so all sessions changed in the same event loop iteration are sent in as
+ * few messages as possible.
+ *
+ * \param[in,out] bdc data plane client context.
+ * \param[in] bs the session.
+ *
+ * \returns `-1` on failure (buffer full) or `0` on success.
+ */
+static int bfd_dplane_enqueue_session(struct bfd_dplane_ctx *bdc,
+				      const struct bfd_session *bs)
+{
+	struct bfddp_message msg = {};
+	struct bfddp_session session = {};
+	size_t hdrlen = sizeof(struct bfddp_message_header)
+			+ sizeof(struct bfddp_sessions);
+
+	if (!CHECK_FLAG(bdc->capabilities, CAPABILITY_BULK)) {
+		_bfd_dplane_session_fill(bs, &msg);
+		return bfd_dplane_enqueue(bdc, &msg, ntohs(msg.header.length));
+	}
+
+	_bfd_dplane_session_fill_data(bs, &session);
+
+	/* Current message is full. */
+	if (bdc->bulk_count == BFD_DPLANE_SESSIONS_MAX
+	    || sizeof(session) > STREAM_WRITEABLE(bdc->outbuf))
+		bdc->bulk_count = 0;
+
+	/* Start a new message. */
+	if (bdc->bulk_count == 0) {
+		if (bfd_dplane_reserve(bdc, hdrlen + sizeof(session)) == -1)
+			return -1;
+
+		bdc->bulk_pos = stream_get_endp(bdc->outbuf);
+		stream_putc(bdc->outbuf, BFD_DP_VERSION);
+		stream_putc(bdc->outbuf, 0);
+		stream_putw(bdc->outbuf, DP_ADD_SESSIONS);
+		stream_putw(bdc->outbuf, 0);
+		stream_putw(bdc->outbuf, hdrlen);
+		stream_putl(bdc->outbuf, 0);
+
+		/* Account message as sent. */
+		bdc->out_msgs++;
+	}
+
+	if (bglobal.debug_dplane) {
+		zlog_debug("dplane-packet: [DP_ADD_SESSIONS session=%u]",
+			   bdc->bulk_count + 1);
+		bfd_dplane_debug_session(&session);
+	}
+
+	/* Append session and keep the message consistent. */
+	stream_write(bdc->outbuf, &session, sizeof(session));
+	bdc->bulk_count++;
+	stream_putw_at(bdc->outbuf,
+		       bdc->bulk_pos
+			       + offsetof(struct bfddp_message_header, length),
+		       hdrlen + bdc->bulk_count * sizeof(session));
+	stream_putl_at(bdc->outbuf,
+		       bdc->bulk_pos + sizeof(struct bfddp_message_header),
+		       bdc->bulk_count);
+
+	bfd_dplane_enqueued(bdc);
 
 	return 0;
 }
@@ -452,6 +722,7 @@ static void bfd_dplane_echo_request_handle(struct bfd_dplane_ctx *bdc,
 	/* Prepare header. */
 	msg.header.version = BFD_DP_VERSION;
 	msg.header.type = htons(ECHO_REPLY);
+	msg.header.id = bm->header.id;
 	msg.header.length = htons(msglen);
 
 	/* Prepare payload. */
@@ -463,6 +734,129 @@ static void bfd_dplane_echo_request_handle(struct bfd_dplane_ctx *bdc,
 	bfd_dplane_enqueue(bdc, &msg, msglen);
 }
 
+/**
+ * Registers all unattached sessions with the data plane.
+ *
+ * \param bdc the data plane context.
+ */
+static void bfd_dplane_sync(struct bfd_dplane_ctx *bdc)
+{
+	bdc->syncing = false;
+	event_cancel(&bdc->syncev);
+
+	if (bglobal.debug_dplane)
+		zlog_debug("%s: registering sessions (capabilities 0x%08x)",
+			   __func__, bdc->capabilities);
+
+	/* Register all unattached sessions. */
+	bfd_key_iterate(_bfd_session_register_dplane, bdc);
+}
+
+static void bfd_dplane_sync_timeout(struct event *t)
+{
+	struct bfd_dplane_ctx *bdc = EVENT_ARG(t);
+
+	if (bglobal.debug_dplane)
+		zlog_debug("%s: data plane didn't answer echo request",
+			   __func__);
+
+	bfd_dplane_sync(bdc);
+}
+
+/**
+ * Starts sessions registration.
+ *
+ * Data planes announce their capabilities as soon as the connection is
+ * established, so waiting for the answer of an echo request makes sure we
+ * know them before sending the sessions. Data planes not answering echo
+ * requests get their sessions after a short timeout.
+ *
+ * \param bdc the data plane context.
+ */
+static void bfd_dplane_sync_start(struct bfd_dplane_ctx *bdc)
+{
+	struct bfddp_message msg = {};
+	uint16_t msglen = sizeof(msg.header) + sizeof(msg.data.echo);
+	struct timeval tv;
+
+	bdc->capabilities = 0;
+	bdc->syncing = true;
+	event_add_timer(master, bfd_dplane_sync_timeout, bdc,
+			BFD_DPLANE_SYNC_TIMEOUT, &bdc->syncev);
+
+	gettimeofday(&tv, NULL);
+
+	/* Prepare header. */
+	msg.header.version = BFD_DP_VERSION;
+	msg.header.type = htons(ECHO_REQUEST);
+	msg.header.id = htons(bfd_dplane_next_id(bdc));
+	msg.header.length = htons(msglen);
+
+	/* Prepare payload. */
+	msg.data.echo.bfdd_time =
+		htobe64((uint64_t)((tv.tv_sec * 1000000) + tv.tv_usec));
+
+	/* Nothing to wait for if we can't ask. */
+	if (bfd_dplane_enqueue(bdc, &msg, msglen) == -1)
+		bfd_dplane_sync(bdc);
+}
+
+static void
+bfd_dplane_session_counters_update(struct bfd_dplane_ctx *bdc,
+				   const struct bfddp_session_counters *counters)
+{
+	struct bfd_session *bs;
+
+	bs = bfd_id_lookup(ntohl(counters->lid));
+	if (bs == NULL || bs->bdc != bdc) {
+		if (bglobal.debug_dplane)
+			zlog_debug("%s: failed to find session to update",
+				   __func__);
+		return;
+	}
+
+	bs->stats.rx_ctrl_pkt = be64toh(counters->control_input_packets);
+	bs->stats.tx_ctrl_pkt = be64toh(counters->control_output_packets);
+	bs->stats.rx_echo_pkt = be64toh(counters->echo_input_packets);
+	bs->stats.tx_echo_pkt = be64toh(counters->echo_output_packets);
+}
+
+/**
+ * Handles `BFD_SESSION_COUNTERS` and `BFD_COUNTERS_BULK` messages.
+ *
+ * \param msg the message.
+ * \param arg the data plane context.
+ */
+static void _bfd_dplane_update_session_counters(struct bfddp_message *msg,
+						void *arg)
+{
+	const struct bfddp_counters_bulk *bulk;
+	struct bfd_dplane_ctx *bdc = arg;
+	size_t count, max;
+
+	if (ntohs(msg->header.type) == BFD_SESSION_COUNTERS) {
+		bfd_dplane_session_counters_update(bdc,
+						   &msg->data.session_counters);
+		return;
+	}
+
+	/* Don't trust the count beyond the message length. */
+	bulk = (const struct bfddp_counters_bulk *)&msg->data;
+	max = (ntohs(msg->header.length) - sizeof(msg->header)
+	       - sizeof(*bulk))
+	      / sizeof(bulk->counters[0]);
+	count = ntohl(bulk->count);
+	if (count > max) {
+		zlog_warn("%s: bad counters amount %zu (message fits %zu)",
+			  __func__, count, max);
+		count = max;
+	}
+
+	while (count--)
+		bfd_dplane_session_counters_update(bdc,
+						   &bulk->counters[count]);
+}
+
 static void bfd_dplane_handle_message(struct bfddp_message *msg, void *arg)
 {
 	enum bfddp_message_type bmt;
@@ -478,18 +872,27 @@ static void bfd_dplane_handle_message(struct bfddp_message *msg, void *arg)
 		bfd_dplane_session_state_change(bdc, &msg->data.state);
 		break;
 	case ECHO_REPLY:
-		/* NOTHING: we don't do anything with this information. */
+		/* Capabilities were announced before this: register now. */
+		if (bdc->syncing)
+			bfd_dplane_sync(bdc);
+		break;
+	case BFD_CAPABILITIES:
+		bdc->capabilities = ntohl(msg->data.capabilities.flags);
 		break;
 	case DP_ADD_SESSION:
 	case DP_DELETE_SESSION:
 	case DP_REQUEST_SESSION_COUNTERS:
+	case DP_ADD_SESSIONS:
+	case DP_REQUEST_COUNTERS_BULK:
 		/* NOTHING: we are not supposed to receive this. */
 		break;
 	case BFD_SESSION_COUNTERS:
+	case BFD_COUNTERS_BULK:
 		/*
-		 * NOTHING: caller of DP_REQUEST_SESSION_COUNTERS should
-		 * handle this with `bfd_dplane_expect`.
+		 * Answer arriving after its requester gave up waiting in
+		 * `bfd_dplane_expect`: the values are still good.
 		 */
+		_bfd_dplane_update_session_counters(msg, bdc);
 		break;
 
 	default:
@@ -499,21 +902,22 @@ static void bfd_dplane_handle_message(struct bfddp_message *msg, void *arg)
 }
 
 /**
- * Reads the socket immediately to receive data plane answer to query.
+ * Reads the socket immediately to receive data plane answers to queries.
  *
  * \param bdc the data plane context.
- * \param id the message ID waiting response.
- * \param cb the callback to call when ready.
- * \param arg the callback argument.
+ * \param be the answers to wait for or `NULL` to just handle what is
+ *           available.
  *
  * \return
- * `-2` on unavailability (try again), `-1` on failure or `0` on success.
+ * `-2` on unavailability (try again), `-1` on failure or `0` on success
+ * (all answers received).
  */
-static int bfd_dplane_expect(struct bfd_dplane_ctx *bdc, uint16_t id,
-			     bfd_dplane_expect_cb cb, void *arg)
+static int bfd_dplane_expect(struct bfd_dplane_ctx *bdc,
+			     struct bfd_dplane_expect *be)
 {
 	struct bfddp_message_header *bh;
 	size_t rlen = 0, reads = 0;
+	bool expected;
 	ssize_t rv;
 
 	/*
@@ -546,17 +950,20 @@ read_again:
 
 	/* Account read bytes. */
 	bdc->in_bytes += (uint64_t)rv;
+
+skip_read:
 	/* Register peak buffered bytes. */
 	rlen = STREAM_READABLE(bdc->inbuf);
 	if (bdc->in_bytes_peak < rlen)
 		bdc->in_bytes_peak = rlen;
 
-skip_read:
 	while (rlen > 0) {
 		bh = (struct bfddp_message_header *)stream_pnt(bdc->inbuf);
-		/* Not enough data read. */
-		if (ntohs(bh->length) > rlen)
+		/* Not enough data read: make room for the rest. */
+		if (rlen < sizeof(*bh) || ntohs(bh->length) > rlen) {
+			stream_pulldown(bdc->inbuf);
 			goto read_again;
+		}
 
 		/* Account full message read. */
 		bdc->in_msgs++;
@@ -570,6 +977,12 @@ skip_read:
 				 __func__, bh->version);
 			return -1;
 		}
+		/* Check for bad length. */
+		if (ntohs(bh->length) < sizeof(*bh)) {
+			zlog_err("%s: bad data plane message length: %d",
+				 __func__, ntohs(bh->length));
+			return -1;
+		}
 
 		/* Show debug message if active. */
 		bfd_dplane_debug_message((struct bfddp_message *)bh);
@@ -578,8 +991,10 @@ skip_read:
 		 * Handle incoming message with callback if the ID matches,
 		 * otherwise fallback to default handler.
 		 */
-		if (id && ntohs(bh->id) == id)
-			cb((struct bfddp_message *)bh, arg);
+		expected = be && bh->id
+			   && (uint16_t)(ntohs(bh->id) - be->id) < be->count;
+		if (expected)
+			be->cb((struct bfddp_message *)bh, be->arg);
 		else
 			bfd_dplane_handle_message((struct bfddp_message *)bh,
 						  bdc);
@@ -596,20 +1011,71 @@ skip_read:
 			reads = 0;
 		}
 
-		/* We found the message, return to caller. */
-		if (id && ntohs(bh->id) == id)
-			break;
+		/* We found all messages, return to caller. */
+		if (expected && be->pending && --be->pending == 0)
+			return 0;
+	}
+
+	/* Answers still missing. */
+	if (be && be->pending) {
+		stream_pulldown(bdc->inbuf);
+		goto read_again;
 	}
 
 	return 0;
 }
 
+/**
+ * Sends the buffered requests and waits for their answers.
+ *
+ * \param bdc the data plane context.
+ * \param be the answers to wait for.
+ *
+ * \return
+ * `-1` on failure (the context must not be used anymore if the connection
+ * failed) or `0` on success.
+ */
+static int bfd_dplane_wait(struct bfd_dplane_ctx *bdc,
+			   struct bfd_dplane_expect *be)
+{
+	struct pollfd pfd = { .fd = bdc->sock };
+	int rv;
+
+	for (;;) {
+		/* Keep sending while the data plane reads our requests. */
+		if (STREAM_READABLE(bdc->outbuf) && bfd_dplane_flush(bdc) == -1)
+			return -1;
+
+		rv = bfd_dplane_expect(bdc, be);
+		if (rv != -2)
+			return rv;
+
+		pfd.events = POLLIN;
+		if (STREAM_READABLE(bdc->outbuf))
+			pfd.events |= POLLOUT;
+
+		rv = poll(&pfd, 1, BFD_DPLANE_EXPECT_TIMEOUT);
+		if (rv == -1 && errno == EINTR)
+			continue;
+		if (rv == -1) {
+			zlog_warn("%s: poll failed: %s", __func__,
+				  strerror(errno));
+			return -1;
+		}
+		if (rv == 0) {
+			zlog_warn("%s: data plane didn't answer %u requests",
+				  __func__, be->pending);
+			return -1;
+		}
+	}
+}
+
 static void bfd_dplane_read(struct event *t)
 {
 	struct bfd_dplane_ctx *bdc = EVENT_ARG(t);
 	int rv;
 
-	rv = bfd_dplane_expect(bdc, 0, bfd_dplane_handle_message, NULL);
+	rv = bfd_dplane_expect(bdc, NULL);
 	if (rv == -1)
 		return;
 
@@ -649,7 +1115,7 @@ static struct bfd_dplane_ctx *bfd_dplane_ctx_new(int sock)
 	event_add_read(master, bfd_dplane_read, bdc, sock, &bdc->inbufev);
 
 	/* Register all unattached sessions. */
-	bfd_key_iterate(_bfd_session_register_dplane, bdc);
+	bfd_dplane_sync_start(bdc);
 
 	return bdc;
 }
@@ -687,6 +1153,9 @@ static void bfd_dplane_ctx_free(struct bfd_dplane_ctx *bdc)
 		socket_close(&bdc->sock);
 		event_cancel(&bdc->inbufev);
 		event_cancel(&bdc->outbufev);
+		event_cancel(&bdc->syncev);
+		bdc->syncing = false;
+		bdc->bulk_count = 0;
 		event_add_timer(master, bfd_dplane_client_connect, bdc, 3,
 				&bdc->connectev);
 		return;
@@ -706,52 +1175,59 @@ free_resources:
 	stream_free(bdc->outbuf);
 	event_cancel(&bdc->inbufev);
 	event_cancel(&bdc->outbufev);
+	event_cancel(&bdc->syncev);
 	XFREE(MTYPE_BFDD_DPLANE_CTX, bdc);
 }
 
-static void _bfd_dplane_session_fill(const struct bfd_session *bs,
-				     struct bfddp_message *msg)
+static void _bfd_dplane_session_fill_data(const struct bfd_session *bs,
+					  struct bfddp_session *session)
 {
-	uint16_t msglen = sizeof(msg->header) + sizeof(msg->data.session);
-
-	/* Message header. */
-	msg->header.version = BFD_DP_VERSION;
-	msg->header.length = ntohs(msglen);
-	msg->header.type = ntohs(DP_ADD_SESSION);
-
-	/* Message payload. */
-	msg->data.session.dst = bs->key.peer;
-	msg->data.session.src = bs->key.local;
-	msg->data.session.detect_mult = bs->detect_mult;
+	session->dst = bs->key.peer;
+	session->src = bs->key.local;
+	session->detect_mult = bs->detect_mult;
 
 	if (bs->ifp) {
-		msg->data.session.ifindex = htonl(bs->ifp->ifindex);
-		strlcpy(msg->data.session.ifname, bs->ifp->name,
-			sizeof(msg->data.session.ifname));
+		session->ifindex = htonl(bs->ifp->ifindex);
+		strlcpy(session->ifname, bs->ifp->name,
+			sizeof(session->ifname));
 	}
 	if (bs->flags & BFD_SESS_FLAG_MH) {
-		msg->data.session.flags |= SESSION_MULTIHOP;
-		msg->data.session.ttl = bs->mh_ttl;
+		session->flags |= SESSION_MULTIHOP;
+		session->ttl = bs->mh_ttl;
 	} else
-		msg->data.session.ttl = BFD_TTL_VAL;
+		session->ttl = BFD_TTL_VAL;
 
 	if (bs->flags & BFD_SESS_FLAG_IPV6)
-		msg->data.session.flags |= SESSION_IPV6;
+		session->flags |= SESSION_IPV6;
 	if (bs->flags & BFD_SESS_FLAG_ECHO)
-		msg->data.session.flags |= SESSION_ECHO;
+		session->flags |= SESSION_ECHO;
 	if (bs->flags & BFD_SESS_FLAG_CBIT)
-		msg->data.session.flags |= SESSION_CBIT;
+		session->flags |= SESSION_CBIT;
 	if (bs->flags & BFD_SESS_FLAG_PASSIVE)
-		msg->data.session.flags |= SESSION_PASSIVE;
+		session->flags |= SESSION_PASSIVE;
 	if (bs->flags & BFD_SESS_FLAG_SHUTDOWN)
-		msg->data.session.flags |= SESSION_SHUTDOWN;
-
-	msg->data.session.flags = htonl(msg->data.session.flags);
-	msg->data.session.lid = htonl(bs->discrs.my_discr);
-	msg->data.session.min_tx = htonl(bs->timers.desired_min_tx);
-	msg->data.session.min_rx = htonl(bs->timers.required_min_rx);
-	msg->data.session.min_echo_tx = htonl(bs->timers.desired_min_echo_tx);
-	msg->data.session.min_echo_rx = htonl(bs->timers.required_min_echo_rx);
+		session->flags |= SESSION_SHUTDOWN;
+
+	session->flags = htonl(session->flags);
+	session->lid = htonl(bs->discrs.my_discr);
+	session->min_tx = htonl(bs->timers.desired_min_tx);
+	session->min_rx = htonl(bs->timers.required_min_rx);
+	session->min_echo_tx = htonl(bs->timers.desired_min_echo_tx);
+	session->min_echo_rx = htonl(bs->timers.required_min_echo_rx);
+}
+
+static void _bfd_dplane_session_fill(const struct bfd_session *bs,
+				     struct bfddp_message *msg)
+{
+	uint16_t msglen = sizeof(msg->header) + sizeof(msg->data.session);
+
+	/* Message header. */
+	msg->header.version = BFD_DP_VERSION;
+	msg->header.length = ntohs(msglen);
+	msg->header.type = ntohs(DP_ADD_SESSION);
+
+	/* Message payload. */
+	_bfd_dplane_session_fill_data(bs, &msg->data.session);
 }
 
 static int _bfd_dplane_add_session(struct bfd_dplane_ctx *bdc,
@@ -775,29 +1251,16 @@ static int _bfd_dplane_add_session(struct bfd_dplane_ctx *bdc,
 	return rv;
 }
 
-static void _bfd_dplane_update_session_counters(struct bfddp_message *msg,
-						void *arg)
-{
-	struct bfd_session *bs = arg;
-
-	bs->stats.rx_ctrl_pkt =
-		be64toh(msg->data.session_counters.control_input_packets);
-	bs->stats.tx_ctrl_pkt =
-		be64toh(msg->data.session_counters.control_output_packets);
-	bs->stats.rx_echo_pkt =
-		be64toh(msg->data.session_counters.echo_input_packets);
-	bs->stats.tx_echo_pkt =
-		be64toh(msg->data.session_counters.echo_output_bytes);
-}
-
 /**
  * Send message to data plane requesting the session counters.
  *
  * \param bs the BFD session.
+ * \param id the request id.
  *
- * \returns `0` on failure or the request id.
+ * \returns `-1` on failure (buffer full) or `0` on success.
  */
-static uint16_t bfd_dplane_request_counters(const struct bfd_session *bs)
+static int bfd_dplane_request_counters(const struct bfd_session *bs,
+				       uint16_t id)
 {
 	struct bfddp_message msg = {};
 	size_t msglen = sizeof(msg.header) + sizeof(msg.data.counters_req);
@@ -806,19 +1269,160 @@ static uint16_t bfd_dplane_request_counters(const struct bfd_session *bs)
 	msg.header.version = BFD_DP_VERSION;
 	msg.header.length = htons(msglen);
 	msg.header.type = htons(DP_REQUEST_SESSION_COUNTERS);
-	msg.header.id = htons(bfd_dplane_next_id(bs->bdc));
+	msg.header.id = htons(id);
 
 	/* Session to get counters. */
 	msg.data.counters_req.lid = htonl(bs->discrs.my_discr);
 
-	/* If enqueue failed, let caller know. */
-	if (bfd_dplane_enqueue(bs->bdc, &msg, msglen) == -1)
-		return 0;
+	return bfd_dplane_enqueue(bs->bdc, &msg, msglen);
+}
+
+/** Sessions of a data plane, collected for counters requests. */
+struct bfd_dplane_sessions {
+	/** The data plane context. */
+	struct bfd_dplane_ctx *bdc;
+	/** Sessions. */
+	struct bfd_session **bs;
+	/** Amount of sessions. */
+	size_t count;
+	/** Allocated sessions. */
+	size_t size;
+};
+
+static void _bfd_dplane_sessions_collect(struct hash_bucket *hb, void *arg)
+{
+	struct bfd_dplane_sessions *bds = arg;
+	struct bfd_session *bs = hb->data;
+
+	if (bs->bdc != bds->bdc)
+		return;
+
+	if (bds->count == bds->size) {
+		bds->size = bds->size ? bds->size * 2 : 64;
+		bds->bs = XREALLOC(MTYPE_BFDD_DPLANE_REQ, bds->bs,
+				   bds->size * sizeof(*bds->bs));
+	}
+
+	bds->bs[bds->count++] = bs;
+}
+
+/**
+ * Send message to data plane requesting many sessions counters.
+ *
+ * \param bdc the data plane context.
+ * \param bs the BFD sessions.
+ * \param count the amount of sessions (at most `BFD_DPLANE_COUNTERS_MAX`).
+ * \param id the request id.
+ *
+ * \returns `-1` on failure (buffer full) or `0` on success.
+ */
+static int bfd_dplane_request_counters_bulk(struct bfd_dplane_ctx *bdc,
+					    struct bfd_session **bs,
+					    size_t count, uint16_t id)
+{
+	struct bfddp_message_header *bh;
+	struct bfddp_request_counters_bulk *req;
+	size_t msglen = sizeof(*bh) + sizeof(*req) + count * sizeof(uint32_t);
+	size_t i;
+	int rv;
+
+	bh = XCALLOC(MTYPE_BFDD_DPLANE_REQ, msglen);
+	req = (struct bfddp_request_counters_bulk *)(bh + 1);
+
+	/* Fill header information. */
+	bh->version = BFD_DP_VERSION;
+	bh->length = htons(msglen);
+	bh->type = htons(DP_REQUEST_COUNTERS_BULK);
+	bh->id = htons(id);
 
-	/* Flush socket. */
-	bfd_dplane_flush(bs->bdc);
+	/* Sessions to get counters. */
+	req->count = htonl(count);
+	for (i = 0; i < count; i++)
+		req->lid[i] = htonl(bs[i]->discrs.my_discr);
 
-	return ntohs(msg.header.id);
+	rv = bfd_dplane_enqueue(bdc, bh, msglen);
+	XFREE(MTYPE_BFDD_DPLANE_REQ, bh);
+
+	return rv;
+}
+
+/**
+ * Asks a data plane for the counters of all its sessions.
+ *
+ * Requests are pipelined: a window of requests is sent and then all
+ * answers are waited for at once. Data planes supporting bulk messages get
+ * one request for many sessions.
+ *
+ * \param bdc the data plane context.
+ *
+ * \returns `-1` on failure (the context must not be used anymore) or `0` on
+ * success.
+ */
+static int bfd_dplane_update_counters_ctx(struct bfd_dplane_ctx *bdc)
+{
+	struct bfd_dplane_sessions bds = { .bdc = bdc };
+	struct bfd_dplane_expect be = {
+		.cb = _bfd_dplane_update_session_counters,
+		.arg = bdc,
+	};
+	size_t per_req, done = 0, n, msglen;
+	bool bulk;
+	int rv = 0;
+
+	bfd_key_iterate(_bfd_dplane_sessions_collect, &bds);
+
+	bulk = CHECK_FLAG(bdc->capabilities, CAPABILITY_BULK);
+	per_req = bulk ? BFD_DPLANE_COUNTERS_MAX : 1;
+
+	while (done < bds.count) {
+		be.id = bfd_dplane_next_ids(bdc, BFD_DPLANE_PIPELINE_MAX);
+		be.count = 0;
+
+		/* Fill the output buffer with requests. */
+		while (done < bds.count && be.count < BFD_DPLANE_PIPELINE_MAX) {
+			n = MIN(per_req, bds.count - done);
+			if (bulk)
+				msglen = sizeof(struct bfddp_message_header)
+					 + sizeof(struct bfddp_request_counters_bulk)
+					 + n * sizeof(uint32_t);
+			else
+				msglen = sizeof(struct bfddp_message_header)
+					 + sizeof(struct bfddp_request_counters);
+
+			/* What doesn't fit goes in the next window. */
+			if (msglen > STREAM_WRITEABLE(bdc->outbuf))
+				break;
+
+			if (bulk)
+				rv = bfd_dplane_request_counters_bulk(
+					bdc, &bds.bs[done], n,
+					be.id + be.count);
+			else
+				rv = bfd_dplane_request_counters(
+					bds.bs[done], be.id + be.count);
+			if (rv == -1)
+				goto out;
+
+			done += n;
+			be.count++;
+		}
+
+		/* Send what is left from the previous window. */
+		if (be.count == 0 && bfd_dplane_flush(bdc) <= 0) {
+			rv = -1;
+			goto out;
+		}
+
+		be.pending = be.count;
+		rv = bfd_dplane_wait(bdc, &be);
+		if (rv == -1)
+			goto out;
+	}
+
+out:
+	XFREE(MTYPE_BFDD_DPLANE_REQ, bds.bs);
+
+	return rv;
 }
 
 /*
@@ -859,13 +1463,14 @@ static void _bfd_dplane_client_bootstrap(struct bfd_dplane_ctx *bdc)
 	/* Clean up buffers. */
 	stream_reset(bdc->inbuf);
 	stream_reset(bdc->outbuf);
+	bdc->bulk_count = 0;
 
 	/* Ask for read notifications. */
 	event_add_read(master, bfd_dplane_read, bdc, bdc->sock, &bdc->inbufev);
 
 	/* Remove all sessions then register again to send them all. */
 	bfd_key_iterate(_bfd_session_unregister_dplane, bdc);
-	bfd_key_iterate(_bfd_session_register_dplane, bdc);
+	bfd_dplane_sync_start(bdc);
 }
 
 static bool bfd_dplane_client_connecting(struct bfd_dplane_ctx *bdc)
@@ -1094,15 +1699,11 @@ int bfd_dplane_add_session(struct bfd_session *bs)
 
 int bfd_dplane_update_session(const struct bfd_session *bs)
 {
-	struct bfddp_message msg = {};
-
 	if (bs->bdc == NULL)
 		return 0;
 
-	_bfd_dplane_session_fill(bs, &msg);
-
 	/* Enqueue message to data plane client. */
-	return bfd_dplane_enqueue(bs->bdc, &msg, ntohs(msg.header.length));
+	return bfd_dplane_enqueue_session(bs->bdc, bs);
 }
 
 int bfd_dplane_delete_session(struct bfd_session *bs)
@@ -1152,7 +1753,8 @@ void bfd_dplane_show_counters(struct vty *vty)
 		SHOW_COUNTER("Output messages", bdc->out_msgs, PRIu64);
 		SHOW_COUNTER("Output full events", bdc->out_fullev, PRIu64);
 		SHOW_COUNTER("Output current usage",
-			     STREAM_READABLE(bdc->inbuf), "zu");
+			     STREAM_READABLE(bdc->outbuf), "zu");
+		SHOW_COUNTER("Capabilities", bdc->capabilities, "#010x");
 		vty_out(vty, "\n");
 	}
 #undef SHOW_COUNTER
@@ -1160,25 +1762,40 @@ void bfd_dplane_show_counters(struct vty *vty)
 
 int bfd_dplane_update_session_counters(struct bfd_session *bs)
 {
-	uint16_t id;
-	int rv;
+	struct bfd_dplane_expect be = {
+		.count = 1,
+		.pending = 1,
+		.cb = _bfd_dplane_update_session_counters,
+		.arg = bs->bdc,
+	};
 
 	/* If session is not using data plane, then just return success. */
 	if (bs->bdc == NULL)
 		return 0;
 
 	/* Make the request. */
-	id = bfd_dplane_request_counters(bs);
-	if (id == 0) {
+	be.id = bfd_dplane_next_id(bs->bdc);
+	if (bfd_dplane_request_counters(bs, be.id) == -1) {
 		zlog_debug("%s: counters request failed", __func__);
 		return -1;
 	}
 
-	/* Handle interruptions. */
-	do {
-		rv = bfd_dplane_expect(bs->bdc, id,
-				       _bfd_dplane_update_session_counters, bs);
-	} while (rv == -2);
+	return bfd_dplane_wait(bs->bdc, &be);
+}
+
+int bfd_dplane_update_counters(void)
+{
+	struct bfd_dplane_ctx *bdc, *bdc_next;
+	int rv = 0;
+
+	TAILQ_FOREACH_SAFE (bdc, &bglobal.bg_dplaneq, entry, bdc_next) {
+		/* Not connected or still registering sessions. */
+		if (bdc->sock == -1 || bdc->connecting)
+			continue;
+
+		if (bfd_dplane_update_counters_ctx(bdc) == -1)
+			rv = -1;
+	}
 
 	return rv;
 }
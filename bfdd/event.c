@@ -34,6 +34,11 @@ void bfd_recvtimer_update(struct bfd_session *bs)
 	    bs->sock == -1)
 		return;
 
+	if (bfd_rt_session_eligible(bs)) {
+		bfd_rt_detect_start(bs);
+		return;
+	}
+
 	tv_normalize(&tv);
 
 	event_add_timer_tv(master, bfd_recvtimer_cb, bs, &tv,
@@ -143,6 +148,11 @@ void bfd_xmttimer_update(struct bfd_session *bs, uint64_t jitter)
 		return;
 	}
 
+	if (bfd_rt_session_eligible(bs)) {
+		bfd_rt_xmt_start(bs);
+		return;
+	}
+
 	tv_normalize(&tv);
 
 	event_add_timer_tv(master, bfd_xmt_cb, bs, &tv, &bs->xmttimer_ev);
@@ -175,6 +185,7 @@ void bfd_echo_xmttimer_update(struct bfd_session *bs, uint64_t jitter)
 void bfd_recvtimer_delete(struct bfd_session *bs)
 {
 	event_cancel(&bs->recvtimer_ev);
+	bfd_rt_detect_stop(bs);
 }
 
 void bfd_echo_recvtimer_delete(struct bfd_session *bs)
@@ -185,6 +196,7 @@ void bfd_echo_recvtimer_delete(struct bfd_session *bs)
 void bfd_xmttimer_delete(struct bfd_session *bs)
 {
 	event_cancel(&bs->xmttimer_ev);
+	bfd_rt_xmt_stop(bs);
 }
 
 void bfd_echo_xmttimer_delete(struct bfd_session *bs)
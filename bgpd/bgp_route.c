@@ -6961,6 +6961,8 @@ static void bgp_clear_node_queue_init(struct peer *peer)
 	peer->clear_node_queue->spec.del_item_data = &bgp_clear_node_queue_del;
 	peer->clear_node_queue->spec.completion_func = &bgp_clear_node_complete;
 	peer->clear_node_queue->spec.max_retries = 0;
+	/* best path processing goes first, clearing catches up */
+	peer->clear_node_queue->spec.priority = WQ_PRIO_LOW;
 
 	/* we only 'lock' this peer reference when the queue is actually active
 	 */
@@ -7083,7 +7085,7 @@ void bgp_clear_route(struct peer *peer, afi_t afi, safi_t safi)
 	 * the unlock will happen upon work-queue completion; other wise, the
 	 * unlock happens at the end of this function.
 	 */
-	if (!peer->clear_node_queue->event)
+	if (!work_queue_is_scheduled(peer->clear_node_queue))
 		peer_lock(peer);
 
 	if (safi != SAFI_MPLS_VPN && safi != SAFI_ENCAP && safi != SAFI_EVPN)
@@ -7099,7 +7101,7 @@ void bgp_clear_route(struct peer *peer, afi_t afi, safi_t safi)
 		}
 
 	/* unlock if no nodes got added to the clear-node-queue. */
-	if (!peer->clear_node_queue->event)
+	if (!work_queue_is_scheduled(peer->clear_node_queue))
 		peer_unlock(peer);
 }
 
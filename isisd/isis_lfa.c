@@ -9,6 +9,7 @@
 #include "linklist.h"
 #include "log.h"
 #include "memory.h"
+#include "frr_pthread.h"
 #include "vrf.h"
 #include "table.h"
 #include "srcdest_table.h"
@@ -28,11 +29,13 @@
 #include "isis_spf_private.h"
 #include "isis_zebra.h"
 #include "isis_errors.h"
+#include "isis_flex_algo.h"
 
 DEFINE_MTYPE_STATIC(ISISD, ISIS_SPF_NODE, "ISIS SPF Node");
 DEFINE_MTYPE_STATIC(ISISD, ISIS_LFA_TIEBREAKER, "ISIS LFA Tiebreaker");
 DEFINE_MTYPE_STATIC(ISISD, ISIS_LFA_EXCL_IFACE, "ISIS LFA Excluded Interface");
 DEFINE_MTYPE_STATIC(ISISD, ISIS_RLFA, "ISIS Remote LFA");
+DEFINE_MTYPE_STATIC(ISISD, ISIS_LFA_JOB, "ISIS LFA worker job");
 DEFINE_MTYPE(ISISD, ISIS_NEXTHOP_LABELS, "ISIS nexthop MPLS labels");
 
 static inline int isis_spf_node_compare(const struct isis_spf_node *a,
@@ -571,7 +574,6 @@ static bool lfa_ext_p_space_check(const struct isis_spftree *spftree_pc,
 				  const struct isis_vertex *vertex_dest,
 				  const struct isis_vertex *vertex)
 {
-	struct isis_spftree *spftree_old = spftree_pc->lfa.old.spftree;
 	struct isis_vertex_adj *vadj;
 	struct listnode *node;
 
@@ -587,8 +589,8 @@ static bool lfa_ext_p_space_check(const struct isis_spftree *spftree_pc,
 		struct isis_spf_adj *sadj = vadj->sadj;
 		struct isis_spf_node *adj_node;
 
-		adj_node =
-			isis_spf_node_find(&spftree_old->adj_nodes, sadj->id);
+		adj_node = isis_spf_node_find(&spftree_pc->lfa.p_space_adj,
+					      sadj->id);
 		if (!adj_node)
 			continue;
 
@@ -876,6 +878,70 @@ static bool lfa_check_needs_protection(const struct isis_spftree *spftree_pc,
 		&spftree_pc->lfa.protected_resource);
 }
 
+/* Check if a TI-LFA vertex was already covered by node protection. */
+static bool tilfa_check_node_protected(const struct isis_spftree *spftree_pc,
+				       const struct isis_vertex *vertex)
+{
+	char buf[VID2STR_BUFFER];
+
+	if (VTYPE_IS(vertex->type)) {
+		struct isis_adjacency *adj;
+
+		adj = isis_adj_find(spftree_pc->area, spftree_pc->level,
+				    vertex->N.id);
+		if (adj && isis_sr_adj_sid_find(adj, spftree_pc->family,
+						ISIS_SR_ADJ_BACKUP)) {
+			if (IS_DEBUG_LFA)
+				zlog_debug(
+					"ISIS-LFA: %s %s already covered by node protection",
+					vtype2string(vertex->type),
+					vid2string(vertex, buf, sizeof(buf)));
+
+			return true;
+		}
+	}
+	if (VTYPE_IP(vertex->type)) {
+		struct route_table *route_table;
+		struct route_node *rn;
+
+		route_table = spftree_pc->lfa.old.spftree->route_table_backup;
+		rn = route_node_lookup(route_table, &vertex->N.ip.p.dest);
+		if (rn) {
+			route_unlock_node(rn);
+			if (IS_DEBUG_LFA)
+				zlog_debug(
+					"ISIS-LFA: %s %s already covered by node protection",
+					vtype2string(vertex->type),
+					vid2string(vertex, buf, sizeof(buf)));
+
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/**
+ * Check if the route/adjacency was already covered by node protection or by
+ * a local LFA.  Used for TI-LFA trees computed with deferred installation,
+ * where the repair paths installed by the trees computed before this one
+ * weren't known yet when the vertex was checked.
+ *
+ * @param spftree_pc	The post-convergence SPF tree
+ * @param vertex	IS-IS SPF vertex to check
+ *
+ * @return		true if a repair path is already installed
+ */
+bool isis_tilfa_covered(const struct isis_spftree *spftree_pc,
+			const struct isis_vertex *vertex)
+{
+	/* Local LFAs of other interfaces might have been computed since. */
+	if (!lfa_check_needs_protection(spftree_pc, vertex))
+		return true;
+
+	return tilfa_check_node_protected(spftree_pc, vertex);
+}
+
 /**
  * Check if the given SPF vertex needs protection and, if so, compute and
  * install the corresponding repair paths.
@@ -909,38 +975,13 @@ int isis_tilfa_check(struct isis_spftree *spftree_pc,
 	}
 
 	/*
-	 * Check if the route/adjacency was already covered by node protection.
+	 * Trees computed by an LFA worker leave this to
+	 * isis_spf_lfa_install_deferred(), the repair paths installed so far
+	 * aren't known yet.
 	 */
-	if (VTYPE_IS(vertex->type)) {
-		struct isis_adjacency *adj;
-
-		adj = isis_adj_find(spftree_pc->area, spftree_pc->level,
-				    vertex->N.id);
-		if (adj && isis_sr_adj_sid_find(adj, spftree_pc->family,
-						ISIS_SR_ADJ_BACKUP)) {
-			if (IS_DEBUG_LFA)
-				zlog_debug(
-					"ISIS-LFA: %s %s already covered by node protection",
-					vtype2string(vertex->type),
-					vid2string(vertex, buf, sizeof(buf)));
-
-			return -1;
-		}
-	}
-	if (VTYPE_IP(vertex->type)) {
-		struct route_table *route_table;
-
-		route_table = spftree_pc->lfa.old.spftree->route_table_backup;
-		if (route_node_lookup(route_table, &vertex->N.ip.p.dest)) {
-			if (IS_DEBUG_LFA)
-				zlog_debug(
-					"ISIS-LFA: %s %s already covered by node protection",
-					vtype2string(vertex->type),
-					vid2string(vertex, buf, sizeof(buf)));
-
-			return -1;
-		}
-	}
+	if (!spftree_pc->lfa.deferred
+	    && tilfa_check_node_protected(spftree_pc, vertex))
+		return -1;
 
 	if (IS_DEBUG_LFA)
 		zlog_debug(
@@ -1153,30 +1194,24 @@ static void lfa_calc_pq_spaces(struct isis_spftree *spftree_pc,
 					     resource,
 					     &spftree_pc->lfa.q_space);
 		} else {
+			struct isis_spf_node *p_space_node;
+
 			if (IS_DEBUG_LFA)
 				zlog_debug("ISIS-LFA: computing P-space (%s)",
 					   print_sys_hostname(adj_node->sysid));
+			p_space_node = isis_spf_node_new(
+				&spftree_pc->lfa.p_space_adj, adj_node->sysid);
 			lfa_calc_reach_nodes(adj_node->lfa.spftree, spftree,
 					     adj_nodes, true, resource,
-					     &adj_node->lfa.p_space);
+					     &p_space_node->lfa.p_space);
 		}
 	}
 }
 
-/**
- * Compute the TI-LFA backup paths for a given protected interface.
- *
- * @param area		  IS-IS area
- * @param spftree	  IS-IS SPF tree
- * @param spftree_reverse IS-IS Reverse SPF tree
- * @param resource	  Protected resource
- *
- * @return		  Pointer to the post-convergence SPF tree
- */
-struct isis_spftree *isis_tilfa_compute(struct isis_area *area,
-					struct isis_spftree *spftree,
-					struct isis_spftree *spftree_reverse,
-					struct lfa_protected_resource *resource)
+static struct isis_spftree *
+tilfa_compute(struct isis_area *area, struct isis_spftree *spftree,
+	      struct isis_spftree *spftree_reverse,
+	      struct lfa_protected_resource *resource, bool deferred)
 {
 	struct isis_spftree *spftree_pc;
 	struct isis_spf_node *adj_node;
@@ -1214,15 +1249,38 @@ struct isis_spftree *isis_tilfa_compute(struct isis_area *area,
 			lfa_protected_resource2str(resource));
 
 	/* Re-run SPF in the local node to find the post-convergence paths. */
+	if (deferred)
+		spftree_pc->lfa.deferred = list_new();
 	isis_run_spf(spftree_pc);
 
-	/* Clear list of nodes affeted by link failure. */
-	if (resource->type == LFA_NODE_PROTECTION)
+	/*
+	 * Clear list of nodes affeted by link failure.  With deferred
+	 * installation the caller does that once the repair paths are in.
+	 */
+	if (resource->type == LFA_NODE_PROTECTION && !deferred)
 		isis_spf_node_list_clear(&resource->nodes);
 
 	return spftree_pc;
 }
 
+/**
+ * Compute the TI-LFA backup paths for a given protected interface.
+ *
+ * @param area		  IS-IS area
+ * @param spftree	  IS-IS SPF tree
+ * @param spftree_reverse IS-IS Reverse SPF tree
+ * @param resource	  Protected resource
+ *
+ * @return		  Pointer to the post-convergence SPF tree
+ */
+struct isis_spftree *isis_tilfa_compute(struct isis_area *area,
+					struct isis_spftree *spftree,
+					struct isis_spftree *spftree_reverse,
+					struct lfa_protected_resource *resource)
+{
+	return tilfa_compute(area, spftree, spftree_reverse, resource, false);
+}
+
 /**
  * Run forward SPF on all adjacent routers.
  *
@@ -1703,22 +1761,10 @@ void isis_rlfa_check(struct isis_spftree *spftree_pc,
 		rlfa_delete(spftree_old, rlfa);
 }
 
-/**
- * Compute the Remote LFA backup paths for a given protected interface.
- *
- * @param area		  IS-IS area
- * @param spftree	  IS-IS SPF tree
- * @param spftree_reverse IS-IS Reverse SPF tree
- * @param max_metric	  Remote LFA maximum metric
- * @param resource	  Protected resource
- *
- * @return		  Pointer to the post-convergence SPF tree
- */
-struct isis_spftree *isis_rlfa_compute(struct isis_area *area,
-				       struct isis_spftree *spftree,
-				       struct isis_spftree *spftree_reverse,
-				       uint32_t max_metric,
-				       struct lfa_protected_resource *resource)
+static struct isis_spftree *
+rlfa_compute(struct isis_area *area, struct isis_spftree *spftree,
+	     struct isis_spftree *spftree_reverse, uint32_t max_metric,
+	     struct lfa_protected_resource *resource, bool deferred)
 {
 	struct isis_spftree *spftree_pc;
 
@@ -1745,11 +1791,34 @@ struct isis_spftree *isis_rlfa_compute(struct isis_area *area,
 			lfa_protected_resource2str(resource));
 
 	/* Re-run SPF in the local node to find the post-convergence paths. */
+	if (deferred)
+		spftree_pc->lfa.deferred = list_new();
 	isis_run_spf(spftree_pc);
 
 	return spftree_pc;
 }
 
+/**
+ * Compute the Remote LFA backup paths for a given protected interface.
+ *
+ * @param area		  IS-IS area
+ * @param spftree	  IS-IS SPF tree
+ * @param spftree_reverse IS-IS Reverse SPF tree
+ * @param max_metric	  Remote LFA maximum metric
+ * @param resource	  Protected resource
+ *
+ * @return		  Pointer to the post-convergence SPF tree
+ */
+struct isis_spftree *isis_rlfa_compute(struct isis_area *area,
+				       struct isis_spftree *spftree,
+				       struct isis_spftree *spftree_reverse,
+				       uint32_t max_metric,
+				       struct lfa_protected_resource *resource)
+{
+	return rlfa_compute(area, spftree, spftree_reverse, max_metric,
+			    resource, false);
+}
+
 /* Calculate the distance from the root node to the given IP destination. */
 static int lfa_calc_dist_destination(struct isis_spftree *spftree,
 				     const struct isis_vertex *vertex_N,
@@ -2280,6 +2349,472 @@ static void isis_spf_run_tilfa(struct isis_area *area,
 	isis_spftree_del(spftree_pc_link);
 }
 
+/* Fill in the protected resource of the given circuit. */
+static bool lfa_circuit_resource(struct isis_circuit *circuit, int level,
+				 struct lfa_protected_resource *resource)
+{
+	static uint8_t null_sysid[ISIS_SYS_ID_LEN + 1];
+	struct isis_adjacency *adj;
+
+	switch (circuit->circ_type) {
+	case CIRCUIT_T_BROADCAST:
+		if (level == ISIS_LEVEL1)
+			memcpy(resource->adjacency, circuit->u.bc.l1_desig_is,
+			       ISIS_SYS_ID_LEN + 1);
+		else
+			memcpy(resource->adjacency, circuit->u.bc.l2_desig_is,
+			       ISIS_SYS_ID_LEN + 1);
+		/* Do nothing if no DR was elected yet. */
+		if (!memcmp(resource->adjacency, null_sysid,
+			    ISIS_SYS_ID_LEN + 1))
+			return false;
+		return true;
+	case CIRCUIT_T_P2P:
+		adj = circuit->u.p2p.neighbor;
+		if (!adj)
+			return false;
+		memcpy(resource->adjacency, adj->sysid, ISIS_SYS_ID_LEN);
+		LSP_PSEUDO_ID(resource->adjacency) = 0;
+		return true;
+	default:
+		return false;
+	}
+}
+
+/*
+ * LFA worker pool.
+ *
+ * The SPTs computed on behalf of the neighbors and the post-convergence SPTs
+ * of the protected interfaces are independent of each other, so they are
+ * computed by a small pool of pthreads, with the main pthread taking part as
+ * well.  The main pthread is blocked until the whole batch is done, so the
+ * LSPDB, the adjacencies and the pre-failure SPT are an immutable snapshot
+ * for the workers.  Anything that modifies shared state (Adj-SIDs, backup
+ * routes, RLFA registration with LDP) is deferred and done by the main
+ * pthread afterwards, in the same order the serial computation uses.
+ */
+#define ISIS_LFA_WORKERS_MAX 8
+
+enum lfa_job_type {
+	LFA_JOB_NEIGHBOR,
+	LFA_JOB_REVERSE,
+	LFA_JOB_LOCAL,
+	LFA_JOB_RLFA,
+	LFA_JOB_TILFA,
+};
+
+struct lfa_job {
+	enum lfa_job_type type;
+	struct isis_spftree *spftree;
+	struct isis_spftree *spftree_reverse;
+
+	/* LFA_JOB_NEIGHBOR */
+	struct isis_spf_node *adj_node;
+	bool reverse;
+
+	/* LFA_JOB_LOCAL, LFA_JOB_RLFA and LFA_JOB_TILFA */
+	struct isis_circuit *circuit;
+	struct lfa_protected_resource resource;
+	uint32_t max_metric;
+
+	/* Result. */
+	struct isis_spftree *spftree_pc;
+};
+
+static struct lfa_pool {
+	pthread_mutex_t mtx;
+	pthread_cond_t cond_work;
+	pthread_cond_t cond_done;
+
+	struct frr_pthread *workers[ISIS_LFA_WORKERS_MAX];
+	unsigned int num_workers;
+	bool started;
+	bool stop;
+
+	/* Current batch. */
+	struct lfa_job *jobs;
+	size_t num_jobs;
+	size_t next_job;
+	size_t done_jobs;
+} lfa_pool = {
+	.mtx = PTHREAD_MUTEX_INITIALIZER,
+	.cond_work = PTHREAD_COND_INITIALIZER,
+	.cond_done = PTHREAD_COND_INITIALIZER,
+};
+
+static void lfa_job_run(struct lfa_job *job)
+{
+	struct isis_spftree *spftree = job->spftree;
+	struct isis_spf_node *adj_node = job->adj_node;
+
+	switch (job->type) {
+	case LFA_JOB_NEIGHBOR:
+		adj_node->lfa.spftree = isis_spftree_new(
+			spftree->area, spftree->lspdb, adj_node->sysid,
+			spftree->level, spftree->tree_id, SPF_TYPE_FORWARD,
+			F_SPFTREE_NO_ADJACENCIES | F_SPFTREE_NO_ROUTES,
+			spftree->algorithm);
+		isis_run_spf(adj_node->lfa.spftree);
+		if (job->reverse)
+			adj_node->lfa.spftree_reverse =
+				isis_spf_reverse_run(adj_node->lfa.spftree);
+		break;
+	case LFA_JOB_REVERSE:
+		job->spftree_pc = isis_spf_reverse_run(spftree);
+		break;
+	case LFA_JOB_LOCAL:
+		/* Done by the main pthread. */
+		break;
+	case LFA_JOB_RLFA:
+		job->spftree_pc = rlfa_compute(spftree->area, spftree,
+					       job->spftree_reverse,
+					       job->max_metric, &job->resource,
+					       true);
+		break;
+	case LFA_JOB_TILFA:
+		job->spftree_pc = tilfa_compute(spftree->area, spftree,
+						job->spftree_reverse,
+						&job->resource, true);
+		break;
+	}
+}
+
+/* Run jobs of the current batch until there are none left to pick up. */
+static void lfa_pool_work(void)
+{
+	struct lfa_job *job;
+
+	while (lfa_pool.next_job < lfa_pool.num_jobs) {
+		job = &lfa_pool.jobs[lfa_pool.next_job++];
+		pthread_mutex_unlock(&lfa_pool.mtx);
+
+		lfa_job_run(job);
+
+		pthread_mutex_lock(&lfa_pool.mtx);
+		if (++lfa_pool.done_jobs == lfa_pool.num_jobs)
+			pthread_cond_signal(&lfa_pool.cond_done);
+	}
+}
+
+static void *lfa_worker_start(void *arg)
+{
+	struct frr_pthread *fpt = arg;
+
+	frr_pthread_set_name(fpt);
+	frr_pthread_notify_running(fpt);
+
+	pthread_mutex_lock(&lfa_pool.mtx);
+	while (!lfa_pool.stop) {
+		lfa_pool_work();
+		if (!lfa_pool.stop)
+			pthread_cond_wait(&lfa_pool.cond_work, &lfa_pool.mtx);
+	}
+	pthread_mutex_unlock(&lfa_pool.mtx);
+
+	return NULL;
+}
+
+static int lfa_worker_stop(struct frr_pthread *fpt, void **result)
+{
+	frr_with_mutex (&lfa_pool.mtx) {
+		lfa_pool.stop = true;
+		pthread_cond_broadcast(&lfa_pool.cond_work);
+	}
+
+	atomic_store_explicit(&fpt->running, false, memory_order_relaxed);
+	pthread_join(fpt->thread, result);
+
+	return 0;
+}
+
+static const struct frr_pthread_attr lfa_worker_attr = {
+	.start = lfa_worker_start,
+	.stop = lfa_worker_stop,
+};
+
+/* Start the worker pthreads the first time they're needed. */
+static bool lfa_pool_start(void)
+{
+	long nprocs;
+	unsigned int num_workers;
+
+	if (lfa_pool.started)
+		return lfa_pool.num_workers > 0;
+	if (!frr_is_after_fork)
+		return false;
+	lfa_pool.started = true;
+
+	nprocs = sysconf(_SC_NPROCESSORS_ONLN);
+	if (nprocs < 2)
+		return false;
+	num_workers = MIN(nprocs, ISIS_LFA_WORKERS_MAX) - 1;
+
+	for (unsigned int i = 0; i < num_workers; i++) {
+		struct frr_pthread *fpt;
+		char name[16];
+
+		snprintf(name, sizeof(name), "isisLFA%u", i);
+		fpt = frr_pthread_new(&lfa_worker_attr, name, name);
+		if (frr_pthread_run(fpt, NULL) != 0) {
+			frr_pthread_destroy(fpt);
+			break;
+		}
+		frr_pthread_wait_running(fpt);
+		lfa_pool.workers[lfa_pool.num_workers++] = fpt;
+	}
+
+	return lfa_pool.num_workers > 0;
+}
+
+/* Run a batch of jobs on the worker pool and wait until all are done. */
+static void lfa_pool_run(struct lfa_job *jobs, size_t num_jobs)
+{
+	frr_with_mutex (&lfa_pool.mtx) {
+		lfa_pool.jobs = jobs;
+		lfa_pool.num_jobs = num_jobs;
+		lfa_pool.next_job = 0;
+		lfa_pool.done_jobs = 0;
+		pthread_cond_broadcast(&lfa_pool.cond_work);
+
+		lfa_pool_work();
+		while (lfa_pool.done_jobs < lfa_pool.num_jobs)
+			pthread_cond_wait(&lfa_pool.cond_done, &lfa_pool.mtx);
+
+		lfa_pool.jobs = NULL;
+		lfa_pool.num_jobs = 0;
+		lfa_pool.next_job = 0;
+		lfa_pool.done_jobs = 0;
+	}
+}
+
+/*
+ * Compute the post-convergence SPTs of the first num_pc_jobs jobs on the
+ * worker pool and install their repair paths.  The jobs array needs room for
+ * one more job per neighbor plus one for the reverse SPF.
+ */
+static void lfa_pool_compute(struct isis_area *area,
+			     struct isis_spftree *spftree, struct lfa_job *jobs,
+			     size_t num_pc_jobs, bool reverse)
+{
+	struct isis_spftree *spftree_reverse = NULL;
+	struct isis_spf_node *adj_node;
+	struct lfa_job *job;
+	size_t num_jobs = num_pc_jobs;
+
+	/*
+	 * First batch: reverse SPF of the local node and SPF (plus reverse SPF
+	 * where the Q-space computation needs it) on behalf of the neighbors.
+	 */
+	RB_FOREACH (adj_node, isis_spf_nodes, &spftree->adj_nodes) {
+		job = &jobs[num_jobs++];
+		job->type = LFA_JOB_NEIGHBOR;
+		job->spftree = spftree;
+		job->adj_node = adj_node;
+		for (size_t i = 0; i < num_pc_jobs && reverse; i++) {
+			if (jobs[i].type == LFA_JOB_LOCAL)
+				continue;
+			if (spf_adj_node_is_affected(adj_node,
+						     &jobs[i].resource,
+						     spftree->sysid)) {
+				job->reverse = true;
+				break;
+			}
+		}
+	}
+	if (reverse) {
+		job = &jobs[num_jobs++];
+		job->type = LFA_JOB_REVERSE;
+		job->spftree = spftree;
+	}
+	lfa_pool_run(&jobs[num_pc_jobs], num_jobs - num_pc_jobs);
+	if (reverse)
+		spftree_reverse = jobs[num_jobs - 1].spftree_pc;
+
+	/* Second batch: the post-convergence SPTs. */
+	for (size_t i = 0; i < num_pc_jobs; i++) {
+		jobs[i].spftree = spftree;
+		jobs[i].spftree_reverse = spftree_reverse;
+	}
+	lfa_pool_run(jobs, num_pc_jobs);
+
+	/* Install the results in the order of the serial computation. */
+	for (size_t i = 0; i < num_pc_jobs; i++) {
+		job = &jobs[i];
+
+		switch (job->type) {
+		case LFA_JOB_LOCAL:
+			isis_lfa_compute(area, job->circuit, spftree,
+					 &job->resource);
+			break;
+		case LFA_JOB_RLFA:
+			isis_spf_lfa_install_deferred(job->spftree_pc);
+			listnode_add(spftree->lfa.remote.pc_spftrees,
+				     job->spftree_pc);
+			break;
+		case LFA_JOB_TILFA:
+			isis_spf_lfa_install_deferred(job->spftree_pc);
+			isis_spftree_del(job->spftree_pc);
+			if (job->resource.type == LFA_NODE_PROTECTION)
+				isis_spf_node_list_clear(&job->resource.nodes);
+			break;
+		case LFA_JOB_NEIGHBOR:
+		case LFA_JOB_REVERSE:
+			break;
+		}
+	}
+
+	if (spftree_reverse)
+		isis_spftree_del(spftree_reverse);
+}
+
+/* Number of jobs lfa_pool_compute() needs room for. */
+static size_t lfa_pool_max_jobs(struct isis_spftree *spftree,
+				size_t num_pc_jobs)
+{
+	struct isis_spf_node *adj_node;
+	size_t max_jobs = num_pc_jobs + 1;
+
+	RB_FOREACH (adj_node, isis_spf_nodes, &spftree->adj_nodes)
+		max_jobs++;
+
+	return max_jobs;
+}
+
+/*
+ * Parallel version of isis_spf_run_lfa().  Returns false if the computation
+ * needs to be done serially.
+ */
+static bool isis_spf_run_lfa_parallel(struct isis_area *area,
+				      struct isis_spftree *spftree)
+{
+	struct isis_circuit *circuit;
+	struct listnode *node;
+	struct lfa_job *jobs, *job;
+	size_t num_pc_jobs = 0;
+	int level = spftree->level;
+	bool reverse;
+
+	/* Debug messages would interleave, keep them readable. */
+	if (IS_DEBUG_LFA || IS_DEBUG_SPF_EVENTS)
+		return false;
+
+#ifndef FABRICD
+	/*
+	 * An inconsistent Flex-Algo state makes isis_run_spf() schedule an LSP
+	 * regeneration, which only the main pthread can do.
+	 */
+	if (flex_algo_id_valid(spftree->algorithm)
+	    && !!isis_flex_algo_elected_supported(spftree->algorithm, area)
+		       != flex_algo_get_state(area->flex_algos,
+					      spftree->algorithm))
+		return false;
+#endif /* ifndef FABRICD */
+
+	if (!isis_root_system_lsp(spftree->lspdb, spftree->sysid))
+		return false;
+
+	if (!lfa_pool_start())
+		return false;
+
+	reverse = area->rlfa_protected_links[level - 1] > 0
+		  || area->tilfa_protected_links[level - 1] > 0;
+
+	jobs = XCALLOC(MTYPE_ISIS_LFA_JOB,
+		       lfa_pool_max_jobs(spftree,
+					 2 * listcount(area->circuit_list))
+			       * sizeof(*jobs));
+
+	/* Collect the protected resources, in circuit order. */
+	for (ALL_LIST_ELEMENTS_RO(area->circuit_list, node, circuit)) {
+		struct lfa_protected_resource resource = {};
+
+		if (!(circuit->is_type & level))
+			continue;
+
+		if (!circuit->lfa_protection[level - 1]
+		    && !circuit->tilfa_protection[level - 1])
+			continue;
+
+		if (!lfa_circuit_resource(circuit, level, &resource))
+			continue;
+
+		if (circuit->lfa_protection[level - 1]) {
+			resource.type = LFA_LINK_PROTECTION;
+			job = &jobs[num_pc_jobs++];
+			job->type = LFA_JOB_LOCAL;
+			job->circuit = circuit;
+			job->resource = resource;
+
+			if (circuit->rlfa_protection[level - 1]) {
+				job = &jobs[num_pc_jobs++];
+				job->type = LFA_JOB_RLFA;
+				job->circuit = circuit;
+				job->resource = resource;
+				job->max_metric =
+					circuit->rlfa_max_metric[level - 1];
+			}
+		} else if (circuit->tilfa_protection[level - 1]) {
+			if (circuit->tilfa_node_protection[level - 1]) {
+				job = &jobs[num_pc_jobs++];
+				job->type = LFA_JOB_TILFA;
+				job->circuit = circuit;
+				job->resource = resource;
+				job->resource.type = LFA_NODE_PROTECTION;
+			}
+			if (!circuit->tilfa_node_protection[level - 1]
+			    || circuit->tilfa_link_fallback[level - 1]) {
+				job = &jobs[num_pc_jobs++];
+				job->type = LFA_JOB_TILFA;
+				job->circuit = circuit;
+				job->resource = resource;
+				job->resource.type = LFA_LINK_PROTECTION;
+			}
+		}
+	}
+
+	lfa_pool_compute(area, spftree, jobs, num_pc_jobs, reverse);
+	XFREE(MTYPE_ISIS_LFA_JOB, jobs);
+
+	return true;
+}
+
+/**
+ * Compute the TI-LFA repair paths of several protected resources on the LFA
+ * worker pool, as if isis_tilfa_compute() was called for each of them in
+ * turn.  The unit tests use this to check the parallel computation against
+ * the serial one.
+ *
+ * @param area		IS-IS area
+ * @param spftree	IS-IS SPF tree
+ * @param resources	Protected resources
+ * @param num_resources	Number of protected resources
+ *
+ * @return		false if the worker pool isn't running
+ */
+bool isis_tilfa_compute_parallel(struct isis_area *area,
+				 struct isis_spftree *spftree,
+				 const struct lfa_protected_resource *resources,
+				 size_t num_resources)
+{
+	struct lfa_job *jobs;
+
+	if (lfa_pool.num_workers == 0)
+		return false;
+
+	jobs = XCALLOC(MTYPE_ISIS_LFA_JOB,
+		       lfa_pool_max_jobs(spftree, num_resources)
+			       * sizeof(*jobs));
+	for (size_t i = 0; i < num_resources; i++) {
+		jobs[i].type = LFA_JOB_TILFA;
+		jobs[i].resource = resources[i];
+	}
+
+	lfa_pool_compute(area, spftree, jobs, num_resources, true);
+	XFREE(MTYPE_ISIS_LFA_JOB, jobs);
+
+	return true;
+}
+
 /**
  * Run the LFA/RLFA/TI-LFA algorithms for all protected interfaces.
  *
@@ -2293,6 +2828,9 @@ void isis_spf_run_lfa(struct isis_area *area, struct isis_spftree *spftree)
 	struct listnode *node;
 	int level = spftree->level;
 
+	if (isis_spf_run_lfa_parallel(area, spftree))
+		return;
+
 	/* Run reverse SPF locally. */
 	if (area->rlfa_protected_links[level - 1] > 0
 	    || area->tilfa_protected_links[level - 1] > 0)
@@ -2304,8 +2842,6 @@ void isis_spf_run_lfa(struct isis_area *area, struct isis_spftree *spftree)
 	/* Check which interfaces are protected. */
 	for (ALL_LIST_ELEMENTS_RO(area->circuit_list, node, circuit)) {
 		struct lfa_protected_resource resource = {};
-		struct isis_adjacency *adj;
-		static uint8_t null_sysid[ISIS_SYS_ID_LEN + 1];
 
 		if (!(circuit->is_type & level))
 			continue;
@@ -2315,31 +2851,8 @@ void isis_spf_run_lfa(struct isis_area *area, struct isis_spftree *spftree)
 			continue;
 
 		/* Fill in the protected resource. */
-		switch (circuit->circ_type) {
-		case CIRCUIT_T_BROADCAST:
-			if (level == ISIS_LEVEL1)
-				memcpy(resource.adjacency,
-				       circuit->u.bc.l1_desig_is,
-				       ISIS_SYS_ID_LEN + 1);
-			else
-				memcpy(resource.adjacency,
-				       circuit->u.bc.l2_desig_is,
-				       ISIS_SYS_ID_LEN + 1);
-			/* Do nothing if no DR was elected yet. */
-			if (!memcmp(resource.adjacency, null_sysid,
-				    ISIS_SYS_ID_LEN + 1))
-				continue;
-			break;
-		case CIRCUIT_T_P2P:
-			adj = circuit->u.p2p.neighbor;
-			if (!adj)
-				continue;
-			memcpy(resource.adjacency, adj->sysid, ISIS_SYS_ID_LEN);
-			LSP_PSEUDO_ID(resource.adjacency) = 0;
-			break;
-		default:
+		if (!lfa_circuit_resource(circuit, level, &resource))
 			continue;
-		}
 
 		if (circuit->lfa_protection[level - 1]) {
 			/* Run local LFA. */
@@ -164,9 +164,16 @@ void isis_lfa_compute(struct isis_area *area, struct isis_circuit *circuit,
 		      struct lfa_protected_resource *resource);
 void isis_spf_run_lfa(struct isis_area *area, struct isis_spftree *spftree);
 int isis_tilfa_check(struct isis_spftree *spftree, struct isis_vertex *vertex);
+bool isis_tilfa_covered(const struct isis_spftree *spftree_pc,
+			const struct isis_vertex *vertex);
 struct isis_spftree *
 isis_tilfa_compute(struct isis_area *area, struct isis_spftree *spftree,
 		   struct isis_spftree *spftree_reverse,
 		   struct lfa_protected_resource *protected_resource);
+bool isis_tilfa_compute_parallel(struct isis_area *area,
+				 struct isis_spftree *spftree,
+				 const struct lfa_protected_resource *resources,
+				 size_t num_resources);
+bool isis_lfa_pool_start(unsigned int num_workers);
 
 #endif /* _FRR_ISIS_LFA_H */
@@ -490,6 +490,9 @@ static void lsp_update_data(struct isis_lsp *lsp, struct isis_lsp_hdr *hdr,
 	lsp->age_out = ZERO_AGE_LIFETIME;
 	lsp->installed = time(NULL);
 
+	/* kept for as long as the LSP stays in the database */
+	if (tlvs)
+		isis_tlvs_compact(tlvs);
 	lsp->tlvs = tlvs;
 
 	if (area->dynhostname && lsp->hdr.rem_lifetime) {
@@ -527,6 +530,8 @@ void lsp_update(struct isis_lsp *lsp, struct isis_lsp_hdr *hdr,
 		struct isis_tlvs *tlvs, struct stream *stream,
 		struct isis_area *area, int level, bool confusion)
 {
+	bool prc;
+
 	if (lsp->own_lsp) {
 		flog_err(
 			EC_LIB_DEVELOPMENT,
@@ -536,6 +541,17 @@ void lsp_update(struct isis_lsp *lsp, struct isis_lsp_hdr *hdr,
 		lsp->own_lsp = 0;
 	}
 
+	/*
+	 * If only IP reachability changed, the SPT stays the same and a
+	 * partial route calculation is enough.  Fragments need to be linked
+	 * already, otherwise they're new to the SPF.
+	 */
+	prc = !confusion && lsp->tlvs && tlvs && lsp->hdr.seqno
+	      && lsp->hdr.rem_lifetime && hdr->rem_lifetime
+	      && lsp->hdr.lsp_bits == hdr->lsp_bits
+	      && (!LSP_FRAGMENT(lsp->hdr.lsp_id) || lsp->lspu.zero_lsp)
+	      && isis_tlvs_topology_same(lsp->tlvs, tlvs);
+
 	if (confusion) {
 		lsp_purge(lsp, level, NULL);
 	} else {
@@ -554,7 +570,10 @@ void lsp_update(struct isis_lsp *lsp, struct isis_lsp_hdr *hdr,
 	}
 
 	if (lsp->hdr.seqno) {
-		isis_spf_schedule(lsp->area, lsp->level);
+		if (prc)
+			isis_spf_schedule_prc(lsp->area, lsp->level);
+		else
+			isis_spf_schedule(lsp->area, lsp->level);
 		isis_te_lsp_event(lsp, LSP_UPD);
 	}
 }
@@ -1420,7 +1439,23 @@ static void lsp_build(struct isis_lsp *lsp, struct isis_area *area)
 	size_t tlv_space = STREAM_WRITEABLE(lsp->pdu) - LLC_LEN;
 	lsp_clear_data(lsp);
 
-	struct list *fragments = isis_fragment_tlvs(tlvs, tlv_space);
+	struct isis_passwd *passwd = (level == IS_LEVEL_1)
+					     ? &area->area_passwd
+					     : &area->domain_passwd;
+	uint8_t salt[2 + sizeof(passwd->passwd)];
+
+	/* the authentication goes into every fragment as well */
+	salt[0] = passwd->type;
+	salt[1] = passwd->len;
+	memcpy(salt + 2, passwd->passwd, passwd->len);
+
+	if (!area->lsp_frag_state[level - 1])
+		area->lsp_frag_state[level - 1] = isis_fragment_state_new();
+
+	struct list *fragments =
+		isis_fragment_tlvs_stable(tlvs, tlv_space,
+					  area->lsp_frag_state[level - 1],
+					  salt, 2 + passwd->len);
 	if (!fragments) {
 		zlog_warn("BUG: could not fragment own LSP:");
 		log_multiline(LOG_WARNING, "    ", "%s",
@@ -1545,6 +1580,40 @@ int lsp_generate(struct isis_area *area, int level)
 	return ISIS_OK;
 }
 
+/*
+ * Reissue one of our own rebuilt LSP fragments.
+ *
+ * lsp_build() keeps the items of our LSP in the fragments they were in, a
+ * fragment that came out the same as the copy we last flooded keeps its
+ * sequence number and isn't encoded or flooded again, as long as that copy
+ * lives until the next refresh.  On a large LSP most triggered
+ * regenerations only touch one or two fragments, this spares the rest of
+ * the domain from installing and running SPF on the others.
+ *
+ * Returns true if the fragment was reissued.
+ */
+static bool lsp_reissue(struct isis_lsp *lsp, bool unchanged,
+			uint16_t rem_lifetime, uint16_t refresh_time)
+{
+	struct isis_area *area = lsp->area;
+
+	if (unchanged && lsp->hdr.seqno
+	    && lsp->hdr.rem_lifetime
+		       > refresh_time + area->lsp_gen_interval[lsp->level - 1]) {
+		area->lsp_frag_unchanged_count[lsp->level - 1]++;
+		return false;
+	}
+
+	/* Set the lifetime values of all the fragments to the same value,
+	 * so that no fragment expires before the lsp is refreshed.
+	 */
+	lsp->hdr.rem_lifetime = rem_lifetime;
+	lsp->age_out = ZERO_AGE_LIFETIME;
+	lsp_inc_seqno(lsp, 0);
+	lsp_flood(lsp, NULL);
+	return true;
+}
+
 /*
  * Search own LSPs, update holding time and flood
  */
@@ -1555,6 +1624,11 @@ static int lsp_regenerate(struct isis_area *area, int level)
 	struct listnode *node;
 	uint8_t lspid[ISIS_SYS_ID_LEN + 2];
 	uint16_t rem_lifetime, refresh_time;
+	struct isis_lsp_hdr old_hdr;
+	struct stream *old_pdu;
+	uint8_t old_bits;
+	bool unchanged;
+	unsigned int reissued = 0;
 
 	if ((area == NULL) || (area->is_type & level) != level)
 		return ISIS_ERROR;
@@ -1572,35 +1646,60 @@ static int lsp_regenerate(struct isis_area *area, int level)
 		return ISIS_ERROR;
 	}
 
+	/* lsp_build() packs an empty fragment zero to size the TLV space */
+	old_hdr = lsp->hdr;
+	old_pdu = stream_dup(lsp->pdu);
 	lsp_clear_data(lsp);
 	lsp_build(lsp, area);
 	rem_lifetime = lsp_rem_lifetime(area, level);
-	lsp->hdr.rem_lifetime = rem_lifetime;
+	refresh_time = lsp_refresh_time(lsp, rem_lifetime);
 	lsp->last_generated = time(NULL);
-	lsp_flood(lsp, NULL);
 	area->lsp_gen_count[level - 1]++;
+
+	unchanged = lsp->hdr.lsp_bits == old_hdr.lsp_bits
+		    && isis_fragment_unchanged(area->lsp_frag_state[level - 1],
+					       0);
+	if (unchanged) {
+		stream_free(lsp->pdu);
+		lsp->pdu = old_pdu;
+		lsp->hdr.pdu_len = old_hdr.pdu_len;
+		lsp->hdr.checksum = old_hdr.checksum;
+	} else
+		stream_free(old_pdu);
+
+	if (lsp_reissue(lsp, unchanged, rem_lifetime, refresh_time))
+		reissued++;
+
 	for (ALL_LIST_ELEMENTS_RO(lsp->lspu.frags, node, frag)) {
 		if (!frag->tlvs) {
-			/* Updating and flooding should only affect fragments
-			 * carrying data
+			/* Purge should only be applied when the fragment has
+			 * non-zero remaining lifetime.
 			 */
+			if (frag->hdr.rem_lifetime) {
+				lsp_purge(frag, level, NULL);
+				reissued++;
+			}
 			continue;
 		}
 
+		old_bits = frag->hdr.lsp_bits;
 		frag->hdr.lsp_bits =
 			lsp_bits_generate(level, area->overload_bit,
 					  area->attached_bit_send, area);
-		/* Set the lifetime values of all the fragments to the same
-		 * value,
-		 * so that no fragment expires before the lsp is refreshed.
-		 */
-		frag->hdr.rem_lifetime = rem_lifetime;
-		frag->age_out = ZERO_AGE_LIFETIME;
-		lsp_flood(frag, NULL);
+		unchanged = frag->hdr.lsp_bits == old_bits
+			    && isis_fragment_unchanged(
+				    area->lsp_frag_state[level - 1],
+				    LSP_FRAGMENT(frag->hdr.lsp_id));
+		if (lsp_reissue(frag, unchanged, rem_lifetime, refresh_time))
+			reissued++;
 	}
-	lsp_seqno_update(lsp);
 
-	refresh_time = lsp_refresh_time(lsp, rem_lifetime);
+	/* Nothing went out, but whatever asked for the regeneration may still
+	 * expect a local route calculation.
+	 */
+	if (!reissued)
+		isis_spf_schedule(area, level);
+
 	event_add_timer(master, lsp_refresh, &area->lsp_refresh_arg[level - 1],
 			refresh_time, &area->t_lsp_refresh[level - 1]);
 	area->lsp_regenerate_pending[level - 1] = 0;
@@ -2504,7 +2603,7 @@ int isis_lsp_iterate_is_reach(struct isis_lsp *lsp, uint16_t mtid,
 			te_neighs = &lsp->tlvs->extended_reach;
 		else
 			te_neighs =
-				isis_get_mt_items(&lsp->tlvs->mt_reach, mtid);
+				isis_lookup_mt_items(&lsp->tlvs->mt_reach, mtid);
 		if (te_neighs) {
 			head = te_neighs->head;
 			for (struct isis_extended_reach *reach =
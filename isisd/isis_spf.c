@@ -24,6 +24,7 @@
 #include "hash.h"
 #include "table.h"
 #include "spf_backoff.h"
+#include "spf_csr.h"
 #include "srcdest_table.h"
 #include "vrf.h"
 #include "lib/json.h"
@@ -59,6 +60,7 @@ static void spf_adj_list_parse_lsp(struct isis_spftree *spftree,
 				   struct list *adj_list, struct isis_lsp *lsp,
 				   const uint8_t *pseudo_nodeid,
 				   uint32_t pseudo_metric);
+static void isis_spf_csr_free(struct isis_spftree *spftree);
 
 /*
  *  supports the given af ?
@@ -345,6 +347,7 @@ static void _isis_spftree_init(struct isis_spftree *tree)
 	if (tree->type == SPF_TYPE_RLFA || tree->type == SPF_TYPE_TI_LFA) {
 		isis_spf_node_list_init(&tree->lfa.p_space);
 		isis_spf_node_list_init(&tree->lfa.q_space);
+		isis_spf_node_list_init(&tree->lfa.p_space_adj);
 	}
 }
 
@@ -388,11 +391,15 @@ static void _isis_spftree_del(struct isis_spftree *spftree)
 	    || spftree->type == SPF_TYPE_TI_LFA) {
 		isis_spf_node_list_clear(&spftree->lfa.q_space);
 		isis_spf_node_list_clear(&spftree->lfa.p_space);
+		isis_spf_node_list_clear(&spftree->lfa.p_space_adj);
 	}
+	if (spftree->lfa.deferred)
+		list_delete(&spftree->lfa.deferred);
 	isis_spf_node_list_clear(&spftree->adj_nodes);
 	list_delete(&spftree->sadj_list);
 	isis_vertex_queue_free(&spftree->tents);
 	isis_vertex_queue_free(&spftree->paths);
+	isis_spf_csr_free(spftree);
 	info =  spftree->route_table->info;
 	backup_info = spftree->route_table_backup->info;
 	route_table_finish(spftree->route_table);
@@ -556,34 +563,18 @@ static void vertex_update_firsthops(struct isis_vertex *vertex,
 }
 
 /*
- * Add a vertex to TENT sorted by cost and by vertextype on tie break situation
+ * Create a vertex reached from parent (or, for a neighbor of the root, over
+ * sadj) and inherit the adjacencies of the path.
  */
 static struct isis_vertex *
-isis_spf_add2tent(struct isis_spftree *spftree, enum vertextype vtype, void *id,
-		  uint32_t cost, int depth, struct isis_spf_adj *sadj,
-		  struct isis_prefix_sid *psid, struct isis_vertex *parent)
+isis_spf_vertex_create(struct isis_spftree *spftree, enum vertextype vtype,
+		       void *id, uint32_t cost, int depth,
+		       struct isis_spf_adj *sadj, struct isis_prefix_sid *psid,
+		       struct isis_vertex *parent)
 {
 	struct isis_vertex *vertex;
 	struct listnode *node;
 	bool last_hop;
-	char buff[VID2STR_BUFFER];
-
-	vertex = isis_find_vertex(&spftree->paths, id, vtype);
-	if (vertex != NULL) {
-		zlog_err(
-			"%s: vertex %s of type %s already in PATH; check for sysId collisions with established neighbors",
-			__func__, vid2string(vertex, buff, sizeof(buff)),
-			vtype2string(vertex->type));
-		return NULL;
-	}
-	vertex = isis_find_vertex(&spftree->tents, id, vtype);
-	if (vertex != NULL) {
-		zlog_err(
-			"%s: vertex %s of type %s already in TENT; check for sysId collisions with established neighbors",
-			__func__, vid2string(vertex, buff, sizeof(buff)),
-			vtype2string(vertex->type));
-		return NULL;
-	}
 
 	vertex = isis_vertex_new(spftree, id, vtype);
 	vertex->d_N = cost;
@@ -654,6 +645,40 @@ isis_spf_add2tent(struct isis_spftree *spftree, enum vertextype vtype, void *id,
 				    last_hop);
 	}
 
+	return vertex;
+}
+
+/*
+ * Add a vertex to TENT sorted by cost and by vertextype on tie break situation
+ */
+static struct isis_vertex *
+isis_spf_add2tent(struct isis_spftree *spftree, enum vertextype vtype, void *id,
+		  uint32_t cost, int depth, struct isis_spf_adj *sadj,
+		  struct isis_prefix_sid *psid, struct isis_vertex *parent)
+{
+	struct isis_vertex *vertex;
+	char buff[VID2STR_BUFFER];
+
+	vertex = isis_find_vertex(&spftree->paths, id, vtype);
+	if (vertex != NULL) {
+		zlog_err(
+			"%s: vertex %s of type %s already in PATH; check for sysId collisions with established neighbors",
+			__func__, vid2string(vertex, buff, sizeof(buff)),
+			vtype2string(vertex->type));
+		return NULL;
+	}
+	vertex = isis_find_vertex(&spftree->tents, id, vtype);
+	if (vertex != NULL) {
+		zlog_err(
+			"%s: vertex %s of type %s already in TENT; check for sysId collisions with established neighbors",
+			__func__, vid2string(vertex, buff, sizeof(buff)),
+			vtype2string(vertex->type));
+		return NULL;
+	}
+
+	vertex = isis_spf_vertex_create(spftree, vtype, id, cost, depth, sadj,
+					psid, parent);
+
 #ifdef EXTREME_DEBUG
 	if (IS_DEBUG_SPF_EVENTS)
 		zlog_debug(
@@ -712,6 +737,32 @@ static void isis_spf_add_local(struct isis_spftree *spftree,
 	return;
 }
 
+/* C.2.6 d) 1) and 2): another path of the same cost to vertex */
+static void isis_spf_vertex_add_parent(struct isis_spftree *spftree,
+				       struct isis_vertex *vertex,
+				       struct isis_prefix_sid *psid,
+				       struct isis_vertex *parent)
+{
+	struct listnode *node;
+	struct isis_vertex_adj *parent_vadj;
+
+	for (ALL_LIST_ELEMENTS_RO(parent->Adj_N, node, parent_vadj))
+		if (!isis_vertex_adj_exists(spftree, vertex,
+					    parent_vadj->sadj)) {
+			bool last_hop = (vertex->depth == 2);
+
+			isis_vertex_adj_add(spftree, vertex, vertex->Adj_N,
+					    parent_vadj->sadj, psid, last_hop);
+		}
+	if (CHECK_FLAG(spftree->flags, F_SPFTREE_HOPCOUNT_METRIC))
+		vertex_update_firsthops(vertex, parent);
+	if (!CHECK_FLAG(spftree->flags, F_SPFTREE_NO_ADJACENCIES)
+	    && listcount(vertex->Adj_N) > ISIS_MAX_PATH_SPLITS)
+		remove_excess_adjs(vertex->Adj_N);
+	if (listnode_lookup(vertex->parents, parent) == NULL)
+		listnode_add(vertex->parents, parent);
+}
+
 static void process_N(struct isis_spftree *spftree, enum vertextype vtype,
 		      void *id, uint32_t dist, uint16_t depth,
 		      struct isis_prefix_sid *psid, struct isis_vertex *parent)
@@ -779,30 +830,8 @@ static void process_N(struct isis_spftree *spftree, enum vertextype vtype,
 				(parent ? listcount(parent->Adj_N) : 0));
 #endif /* EXTREME_DEBUG */
 		if (vertex->d_N == dist) {
-			struct listnode *node;
-			struct isis_vertex_adj *parent_vadj;
-			for (ALL_LIST_ELEMENTS_RO(parent->Adj_N, node,
-						  parent_vadj))
-				if (!isis_vertex_adj_exists(
-					    spftree, vertex,
-					    parent_vadj->sadj)) {
-					bool last_hop = (vertex->depth == 2);
-
-					isis_vertex_adj_add(spftree, vertex,
-							    vertex->Adj_N,
-							    parent_vadj->sadj,
-							    psid, last_hop);
-				}
-			if (CHECK_FLAG(spftree->flags,
-				       F_SPFTREE_HOPCOUNT_METRIC))
-				vertex_update_firsthops(vertex, parent);
-			/*      2) */
-			if (!CHECK_FLAG(spftree->flags,
-					F_SPFTREE_NO_ADJACENCIES)
-			    && listcount(vertex->Adj_N) > ISIS_MAX_PATH_SPLITS)
-				remove_excess_adjs(vertex->Adj_N);
-			if (listnode_lookup(vertex->parents, parent) == NULL)
-				listnode_add(vertex->parents, parent);
+			isis_spf_vertex_add_parent(spftree, vertex, psid,
+						   parent);
 			return;
 		} else if (vertex->d_N < dist) {
 			return;
@@ -1542,8 +1571,8 @@ static void spf_adj_list_parse_lsp(struct isis_spftree *spftree,
 		if (pseudo_lsp || spftree->mtid == ISIS_MT_IPV4_UNICAST)
 			te_neighs = &lsp->tlvs->extended_reach;
 		else
-			te_neighs = isis_get_mt_items(&lsp->tlvs->mt_reach,
-						      spftree->mtid);
+			te_neighs = isis_lookup_mt_items(&lsp->tlvs->mt_reach,
+							 spftree->mtid);
 		if (te_neighs) {
 			head = te_neighs->head;
 			for (struct isis_extended_reach *reach =
@@ -1678,6 +1707,59 @@ spf_prefix_priority(struct isis_spftree *spftree, struct isis_vertex *vertex)
 	return SPF_PREFIX_PRIO_LOW;
 }
 
+/* Install the TI-LFA repair path(s) computed for the given vertex. */
+static void spf_tilfa_install(struct isis_spftree *spftree_pc,
+			      struct isis_vertex *vertex)
+{
+	struct isis_area *area = spftree_pc->area;
+	int level = spftree_pc->level;
+	struct isis_spftree *pre_spftree = spftree_pc->lfa.old.spftree;
+
+	if (VTYPE_IS(vertex->type)) {
+		struct isis_adjacency *adj;
+
+		adj = isis_adj_find(area, level, vertex->N.id);
+		if (adj)
+			sr_adj_sid_add_single(adj, spftree_pc->family, true,
+					      vertex->Adj_N);
+		return;
+	}
+
+	pre_spftree->lfa.protection_counters.tilfa[vertex->N.ip.priority] += 1;
+	isis_route_create(&vertex->N.ip.p.dest, &vertex->N.ip.p.src,
+			  vertex->d_N, vertex->depth, &vertex->N.ip.sr,
+			  vertex->Adj_N, area->lfa_load_sharing[level - 1],
+			  area, pre_spftree->route_table_backup);
+}
+
+/*
+ * Install the repair paths of a post-convergence SPT that was computed with
+ * deferred installation.  This needs to happen on the main pthread, in the
+ * same order the trees would have been computed in.
+ */
+void isis_spf_lfa_install_deferred(struct isis_spftree *spftree_pc)
+{
+	struct isis_vertex *vertex;
+	struct listnode *node;
+
+	for (ALL_LIST_ELEMENTS_RO(spftree_pc->lfa.deferred, node, vertex)) {
+		switch (spftree_pc->type) {
+		case SPF_TYPE_RLFA:
+			isis_rlfa_check(spftree_pc, vertex);
+			break;
+		case SPF_TYPE_TI_LFA:
+			if (!isis_tilfa_covered(spftree_pc, vertex))
+				spf_tilfa_install(spftree_pc, vertex);
+			break;
+		case SPF_TYPE_FORWARD:
+		case SPF_TYPE_REVERSE:
+			break;
+		}
+	}
+
+	list_delete(&spftree_pc->lfa.deferred);
+}
+
 static void spf_path_process(struct isis_spftree *spftree,
 			     struct isis_vertex *vertex)
 {
@@ -1688,15 +1770,14 @@ static void spf_path_process(struct isis_spftree *spftree,
 	if (spftree->type == SPF_TYPE_TI_LFA && VTYPE_IS(vertex->type)
 	    && !CHECK_FLAG(spftree->flags, F_SPFTREE_NO_ADJACENCIES)) {
 		if (listcount(vertex->Adj_N) > 0) {
-			struct isis_adjacency *adj;
-
 			if (isis_tilfa_check(spftree, vertex) != 0)
 				return;
 
-			adj = isis_adj_find(area, level, vertex->N.id);
-			if (adj)
-				sr_adj_sid_add_single(adj, spftree->family,
-						      true, vertex->Adj_N);
+			if (spftree->lfa.deferred) {
+				listnode_add(spftree->lfa.deferred, vertex);
+				return;
+			}
+			spf_tilfa_install(spftree, vertex);
 		} else if (IS_DEBUG_SPF_EVENTS)
 			zlog_debug(
 				"ISIS-SPF: no adjacencies, do not install backup Adj-SID for %s depth %d dist %d",
@@ -1711,7 +1792,6 @@ static void spf_path_process(struct isis_spftree *spftree,
 		priority = spf_prefix_priority(spftree, vertex);
 		vertex->N.ip.priority = priority;
 		if (vertex->depth == 1 || listcount(vertex->Adj_N) > 0) {
-			struct isis_spftree *pre_spftree;
 			struct route_table *route_table = NULL;
 			bool allow_ecmp = false;
 
@@ -1738,18 +1818,23 @@ static void spf_path_process(struct isis_spftree *spftree,
 
 			switch (spftree->type) {
 			case SPF_TYPE_RLFA:
-				isis_rlfa_check(spftree, vertex);
+				if (spftree->lfa.deferred)
+					listnode_add(spftree->lfa.deferred,
+						     vertex);
+				else
+					isis_rlfa_check(spftree, vertex);
 				return;
 			case SPF_TYPE_TI_LFA:
 				if (isis_tilfa_check(spftree, vertex) != 0)
 					return;
 
-				pre_spftree = spftree->lfa.old.spftree;
-				route_table = pre_spftree->route_table_backup;
-				allow_ecmp = area->lfa_load_sharing[level - 1];
-				pre_spftree->lfa.protection_counters
-					.tilfa[vertex->N.ip.priority] += 1;
-				break;
+				if (spftree->lfa.deferred) {
+					listnode_add(spftree->lfa.deferred,
+						     vertex);
+					return;
+				}
+				spf_tilfa_install(spftree, vertex);
+				return;
 			case SPF_TYPE_FORWARD:
 			case SPF_TYPE_REVERSE:
 				route_table = spftree->route_table;
@@ -1794,12 +1879,27 @@ static void spf_path_process(struct isis_spftree *spftree,
 	}
 }
 
-static void isis_spf_loop(struct isis_spftree *spftree,
-			  uint8_t *root_sysid)
+/* C.2.6 Step 1 for an IS vertex that has been moved to PATHS */
+static void isis_spf_process_vertex(struct isis_spftree *spftree,
+				    struct isis_vertex *vertex,
+				    uint8_t *root_sysid)
 {
-	struct isis_vertex *vertex;
 	struct isis_lsp *lsp;
-	struct listnode *node;
+
+	lsp = lsp_for_vertex(spftree, vertex);
+	if (!lsp) {
+		zlog_warn("ISIS-SPF: No LSP found for %pPN", vertex->N.id);
+		return;
+	}
+
+	isis_spf_process_lsp(spftree, lsp, vertex->d_N, vertex->depth,
+			     root_sysid, vertex);
+}
+
+static void isis_spf_tent_loop(struct isis_spftree *spftree,
+			       uint8_t *root_sysid)
+{
+	struct isis_vertex *vertex;
 
 	while (isis_vertex_queue_count(&spftree->tents)) {
 		vertex = isis_vertex_queue_pop(&spftree->tents);
@@ -1815,18 +1915,16 @@ static void isis_spf_loop(struct isis_spftree *spftree,
 		if (!VTYPE_IS(vertex->type))
 			continue;
 
-		lsp = lsp_for_vertex(spftree, vertex);
-		if (!lsp) {
-			zlog_warn("ISIS-SPF: No LSP found for %pPN",
-				  vertex->N.id);
-			continue;
-		}
-
-		isis_spf_process_lsp(spftree, lsp, vertex->d_N, vertex->depth,
-				     root_sysid, vertex);
+		isis_spf_process_vertex(spftree, vertex, root_sysid);
 	}
+}
+
+/* Generate routes once the SPT is formed. */
+static void isis_spf_generate_routes(struct isis_spftree *spftree)
+{
+	struct isis_vertex *vertex;
+	struct listnode *node;
 
-	/* Generate routes once the SPT is formed. */
 	for (ALL_QUEUE_ELEMENTS_RO(&spftree->paths, node, vertex)) {
 		/* New-style TLVs take precedence over the old-style TLVs. */
 		switch (vertex->type) {
@@ -1851,6 +1949,511 @@ static void isis_spf_loop(struct isis_spftree *spftree,
 	}
 }
 
+static void isis_spf_loop(struct isis_spftree *spftree,
+			  uint8_t *root_sysid)
+{
+	isis_spf_tent_loop(spftree, root_sysid);
+	isis_spf_generate_routes(spftree);
+}
+
+/*
+ * Dijkstra on the shared SPF kernel (lib/spf_csr.h).
+ *
+ * The IS part of the LSPDB is translated into a graph with one vertex per
+ * fragment zero LSP and metric style (narrow and wide reachability give
+ * distinct vertices, as in TENT) and exactly the IS neighbors
+ * isis_spf_process_lsp() would pass to process_N().  Neighbors without a
+ * usable LSP get a vertex without edges, the classic code puts them on PATHS
+ * as well.  The vertices preloaded into TENT from the adjacencies become
+ * edges of the root.
+ *
+ * The kernel breaks ties like TENT does (vertex type, then order of
+ * insertion), so creating the IS vertices in the order they were settled,
+ * from the first parent found and adding the other parents as equal cost
+ * paths, gives the same vertices as the classic loop.  The LSPs of the IS
+ * vertices are then processed in that order to put their prefixes on TENT,
+ * which by now only holds prefixes, and the two runs of PATHS are merged by
+ * distance and vertex type.
+ */
+DEFINE_MTYPE_STATIC(ISISD, ISIS_SPF_CSR, "ISIS SPF kernel data");
+
+struct isis_spf_csr_extra {
+	uint8_t id[ISIS_SYS_ID_LEN + 1];
+	enum vertextype vtype;
+};
+
+struct isis_spf_csr {
+	struct spf_csr csr;
+
+	/*
+	 * Usable fragment zero LSPs in LSPDB order, LSP i and metric style
+	 * variant k are vertex 1 + i * nvariants + k.  The root is vertex 0.
+	 */
+	uint32_t nlsps;
+	uint32_t lsps_alloc;
+	struct isis_lsp **lsps;
+	uint8_t nvariants;
+
+	/* IS neighbors without LSP, vertex 1 + nlsps * nvariants + i */
+	uint32_t nextras;
+	uint32_t extras_alloc;
+	struct isis_spf_csr_extra *extras;
+
+	/* vertex index -> SPF vertex */
+	uint32_t vertices_alloc;
+	struct isis_vertex **vertices;
+};
+
+static void isis_spf_csr_free(struct isis_spftree *spftree)
+{
+	struct isis_spf_csr *sc = spftree->csr;
+
+	if (!sc)
+		return;
+
+	spf_csr_fini(&sc->csr);
+	XFREE(MTYPE_ISIS_SPF_CSR, sc->lsps);
+	XFREE(MTYPE_ISIS_SPF_CSR, sc->extras);
+	XFREE(MTYPE_ISIS_SPF_CSR, sc->vertices);
+	XFREE(MTYPE_ISIS_SPF_CSR, spftree->csr);
+}
+
+/* Metric style variant of an IS vertex type, -1 if not in the graph. */
+static int isis_spf_csr_variant(const struct isis_spftree *spftree,
+				enum vertextype vtype)
+{
+	bool te = (vtype == VTYPE_PSEUDO_TE_IS
+		   || vtype == VTYPE_NONPSEUDO_TE_IS);
+
+	if (!VTYPE_IS(vtype))
+		return -1;
+	if (te ? !spftree->area->newmetric : !spftree->area->oldmetric)
+		return -1;
+
+	return (te && spftree->area->oldmetric) ? 1 : 0;
+}
+
+static enum vertextype isis_spf_csr_vtype(const struct isis_spftree *spftree,
+					  const uint8_t *id, int variant)
+{
+	bool te = variant || !spftree->area->oldmetric;
+
+	if (LSP_PSEUDO_ID(id))
+		return te ? VTYPE_PSEUDO_TE_IS : VTYPE_PSEUDO_IS;
+	return te ? VTYPE_NONPSEUDO_TE_IS : VTYPE_NONPSEUDO_IS;
+}
+
+static uint32_t isis_spf_csr_lookup(struct isis_spftree *spftree,
+				    struct isis_spf_csr *sc, const uint8_t *id,
+				    enum vertextype vtype)
+{
+	struct isis_spf_csr_extra *extra;
+	uint32_t lo = 0, hi = sc->nlsps;
+	int variant, cmp;
+
+	variant = isis_spf_csr_variant(spftree, vtype);
+	if (variant < 0)
+		return SPF_CSR_NONE;
+
+	while (lo < hi) {
+		uint32_t mid = lo + (hi - lo) / 2;
+
+		cmp = memcmp(sc->lsps[mid]->hdr.lsp_id, id,
+			     ISIS_SYS_ID_LEN + 1);
+		if (cmp == 0)
+			return 1 + mid * sc->nvariants + variant;
+		if (cmp < 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	for (uint32_t i = 0; i < sc->nextras; i++) {
+		extra = &sc->extras[i];
+		if (extra->vtype == vtype
+		    && !memcmp(extra->id, id, ISIS_SYS_ID_LEN + 1))
+			return 1 + sc->nlsps * sc->nvariants + i;
+	}
+
+	if (sc->nextras == sc->extras_alloc) {
+		sc->extras_alloc = sc->extras_alloc ? sc->extras_alloc * 2 : 16;
+		sc->extras = XREALLOC(MTYPE_ISIS_SPF_CSR, sc->extras,
+				      sc->extras_alloc * sizeof(*sc->extras));
+	}
+	extra = &sc->extras[sc->nextras++];
+	memcpy(extra->id, id, ISIS_SYS_ID_LEN + 1);
+	extra->vtype = vtype;
+
+	return spf_csr_add_vertex(&sc->csr);
+}
+
+static void isis_spf_csr_vertex_id(const struct isis_spftree *spftree,
+				   const struct isis_spf_csr *sc, uint32_t idx,
+				   uint8_t *id, enum vertextype *vtype)
+{
+	uint32_t i = idx - 1;
+
+	if (i < sc->nlsps * sc->nvariants) {
+		memcpy(id, sc->lsps[i / sc->nvariants]->hdr.lsp_id,
+		       ISIS_SYS_ID_LEN + 1);
+		*vtype = isis_spf_csr_vtype(spftree, id, i % sc->nvariants);
+		return;
+	}
+
+	i -= sc->nlsps * sc->nvariants;
+	memcpy(id, sc->extras[i].id, ISIS_SYS_ID_LEN + 1);
+	*vtype = sc->extras[i].vtype;
+}
+
+static void isis_spf_csr_add_link(struct isis_spftree *spftree,
+				  struct isis_spf_csr *sc, uint32_t lsp_idx,
+				  const uint8_t *id, enum vertextype vtype,
+				  uint32_t metric)
+{
+	uint32_t w = isis_spf_csr_lookup(spftree, sc, id, vtype);
+
+	if (w == SPF_CSR_NONE)
+		return;
+
+	for (uint32_t k = 0; k < sc->nvariants; k++)
+		spf_csr_add_edge(&sc->csr, 1 + lsp_idx * sc->nvariants + k, w,
+				 metric, 0);
+}
+
+/* The IS part of isis_spf_process_lsp(). */
+static void isis_spf_csr_add_links(struct isis_spftree *spftree,
+				   struct isis_spf_csr *sc, uint32_t lsp_idx)
+{
+	struct isis_lsp *lsp = sc->lsps[lsp_idx];
+	bool pseudo_lsp = LSP_PSEUDO_ID(lsp->hdr.lsp_id);
+	struct listnode *fragnode = NULL;
+	static const uint8_t null_sysid[ISIS_SYS_ID_LEN];
+	struct isis_mt_router_info *mt_router_info = NULL;
+
+	if (isis_lfa_excise_node_check(spftree, lsp->hdr.lsp_id))
+		return;
+
+	if (!lsp->tlvs)
+		return;
+
+	if (spftree->mtid != ISIS_MT_IPV4_UNICAST)
+		mt_router_info = isis_tlvs_lookup_mt_router_info(lsp->tlvs,
+								 spftree->mtid);
+
+	if (!pseudo_lsp && (spftree->mtid == ISIS_MT_IPV4_UNICAST
+			    && !speaks(lsp->tlvs->protocols_supported.protocols,
+				       lsp->tlvs->protocols_supported.count,
+				       spftree->family))
+	    && !mt_router_info)
+		return;
+
+	if (!pseudo_lsp
+	    && !(spftree->mtid == ISIS_MT_IPV4_UNICAST
+		 && !ISIS_MASK_LSP_OL_BIT(lsp->hdr.lsp_bits))
+	    && !(mt_router_info && !mt_router_info->overload))
+		return;
+
+	for (;;) {
+		if (!lsp->tlvs || lsp->hdr.seqno == 0)
+			return;
+
+		if ((pseudo_lsp || spftree->mtid == ISIS_MT_IPV4_UNICAST)
+		    && spftree->area->oldmetric && !fabricd) {
+			struct isis_oldstyle_reach *r;
+
+			for (r = (struct isis_oldstyle_reach *)
+					 lsp->tlvs->oldstyle_reach.head;
+			     r; r = r->next) {
+				if (!LSP_PSEUDO_ID(r->id)
+				    && !memcmp(r->id, spftree->sysid,
+					       ISIS_SYS_ID_LEN))
+					continue;
+				if (!pseudo_lsp
+				    && !memcmp(r->id, null_sysid,
+					       ISIS_SYS_ID_LEN))
+					continue;
+				isis_spf_csr_add_link(spftree, sc, lsp_idx,
+						      r->id,
+						      LSP_PSEUDO_ID(r->id)
+							      ? VTYPE_PSEUDO_IS
+							      : VTYPE_NONPSEUDO_IS,
+						      r->metric);
+			}
+		}
+
+		if (spftree->area->newmetric) {
+			struct isis_item_list *te_neighs = NULL;
+			struct isis_extended_reach *er;
+
+			if (pseudo_lsp || spftree->mtid == ISIS_MT_IPV4_UNICAST)
+				te_neighs = &lsp->tlvs->extended_reach;
+			else
+				te_neighs = isis_lookup_mt_items(
+					&lsp->tlvs->mt_reach, spftree->mtid);
+
+			for (er = te_neighs ? (struct isis_extended_reach *)
+						      te_neighs->head
+					    : NULL;
+			     er; er = er->next) {
+				if (!LSP_PSEUDO_ID(er->id)
+				    && !memcmp(er->id, spftree->sysid,
+					       ISIS_SYS_ID_LEN))
+					continue;
+				if (!pseudo_lsp
+				    && !memcmp(er->id, null_sysid,
+					       ISIS_SYS_ID_LEN))
+					continue;
+#ifndef FABRICD
+				if (flex_algo_id_valid(spftree->algorithm) &&
+				    (!sr_algorithm_participated(
+					     lsp, spftree->algorithm) ||
+				     isis_flex_algo_constraint_drop(spftree,
+								    lsp, er)))
+					continue;
+#endif /* ifndef FABRICD */
+				isis_spf_csr_add_link(
+					spftree, sc, lsp_idx, er->id,
+					LSP_PSEUDO_ID(er->id)
+						? VTYPE_PSEUDO_TE_IS
+						: VTYPE_NONPSEUDO_TE_IS,
+					er->metric);
+			}
+		}
+
+		if (fragnode == NULL)
+			fragnode = listhead(lsp->lspu.frags);
+		else
+			fragnode = listnextnode(fragnode);
+		if (!fragnode)
+			return;
+		lsp = listgetdata(fragnode);
+	}
+}
+
+/*
+ * Build the graph and turn TENT, as loaded by isis_spf_preload_tent(), into
+ * edges of the root.  Returns false, with TENT unchanged, if a preloaded
+ * vertex doesn't fit into the graph.
+ */
+static bool isis_spf_csr_build(struct isis_spftree *spftree,
+			       struct isis_spf_csr *sc)
+{
+	struct isis_area *area = spftree->area;
+	struct spf_csr *csr = &sc->csr;
+	struct isis_vertex *vertex;
+	struct isis_lsp *lsp;
+	struct list *tents;
+	struct listnode *node;
+	uint32_t nvertices, w;
+	bool ok = true;
+
+	sc->nlsps = 0;
+	sc->nextras = 0;
+	sc->nvariants = !!area->oldmetric + !!area->newmetric;
+	if (!sc->nvariants)
+		return false;
+
+	frr_each (lspdb, spftree->lspdb, lsp) {
+		if (LSP_FRAGMENT(lsp->hdr.lsp_id) || lsp->hdr.rem_lifetime == 0)
+			continue;
+		if (sc->nlsps == sc->lsps_alloc) {
+			sc->lsps_alloc = sc->lsps_alloc ? sc->lsps_alloc * 2
+							: 64;
+			sc->lsps = XREALLOC(MTYPE_ISIS_SPF_CSR, sc->lsps,
+					    sc->lsps_alloc * sizeof(*sc->lsps));
+		}
+		sc->lsps[sc->nlsps++] = lsp;
+	}
+
+	spf_csr_reset(csr, 1 + sc->nlsps * sc->nvariants);
+	/* RFC3787 section 5.1 and C.2.6 b) */
+	spf_csr_set_max_dist(csr, area->newmetric ? MAX_WIDE_PATH_METRIC
+						  : MAX_NARROW_PATH_METRIC);
+	for (uint32_t i = 0; i < sc->nlsps; i++)
+		for (int k = 0; k < sc->nvariants; k++)
+			spf_csr_set_tiebreak(
+				csr, 1 + i * sc->nvariants + k,
+				isis_spf_csr_vtype(spftree,
+						   sc->lsps[i]->hdr.lsp_id, k));
+
+	/* Empty TENT, in order. */
+	tents = list_new();
+	while ((vertex = isis_vertex_queue_pop(&spftree->tents)))
+		listnode_add(tents, vertex);
+
+	for (ALL_LIST_ELEMENTS_RO(tents, node, vertex)) {
+		if (VTYPE_IP(vertex->type))
+			continue;
+		if (vertex->d_N > csr->max_dist
+		    || isis_spf_csr_variant(spftree, vertex->type) < 0) {
+			ok = false;
+			break;
+		}
+	}
+	if (!ok) {
+		for (ALL_LIST_ELEMENTS_RO(tents, node, vertex))
+			isis_vertex_queue_insert(&spftree->tents, vertex);
+		list_delete(&tents);
+		return false;
+	}
+
+	for (ALL_LIST_ELEMENTS_RO(tents, node, vertex)) {
+		if (VTYPE_IP(vertex->type)) {
+			isis_vertex_queue_insert(&spftree->tents, vertex);
+			continue;
+		}
+		w = isis_spf_csr_lookup(spftree, sc, vertex->N.id,
+					vertex->type);
+		spf_csr_add_edge(csr, 0, w, vertex->d_N, 0);
+	}
+
+	for (uint32_t i = 0; i < sc->nlsps; i++)
+		isis_spf_csr_add_links(spftree, sc, i);
+	for (uint32_t i = 0; i < sc->nextras; i++)
+		spf_csr_set_tiebreak(csr, 1 + sc->nlsps * sc->nvariants + i,
+				     sc->extras[i].vtype);
+	spf_csr_finalize(csr);
+
+	/* The preloaded vertices are kept unless a shorter path shows up. */
+	nvertices = csr->nvertices;
+	if (nvertices > sc->vertices_alloc) {
+		sc->vertices_alloc = nvertices;
+		sc->vertices = XREALLOC(MTYPE_ISIS_SPF_CSR, sc->vertices,
+					nvertices * sizeof(*sc->vertices));
+	}
+	memset(sc->vertices, 0, nvertices * sizeof(*sc->vertices));
+	for (ALL_LIST_ELEMENTS_RO(tents, node, vertex))
+		if (!VTYPE_IP(vertex->type))
+			sc->vertices[isis_spf_csr_lookup(spftree, sc,
+							 vertex->N.id,
+							 vertex->type)] =
+				vertex;
+	list_delete(&tents);
+
+	return true;
+}
+
+/*
+ * PATHS holds the root, the IS vertices and then the prefixes, each in the
+ * order they were settled.  Interleave them the way the classic loop would
+ * have popped them from TENT.
+ */
+static void isis_spf_csr_merge_paths(struct isis_spftree *spftree,
+				     unsigned int nis)
+{
+	struct list *paths = spftree->paths.l.list;
+	unsigned int nip = listcount(paths) - 1 - nis;
+	struct listnode *is, *ip, *next;
+	struct isis_vertex *va, *vb;
+	bool take_is;
+
+	is = listnextnode(listhead(paths));
+	ip = is;
+	for (unsigned int i = 0; i < nis; i++)
+		ip = listnextnode(ip);
+
+	while (nis || nip) {
+		if (!nip)
+			take_is = true;
+		else if (!nis)
+			take_is = false;
+		else {
+			va = listgetdata(is);
+			vb = listgetdata(ip);
+			take_is = va->d_N < vb->d_N
+				  || (va->d_N == vb->d_N
+				      && va->type < vb->type);
+		}
+
+		if (take_is) {
+			next = listnextnode(is);
+			listnode_move_to_tail(paths, is);
+			is = next;
+			nis--;
+		} else {
+			next = listnextnode(ip);
+			listnode_move_to_tail(paths, ip);
+			ip = next;
+			nip--;
+		}
+	}
+}
+
+/*
+ * C.2.6 and C.2.7 on the SPF kernel.  Returns false if the classic loop needs
+ * to do the calculation.
+ */
+static bool isis_spf_dijkstra_csr(struct isis_spftree *spftree,
+				  struct isis_vertex *root_vertex)
+{
+	struct isis_spf_csr *sc;
+	struct spf_csr *csr;
+	struct isis_vertex *vertex, *parent;
+	uint8_t id[ISIS_SYS_ID_LEN + 1];
+	enum vertextype vtype;
+	uint32_t i, idx, e;
+
+	if (CHECK_FLAG(spftree->flags, F_SPFTREE_HOPCOUNT_METRIC))
+		return false;
+
+	if (!spftree->csr)
+		spftree->csr = XCALLOC(MTYPE_ISIS_SPF_CSR,
+				       sizeof(*spftree->csr));
+	sc = spftree->csr;
+	csr = &sc->csr;
+
+	if (!isis_spf_csr_build(spftree, sc))
+		return false;
+
+	if (IS_DEBUG_SPF_EVENTS)
+		zlog_debug("ISIS-SPF: A:%hhu %u vertices, %u links",
+			   spftree->algorithm, csr->nvertices, csr->nedges);
+
+	spf_csr_run(csr, 0);
+
+	spf_csr_foreach_settled (csr, i, idx) {
+		if (i == 0) {
+			sc->vertices[idx] = root_vertex;
+			continue;
+		}
+
+		e = csr->parent_head[idx];
+		vertex = sc->vertices[idx];
+		if (csr->src[e] != 0) {
+			/* reached over another IS first */
+			if (vertex) {
+				hash_release(spftree->prefix_sids, vertex);
+				isis_vertex_del(vertex);
+			}
+			parent = sc->vertices[csr->src[e]];
+			isis_spf_csr_vertex_id(spftree, sc, idx, id, &vtype);
+			vertex = isis_spf_vertex_create(spftree, vtype, id,
+							spf_csr_dist(csr, idx),
+							parent->depth + 1, NULL,
+							NULL, parent);
+			sc->vertices[idx] = vertex;
+		}
+
+		for (e = csr->parent_next[e]; e != SPF_CSR_NONE;
+		     e = csr->parent_next[e])
+			isis_spf_vertex_add_parent(spftree, vertex, NULL,
+						   sc->vertices[csr->src[e]]);
+
+		add_to_paths(spftree, vertex);
+	}
+
+	/* The IS vertices are all in PATHS, this only adds prefixes. */
+	spf_csr_foreach_settled (csr, i, idx)
+		if (i > 0)
+			isis_spf_process_vertex(spftree, sc->vertices[idx],
+						spftree->sysid);
+	isis_spf_tent_loop(spftree, spftree->sysid);
+
+	isis_spf_csr_merge_paths(spftree, csr->norder - 1);
+
+	return true;
+}
+
 struct isis_spftree *isis_run_hopcount_spf(struct isis_area *area,
 					   uint8_t *sysid,
 					   struct isis_spftree *spftree)
@@ -1984,8 +2587,9 @@ void isis_run_spf(struct isis_spftree *spftree)
 			  print_sys_hostname(spftree->sysid));
 	}
 
-	isis_spf_loop(spftree, spftree->sysid);
-
+	if (!isis_spf_dijkstra_csr(spftree, root_vertex))
+		isis_spf_tent_loop(spftree, spftree->sysid);
+	isis_spf_generate_routes(spftree);
 
 #ifndef FABRICD
 	/* flex-algo */
@@ -2005,17 +2609,95 @@ out:
 		+ (time_end.tv_usec - time_start.tv_usec);
 }
 
-static void isis_run_spf_with_protection(struct isis_area *area,
+/*
+ * Partial route calculation:  the SPT is known to be unchanged (only IP
+ * reachability TLVs changed), so keep the IS vertices of the previous run,
+ * throw away the prefixes and attach them again.
+ */
+static bool isis_run_prc(struct isis_spftree *spftree)
+{
+	struct isis_area *area = spftree->area;
+	int level = spftree->level;
+	struct listnode *node, *nnode;
+	struct isis_vertex *vertex;
+	struct isis_lsp *lsp;
+	struct isis_lsp *root_lsp;
+
+	if (area->spf_full_pending[level - 1] || !spftree->runcount
+	    || !isis_vertex_queue_count(&spftree->paths))
+		return false;
+	if (spftree->type != SPF_TYPE_FORWARD || spftree->flags
+	    || spftree->algorithm != SR_ALGORITHM_SPF)
+		return false;
+	/* backup paths need the full machinery */
+	if (area->lfa_protected_links[level - 1] > 0
+	    || area->tilfa_protected_links[level - 1] > 0)
+		return false;
+
+	root_lsp = isis_root_system_lsp(spftree->lspdb, spftree->sysid);
+	if (!root_lsp)
+		return false;
+
+	hash_clean(spftree->prefix_sids, NULL);
+	for (ALL_LIST_ELEMENTS(spftree->paths.l.list, node, nnode, vertex)) {
+		if (!VTYPE_IP(vertex->type))
+			continue;
+		list_delete_node(spftree->paths.l.list, node);
+		hash_release(spftree->paths.hash, vertex);
+		isis_vertex_del(vertex);
+	}
+	isis_vertex_queue_clear(&spftree->tents);
+	memset(&spftree->lfa.protection_counters, 0,
+	       sizeof(spftree->lfa.protection_counters));
+
+	/*
+	 * Re-run C.2.6 Step 1 for all IS vertices.  Their neighbors are in
+	 * PATHS already, so this only puts the prefixes on TENT.
+	 */
+	for (ALL_QUEUE_ELEMENTS_RO(&spftree->paths, node, vertex)) {
+		if (!VTYPE_IS(vertex->type))
+			continue;
+
+		if (vertex->depth == 0) {
+			struct spf_preload_tent_ip_reach_args args = {
+				.spftree = spftree,
+				.parent = vertex,
+			};
+
+			isis_lsp_iterate_ip_reach(
+				root_lsp, spftree->family, spftree->mtid,
+				isis_spf_preload_tent_ip_reach_cb, &args);
+			continue;
+		}
+
+		lsp = lsp_for_vertex(spftree, vertex);
+		if (!lsp)
+			continue;
+		isis_spf_process_lsp(spftree, lsp, vertex->d_N, vertex->depth,
+				     spftree->sysid, vertex);
+	}
+
+	isis_spf_loop(spftree, spftree->sysid);
+	return true;
+}
+
+static bool isis_run_spf_with_protection(struct isis_area *area,
 					 struct isis_spftree *spftree)
 {
-	/* Run forward SPF locally. */
 	memcpy(spftree->sysid, area->isis->sysid, ISIS_SYS_ID_LEN);
+
+	if (isis_run_prc(spftree))
+		return false;
+
+	/* Run forward SPF locally. */
 	isis_run_spf(spftree);
 
 	/* Run LFA protection if configured. */
 	if (area->lfa_protected_links[spftree->level - 1] > 0
 	    || area->tilfa_protected_links[spftree->level - 1] > 0)
 		isis_spf_run_lfa(area, spftree);
+
+	return true;
 }
 
 void isis_spf_verify_routes(struct isis_area *area, struct isis_spftree **trees,
@@ -2067,6 +2749,7 @@ static void isis_run_spf_cb(struct event *event)
 	struct isis_area *area = run->area;
 	int level = run->level;
 	int have_run = 0;
+	bool full_run = false;
 	struct listnode *node;
 	struct isis_circuit *circuit;
 #ifndef FABRICD
@@ -2087,43 +2770,49 @@ static void isis_run_spf_cb(struct event *event)
 	isis_area_invalidate_routes(area, level);
 
 	if (IS_DEBUG_SPF_EVENTS)
-		zlog_debug("ISIS-SPF (%s) L%d SPF needed, periodic SPF",
-			   area->area_tag, level);
+		zlog_debug("ISIS-SPF (%s) L%d %s needed, periodic SPF",
+			   area->area_tag, level,
+			   area->spf_full_pending[level - 1] ? "SPF" : "PRC");
 
 	if (area->ip_circuits) {
-		isis_run_spf_with_protection(
+		full_run |= isis_run_spf_with_protection(
 			area, area->spftree[SPFTREE_IPV4][level - 1]);
 #ifndef FABRICD
 		for (ALL_LIST_ELEMENTS_RO(area->flex_algos->flex_algos, node,
 					  fa)) {
 			data = fa->data;
-			isis_run_spf_with_protection(
+			full_run |= isis_run_spf_with_protection(
 				area, data->spftree[SPFTREE_IPV4][level - 1]);
 		}
 #endif /* ifndef FABRICD */
 		have_run = 1;
 	}
 	if (area->ipv6_circuits) {
-		isis_run_spf_with_protection(
+		full_run |= isis_run_spf_with_protection(
 			area, area->spftree[SPFTREE_IPV6][level - 1]);
 #ifndef FABRICD
 		for (ALL_LIST_ELEMENTS_RO(area->flex_algos->flex_algos, node,
 					  fa)) {
 			data = fa->data;
-			isis_run_spf_with_protection(
+			full_run |= isis_run_spf_with_protection(
 				area, data->spftree[SPFTREE_IPV6][level - 1]);
 		}
 #endif /* ifndef FABRICD */
 		have_run = 1;
 	}
 	if (area->ipv6_circuits && isis_area_ipv6_dstsrc_enabled(area)) {
-		isis_run_spf_with_protection(
+		full_run |= isis_run_spf_with_protection(
 			area, area->spftree[SPFTREE_DSTSRC][level - 1]);
 		have_run = 1;
 	}
 
-	if (have_run)
-		area->spf_run_count[level - 1]++;
+	if (have_run) {
+		if (full_run)
+			area->spf_run_count[level - 1]++;
+		else
+			area->prc_run_count[level - 1]++;
+	}
+	area->spf_full_pending[level - 1] = false;
 
 	isis_area_verify_routes(area);
 
@@ -2149,7 +2838,7 @@ void isis_spf_timer_free(void *run)
 	XFREE(MTYPE_ISIS_SPF_RUN, run);
 }
 
-int _isis_spf_schedule(struct isis_area *area, int level,
+int _isis_spf_schedule(struct isis_area *area, int level, bool prc,
 		       const char *func, const char *file, int line)
 {
 	struct isis_spftree *spftree;
@@ -2157,6 +2846,9 @@ int _isis_spf_schedule(struct isis_area *area, int level,
 	long tree_diff, diff;
 	int tree;
 
+	if (!prc)
+		area->spf_full_pending[level - 1] = true;
+
 	now = monotime(NULL);
 	diff = 0;
 	for (tree = SPFTREE_IPV4; tree < SPFTREE_COUNT; tree++) {
@@ -2174,8 +2866,9 @@ int _isis_spf_schedule(struct isis_area *area, int level,
 
 	if (IS_DEBUG_SPF_EVENTS) {
 		zlog_debug(
-			"ISIS-SPF (%s) L%d SPF schedule called, lastrun %ld sec ago Caller: %s %s:%d",
-			area->area_tag, level, diff, func, file, line);
+			"ISIS-SPF (%s) L%d %s schedule called, lastrun %ld sec ago Caller: %s %s:%d",
+			area->area_tag, level, prc ? "PRC" : "SPF", diff, func,
+			file, line);
 	}
 
 	event_cancel(&area->t_rlfa_rib_update);
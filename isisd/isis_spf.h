@@ -57,9 +57,13 @@ void spftree_area_del(struct isis_area *area);
 struct isis_lsp *isis_root_system_lsp(struct lspdb_head *lspdb,
 				      const uint8_t *sysid);
 #define isis_spf_schedule(area, level) \
-	_isis_spf_schedule((area), (level), __func__, \
+	_isis_spf_schedule((area), (level), false, __func__, \
 			   __FILE__, __LINE__)
-int _isis_spf_schedule(struct isis_area *area, int level,
+/* only IP reachability changed, see isis_tlvs_topology_same() */
+#define isis_spf_schedule_prc(area, level) \
+	_isis_spf_schedule((area), (level), true, __func__, \
+			   __FILE__, __LINE__)
+int _isis_spf_schedule(struct isis_area *area, int level, bool prc,
 		       const char *func, const char *file, int line);
 void isis_print_spftree(struct vty *vty, struct isis_spftree *spftree,
 			struct json_object **json);
@@ -70,6 +74,7 @@ void isis_spf_print(struct isis_spftree *spftree, struct vty *vty);
 void isis_spf_print_json(struct isis_spftree *spftree,
 			 struct json_object *json);
 void isis_run_spf(struct isis_spftree *spftree);
+void isis_spf_lfa_install_deferred(struct isis_spftree *spftree_pc);
 struct isis_spftree *isis_run_hopcount_spf(struct isis_area *area,
 					   uint8_t *sysid,
 					   struct isis_spftree *spftree);
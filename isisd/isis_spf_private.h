@@ -325,6 +325,9 @@ struct isis_spftree {
 		struct isis_spf_nodes p_space;
 		struct isis_spf_nodes q_space;
 
+		/* P-spaces of the adjacent routers (extended P-space). */
+		struct isis_spf_nodes p_space_adj;
+
 		/* Remote LFA related information. */
 		struct {
 			/* List of RLFAs eligible to be installed. */
@@ -348,7 +351,15 @@ struct isis_spftree {
 			uint32_t ecmp[SPF_PREFIX_PRIO_MAX];
 			uint32_t total[SPF_PREFIX_PRIO_MAX];
 		} protection_counters;
+
+		/*
+		 * Vertices whose repair paths are yet to be installed, for
+		 * post-convergence SPTs computed by an LFA worker.
+		 */
+		struct list *deferred;
 	} lfa;
+	/* SPF kernel graph, kept between runs (see isis_spf_dijkstra_csr()) */
+	struct isis_spf_csr *csr;
 	uint8_t algorithm;
 	uint8_t flags;
 };
@@ -18,14 +18,14 @@
 #include <openssl/hmac.h>
 #endif
 
-#ifdef CRYPTO_INTERNAL
 #include "md5.h"
-#endif
 #include "memory.h"
 #include "stream.h"
 #include "sbuf.h"
 #include "network.h"
 #include "lib/json.h"
+#include "hash.h"
+#include "jhash.h"
 
 #include "isisd/isisd.h"
 #include "isisd/isis_tlvs.h"
@@ -48,6 +48,8 @@ DEFINE_MTYPE_STATIC(ISISD, ISIS_TLV, "ISIS TLVs");
 DEFINE_MTYPE(ISISD, ISIS_SUBTLV, "ISIS Sub-TLVs");
 DEFINE_MTYPE(ISISD, ISIS_SUBSUBTLV, "ISIS Sub-Sub-TLVs");
 DEFINE_MTYPE_STATIC(ISISD, ISIS_MT_ITEM_LIST, "ISIS MT Item Lists");
+DEFINE_MTYPE_STATIC(ISISD, ISIS_TLV_BLOCK, "ISIS compacted TLV items");
+DEFINE_MTYPE_STATIC(ISISD, ISIS_FRAG_STATE, "ISIS own LSP fragment state");
 
 typedef int (*unpack_tlv_func)(enum isis_tlv_context context, uint8_t tlv_type,
 			       uint8_t tlv_len, struct stream *s,
@@ -6789,9 +6791,202 @@ struct isis_tlvs *isis_copy_tlvs(struct isis_tlvs *tlvs)
 	copy_mt_items(ISIS_CONTEXT_LSP, ISIS_TLV_SRV6_LOCATOR,
 		      &tlvs->srv6_locator, &rv->srv6_locator);
 
+	rv->topology_hashed = tlvs->topology_hashed;
+	memcpy(rv->topology_hash, tlvs->topology_hash,
+	       sizeof(rv->topology_hash));
+
 	return rv;
 }
 
+/* Functions to compact the tlvs of received LSPs */
+
+/*
+ * Item lists moved into the item block. These are the reachability TLVs,
+ * which make up the bulk of any large LSP.
+ */
+static const struct {
+	enum isis_tlv_type type;
+	size_t offset;
+	bool mt;
+} compact_lists[] = {
+	{ ISIS_TLV_OLDSTYLE_REACH, offsetof(struct isis_tlvs, oldstyle_reach),
+	  false },
+	{ ISIS_TLV_EXTENDED_REACH, offsetof(struct isis_tlvs, extended_reach),
+	  false },
+	{ ISIS_TLV_MT_REACH, offsetof(struct isis_tlvs, mt_reach), true },
+	{ ISIS_TLV_OLDSTYLE_IP_REACH,
+	  offsetof(struct isis_tlvs, oldstyle_ip_reach), false },
+	{ ISIS_TLV_OLDSTYLE_IP_REACH_EXT,
+	  offsetof(struct isis_tlvs, oldstyle_ip_reach_ext), false },
+	{ ISIS_TLV_EXTENDED_IP_REACH,
+	  offsetof(struct isis_tlvs, extended_ip_reach), false },
+	{ ISIS_TLV_MT_IP_REACH, offsetof(struct isis_tlvs, mt_ip_reach), true },
+	{ ISIS_TLV_IPV6_REACH, offsetof(struct isis_tlvs, ipv6_reach), false },
+	{ ISIS_TLV_MT_IPV6_REACH, offsetof(struct isis_tlvs, mt_ipv6_reach),
+	  true },
+};
+
+static size_t compact_item_size(enum isis_tlv_type type)
+{
+	switch (type) {
+	case ISIS_TLV_OLDSTYLE_REACH:
+		return sizeof(struct isis_oldstyle_reach);
+	case ISIS_TLV_EXTENDED_REACH:
+	case ISIS_TLV_MT_REACH:
+		return sizeof(struct isis_extended_reach);
+	case ISIS_TLV_OLDSTYLE_IP_REACH:
+	case ISIS_TLV_OLDSTYLE_IP_REACH_EXT:
+		return sizeof(struct isis_oldstyle_ip_reach);
+	case ISIS_TLV_EXTENDED_IP_REACH:
+	case ISIS_TLV_MT_IP_REACH:
+		return sizeof(struct isis_extended_ip_reach);
+	case ISIS_TLV_IPV6_REACH:
+	case ISIS_TLV_MT_IPV6_REACH:
+		return sizeof(struct isis_ipv6_reach);
+	default:
+		assert(!"Item tlv type can't be compacted!");
+		return 0;
+	}
+}
+
+/* Items in the block still own their sub-TLVs */
+static void release_compact_item(enum isis_tlv_type type,
+				 struct isis_item *i)
+{
+	switch (type) {
+	case ISIS_TLV_EXTENDED_REACH:
+	case ISIS_TLV_MT_REACH: {
+		struct isis_extended_reach *r = (struct isis_extended_reach *)i;
+
+		if (r->subtlvs)
+			free_item_ext_subtlvs(r->subtlvs);
+	} break;
+	case ISIS_TLV_EXTENDED_IP_REACH:
+	case ISIS_TLV_MT_IP_REACH:
+		isis_free_subtlvs(((struct isis_extended_ip_reach *)i)->subtlvs);
+		break;
+	case ISIS_TLV_IPV6_REACH:
+	case ISIS_TLV_MT_IPV6_REACH:
+		isis_free_subtlvs(((struct isis_ipv6_reach *)i)->subtlvs);
+		break;
+	default:
+		break;
+	}
+}
+
+/* Move the items of a list to block, or just size them if block is NULL */
+static size_t compact_items(enum isis_tlv_type type,
+			    struct isis_item_list *items, char *block)
+{
+	size_t size = compact_item_size(type);
+	struct isis_item *item, *next_item;
+	struct isis_item **link = &items->head;
+
+	if (!block)
+		return size * items->count;
+
+	for (item = items->head; item; item = next_item) {
+		next_item = item->next;
+		memcpy(block, item, size);
+		XFREE(MTYPE_ISIS_TLV, item);
+		*link = (struct isis_item *)block;
+		link = &(*link)->next;
+		block += size;
+	}
+	items->tail = link;
+
+	return size * items->count;
+}
+
+static size_t compact_tlvs(struct isis_tlvs *tlvs, char *block)
+{
+	size_t used = 0;
+
+	for (size_t i = 0; i < array_size(compact_lists); i++) {
+		void *list = (char *)tlvs + compact_lists[i].offset;
+		struct isis_item_list *items;
+
+		if (!compact_lists[i].mt) {
+			used += compact_items(compact_lists[i].type, list,
+					      block ? block + used : NULL);
+			continue;
+		}
+
+		RB_FOREACH (items, isis_mt_item_list,
+			    (struct isis_mt_item_list *)list)
+			used += compact_items(compact_lists[i].type, items,
+					      block ? block + used : NULL);
+	}
+
+	return used;
+}
+
+static void release_compact_items(enum isis_tlv_type type,
+				  struct isis_tlvs *tlvs,
+				  struct isis_item_list *items)
+{
+	struct isis_item *item, *next_item;
+
+	for (item = items->head; item; item = next_item) {
+		next_item = item->next;
+		if ((char *)item >= tlvs->item_block
+		    && (char *)item < tlvs->item_block + tlvs->item_block_size)
+			release_compact_item(type, item);
+		else
+			free_item(ISIS_CONTEXT_LSP, type, item);
+	}
+	init_item_list(items);
+}
+
+static void free_compact_tlvs(struct isis_tlvs *tlvs)
+{
+	struct isis_item_list *items;
+
+	for (size_t i = 0; i < array_size(compact_lists); i++) {
+		void *list = (char *)tlvs + compact_lists[i].offset;
+
+		if (!compact_lists[i].mt) {
+			release_compact_items(compact_lists[i].type, tlvs,
+					      list);
+			continue;
+		}
+
+		RB_FOREACH (items, isis_mt_item_list,
+			    (struct isis_mt_item_list *)list)
+			release_compact_items(compact_lists[i].type, tlvs,
+					      items);
+	}
+
+	XFREE(MTYPE_ISIS_TLV_BLOCK, tlvs->item_block);
+	tlvs->item_block_size = 0;
+}
+
+/*
+ * Move the reachability items of unpacked tlvs into a single allocation.
+ *
+ * Unpacking allocates every item on its own, for LSPs that are kept in the
+ * LSDB the allocator overhead ends up being a good part of their memory
+ * footprint.  Packed together the items are also walked in order by SPF.
+ * Lists and items keep their layout, so readers don't notice the
+ * difference, but items can't be removed anymore except by freeing the
+ * whole tlvs.
+ */
+void isis_tlvs_compact(struct isis_tlvs *tlvs)
+{
+	size_t size;
+
+	if (tlvs->item_block)
+		return;
+
+	size = compact_tlvs(tlvs, NULL);
+	if (!size)
+		return;
+
+	tlvs->item_block = XMALLOC(MTYPE_ISIS_TLV_BLOCK, size);
+	tlvs->item_block_size = size;
+	compact_tlvs(tlvs, tlvs->item_block);
+}
+
 static void format_tlvs(struct isis_tlvs *tlvs, struct sbuf *buf, struct json_object *json, int indent)
 {
 	format_tlv_protocols_supported(&tlvs->protocols_supported, buf, json,
@@ -6896,6 +7091,9 @@ void isis_free_tlvs(struct isis_tlvs *tlvs)
 	if (!tlvs)
 		return;
 
+	if (tlvs->item_block)
+		free_compact_tlvs(tlvs);
+
 	free_items(ISIS_CONTEXT_LSP, ISIS_TLV_AUTH, &tlvs->isis_auth);
 	free_tlv_purge_originator(tlvs->purge_originator);
 	free_items(ISIS_CONTEXT_LSP, ISIS_TLV_AREA_ADDRESSES,
@@ -7043,23 +7241,15 @@ static int handle_pack_entry(const struct pack_order_entry *pe,
 	return rv;
 }
 
-static int pack_tlvs(struct isis_tlvs *tlvs, struct stream *stream,
-		     struct isis_tlvs *fragment_tlvs,
-		     struct isis_tlvs *(*new_fragment)(struct list *l),
-		     struct list *new_fragment_arg)
+/*
+ * The TLVs that aren't split up when fragmenting, they only go into the
+ * first fragment.
+ */
+static int pack_tlvs_header(struct isis_tlvs *tlvs, struct stream *stream,
+			    struct isis_tlvs *fragment_tlvs)
 {
 	int rv;
 
-	/* When fragmenting, don't add auth as it's already accounted for in the
-	 * size we are given. */
-	if (!fragment_tlvs) {
-		rv = pack_items(ISIS_CONTEXT_LSP, ISIS_TLV_AUTH,
-				&tlvs->isis_auth, stream, NULL, NULL, NULL,
-				NULL);
-		if (rv)
-			return rv;
-	}
-
 	rv = pack_tlv_purge_originator(tlvs->purge_originator, stream);
 	if (rv)
 		return rv;
@@ -7155,6 +7345,30 @@ static int pack_tlvs(struct isis_tlvs *tlvs, struct stream *stream,
 			copy_tlv_spine_leaf(tlvs->spine_leaf);
 	}
 
+	return 0;
+}
+
+static int pack_tlvs(struct isis_tlvs *tlvs, struct stream *stream,
+		     struct isis_tlvs *fragment_tlvs,
+		     struct isis_tlvs *(*new_fragment)(struct list *l),
+		     struct list *new_fragment_arg)
+{
+	int rv;
+
+	/* When fragmenting, don't add auth as it's already accounted for in the
+	 * size we are given. */
+	if (!fragment_tlvs) {
+		rv = pack_items(ISIS_CONTEXT_LSP, ISIS_TLV_AUTH,
+				&tlvs->isis_auth, stream, NULL, NULL, NULL,
+				NULL);
+		if (rv)
+			return rv;
+	}
+
+	rv = pack_tlvs_header(tlvs, stream, fragment_tlvs);
+	if (rv)
+		return rv;
+
 	for (size_t pack_idx = 0; pack_idx < array_size(pack_order);
 	     pack_idx++) {
 		rv = handle_pack_entry(&pack_order[pack_idx], tlvs, stream,
@@ -7214,6 +7428,380 @@ struct list *isis_fragment_tlvs(struct isis_tlvs *tlvs, size_t size)
 	return rv;
 }
 
+/*
+ * Fragmenting our own LSP the same way every time it's regenerated.
+ *
+ * isis_fragment_tlvs() fills the fragments front to back, so one item added
+ * near the start shifts items across all the later fragments.  Here an item
+ * stays in the fragment it went into last time as long as that fragment has
+ * room for it, new items and the ones that don't fit anymore go into the
+ * first fragment with room.  The state also keeps a digest of every
+ * fragment, so the caller can tell which of them came out the same and
+ * don't need to be encoded and flooded again.
+ */
+struct frag_item {
+	uint8_t digest[16];
+	unsigned int frag;
+};
+
+struct isis_fragment_state {
+	/* TLV space the assignment below was made for */
+	size_t size;
+	/* item digest -> fragment */
+	struct hash *items;
+
+	unsigned int count;
+	uint8_t (*digests)[16];
+	bool *unchanged;
+};
+
+struct frag_unit {
+	const struct pack_order_entry *pe;
+	uint16_t mtid;
+	struct isis_item *item;
+	/* encoded length, and what pack_items_() puts before the first item */
+	size_t len;
+	size_t prefix;
+	uint8_t digest[16];
+	int frag;
+};
+
+static unsigned int frag_item_hash_key(const void *arg)
+{
+	const struct frag_item *fi = arg;
+
+	return jhash(fi->digest, sizeof(fi->digest), 0);
+}
+
+static bool frag_item_hash_cmp(const void *a, const void *b)
+{
+	const struct frag_item *fa = a, *fb = b;
+
+	return !memcmp(fa->digest, fb->digest, sizeof(fa->digest));
+}
+
+static void *frag_item_alloc(void *arg)
+{
+	struct frag_item *fi = XMALLOC(MTYPE_ISIS_FRAG_STATE, sizeof(*fi));
+
+	*fi = *(struct frag_item *)arg;
+	return fi;
+}
+
+static void frag_item_free(void *arg)
+{
+	XFREE(MTYPE_ISIS_FRAG_STATE, arg);
+}
+
+struct isis_fragment_state *isis_fragment_state_new(void)
+{
+	struct isis_fragment_state *state;
+
+	state = XCALLOC(MTYPE_ISIS_FRAG_STATE, sizeof(*state));
+	state->items = hash_create(frag_item_hash_key, frag_item_hash_cmp,
+				   "ISIS own LSP fragment items");
+	return state;
+}
+
+static void fragment_state_reset(struct isis_fragment_state *state)
+{
+	hash_clean(state->items, frag_item_free);
+	XFREE(MTYPE_ISIS_FRAG_STATE, state->digests);
+	XFREE(MTYPE_ISIS_FRAG_STATE, state->unchanged);
+	state->count = 0;
+}
+
+void isis_fragment_state_free(struct isis_fragment_state **state)
+{
+	if (!*state)
+		return;
+
+	fragment_state_reset(*state);
+	hash_free((*state)->items);
+	XFREE(MTYPE_ISIS_FRAG_STATE, *state);
+}
+
+bool isis_fragment_unchanged(const struct isis_fragment_state *state,
+			     unsigned int frag)
+{
+	return frag < state->count && state->unchanged[frag];
+}
+
+static bool frag_collect(struct frag_unit **units, size_t *count,
+			 size_t *alloc, const struct pack_order_entry *pe,
+			 struct isis_item_list *items, uint16_t mtid,
+			 struct stream *s, size_t size)
+{
+	uint8_t idx = pe - pack_order;
+	uint16_t mtid_n = htons(mtid);
+	struct isis_item *item;
+	struct frag_unit *u;
+	MD5_CTX ctx;
+
+	for (item = items->head; item; item = item->next) {
+		size_t min_len = 0;
+
+		if (*count == *alloc) {
+			*alloc = MAX(64, *alloc * 2);
+			*units = XREALLOC(MTYPE_ISIS_FRAG_STATE, *units,
+					  *alloc * sizeof(**units));
+		}
+		u = &(*units)[(*count)++];
+		u->pe = pe;
+		u->mtid = mtid;
+		u->item = item;
+		u->frag = -1;
+		if (IS_COMPAT_MT_TLV(pe->type) && mtid != ISIS_MT_IPV4_UNICAST)
+			u->prefix = 2;
+		else if (pe->type == ISIS_TLV_SRV6_LOCATOR)
+			u->prefix = 2;
+		else if (pe->type == ISIS_TLV_OLDSTYLE_REACH)
+			u->prefix = 1;
+		else
+			u->prefix = 0;
+
+		stream_reset(s);
+		if (pack_item(pe->context, pe->type, item, s, &min_len, NULL,
+			      pe, mtid))
+			return false;
+		u->len = stream_get_endp(s);
+		if (u->prefix + u->len > 255 || 2 + u->prefix + u->len > size)
+			return false;
+
+		MD5Init(&ctx);
+		MD5Update(&ctx, &idx, sizeof(idx));
+		MD5Update(&ctx, &mtid_n, sizeof(mtid_n));
+		MD5Update(&ctx, STREAM_DATA(s), u->len);
+		MD5Final(u->digest, &ctx);
+	}
+
+	return true;
+}
+
+/* Space taken by the items of one fragment, grouped like pack_items_() does */
+static size_t frag_used(const struct frag_unit *units, size_t count, int frag)
+{
+	const struct frag_unit *prev = NULL;
+	size_t used = 0, tlv_len = 0;
+
+	for (size_t i = 0; i < count; i++) {
+		const struct frag_unit *u = &units[i];
+
+		if (u->frag != frag)
+			continue;
+
+		if (!prev || prev->pe != u->pe || prev->mtid != u->mtid
+		    || tlv_len + u->len > 255) {
+			used += 2 + u->prefix;
+			tlv_len = u->prefix;
+		}
+		tlv_len += u->len;
+		used += u->len;
+		prev = u;
+	}
+
+	return used;
+}
+
+static bool frag_place(struct frag_unit *units, size_t count,
+		       struct frag_unit *u, unsigned int frag, size_t *used,
+		       size_t hdr_len, size_t size)
+{
+	size_t n;
+
+	if (used[frag] + u->len > size)
+		return false;
+
+	u->frag = frag;
+	n = frag_used(units, count, frag) + (frag ? 0 : hdr_len);
+	if (n > size) {
+		u->frag = -1;
+		return false;
+	}
+
+	used[frag] = n;
+	return true;
+}
+
+/*
+ * Like isis_fragment_tlvs(), but keeping the items where state says they
+ * were.  salt covers whatever else goes into the fragments, e.g. the
+ * authentication, so that a change to it doesn't go unnoticed.
+ */
+struct list *isis_fragment_tlvs_stable(struct isis_tlvs *tlvs, size_t size,
+				       struct isis_fragment_state *state,
+				       const uint8_t *salt, size_t salt_len)
+{
+	struct stream *s = stream_new(size);
+	struct isis_tlvs *header = isis_alloc_tlvs();
+	struct isis_tlvs **frags = NULL;
+	struct frag_unit *units = NULL;
+	size_t count = 0, alloc = 0, hdr_len;
+	size_t *used = NULL;
+	unsigned int nfrags = 1, last = 0;
+	uint8_t hdr_digest[16];
+	uint8_t(*digests)[16];
+	bool *unchanged;
+	MD5_CTX ctx, *frag_ctx;
+	struct list *rv;
+
+	if (state->size != size) {
+		fragment_state_reset(state);
+		state->size = size;
+	}
+
+	if (pack_tlvs_header(tlvs, s, header))
+		goto fallback;
+	hdr_len = stream_get_endp(s);
+	if (hdr_len > size)
+		goto fallback;
+	MD5Init(&ctx);
+	MD5Update(&ctx, STREAM_DATA(s), hdr_len);
+	MD5Final(hdr_digest, &ctx);
+
+	for (size_t pack_idx = 0; pack_idx < array_size(pack_order);
+	     pack_idx++) {
+		const struct pack_order_entry *pe = &pack_order[pack_idx];
+
+		if (pe->how_to_pack == ISIS_ITEMS) {
+			struct isis_item_list *l;
+
+			l = (struct isis_item_list *)(((char *)tlvs)
+						      + pe->what_to_pack);
+			if (!frag_collect(&units, &count, &alloc, pe, l,
+					  ISIS_MT_IPV4_UNICAST, s, size))
+				goto fallback;
+		} else {
+			struct isis_mt_item_list *m;
+			struct isis_item_list *n;
+
+			m = (struct isis_mt_item_list *)(((char *)tlvs)
+							 + pe->what_to_pack);
+			RB_FOREACH (n, isis_mt_item_list, m) {
+				if (!frag_collect(&units, &count, &alloc, pe, n,
+						  n->mtid, s, size))
+					goto fallback;
+			}
+		}
+	}
+
+	/* Items we still have go back where they were */
+	for (size_t i = 0; i < count; i++) {
+		struct frag_item key, *fi;
+
+		memcpy(key.digest, units[i].digest, sizeof(key.digest));
+		fi = hash_lookup(state->items, &key);
+		if (!fi)
+			continue;
+		units[i].frag = fi->frag;
+		nfrags = MAX(nfrags, fi->frag + 1);
+	}
+
+	/* Fragments that have grown too big lose their last items */
+	used = XCALLOC(MTYPE_ISIS_FRAG_STATE, nfrags * sizeof(*used));
+	for (unsigned int f = 0; f < nfrags; f++) {
+		size_t i = count;
+
+		used[f] = frag_used(units, count, f) + (f ? 0 : hdr_len);
+		while (used[f] > size) {
+			while (units[--i].frag != (int)f)
+				;
+			units[i].frag = -1;
+			used[f] = frag_used(units, count, f) + (f ? 0 : hdr_len);
+		}
+	}
+
+	/* Everything else goes next to the item before it if there's room,
+	 * so a changed item usually stays where it was, or else into the
+	 * first fragment with room for it.
+	 */
+	for (size_t i = 0; i < count; i++) {
+		struct frag_unit *u = &units[i];
+		unsigned int f;
+
+		if (u->frag >= 0) {
+			last = u->frag;
+			continue;
+		}
+
+		if (!frag_place(units, count, u, last, used, hdr_len, size)) {
+			for (f = 0; f < nfrags; f++) {
+				if (f != last
+				    && frag_place(units, count, u, f, used,
+						  hdr_len, size))
+					break;
+			}
+			if (f == nfrags) {
+				nfrags++;
+				used = XREALLOC(MTYPE_ISIS_FRAG_STATE, used,
+						nfrags * sizeof(*used));
+				u->frag = f;
+				used[f] = frag_used(units, count, f);
+			}
+		}
+		last = u->frag;
+	}
+
+	while (nfrags > 1 && !used[nfrags - 1])
+		nfrags--;
+
+	rv = list_new();
+	frags = XCALLOC(MTYPE_ISIS_FRAG_STATE, nfrags * sizeof(*frags));
+	frag_ctx = XCALLOC(MTYPE_ISIS_FRAG_STATE, nfrags * sizeof(*frag_ctx));
+	for (unsigned int f = 0; f < nfrags; f++) {
+		frags[f] = f ? new_fragment(rv) : header;
+		if (!f)
+			listnode_add(rv, header);
+		MD5Init(&frag_ctx[f]);
+		if (salt_len)
+			MD5Update(&frag_ctx[f], salt, salt_len);
+	}
+	MD5Update(&frag_ctx[0], hdr_digest, sizeof(hdr_digest));
+
+	hash_clean(state->items, frag_item_free);
+	for (size_t i = 0; i < count; i++) {
+		struct frag_unit *u = &units[i];
+		struct frag_item key = { .frag = u->frag };
+
+		add_item_to_fragment(u->item, u->pe, frags[u->frag], u->mtid);
+		MD5Update(&frag_ctx[u->frag], u->digest, sizeof(u->digest));
+
+		memcpy(key.digest, u->digest, sizeof(key.digest));
+		(void)hash_get(state->items, &key, frag_item_alloc);
+	}
+
+	digests = XCALLOC(MTYPE_ISIS_FRAG_STATE, nfrags * sizeof(*digests));
+	unchanged = XCALLOC(MTYPE_ISIS_FRAG_STATE, nfrags * sizeof(*unchanged));
+	for (unsigned int f = 0; f < nfrags; f++) {
+		MD5Final(digests[f], &frag_ctx[f]);
+		unchanged[f] = f < state->count
+			       && !memcmp(digests[f], state->digests[f],
+					  sizeof(digests[f]));
+	}
+	XFREE(MTYPE_ISIS_FRAG_STATE, state->digests);
+	XFREE(MTYPE_ISIS_FRAG_STATE, state->unchanged);
+	state->digests = digests;
+	state->unchanged = unchanged;
+	state->count = nfrags;
+
+	XFREE(MTYPE_ISIS_FRAG_STATE, frag_ctx);
+	XFREE(MTYPE_ISIS_FRAG_STATE, frags);
+	XFREE(MTYPE_ISIS_FRAG_STATE, used);
+	XFREE(MTYPE_ISIS_FRAG_STATE, units);
+	stream_free(s);
+	return rv;
+
+fallback:
+	/* Something doesn't fit the way we count, leave it to the plain
+	 * fragmentation and start over next time.
+	 */
+	fragment_state_reset(state);
+	XFREE(MTYPE_ISIS_FRAG_STATE, units);
+	isis_free_tlvs(header);
+	stream_free(s);
+	return isis_fragment_tlvs(tlvs, size);
+}
+
 static int unpack_tlv_unknown(enum isis_tlv_context context, uint8_t tlv_type,
 			      uint8_t tlv_len, struct stream *s,
 			      struct sbuf *log, int indent)
@@ -7293,12 +7881,52 @@ static int unpack_tlvs(enum isis_tlv_context context, size_t avail_len,
 	return 0;
 }
 
+/*
+ * Digest of all TLVs except IP reachability, authentication and the
+ * hostname, which don't affect the SPT.  It is taken from the received
+ * bytes once, so isis_tlvs_topology_same() doesn't need to re-encode
+ * anything on every LSP update.
+ */
+static void tlvs_hash_topology(struct isis_tlvs *tlvs, const uint8_t *data,
+			       size_t len)
+{
+	MD5_CTX ctx;
+	size_t pos = 0;
+	uint8_t type, tlv_len;
+
+	MD5Init(&ctx);
+	while (pos + 2 <= len) {
+		type = data[pos];
+		tlv_len = data[pos + 1];
+		if (pos + 2 + tlv_len > len)
+			return;
+
+		switch (type) {
+		case ISIS_TLV_AUTH:
+		case ISIS_TLV_DYNAMIC_HOSTNAME:
+		case ISIS_TLV_OLDSTYLE_IP_REACH:
+		case ISIS_TLV_OLDSTYLE_IP_REACH_EXT:
+		case ISIS_TLV_EXTENDED_IP_REACH:
+		case ISIS_TLV_IPV6_REACH:
+		case ISIS_TLV_MT_IP_REACH:
+		case ISIS_TLV_MT_IPV6_REACH:
+			break;
+		default:
+			MD5Update(&ctx, data + pos, 2 + tlv_len);
+		}
+		pos += 2 + tlv_len;
+	}
+	MD5Final(tlvs->topology_hash, &ctx);
+	tlvs->topology_hashed = true;
+}
+
 int isis_unpack_tlvs(size_t avail_len, struct stream *stream,
 		     struct isis_tlvs **dest, const char **log)
 {
 	static struct sbuf logbuf;
 	int indent = 0;
 	int rv;
+	size_t start;
 	struct isis_tlvs *result;
 
 	if (!sbuf_buf(&logbuf))
@@ -7313,8 +7941,12 @@ int isis_unpack_tlvs(size_t avail_len, struct stream *stream,
 	}
 
 	result = isis_alloc_tlvs();
+	start = stream_get_getp(stream);
 	rv = unpack_tlvs(ISIS_CONTEXT_LSP, avail_len, stream, &logbuf, result,
 			 indent, NULL);
+	if (!rv)
+		tlvs_hash_topology(result, STREAM_DATA(stream) + start,
+				   avail_len);
 
 	*log = sbuf_buf(&logbuf);
 	*dest = result;
@@ -7682,6 +8314,20 @@ bool isis_tlvs_area_addresses_match(struct isis_tlvs *tlvs,
 	return false;
 }
 
+/*
+ * Returns true if the two TLV sets differ at most in IP reachability, i.e.
+ * an LSP changing from one to the other doesn't change the SPT and only
+ * requires a partial route calculation.  Only received TLVs can be
+ * compared, anything else is taken as a change.
+ */
+bool isis_tlvs_topology_same(const struct isis_tlvs *old_tlvs,
+			     const struct isis_tlvs *new_tlvs)
+{
+	return old_tlvs->topology_hashed && new_tlvs->topology_hashed
+	       && !memcmp(old_tlvs->topology_hash, new_tlvs->topology_hash,
+			  sizeof(old_tlvs->topology_hash));
+}
+
 static void tlvs_area_addresses_to_adj(struct isis_tlvs *tlvs,
 				       struct isis_adjacency *adj,
 				       bool *changed)
@@ -415,6 +415,14 @@ struct isis_tlvs {
 	struct isis_router_cap *router_cap;
 	struct isis_spine_leaf *spine_leaf;
 	struct isis_mt_item_list srv6_locator;
+
+	/* reachability items moved together by isis_tlvs_compact() */
+	char *item_block;
+	size_t item_block_size;
+
+	/* received TLVs only, see isis_tlvs_topology_same() */
+	bool topology_hashed;
+	uint8_t topology_hash[16];
 };
 
 enum isis_tlv_context {
@@ -762,7 +770,16 @@ int isis_unpack_tlvs(size_t avail_len, struct stream *stream,
 		     struct isis_tlvs **dest, const char **error_log);
 const char *isis_format_tlvs(struct isis_tlvs *tlvs, struct json_object *json);
 struct isis_tlvs *isis_copy_tlvs(struct isis_tlvs *tlvs);
+void isis_tlvs_compact(struct isis_tlvs *tlvs);
 struct list *isis_fragment_tlvs(struct isis_tlvs *tlvs, size_t size);
+struct isis_fragment_state;
+struct isis_fragment_state *isis_fragment_state_new(void);
+void isis_fragment_state_free(struct isis_fragment_state **state);
+struct list *isis_fragment_tlvs_stable(struct isis_tlvs *tlvs, size_t size,
+				       struct isis_fragment_state *state,
+				       const uint8_t *salt, size_t salt_len);
+bool isis_fragment_unchanged(const struct isis_fragment_state *state,
+			     unsigned int frag);
 
 #define ISIS_EXTENDED_IP_REACH_DOWN 0x80
 #define ISIS_EXTENDED_IP_REACH_SUBTLV 0x40
@@ -797,6 +814,8 @@ int isis_tlvs_auth_is_valid(struct isis_tlvs *tlvs, struct isis_passwd *passwd,
 			    struct stream *stream, bool is_lsp);
 bool isis_tlvs_area_addresses_match(struct isis_tlvs *tlvs,
 				    struct list *addresses);
+bool isis_tlvs_topology_same(const struct isis_tlvs *old_tlvs,
+			     const struct isis_tlvs *new_tlvs);
 struct isis_adjacency;
 void isis_tlvs_to_adj(struct isis_tlvs *tlvs, struct isis_adjacency *adj,
 		      bool *changed);
@@ -564,6 +564,8 @@ void isis_area_destroy(struct isis_area *area)
 
 	lsp_db_fini(&area->lspdb[0]);
 	lsp_db_fini(&area->lspdb[1]);
+	isis_fragment_state_free(&area->lsp_frag_state[0]);
+	isis_fragment_state_free(&area->lsp_frag_state[1]);
 
 	/* invalidate and verify to delete all routes from zebra */
 	isis_area_invalidate_routes(area, area->is_type);
@@ -2322,6 +2324,12 @@ static void isis_spf_ietf_common(struct vty *vty, struct isis *isis)
 			} else {
 				vty_out(vty, "    Using legacy backoff algo\n");
 			}
+
+			vty_out(vty,
+				"    SPF runs: %" PRIu64 ", PRC runs: %" PRIu64
+				"\n",
+				area->spf_run_count[level - 1],
+				area->prc_run_count[level - 1]);
 		}
 	}
 }
@@ -2472,6 +2480,9 @@ static void common_isis_summary_json(struct json_object *json,
 					    area->lsp_gen_count[level - 1]);
 			json_object_int_add(level_json, "lsp-purged",
 					    area->lsp_purge_count[level - 1]);
+			json_object_int_add(
+				level_json, "lsp-frag-unchanged",
+				area->lsp_frag_unchanged_count[level - 1]);
 			if (area->spf_timer[level - 1])
 				json_object_string_add(level_json, "spf",
 						       "pending");
@@ -2563,6 +2574,9 @@ static void common_isis_summary_vty(struct vty *vty, struct isis *isis)
 			vty_out(vty, "         LSPs purged: %" PRIu64 "\n",
 				area->lsp_purge_count[level - 1]);
 
+			vty_out(vty, "    Fragments unchanged: %" PRIu64 "\n",
+				area->lsp_frag_unchanged_count[level - 1]);
+
 			if (area->spf_timer[level - 1])
 				vty_out(vty, "    SPF: (pending)\n");
 			else
@@ -200,9 +200,16 @@ struct isis_area {
 	int lsp_frag_threshold;
 	uint64_t lsp_gen_count[ISIS_LEVELS];
 	uint64_t lsp_purge_count[ISIS_LEVELS];
+	/* own fragments left alone on regeneration since nothing changed */
+	uint64_t lsp_frag_unchanged_count[ISIS_LEVELS];
+	/* where the items of our own LSP went, see lsp_build() */
+	struct isis_fragment_state *lsp_frag_state[ISIS_LEVELS];
 	uint32_t lsp_exceeded_max_counter;
 	uint32_t lsp_seqno_skipped_counter;
 	uint64_t spf_run_count[ISIS_LEVELS];
+	/* partial route calculations (prefix-only LSP changes) */
+	uint64_t prc_run_count[ISIS_LEVELS];
+	bool spf_full_pending[ISIS_LEVELS];
 	int ip_circuits;
 	/* logging adjacency changes? */
 	uint8_t log_adj_changes;
@@ -8,6 +8,7 @@
 
 #include "memory.h"
 #include "buffer.h"
+#include "iobuf.h"
 #include "log.h"
 #include "network.h"
 #include "lib_errors.h"
@@ -37,6 +38,11 @@ struct buffer_data {
 	/* Pointer to data not yet flushed. */
 	size_t sp;
 
+	/* Zero-copy data queued by buffer_put_iobuf().  If set, sp/cp and
+	 * data[] are unused and nothing may be appended to this entry.
+	 */
+	struct iobuf *iob;
+
 	/* Actual data stream (variable length). */
 	unsigned char data[]; /* real dimension is buffer->size */
 };
@@ -47,7 +53,16 @@ struct buffer_data {
    next page boundary. */
 #define BUFFER_SIZE_DEFAULT		4096
 
-#define BUFFER_DATA_FREE(D) XFREE(MTYPE_BUFFER_DATA, (D))
+#define BUFFER_DATA_FREE(D)                                                    \
+	do {                                                                   \
+		iobuf_free((D)->iob);                                          \
+		XFREE(MTYPE_BUFFER_DATA, (D));                                 \
+	} while (0)
+
+static inline size_t buffer_data_len(const struct buffer_data *d)
+{
+	return d->iob ? iobuf_len(d->iob) : d->cp - d->sp;
+}
 
 /* Make new buffer. */
 struct buffer *buffer_new(size_t size)
@@ -87,11 +102,16 @@ char *buffer_getstr(struct buffer *b)
 	char *p;
 
 	for (data = b->head; data; data = data->next)
-		totlen += data->cp - data->sp;
+		totlen += buffer_data_len(data);
 	if (!(s = XMALLOC(MTYPE_TMP, totlen + 1)))
 		return NULL;
 	p = s;
 	for (data = b->head; data; data = data->next) {
+		if (data->iob) {
+			p += iobuf_copyout(data->iob, 0, p,
+					   iobuf_len(data->iob));
+			continue;
+		}
 		memcpy(p, data->data + data->sp, data->cp - data->sp);
 		p += data->cp - data->sp;
 	}
@@ -120,6 +140,7 @@ static struct buffer_data *buffer_add(struct buffer *b)
 	d = XMALLOC(MTYPE_BUFFER_DATA,
 		    offsetof(struct buffer_data, data) + b->size);
 	d->cp = d->sp = 0;
+	d->iob = NULL;
 	d->next = NULL;
 
 	if (b->tail)
@@ -142,7 +163,7 @@ void buffer_put(struct buffer *b, const void *p, size_t size)
 		size_t chunk;
 
 		/* If there is no data buffer add it. */
-		if (data == NULL || data->cp == b->size)
+		if (data == NULL || data->iob || data->cp == b->size)
 			data = buffer_add(b);
 
 		chunk = ((size <= (b->size - data->cp)) ? size
@@ -154,6 +175,35 @@ void buffer_put(struct buffer *b, const void *p, size_t size)
 	}
 }
 
+/* Queue iobuf data without copying it. */
+void buffer_put_iobuf(struct buffer *b, struct iobuf *iob)
+{
+	struct buffer_data *d;
+
+	if (iobuf_empty(iob)) {
+		iobuf_free(iob);
+		return;
+	}
+
+	/* consecutive iobufs share one queue entry */
+	if (b->tail && b->tail->iob) {
+		iobuf_append(b->tail->iob, iob);
+		iobuf_free(iob);
+		return;
+	}
+
+	d = XMALLOC(MTYPE_BUFFER_DATA, sizeof(struct buffer_data));
+	d->cp = d->sp = 0;
+	d->iob = iob;
+	d->next = NULL;
+
+	if (b->tail)
+		b->tail->next = d;
+	else
+		b->head = d;
+	b->tail = d;
+}
+
 /* Insert character into the buffer. */
 void buffer_putc(struct buffer *b, uint8_t c)
 {
@@ -180,7 +230,7 @@ void buffer_put_crlf(struct buffer *b, const void *origp, size_t origsize)
 		size_t avail, chunk;
 
 		/* If there is no data buffer add it. */
-		if (data == NULL || data->cp == b->size)
+		if (data == NULL || data->iob || data->cp == b->size)
 			data = buffer_add(b);
 
 		size = (lf ? lf : end) - p;
@@ -207,6 +257,41 @@ void buffer_put_crlf(struct buffer *b, const void *origp, size_t origsize)
 	}
 }
 
+/* Replace zero-copy entries with regular ones, for code that needs to look
+   at the data byte by byte. */
+static void buffer_flatten(struct buffer *b)
+{
+	struct buffer_data *d, *prev = NULL, *next;
+
+	for (d = b->head; d; prev = d, d = next) {
+		struct buffer tmp = { .size = b->size };
+		size_t len, off = 0;
+
+		next = d->next;
+		if (!d->iob)
+			continue;
+
+		len = iobuf_len(d->iob);
+		while (off < len) {
+			struct buffer_data *n = buffer_add(&tmp);
+
+			n->cp = iobuf_copyout(d->iob, off, n->data, b->size);
+			off += n->cp;
+		}
+
+		tmp.tail->next = next;
+		if (prev)
+			prev->next = tmp.head;
+		else
+			b->head = tmp.head;
+		if (b->tail == d)
+			b->tail = tmp.tail;
+
+		BUFFER_DATA_FREE(d);
+		d = tmp.tail;
+	}
+}
+
 /* Keep flushing data to the fd until the buffer is empty or an error is
    encountered or the operation would block. */
 buffer_status_t buffer_flush_all(struct buffer *b, int fd)
@@ -217,15 +302,17 @@ buffer_status_t buffer_flush_all(struct buffer *b, int fd)
 
 	if (!b->head)
 		return BUFFER_EMPTY;
-	head_sp = (head = b->head)->sp;
+	head = b->head;
+	head_sp = buffer_data_len(head);
 	/* Flush all data. */
 	while ((ret = buffer_flush_available(b, fd)) == BUFFER_PENDING) {
-		if ((b->head == head) && (head_sp == head->sp)
+		if ((b->head == head) && (head_sp == buffer_data_len(head))
 		    && (errno != EINTR))
 			/* No data was flushed, so kernel buffer must be full.
 			 */
 			return ret;
-		head_sp = (head = b->head)->sp;
+		head = b->head;
+		head_sp = buffer_data_len(head);
 	}
 
 	return ret;
@@ -253,6 +340,8 @@ buffer_status_t buffer_flush_window(struct buffer *b, int fd, int width,
 	if (!b->head)
 		return BUFFER_EMPTY;
 
+	buffer_flatten(b);
+
 	if (height < 1)
 		height = 1;
 	else if (height >= 2)
@@ -405,9 +494,17 @@ in one shot. */
 		return BUFFER_ERROR;
 
 	for (d = b->head; d && (iovcnt < MAX_CHUNKS) && (nbyte < MAX_FLUSH);
-	     d = d->next, iovcnt++) {
+	     d = d->next) {
+		if (d->iob) {
+			size_t n = iobuf_iov(d->iob, iov + iovcnt,
+					     MAX_CHUNKS - iovcnt);
+
+			while (n--)
+				nbyte += iov[iovcnt++].iov_len;
+			continue;
+		}
 		iov[iovcnt].iov_base = d->data + d->sp;
-		nbyte += (iov[iovcnt].iov_len = d->cp - d->sp);
+		nbyte += (iov[iovcnt++].iov_len = d->cp - d->sp);
 	}
 
 	if (!nbyte)
@@ -433,12 +530,15 @@ in one shot. */
 				__func__, (unsigned long)written);
 			break;
 		}
-		if (written < d->cp - d->sp) {
-			d->sp += written;
+		if (written < buffer_data_len(d)) {
+			if (d->iob)
+				iobuf_drain(d->iob, written);
+			else
+				d->sp += written;
 			return BUFFER_PENDING;
 		}
 
-		written -= (d->cp - d->sp);
+		written -= buffer_data_len(d);
 		if (!(b->head = d->next))
 			b->tail = NULL;
 		BUFFER_DATA_FREE(d);
@@ -11,6 +11,8 @@
 extern "C" {
 #endif
 
+struct iobuf;
+
 /* Create a new buffer.  Memory will be allocated in chunks of the given
    size.  If the argument is 0, the library will supply a reasonable
    default size suitable for buffering socket I/O. */
@@ -27,6 +29,9 @@ extern void buffer_free(struct buffer *b);
 extern void buffer_put(struct buffer *b, const void *p, size_t size);
 /* Add a single character to the end of the buffer. */
 extern void buffer_putc(struct buffer *b, uint8_t c);
+/* Add the data referenced by the iobuf to the end of the buffer without
+   copying it.  The buffer takes ownership of the iobuf. */
+extern void buffer_put_iobuf(struct buffer *b, struct iobuf *iob);
 /* Add a NUL-terminated string to the end of the buffer. */
 extern void buffer_putstr(struct buffer *b, const char *str);
 /* Add given data, inline-expanding \n to \r\n */
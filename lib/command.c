@@ -507,6 +507,10 @@ static int config_write_host(struct vty *vty)
 			vty_out(vty, "service walltime-warning %lu\n",
 				walltime_threshold / 1000);
 
+		if (event_watchdog_threshold)
+			vty_out(vty, "service event-watchdog %lu\n",
+				event_watchdog_threshold / 1000);
+
 		if (host.advanced)
 			vty_out(vty, "service advanced-vty\n");
 
@@ -8,6 +8,7 @@
 #include <zebra.h>
 
 #include <signal.h>
+#include <dlfcn.h>
 #include <sys/resource.h>
 #include <sys/stat.h>
 
@@ -118,6 +119,15 @@ struct event_loop {
 	bool ready_run_loop;
 	RUSAGE_T last_getrusage;
 	struct timeval last_tardy_warning;
+
+	/* watchdog: start (monotonic, us) of the callback currently running,
+	 * 0 while idle.  wd_seq tells consecutive callbacks apart.
+	 */
+	atomic_uint_fast64_t wd_start;
+	atomic_uint_fast32_t wd_seq;
+	atomic_uintptr_t wd_hist;
+	/* only accessed by the watchdog, under masters_mtx */
+	uint32_t wd_reported;
 };
 
 #if EPOLL_ENABLED
@@ -191,6 +201,281 @@ static void thread_free(struct event_loop *master, struct event *event);
 bool cputime_enabled = true;
 unsigned long cputime_threshold = CONSUMED_TIME_CHECK;
 unsigned long walltime_threshold = CONSUMED_TIME_CHECK;
+unsigned long event_watchdog_threshold;
+
+static inline unsigned int event_hist_bucket(unsigned long usec)
+{
+	unsigned int bucket;
+
+	if (usec < EVENT_HIST_BASE_USEC)
+		return 0;
+
+	bucket = sizeof(usec) * 8 - __builtin_clzl(usec / EVENT_HIST_BASE_USEC);
+	return MIN(bucket, EVENT_HIST_BUCKETS - 1);
+}
+
+static inline uint64_t timeval_to_usec(const struct timeval *tv)
+{
+	return (uint64_t)tv->tv_sec * TIMER_SECOND_MICRO + tv->tv_usec;
+}
+
+/* Event loop watchdog ------------------------------------------------------
+ *
+ * A separate pthread periodically looks at all event loops.  If one of them
+ * has been in the same callback for longer than event_watchdog_threshold,
+ * that pthread's stack is captured through a signal (see sigevent.c) while
+ * it is still stuck, logged, and kept for "show event stalls".
+ */
+#define EVENT_STALL_KEEP 8
+/* "service event-watchdog" without threshold, in ms */
+#define EVENT_WATCHDOG_DEFAULT 1000
+
+struct event_stall {
+	char loop[32];
+	char funcname[64];
+	time_t when;
+	unsigned long usec;
+
+	int nframes;
+	void *frames[FRR_STACK_CAPTURE_MAX];
+};
+
+static struct {
+	pthread_mutex_t mtx;
+	pthread_cond_t cond;
+	pthread_t thread;
+	bool running;
+
+	/* ring of the last EVENT_STALL_KEEP stalls */
+	struct event_stall stalls[EVENT_STALL_KEEP];
+	unsigned int nstalls;
+} watchdog = {
+	.mtx = PTHREAD_MUTEX_INITIALIZER,
+	.cond = PTHREAD_COND_INITIALIZER,
+};
+
+/* frames[0] and [1] are the capture signal handler and trampoline */
+#define EVENT_STALL_SKIP_FRAMES 2
+
+static const char *event_stall_frame(void *pc, char *buf, size_t len)
+{
+	Dl_info dlinfo;
+
+	if (!dladdr(pc, &dlinfo))
+		snprintfrr(buf, len, "%p", pc);
+	else if (dlinfo.dli_sname)
+		return dlinfo.dli_sname;
+	else {
+		const char *base = strrchr(dlinfo.dli_fname, '/');
+
+		/* static functions aren't in the dynamic symbol table,
+		 * module+offset can be fed to addr2line
+		 */
+		snprintfrr(buf, len, "%s+%#tx",
+			   base ? base + 1 : dlinfo.dli_fname,
+			   (char *)pc - (char *)dlinfo.dli_fbase);
+	}
+	return buf;
+}
+
+/* loops looked at per watchdog round, the rest waits for the next one */
+#define EVENT_WATCHDOG_BATCH 32
+
+/* what the watchdog needs of a stalled loop, copied under masters_mtx so
+ * the backtrace can be taken without holding it
+ */
+struct event_watchdog_cand {
+	struct event_loop *m;
+	pthread_t owner;
+	uint64_t start;
+	uint32_t seq;
+	struct cpu_event_history *hist;
+	char name[32];
+};
+
+static bool event_watchdog_due(struct event_loop *m, uint64_t now,
+			       struct event_watchdog_cand *cand)
+{
+	uint64_t start;
+	uint32_t seq;
+
+	start = atomic_load_explicit(&m->wd_start, memory_order_acquire);
+	seq = atomic_load_explicit(&m->wd_seq, memory_order_relaxed);
+	if (!start || seq == m->wd_reported ||
+	    now < start + event_watchdog_threshold)
+		return false;
+
+	m->wd_reported = seq;
+
+	cand->m = m;
+	cand->owner = m->owner;
+	cand->start = start;
+	cand->seq = seq;
+	cand->hist = (struct cpu_event_history *)atomic_load_explicit(
+		&m->wd_hist, memory_order_relaxed);
+	strlcpy(cand->name, m->name ? m->name : "main", sizeof(cand->name));
+	return true;
+}
+
+static void event_watchdog_check(struct event_watchdog_cand *cand,
+				 uint64_t now)
+{
+	struct event_stall *stall;
+	struct event_loop *m;
+	struct listnode *ln;
+	void *frames[FRR_STACK_CAPTURE_MAX];
+	int nframes;
+	bool stalled = false;
+	char funcname[64] = "?";
+	char buf[128];
+
+	/* can wait up to 100ms for the stuck pthread, so this must not hold
+	 * masters_mtx
+	 */
+	nframes = frr_stack_capture(cand->owner, frames, array_size(frames),
+				    100);
+
+	/* did it finish (or go away) while we were getting the backtrace?
+	 * hist belongs to the loop, so only touch it while the loop is known
+	 * to still be around.
+	 */
+	frr_with_mutex (&masters_mtx) {
+		for (ALL_LIST_ELEMENTS_RO(masters, ln, m)) {
+			if (m != cand->m)
+				continue;
+			stalled = atomic_load_explicit(&m->wd_seq,
+						       memory_order_relaxed) ==
+				  cand->seq;
+			break;
+		}
+		if (!stalled)
+			break;
+
+		if (cand->hist) {
+			atomic_fetch_add_explicit(&cand->hist->total_stall, 1,
+						  memory_order_relaxed);
+			strlcpy(funcname, cand->hist->funcname,
+				sizeof(funcname));
+		}
+	}
+	if (!stalled)
+		return;
+
+	flog_warn(EC_LIB_SLOW_THREAD_WALL,
+		  "STALL: task %s in pthread %s running for %lums%s", funcname,
+		  cand->name, (unsigned long)(now - cand->start) / 1000,
+		  nframes > 0 ? ", backtrace:" : "");
+
+	for (int i = EVENT_STALL_SKIP_FRAMES; i < nframes; i++)
+		zlog_warn("  [bt %d] %s", i - EVENT_STALL_SKIP_FRAMES,
+			  event_stall_frame(frames[i], buf, sizeof(buf)));
+
+	frr_with_mutex (&watchdog.mtx) {
+		stall = &watchdog.stalls[watchdog.nstalls++ % EVENT_STALL_KEEP];
+		strlcpy(stall->loop, cand->name, sizeof(stall->loop));
+		strlcpy(stall->funcname, funcname, sizeof(stall->funcname));
+		stall->when = monotime(NULL);
+		stall->usec = now - cand->start;
+		stall->nframes = MAX(nframes, 0);
+		memcpy(stall->frames, frames,
+		       stall->nframes * sizeof(frames[0]));
+	}
+}
+
+static void *event_watchdog_run(void *arg)
+{
+	struct event_watchdog_cand cands[EVENT_WATCHDOG_BATCH];
+	struct event_loop *m;
+	struct listnode *ln;
+	struct timeval tv;
+	struct timespec ts;
+	unsigned long interval;
+	unsigned int ncands;
+	uint64_t now;
+
+	frr_with_mutex (&watchdog.mtx) {
+		while (event_watchdog_threshold) {
+			/* check 4 times per threshold so a stall is caught
+			 * at most 25% late
+			 */
+			interval = MAX(event_watchdog_threshold / 4, 1000UL);
+			clock_gettime(CLOCK_MONOTONIC, &ts);
+			ts.tv_nsec += (interval % TIMER_SECOND_MICRO) * 1000;
+			ts.tv_sec += interval / TIMER_SECOND_MICRO +
+				     ts.tv_nsec / 1000000000;
+			ts.tv_nsec %= 1000000000;
+			pthread_cond_timedwait(&watchdog.cond, &watchdog.mtx,
+					       &ts);
+			if (!event_watchdog_threshold)
+				break;
+
+			pthread_mutex_unlock(&watchdog.mtx);
+
+			monotime(&tv);
+			now = timeval_to_usec(&tv);
+			ncands = 0;
+			frr_with_mutex (&masters_mtx) {
+				for (ALL_LIST_ELEMENTS_RO(masters, ln, m)) {
+					if (ncands == array_size(cands))
+						break;
+					if (event_watchdog_due(m, now,
+							       &cands[ncands]))
+						ncands++;
+				}
+			}
+
+			for (unsigned int i = 0; i < ncands; i++)
+				event_watchdog_check(&cands[i], now);
+
+			pthread_mutex_lock(&watchdog.mtx);
+		}
+		watchdog.running = false;
+	}
+	return NULL;
+}
+
+int event_watchdog_set(unsigned long threshold)
+{
+	pthread_condattr_t attr;
+	sigset_t oldsigs, blocksigs;
+	int ret = 0;
+
+	if (threshold && frr_stack_capture_init() < 0)
+		flog_warn(EC_LIB_SYSTEM_CALL,
+			  "event watchdog cannot capture backtraces: %s",
+			  safe_strerror(errno));
+
+	frr_with_mutex (&watchdog.mtx) {
+		event_watchdog_threshold = threshold;
+		pthread_cond_signal(&watchdog.cond);
+
+		if (!threshold || watchdog.running)
+			break;
+
+		pthread_condattr_init(&attr);
+		pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+		pthread_cond_destroy(&watchdog.cond);
+		pthread_cond_init(&watchdog.cond, &attr);
+		pthread_condattr_destroy(&attr);
+
+		/* same signal setup as frr_pthread_run() */
+		sigfillset(&blocksigs);
+		pthread_sigmask(SIG_BLOCK, &blocksigs, &oldsigs);
+		ret = pthread_create(&watchdog.thread, NULL,
+				     event_watchdog_run, NULL);
+		pthread_sigmask(SIG_SETMASK, &oldsigs, NULL);
+
+		if (ret) {
+			event_watchdog_threshold = 0;
+			errno = ret;
+			ret = -1;
+			break;
+		}
+		pthread_detach(watchdog.thread);
+		watchdog.running = true;
+	}
+	return ret;
+}
 
 /* CLI start ---------------------------------------------------------------- */
 #include "lib/event_clippy.c"
@@ -445,6 +730,213 @@ DEFUN_NOSH (show_event_cpu,
 	return CMD_SUCCESS;
 }
 
+static unsigned long cpu_record_hist_pct(const size_t *buckets, size_t calls,
+					 unsigned int pct, unsigned long max)
+{
+	size_t target = (calls * pct + 99) / 100, sum = 0;
+
+	for (unsigned int i = 0; i < EVENT_HIST_BUCKETS - 1; i++) {
+		sum += buckets[i];
+		if (sum >= target)
+			return MIN((unsigned long)EVENT_HIST_BASE_USEC << i, max);
+	}
+	return max;
+}
+
+static void cpu_record_hist_print_one(struct vty *vty, uint8_t filter,
+				      const struct cpu_event_history *a,
+				      bool detail)
+{
+	size_t buckets[EVENT_HIST_BUCKETS], calls = 0, stalls;
+	unsigned long max;
+
+	if (!(atomic_load_explicit(&a->types, memory_order_relaxed) & filter))
+		return;
+
+	for (unsigned int i = 0; i < EVENT_HIST_BUCKETS; i++) {
+		buckets[i] = atomic_load_explicit(&a->real_hist[i],
+						  memory_order_relaxed);
+		calls += buckets[i];
+	}
+	if (!calls)
+		return;
+
+	max = atomic_load_explicit(&a->real.max, memory_order_relaxed);
+	stalls = atomic_load_explicit(&a->total_stall, memory_order_relaxed);
+
+	vty_out(vty, "%9zu %9lu %9lu %9lu %9lu %6zu  %s\n", calls,
+		cpu_record_hist_pct(buckets, calls, 50, max),
+		cpu_record_hist_pct(buckets, calls, 90, max),
+		cpu_record_hist_pct(buckets, calls, 99, max), max, stalls,
+		a->funcname);
+
+	if (!detail)
+		return;
+
+	vty_out(vty, "         ");
+	for (unsigned int i = 0; i < EVENT_HIST_BUCKETS; i++) {
+		if (!buckets[i])
+			continue;
+		if (i < EVENT_HIST_BUCKETS - 1)
+			vty_out(vty, " <%luus:%zu",
+				(unsigned long)EVENT_HIST_BASE_USEC << i,
+				buckets[i]);
+		else
+			vty_out(vty, " >=%luus:%zu",
+				(unsigned long)EVENT_HIST_BASE_USEC << (i - 1),
+				buckets[i]);
+	}
+	vty_out(vty, "\n");
+}
+
+DEFPY_NOSH (show_event_cpu_histogram,
+            show_event_cpu_histogram_cmd,
+            "show event cpu histogram [detail$detail] [FILTER$filterstr]",
+            SHOW_STR
+            "Event information\n"
+            "Event CPU usage\n"
+            "Wallclock runtime distribution per event handler\n"
+            "Show histogram buckets\n"
+            "Display filter (rwtexb)\n")
+{
+	uint8_t filter = (uint8_t)-1U;
+	struct event_loop *m;
+	struct listnode *ln;
+
+	if (filterstr) {
+		filter = parse_filter(filterstr);
+		if (!filter) {
+			vty_out(vty,
+				"Invalid filter \"%s\" specified; must contain at least one of 'RWTEXB'\n",
+				filterstr);
+			return CMD_WARNING;
+		}
+	}
+
+	frr_with_mutex (&masters_mtx) {
+		for (ALL_LIST_ELEMENTS_RO(masters, ln, m)) {
+			struct cpu_event_history *rec;
+
+			vty_out(vty, "\nShowing runtime histogram for pthread %s\n",
+				m->name ? m->name : "main");
+			vty_out(vty, "%9s %9s %9s %9s %9s %6s  %s\n", "Invoked",
+				"p50 uSec", "p90 uSec", "p99 uSec", "Max uSecs",
+				"Stalls", "Event");
+
+			frr_each (cpu_records, m->cpu_records, rec)
+				cpu_record_hist_print_one(vty, filter, rec,
+							  !!detail);
+		}
+	}
+	return CMD_SUCCESS;
+}
+
+DEFPY_NOSH (show_event_cpu_folded,
+            show_event_cpu_folded_cmd,
+            "show event cpu folded",
+            SHOW_STR
+            "Event information\n"
+            "Event CPU usage\n"
+            "Wallclock totals in folded stack format (for flamegraph.pl)\n")
+{
+	struct event_loop *m;
+	struct listnode *ln;
+
+	frr_with_mutex (&masters_mtx) {
+		for (ALL_LIST_ELEMENTS_RO(masters, ln, m)) {
+			struct cpu_event_history *rec;
+			size_t total;
+
+			frr_each (cpu_records, m->cpu_records, rec) {
+				total = atomic_load_explicit(
+					&rec->real.total, memory_order_relaxed);
+				if (total)
+					vty_out(vty, "%s;%s;%s %zu\n",
+						frr_protonameinst,
+						m->name ? m->name : "main",
+						rec->funcname, total);
+			}
+		}
+	}
+	return CMD_SUCCESS;
+}
+
+DEFPY_NOSH (show_event_stalls,
+            show_event_stalls_cmd,
+            "show event stalls [folded$folded]",
+            SHOW_STR
+            "Event information\n"
+            "Event handlers caught by the watchdog, with backtraces\n"
+            "Folded stack format (for flamegraph.pl)\n")
+{
+	struct event_stall *stalls, *stall;
+	unsigned int nstalls, first;
+	char buf[128];
+
+	stalls = XCALLOC(MTYPE_TMP, sizeof(watchdog.stalls));
+	frr_with_mutex (&watchdog.mtx) {
+		memcpy(stalls, watchdog.stalls, sizeof(watchdog.stalls));
+		nstalls = watchdog.nstalls;
+	}
+
+	if (!folded) {
+		if (event_watchdog_threshold)
+			vty_out(vty, "Event watchdog threshold: %lums\n",
+				event_watchdog_threshold / 1000);
+		else
+			vty_out(vty, "Event watchdog is disabled\n");
+		vty_out(vty, "%u stalls detected\n", nstalls);
+	}
+
+	first = nstalls > EVENT_STALL_KEEP ? nstalls - EVENT_STALL_KEEP : 0;
+	for (unsigned int n = first; n < nstalls; n++) {
+		stall = &stalls[n % EVENT_STALL_KEEP];
+
+		if (folded) {
+			vty_out(vty, "%s;%s", frr_protonameinst, stall->loop);
+			for (int i = stall->nframes - 1;
+			     i >= EVENT_STALL_SKIP_FRAMES; i--)
+				vty_out(vty, ";%s",
+					event_stall_frame(stall->frames[i], buf,
+							  sizeof(buf)));
+			vty_out(vty, " %lu\n", stall->usec);
+			continue;
+		}
+
+		vty_out(vty, "\n%s ago: task %s in pthread %s running for %lums\n",
+			frrtime_to_interval(monotime(NULL) - stall->when, buf,
+					    sizeof(buf)),
+			stall->funcname, stall->loop, stall->usec / 1000);
+		for (int i = EVENT_STALL_SKIP_FRAMES; i < stall->nframes; i++)
+			vty_out(vty, "  [bt %d] %s\n",
+				i - EVENT_STALL_SKIP_FRAMES,
+				event_stall_frame(stall->frames[i], buf,
+						  sizeof(buf)));
+	}
+
+	XFREE(MTYPE_TMP, stalls);
+	return CMD_SUCCESS;
+}
+
+DEFPY (service_event_watchdog,
+       service_event_watchdog_cmd,
+       "[no] service event-watchdog ![(10-600000)$threshold]",
+       NO_STR
+       "Set up miscellaneous service\n"
+       "Capture backtraces of event handlers running too long\n"
+       "Threshold in milliseconds\n")
+{
+	if (!no && !threshold)
+		threshold = EVENT_WATCHDOG_DEFAULT;
+
+	if (event_watchdog_set(no ? 0 : threshold * 1000) < 0) {
+		vty_out(vty, "%% Failed to start event watchdog: %s\n",
+			safe_strerror(errno));
+		return CMD_WARNING_CONFIG_FAILED;
+	}
+	return CMD_SUCCESS;
+}
+
 DEFPY (service_cputime_stats,
        service_cputime_stats_cmd,
        "[no] service cputime-stats",
@@ -677,12 +1169,16 @@ DEFPY_NOSH (show_event_timers,
 void event_cmd_init(void)
 {
 	install_element(VIEW_NODE, &show_event_cpu_cmd);
+	install_element(VIEW_NODE, &show_event_cpu_histogram_cmd);
+	install_element(VIEW_NODE, &show_event_cpu_folded_cmd);
+	install_element(VIEW_NODE, &show_event_stalls_cmd);
 	install_element(VIEW_NODE, &show_event_poll_cmd);
 	install_element(ENABLE_NODE, &clear_event_cpu_cmd);
 
 	install_element(CONFIG_NODE, &service_cputime_stats_cmd);
 	install_element(CONFIG_NODE, &service_cputime_warning_cmd);
 	install_element(CONFIG_NODE, &service_walltime_warning_cmd);
+	install_element(CONFIG_NODE, &service_event_watchdog_cmd);
 
 	install_element(VIEW_NODE, &show_event_timers_cmd);
 }
@@ -2726,10 +3222,29 @@ void event_call(struct event *event)
 		 event->xref->xref.line, NULL, event->u.fd, event->u.val,
 		 event->arg, event->u.sands.tv_sec);
 
+	/* event_execute() nests, the watchdog only tracks the outermost */
+	bool wd_track = !atomic_load_explicit(&event->master->wd_start,
+					      memory_order_relaxed);
+
+	if (wd_track) {
+		atomic_store_explicit(&event->master->wd_hist,
+				      (uintptr_t)event->hist,
+				      memory_order_relaxed);
+		atomic_fetch_add_explicit(&event->master->wd_seq, 1,
+					  memory_order_relaxed);
+		atomic_store_explicit(&event->master->wd_start,
+				      timeval_to_usec(&before.real),
+				      memory_order_release);
+	}
+
 	pthread_setspecific(thread_current, event);
 	(*event->func)(event);
 	pthread_setspecific(thread_current, NULL);
 
+	if (wd_track)
+		atomic_store_explicit(&event->master->wd_start, 0,
+				      memory_order_release);
+
 	GETRUSAGE(&after);
 	event->master->last_getrusage = after;
 
@@ -2741,6 +3256,9 @@ void event_call(struct event *event)
 	/* update walltime */
 	atomic_fetch_add_explicit(&event->hist->real.total, walltime,
 				  memory_order_seq_cst);
+	atomic_fetch_add_explicit(
+		&event->hist->real_hist[event_hist_bucket(walltime)], 1,
+		memory_order_relaxed);
 	exp = atomic_load_explicit(&event->hist->real.max,
 				   memory_order_seq_cst);
 	while (exp < walltime
@@ -36,6 +36,10 @@ extern unsigned long cputime_threshold;
  * hardware TSC w/o syscalls)
  */
 extern unsigned long walltime_threshold;
+/* event loop watchdog: capture a backtrace of callbacks still running after
+ * this many microseconds.  0 = disabled.  Use event_watchdog_set().
+ */
+extern unsigned long event_watchdog_threshold;
 
 struct rusage_t {
 	struct timespec cpu;
@@ -102,6 +106,12 @@ struct event {
 #pragma FRR printfrr_ext "%pTH"(struct event *)
 #endif
 
+/* Wallclock runtime histogram with log2 buckets:  bucket 0 is < 16us,
+ * bucket n is [8us << n, 16us << n), the last bucket is open ended.
+ */
+#define EVENT_HIST_BUCKETS 16
+#define EVENT_HIST_BASE_USEC 16
+
 struct cpu_event_history {
 	struct cpu_records_item item;
 
@@ -120,6 +130,9 @@ struct cpu_event_history {
 	} real;
 	struct time_stats cpu;
 	atomic_uint_fast32_t types;
+	/* callbacks caught running past event_watchdog_threshold */
+	atomic_size_t total_stall;
+	atomic_size_t real_hist[EVENT_HIST_BUCKETS];
 
 	/* end of cleared region */
 	char _clear_end[0];
@@ -242,6 +255,7 @@ extern void event_set_yield_time(struct event *event, unsigned long ytime);
 /* Internal libfrr exports */
 extern void event_getrusage(RUSAGE_T *r);
 extern void event_cmd_init(void);
+extern int event_watchdog_set(unsigned long threshold);
 
 /* Returns elapsed real (wall clock) time. */
 extern unsigned long event_consumed_time(RUSAGE_T *after, RUSAGE_T *before,
@@ -1,6 +1,6 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 /*
- * FRR sendmmsg wrapper
+ * FRR sendmmsg/recvmmsg wrapper
  * Copyright (C) 2024 by Nvidia, Inc.
  *                       Donald Sharp
  */
@@ -27,4 +27,20 @@ static inline int sendmmsg(int fd, struct mmsghdr *mmh, unsigned int len,
 }
 #endif
 
+#if !defined(HAVE_STRUCT_MMSGHDR_MSG_HDR) || !defined(HAVE_RECVMMSG)
+#define recvmmsg frr_recvmmsg
+
+/* same as above, one message per call */
+static inline int recvmmsg(int fd, struct mmsghdr *mmh, unsigned int len,
+			   int flags, struct timespec *timeout)
+{
+	ssize_t rv = recvmsg(fd, &mmh->msg_hdr, flags);
+
+	if (rv < 0)
+		return -1;
+	mmh->msg_len = rv;
+	return 1;
+}
+#endif
+
 #endif
@@ -0,0 +1,348 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Refcounted segmented I/O buffer chains
+ */
+
+#include <zebra.h>
+
+#include "iobuf.h"
+#include "memory.h"
+
+DEFINE_MTYPE_STATIC(LIB, IOBUF, "I/O buffer chain");
+DEFINE_MTYPE_STATIC(LIB, IOBUF_SLICES, "I/O buffer slices");
+DEFINE_MTYPE_STATIC(LIB, IOBUF_SEG, "I/O buffer segment");
+
+/* Backing storage for slices.  Either owns an inline data area (created by
+ * iobuf_put()) or an adopted stream (iobuf_put_stream()).
+ */
+struct iobuf_seg {
+	atomic_size_t refcnt;
+
+	struct stream *stream;
+
+	/* bytes [0, used) are valid and immutable; [used, size) may be
+	 * appended to by the (single) owner of the segment
+	 */
+	size_t size;
+	size_t used;
+	uint8_t *data;
+
+	uint8_t inline_data[0];
+};
+
+static struct iobuf_seg *iobuf_seg_new(size_t size)
+{
+	struct iobuf_seg *seg;
+
+	seg = XMALLOC(MTYPE_IOBUF_SEG, sizeof(*seg) + size);
+	atomic_store_explicit(&seg->refcnt, 1, memory_order_relaxed);
+	seg->stream = NULL;
+	seg->size = size;
+	seg->used = 0;
+	seg->data = seg->inline_data;
+	return seg;
+}
+
+static struct iobuf_seg *iobuf_seg_ref(struct iobuf_seg *seg)
+{
+	atomic_fetch_add_explicit(&seg->refcnt, 1, memory_order_relaxed);
+	return seg;
+}
+
+static void iobuf_seg_unref(struct iobuf_seg *seg)
+{
+	if (atomic_fetch_sub_explicit(&seg->refcnt, 1, memory_order_acq_rel)
+	    != 1)
+		return;
+
+	stream_free(seg->stream);
+	XFREE(MTYPE_IOBUF_SEG, seg);
+}
+
+static bool iobuf_seg_exclusive(struct iobuf_seg *seg)
+{
+	return atomic_load_explicit(&seg->refcnt, memory_order_acquire) == 1;
+}
+
+struct iobuf *iobuf_new(void)
+{
+	return XCALLOC(MTYPE_IOBUF, sizeof(struct iobuf));
+}
+
+void iobuf_reset(struct iobuf *iob)
+{
+	for (size_t i = 0; i < iob->nslices; i++)
+		iobuf_seg_unref(iob->slices[i].seg);
+
+	iob->nslices = 0;
+	iob->len = 0;
+}
+
+void iobuf_free(struct iobuf *iob)
+{
+	if (!iob)
+		return;
+
+	iobuf_reset(iob);
+	XFREE(MTYPE_IOBUF_SLICES, iob->slices);
+	XFREE(MTYPE_IOBUF, iob);
+}
+
+static struct iobuf_slice *iobuf_slice_add(struct iobuf *iob,
+					   struct iobuf_seg *seg,
+					   size_t offset, size_t len)
+{
+	struct iobuf_slice *sl;
+
+	if (iob->nslices > 0) {
+		sl = &iob->slices[iob->nslices - 1];
+
+		/* adjacent to the previous slice in the same segment, merge */
+		if (sl->seg == seg && sl->offset + sl->len == offset) {
+			sl->len += len;
+			iob->len += len;
+			iobuf_seg_unref(seg);
+			return sl;
+		}
+	}
+
+	if (iob->nslices == iob->slices_alloc) {
+		iob->slices_alloc = MAX(iob->slices_alloc * 2, 4U);
+		iob->slices = XREALLOC(MTYPE_IOBUF_SLICES, iob->slices,
+				       iob->slices_alloc * sizeof(*iob->slices));
+	}
+
+	sl = &iob->slices[iob->nslices++];
+	sl->seg = seg;
+	sl->offset = offset;
+	sl->len = len;
+	iob->len += len;
+	return sl;
+}
+
+void iobuf_put(struct iobuf *iob, const void *data, size_t len)
+{
+	const uint8_t *ptr = data;
+	struct iobuf_slice *sl = NULL;
+	struct iobuf_seg *seg;
+	size_t chunk;
+
+	if (!len)
+		return;
+
+	/* the tail segment can be appended to if nobody else holds a
+	 * reference and our last slice ends exactly at its fill mark
+	 */
+	if (iob->nslices > 0) {
+		sl = &iob->slices[iob->nslices - 1];
+		seg = sl->seg;
+
+		if (!seg->stream && iobuf_seg_exclusive(seg) &&
+		    sl->offset + sl->len == seg->used && seg->used < seg->size) {
+			chunk = MIN(len, seg->size - seg->used);
+			memcpy(seg->data + seg->used, ptr, chunk);
+			seg->used += chunk;
+			sl->len += chunk;
+			iob->len += chunk;
+
+			ptr += chunk;
+			len -= chunk;
+		}
+	}
+
+	if (!len)
+		return;
+
+	seg = iobuf_seg_new(MAX(len, (size_t)IOBUF_SEG_SIZE));
+	memcpy(seg->data, ptr, len);
+	seg->used = len;
+	iobuf_slice_add(iob, seg, 0, len);
+}
+
+void iobuf_put_stream(struct iobuf *iob, struct stream *s)
+{
+	struct iobuf_seg *seg;
+	size_t getp = stream_get_getp(s), endp = stream_get_endp(s);
+
+	if (getp == endp) {
+		stream_free(s);
+		return;
+	}
+
+	seg = XMALLOC(MTYPE_IOBUF_SEG, sizeof(*seg));
+	atomic_store_explicit(&seg->refcnt, 1, memory_order_relaxed);
+	seg->stream = s;
+	seg->size = stream_get_size(s);
+	/* adopted streams are never appended to */
+	seg->used = seg->size;
+	seg->data = STREAM_DATA(s);
+
+	iobuf_slice_add(iob, seg, getp, endp - getp);
+}
+
+struct iobuf *iobuf_from_stream(struct stream *s)
+{
+	struct iobuf *iob = iobuf_new();
+
+	iobuf_put_stream(iob, s);
+	return iob;
+}
+
+void iobuf_append(struct iobuf *dst, const struct iobuf *src)
+{
+	/* dst == src would iterate over slices that are being added */
+	size_t nslices = src->nslices;
+
+	for (size_t i = 0; i < nslices; i++) {
+		const struct iobuf_slice *sl = &src->slices[i];
+
+		iobuf_slice_add(dst, iobuf_seg_ref(sl->seg), sl->offset,
+				sl->len);
+	}
+}
+
+struct iobuf *iobuf_clone(const struct iobuf *iob)
+{
+	struct iobuf *clone = iobuf_new();
+
+	iobuf_append(clone, iob);
+	return clone;
+}
+
+struct iobuf *iobuf_slice(const struct iobuf *iob, size_t offset, size_t len)
+{
+	struct iobuf *slice = iobuf_new();
+
+	for (size_t i = 0; i < iob->nslices && len; i++) {
+		const struct iobuf_slice *sl = &iob->slices[i];
+		size_t chunk;
+
+		if (offset >= sl->len) {
+			offset -= sl->len;
+			continue;
+		}
+
+		chunk = MIN(len, sl->len - offset);
+		iobuf_slice_add(slice, iobuf_seg_ref(sl->seg),
+				sl->offset + offset, chunk);
+		len -= chunk;
+		offset = 0;
+	}
+	return slice;
+}
+
+void iobuf_drain(struct iobuf *iob, size_t len)
+{
+	size_t i;
+
+	if (len >= iob->len) {
+		iobuf_reset(iob);
+		return;
+	}
+
+	iob->len -= len;
+
+	for (i = 0; i < iob->nslices; i++) {
+		struct iobuf_slice *sl = &iob->slices[i];
+
+		if (len < sl->len) {
+			sl->offset += len;
+			sl->len -= len;
+			break;
+		}
+		len -= sl->len;
+		iobuf_seg_unref(sl->seg);
+	}
+
+	if (i) {
+		memmove(&iob->slices[0], &iob->slices[i],
+			(iob->nslices - i) * sizeof(iob->slices[0]));
+		iob->nslices -= i;
+	}
+}
+
+size_t iobuf_copyout(const struct iobuf *iob, size_t offset, void *dst,
+		     size_t len)
+{
+	uint8_t *out = dst;
+	size_t copied = 0;
+
+	for (size_t i = 0; i < iob->nslices && len; i++) {
+		const struct iobuf_slice *sl = &iob->slices[i];
+		size_t chunk;
+
+		if (offset >= sl->len) {
+			offset -= sl->len;
+			continue;
+		}
+
+		chunk = MIN(len, sl->len - offset);
+		memcpy(out + copied, sl->seg->data + sl->offset + offset,
+		       chunk);
+		copied += chunk;
+		len -= chunk;
+		offset = 0;
+	}
+	return copied;
+}
+
+struct stream *iobuf_to_stream(const struct iobuf *iob)
+{
+	struct stream *s = stream_new(MAX(iob->len, 1U));
+
+	iobuf_copyout(iob, 0, STREAM_DATA(s), iob->len);
+	stream_set_endp(s, iob->len);
+	return s;
+}
+
+size_t iobuf_iov(const struct iobuf *iob, struct iovec *iov, size_t iovcnt)
+{
+	size_t i;
+
+	for (i = 0; i < iob->nslices && i < iovcnt; i++) {
+		iov[i].iov_base = iob->slices[i].seg->data +
+				  iob->slices[i].offset;
+		iov[i].iov_len = iob->slices[i].len;
+	}
+	return i;
+}
+
+#ifdef IOV_MAX
+#define IOBUF_MAX_IOV ((IOV_MAX >= 64) ? 64 : IOV_MAX)
+#else
+#define IOBUF_MAX_IOV 16
+#endif
+
+ssize_t iobuf_writev(struct iobuf *iob, int fd)
+{
+	struct iovec iov[IOBUF_MAX_IOV];
+	size_t iovcnt;
+	ssize_t nwr;
+
+	iovcnt = iobuf_iov(iob, iov, array_size(iov));
+	if (!iovcnt)
+		return 0;
+
+	nwr = writev(fd, iov, iovcnt);
+	if (nwr > 0)
+		iobuf_drain(iob, nwr);
+	return nwr;
+}
+
+ssize_t iobuf_sendmsg(struct iobuf *iob, int fd, const struct msghdr *msg,
+		      int flags)
+{
+	struct iovec iov[IOBUF_MAX_IOV];
+	struct msghdr mh = *msg;
+	ssize_t nwr;
+
+	mh.msg_iov = iov;
+	mh.msg_iovlen = iobuf_iov(iob, iov, array_size(iov));
+	if (!mh.msg_iovlen)
+		return 0;
+
+	nwr = sendmsg(fd, &mh, flags);
+	if (nwr > 0)
+		iobuf_drain(iob, nwr);
+	return nwr;
+}
@@ -0,0 +1,123 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Refcounted segmented I/O buffer chains
+ */
+
+#ifndef _FRR_IOBUF_H
+#define _FRR_IOBUF_H
+
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <sys/socket.h>
+
+#include "frratomic.h"
+#include "stream.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* An iobuf is an ordered list of references ("slices") into refcounted
+ * backing segments.  Cloning, slicing or concatenating iobufs only copies
+ * the slice descriptors and bumps segment refcounts;  the payload bytes are
+ * never copied.  This is intended for messages that are built once and then
+ * relayed or fanned out to several destinations (zapi clients, BGP peers,
+ * BMP stations.)
+ *
+ * Rules of use:
+ * - payload bytes are immutable once they are referenced by more than one
+ *   iobuf.  iobuf_put() only ever appends into a segment that is not shared.
+ * - an individual struct iobuf is NOT mt-safe and must only be used by one
+ *   pthread at a time.  Segment refcounts are atomic though, so clones of
+ *   the same iobuf may be handed to different pthreads freely.
+ * - iobuf_put_stream() adopts the stream; the stream is freed when the last
+ *   slice referencing it goes away.  Do not touch the stream afterwards.
+ */
+
+struct iobuf_seg;
+
+struct iobuf_slice {
+	struct iobuf_seg *seg;
+	size_t offset;
+	size_t len;
+};
+
+struct iobuf {
+	/* total number of bytes referenced */
+	size_t len;
+
+	size_t nslices;
+	size_t slices_alloc;
+	struct iobuf_slice *slices;
+};
+
+/* default allocation size for segments created by iobuf_put() */
+#define IOBUF_SEG_SIZE 4096
+
+extern struct iobuf *iobuf_new(void);
+extern void iobuf_free(struct iobuf *iob);
+/* drop all references, iobuf is empty afterwards */
+extern void iobuf_reset(struct iobuf *iob);
+
+static inline size_t iobuf_len(const struct iobuf *iob)
+{
+	return iob->len;
+}
+
+static inline bool iobuf_empty(const struct iobuf *iob)
+{
+	return iob->len == 0;
+}
+
+/* copy data into the iobuf (this is the only function that copies.) */
+extern void iobuf_put(struct iobuf *iob, const void *data, size_t len);
+
+/* zero-copy: take ownership of s, referencing bytes [getp, endp) */
+extern void iobuf_put_stream(struct iobuf *iob, struct stream *s);
+extern struct iobuf *iobuf_from_stream(struct stream *s);
+
+/* zero-copy: reference all of src's bytes at the end of dst */
+extern void iobuf_append(struct iobuf *dst, const struct iobuf *src);
+
+/* zero-copy: new iobuf referencing the same bytes */
+extern struct iobuf *iobuf_clone(const struct iobuf *iob);
+
+/* zero-copy: new iobuf referencing bytes [offset, offset + len) of iob.
+ * The range is clamped to the available data.
+ */
+extern struct iobuf *iobuf_slice(const struct iobuf *iob, size_t offset,
+				 size_t len);
+
+/* remove len bytes from the front of the iobuf (e.g. after a short write) */
+extern void iobuf_drain(struct iobuf *iob, size_t len);
+
+/* copy out bytes, returns number of bytes copied */
+extern size_t iobuf_copyout(const struct iobuf *iob, size_t offset, void *dst,
+			    size_t len);
+
+/* linearize into a newly allocated stream (for code that needs contiguous
+ * data, e.g. parsers.)  This obviously copies.
+ */
+extern struct stream *iobuf_to_stream(const struct iobuf *iob);
+
+/* fill iov[] with up to iovcnt entries referencing the iobuf's data,
+ * returns the number of entries used.
+ */
+extern size_t iobuf_iov(const struct iobuf *iob, struct iovec *iov,
+			size_t iovcnt);
+
+/* Write as much as possible to fd with one writev()/sendmsg() call and drain
+ * the written bytes.  Return value as for writev()/sendmsg().
+ *
+ * For iobuf_sendmsg(), msg supplies msg_name/msg_control; its msg_iov and
+ * msg_iovlen are ignored and replaced with the iobuf's data.
+ */
+extern ssize_t iobuf_writev(struct iobuf *iob, int fd);
+extern ssize_t iobuf_sendmsg(struct iobuf *iob, int fd,
+			     const struct msghdr *msg, int flags);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _FRR_IOBUF_H */
@@ -464,7 +464,8 @@ static const struct zebra_desc_table command_types[] = {
 	DESC_ENTRY(ZEBRA_TC_FILTER_ADD),
 	DESC_ENTRY(ZEBRA_TC_FILTER_DELETE),
 	DESC_ENTRY(ZEBRA_OPAQUE_NOTIFY),
-	DESC_ENTRY(ZEBRA_SRV6_SID_NOTIFY)
+	DESC_ENTRY(ZEBRA_SRV6_SID_NOTIFY),
+	DESC_ENTRY(ZEBRA_IPMR_ROUTE_STATS_BULK)
 };
 #undef DESC_ENTRY
 
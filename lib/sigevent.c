@@ -21,6 +21,16 @@
 #include <ucontext.h>
 #endif /* HAVE_UCONTEXT_H */
 
+#ifdef HAVE_LIBUNWIND
+#define UNW_LOCAL_ONLY
+#include <libunwind.h>
+#elif defined(HAVE_GLIBC_BACKTRACE)
+#include <execinfo.h>
+#endif
+
+#include "frratomic.h"
+#include "frr_pthread.h"
+
 
 /* master signals descriptor struct */
 static struct frr_sigevent_master_t {
@@ -353,6 +363,159 @@ static void trap_default_signals(void)
 	}
 }
 
+/* Capturing the stack of another pthread:  the target gets a signal and
+ * records its own backtrace from the signal handler.  Only one capture can
+ * be in progress at a time.
+ *
+ * The handler has to claim the pending capture before writing to frames[].
+ * A capture that times out withdraws its claim, so a signal that is only
+ * delivered later can't write into the next capture.
+ */
+static struct {
+	pthread_mutex_t mtx;
+	int signo;
+
+	/* set while a capture of target waits for the handler */
+	atomic_bool pending;
+	pthread_t target;
+
+	/* -1 until the handler that claimed the capture is done */
+	atomic_int nframes;
+	void *frames[FRR_STACK_CAPTURE_MAX];
+} stack_capture = {
+	.mtx = PTHREAD_MUTEX_INITIALIZER,
+	.signo = -1,
+};
+
+static int stack_capture_frames(void **frames, int max)
+{
+	int n = 0;
+
+#ifdef HAVE_LIBUNWIND
+	n = unw_backtrace(frames, max);
+#elif defined(HAVE_GLIBC_BACKTRACE)
+	n = backtrace(frames, max);
+#endif
+	return MAX(n, 0);
+}
+
+static void stack_capture_handler(int signo, siginfo_t *siginfo,
+				  void *context)
+{
+	int saved_errno = errno;
+	bool expect = true;
+	int n;
+
+	if (!atomic_load_explicit(&stack_capture.pending,
+				  memory_order_acquire) ||
+	    !pthread_equal(pthread_self(), stack_capture.target) ||
+	    !atomic_compare_exchange_strong_explicit(&stack_capture.pending,
+						     &expect, false,
+						     memory_order_acq_rel,
+						     memory_order_relaxed)) {
+		errno = saved_errno;
+		return;
+	}
+
+	n = stack_capture_frames(stack_capture.frames,
+				 array_size(stack_capture.frames));
+	atomic_store_explicit(&stack_capture.nframes, n, memory_order_release);
+	errno = saved_errno;
+}
+
+int frr_stack_capture_init(void)
+{
+#if defined(SIGRTMIN) && (defined(HAVE_LIBUNWIND) || defined(HAVE_GLIBC_BACKTRACE))
+	struct sigaction act, oact;
+	int signo = SIGRTMIN + FRR_STACK_CAPTURE_SIGOFFSET;
+
+	frr_with_mutex (&stack_capture.mtx) {
+		if (stack_capture.signo >= 0)
+			return 0;
+
+		if (sigaction(signo, NULL, &oact) < 0 ||
+		    (oact.sa_handler != SIG_DFL && oact.sa_handler != SIG_IGN)) {
+			errno = EBUSY;
+			return -1;
+		}
+
+		/* the first backtrace() call may need to load libgcc, which
+		 * is not something to do inside a signal handler.
+		 */
+		stack_capture_frames(stack_capture.frames,
+				     array_size(stack_capture.frames));
+
+		memset(&act, 0, sizeof(act));
+		sigfillset(&act.sa_mask);
+		act.sa_sigaction = stack_capture_handler;
+		act.sa_flags = SA_SIGINFO | SA_RESTART;
+		if (sigaction(signo, &act, NULL) < 0)
+			return -1;
+
+		stack_capture.signo = signo;
+	}
+	return 0;
+#else
+	errno = ENOTSUP;
+	return -1;
+#endif
+}
+
+int frr_stack_capture(pthread_t pth, void **frames, int max,
+		      unsigned long timeout_ms)
+{
+	struct timespec ts = { .tv_sec = 0, .tv_nsec = 1000000 };
+	bool expect = true;
+	int n = -1;
+
+	frr_with_mutex (&stack_capture.mtx) {
+		if (stack_capture.signo < 0) {
+			errno = ENOTSUP;
+			return -1;
+		}
+
+		atomic_store_explicit(&stack_capture.nframes, -1,
+				      memory_order_relaxed);
+		stack_capture.target = pth;
+		atomic_store_explicit(&stack_capture.pending, true,
+				      memory_order_release);
+
+		errno = pthread_kill(pth, stack_capture.signo);
+		if (errno) {
+			atomic_store_explicit(&stack_capture.pending, false,
+					      memory_order_relaxed);
+			return -1;
+		}
+
+		for (unsigned long i = 0; i <= timeout_ms; i++) {
+			n = atomic_load_explicit(&stack_capture.nframes,
+						 memory_order_acquire);
+			if (n >= 0)
+				break;
+			nanosleep(&ts, NULL);
+		}
+		if (n < 0) {
+			/* withdraw, unless the handler has just claimed it */
+			if (atomic_compare_exchange_strong_explicit(
+				    &stack_capture.pending, &expect, false,
+				    memory_order_acq_rel,
+				    memory_order_relaxed)) {
+				errno = ETIMEDOUT;
+				return -1;
+			}
+
+			/* it is running, wait for it to finish with frames[] */
+			while ((n = atomic_load_explicit(&stack_capture.nframes,
+							 memory_order_acquire)) < 0)
+				nanosleep(&ts, NULL);
+		}
+
+		n = MIN(n, max);
+		memcpy(frames, stack_capture.frames, n * sizeof(frames[0]));
+	}
+	return n;
+}
+
 void signal_init(struct event_loop *m, int sigc, struct frr_signal_t signals[])
 {
 
@@ -45,6 +45,21 @@ bool frr_sigevent_check(sigset_t *setp);
 /* check whether there are signals to handle, process any found */
 extern int frr_sigevent_process(void);
 
+/* Backtrace capture for other pthreads (used by the event loop watchdog.)
+ * The target pthread is interrupted with SIGRTMIN + FRR_STACK_CAPTURE_SIGOFFSET
+ * and records its stack from the signal handler.  The first 2 frames are the
+ * signal handler and the kernel's signal trampoline.
+ *
+ * frr_stack_capture() returns the number of frames stored or -1 with errno
+ * set (ENOTSUP if there is no backtrace support or _init wasn't called.)
+ */
+#define FRR_STACK_CAPTURE_SIGOFFSET 2
+#define FRR_STACK_CAPTURE_MAX 48
+
+extern int frr_stack_capture_init(void);
+extern int frr_stack_capture(pthread_t pth, void **frames, int max,
+			     unsigned long timeout_ms);
+
 /* Ensure we don't handle "application-type" signals on a secondary thread by
  * blocking these signals when creating threads
  *
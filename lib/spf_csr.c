@@ -0,0 +1,321 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Array based shortest path first kernel
+ */
+
+#include <zebra.h>
+
+#include "spf_csr.h"
+#include "memory.h"
+
+DEFINE_MTYPE_STATIC(LIB, SPF_CSR_VERTICES, "SPF kernel vertex arrays");
+DEFINE_MTYPE_STATIC(LIB, SPF_CSR_EDGES, "SPF kernel edge arrays");
+
+void spf_csr_init(struct spf_csr *csr)
+{
+	memset(csr, 0, sizeof(*csr));
+}
+
+void spf_csr_fini(struct spf_csr *csr)
+{
+	XFREE(MTYPE_SPF_CSR_VERTICES, csr->row);
+	XFREE(MTYPE_SPF_CSR_VERTICES, csr->tiebreak);
+	XFREE(MTYPE_SPF_CSR_VERTICES, csr->dist);
+	XFREE(MTYPE_SPF_CSR_VERTICES, csr->order);
+	XFREE(MTYPE_SPF_CSR_VERTICES, csr->parent_head);
+	XFREE(MTYPE_SPF_CSR_VERTICES, csr->parent_tail);
+	XFREE(MTYPE_SPF_CSR_VERTICES, csr->heap);
+	XFREE(MTYPE_SPF_CSR_VERTICES, csr->heap_pos);
+	XFREE(MTYPE_SPF_CSR_VERTICES, csr->seq);
+
+	XFREE(MTYPE_SPF_CSR_EDGES, csr->src);
+	XFREE(MTYPE_SPF_CSR_EDGES, csr->dst);
+	XFREE(MTYPE_SPF_CSR_EDGES, csr->cost);
+	XFREE(MTYPE_SPF_CSR_EDGES, csr->cookie);
+	XFREE(MTYPE_SPF_CSR_EDGES, csr->parent_next);
+	XFREE(MTYPE_SPF_CSR_EDGES, csr->add_src);
+	XFREE(MTYPE_SPF_CSR_EDGES, csr->add_dst);
+	XFREE(MTYPE_SPF_CSR_EDGES, csr->add_cost);
+	XFREE(MTYPE_SPF_CSR_EDGES, csr->add_cookie);
+
+	memset(csr, 0, sizeof(*csr));
+}
+
+/* arrays only ever grow, a steady state topology doesn't reallocate */
+static uint32_t spf_csr_grow(uint32_t have, uint32_t need)
+{
+	uint32_t size = have ? have : 64;
+
+	while (size < need)
+		size *= 2;
+	return size;
+}
+
+#define SPF_CSR_REALLOC(mtype, ptr, n)                                         \
+	(ptr) = XREALLOC(mtype, (ptr), (size_t)(n) * sizeof(*(ptr)))
+
+static void spf_csr_grow_vertices(struct spf_csr *csr, uint32_t nvertices)
+{
+	uint32_t n;
+
+	if (nvertices <= csr->vertices_alloc)
+		return;
+
+	n = spf_csr_grow(csr->vertices_alloc, nvertices);
+	SPF_CSR_REALLOC(MTYPE_SPF_CSR_VERTICES, csr->row, n + 1);
+	SPF_CSR_REALLOC(MTYPE_SPF_CSR_VERTICES, csr->tiebreak, n);
+	SPF_CSR_REALLOC(MTYPE_SPF_CSR_VERTICES, csr->dist, n);
+	SPF_CSR_REALLOC(MTYPE_SPF_CSR_VERTICES, csr->order, n);
+	SPF_CSR_REALLOC(MTYPE_SPF_CSR_VERTICES, csr->parent_head, n);
+	SPF_CSR_REALLOC(MTYPE_SPF_CSR_VERTICES, csr->parent_tail, n);
+	SPF_CSR_REALLOC(MTYPE_SPF_CSR_VERTICES, csr->heap, n);
+	SPF_CSR_REALLOC(MTYPE_SPF_CSR_VERTICES, csr->heap_pos, n);
+	SPF_CSR_REALLOC(MTYPE_SPF_CSR_VERTICES, csr->seq, n);
+	csr->vertices_alloc = n;
+}
+
+void spf_csr_reset(struct spf_csr *csr, uint32_t nvertices)
+{
+	spf_csr_grow_vertices(csr, nvertices);
+
+	csr->nvertices = nvertices;
+	csr->nedges = 0;
+	csr->nadded = 0;
+	csr->norder = 0;
+	csr->max_dist = SPF_CSR_INFINITY - 1;
+	if (nvertices)
+		memset(csr->tiebreak, 0, nvertices * sizeof(*csr->tiebreak));
+}
+
+uint32_t spf_csr_add_vertex(struct spf_csr *csr)
+{
+	uint32_t v = csr->nvertices;
+
+	assert(csr->nedges == 0);
+
+	spf_csr_grow_vertices(csr, v + 1);
+	csr->tiebreak[v] = 0;
+	csr->nvertices++;
+	return v;
+}
+
+void spf_csr_set_max_dist(struct spf_csr *csr, uint32_t max_dist)
+{
+	csr->max_dist = MIN(max_dist, SPF_CSR_INFINITY - 1);
+}
+
+void spf_csr_set_tiebreak(struct spf_csr *csr, uint32_t v, uint8_t tiebreak)
+{
+	assert(v < csr->nvertices);
+	csr->tiebreak[v] = tiebreak;
+}
+
+void spf_csr_add_edge(struct spf_csr *csr, uint32_t src, uint32_t dst,
+		      uint32_t cost, uint32_t cookie)
+{
+	assert(src < csr->nvertices && dst < csr->nvertices);
+
+	if (csr->nadded == csr->added_alloc) {
+		uint32_t n = spf_csr_grow(csr->added_alloc, csr->nadded + 1);
+
+		SPF_CSR_REALLOC(MTYPE_SPF_CSR_EDGES, csr->add_src, n);
+		SPF_CSR_REALLOC(MTYPE_SPF_CSR_EDGES, csr->add_dst, n);
+		SPF_CSR_REALLOC(MTYPE_SPF_CSR_EDGES, csr->add_cost, n);
+		SPF_CSR_REALLOC(MTYPE_SPF_CSR_EDGES, csr->add_cookie, n);
+		csr->added_alloc = n;
+	}
+
+	csr->add_src[csr->nadded] = src;
+	csr->add_dst[csr->nadded] = dst;
+	csr->add_cost[csr->nadded] = cost;
+	csr->add_cookie[csr->nadded] = cookie;
+	csr->nadded++;
+}
+
+void spf_csr_finalize(struct spf_csr *csr)
+{
+	uint32_t nv = csr->nvertices;
+	uint32_t ne = csr->nadded;
+
+	if (ne > csr->edges_alloc) {
+		uint32_t n = spf_csr_grow(csr->edges_alloc, ne);
+
+		SPF_CSR_REALLOC(MTYPE_SPF_CSR_EDGES, csr->src, n);
+		SPF_CSR_REALLOC(MTYPE_SPF_CSR_EDGES, csr->dst, n);
+		SPF_CSR_REALLOC(MTYPE_SPF_CSR_EDGES, csr->cost, n);
+		SPF_CSR_REALLOC(MTYPE_SPF_CSR_EDGES, csr->cookie, n);
+		SPF_CSR_REALLOC(MTYPE_SPF_CSR_EDGES, csr->parent_next, n);
+		csr->edges_alloc = n;
+	}
+
+	/* counting sort by source vertex, stable so that the edges of a
+	 * vertex keep the order they were added in
+	 */
+	memset(csr->row, 0, (nv + 1) * sizeof(*csr->row));
+	for (uint32_t i = 0; i < ne; i++)
+		csr->row[csr->add_src[i] + 1]++;
+	for (uint32_t v = 0; v < nv; v++)
+		csr->row[v + 1] += csr->row[v];
+
+	/* use parent_head as insertion cursor, it's reset by every run */
+	memcpy(csr->parent_head, csr->row, nv * sizeof(*csr->row));
+	for (uint32_t i = 0; i < ne; i++) {
+		uint32_t e = csr->parent_head[csr->add_src[i]]++;
+
+		csr->src[e] = csr->add_src[i];
+		csr->dst[e] = csr->add_dst[i];
+		csr->cost[e] = csr->add_cost[i];
+		csr->cookie[e] = csr->add_cookie[i];
+	}
+
+	csr->nedges = ne;
+	csr->nadded = 0;
+}
+
+/* heap order: distance, then tiebreak, then first come first served */
+static inline bool spf_csr_before(const struct spf_csr *csr, uint32_t a,
+				  uint32_t b)
+{
+	if (csr->dist[a] != csr->dist[b])
+		return csr->dist[a] < csr->dist[b];
+	if (csr->tiebreak[a] != csr->tiebreak[b])
+		return csr->tiebreak[a] < csr->tiebreak[b];
+	return csr->seq[a] < csr->seq[b];
+}
+
+static inline void spf_csr_heap_set(struct spf_csr *csr, uint32_t pos,
+				    uint32_t v)
+{
+	csr->heap[pos] = v;
+	csr->heap_pos[v] = pos;
+}
+
+static void spf_csr_sift_up(struct spf_csr *csr, uint32_t pos)
+{
+	uint32_t v = csr->heap[pos];
+
+	while (pos > 0) {
+		uint32_t parent = (pos - 1) / SPF_CSR_HEAP_ARITY;
+
+		if (!spf_csr_before(csr, v, csr->heap[parent]))
+			break;
+		spf_csr_heap_set(csr, pos, csr->heap[parent]);
+		pos = parent;
+	}
+	spf_csr_heap_set(csr, pos, v);
+}
+
+static void spf_csr_sift_down(struct spf_csr *csr, uint32_t pos)
+{
+	uint32_t v = csr->heap[pos];
+
+	for (;;) {
+		uint32_t first = pos * SPF_CSR_HEAP_ARITY + 1;
+		uint32_t last, best;
+
+		if (first >= csr->heap_len)
+			break;
+		last = MIN(first + SPF_CSR_HEAP_ARITY, csr->heap_len);
+
+		best = first;
+		for (uint32_t c = first + 1; c < last; c++)
+			if (spf_csr_before(csr, csr->heap[c], csr->heap[best]))
+				best = c;
+
+		if (!spf_csr_before(csr, csr->heap[best], v))
+			break;
+		spf_csr_heap_set(csr, pos, csr->heap[best]);
+		pos = best;
+	}
+	spf_csr_heap_set(csr, pos, v);
+}
+
+static uint32_t spf_csr_heap_pop(struct spf_csr *csr)
+{
+	uint32_t v = csr->heap[0];
+
+	csr->heap_len--;
+	csr->heap_pos[v] = SPF_CSR_NONE;
+	if (csr->heap_len) {
+		spf_csr_heap_set(csr, 0, csr->heap[csr->heap_len]);
+		spf_csr_sift_down(csr, 0);
+	}
+	return v;
+}
+
+static void spf_csr_parent_add(struct spf_csr *csr, uint32_t v, uint32_t e)
+{
+	csr->parent_next[e] = SPF_CSR_NONE;
+	if (csr->parent_head[v] == SPF_CSR_NONE)
+		csr->parent_head[v] = e;
+	else
+		csr->parent_next[csr->parent_tail[v]] = e;
+	csr->parent_tail[v] = e;
+}
+
+void spf_csr_run(struct spf_csr *csr, uint32_t root)
+{
+	uint32_t nv = csr->nvertices;
+
+	assert(root < nv);
+	assert(csr->nadded == 0);
+
+	csr->root = root;
+	csr->norder = 0;
+	csr->heap_len = 0;
+	csr->nextseq = 0;
+
+	for (uint32_t v = 0; v < nv; v++) {
+		csr->dist[v] = SPF_CSR_INFINITY;
+		csr->parent_head[v] = SPF_CSR_NONE;
+		csr->heap_pos[v] = SPF_CSR_NONE;
+	}
+
+	csr->dist[root] = 0;
+	csr->seq[root] = csr->nextseq++;
+	spf_csr_heap_set(csr, 0, root);
+	csr->heap_len = 1;
+
+	while (csr->heap_len) {
+		uint32_t v = spf_csr_heap_pop(csr);
+		uint32_t dist_v = csr->dist[v];
+
+		csr->order[csr->norder++] = v;
+
+		for (uint32_t e = csr->row[v]; e < csr->row[v + 1]; e++) {
+			uint32_t w = csr->dst[e];
+			uint32_t dist;
+
+			/* settled vertices (and the root) are out of the heap
+			 * with a finite distance
+			 */
+			if (csr->dist[w] != SPF_CSR_INFINITY
+			    && csr->heap_pos[w] == SPF_CSR_NONE)
+				continue;
+
+			if (csr->cost[e] > csr->max_dist - dist_v)
+				continue;
+			dist = dist_v + csr->cost[e];
+
+			if (dist > csr->dist[w])
+				continue;
+			if (dist == csr->dist[w]) {
+				/* equal cost path */
+				spf_csr_parent_add(csr, w, e);
+				continue;
+			}
+
+			/* better path, drop the parents found so far */
+			csr->parent_head[w] = SPF_CSR_NONE;
+			spf_csr_parent_add(csr, w, e);
+			csr->dist[w] = dist;
+			csr->seq[w] = csr->nextseq++;
+
+			if (csr->heap_pos[w] == SPF_CSR_NONE) {
+				spf_csr_heap_set(csr, csr->heap_len, w);
+				csr->heap_len++;
+			}
+			spf_csr_sift_up(csr, csr->heap_pos[w]);
+		}
+	}
+}
@@ -0,0 +1,136 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Array based shortest path first kernel
+ */
+
+#ifndef _FRR_SPF_CSR_H
+#define _FRR_SPF_CSR_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Dijkstra on a compact snapshot of a link state database.
+ *
+ * The protocol translates its LSDB into a directed graph of dense vertex
+ * indexes (0 .. nvertices-1) with one edge per usable adjacency, runs the
+ * kernel and then translates the result back into its own tree structures.
+ * All storage is kept in the struct spf_csr and reused by later runs, a
+ * steady state SPF doesn't allocate anything.
+ *
+ * The graph is stored in compressed sparse row form: the outgoing edges of
+ * vertex v are [row[v], row[v + 1]), in the order they were added.  Each
+ * edge carries an opaque 32-bit cookie for the protocol to find the link it
+ * was built from.
+ *
+ * The result of a run is
+ * - the distance of every vertex from the root (SPF_CSR_INFINITY if
+ *   unreachable or further away than the distance limit),
+ * - the order in which vertices were settled, i.e. by increasing distance,
+ *   ties broken by a per-vertex tiebreak value and then by the order in
+ *   which the vertices were reached at their final distance,
+ * - for every reached vertex, the list of equal cost parent edges in the
+ *   order they were found.
+ *
+ * Ties are settled in the order of a FIFO candidate list, like isisd's TENT
+ * does, so a protocol adding the edges of every vertex in the order it would
+ * look at them gets the same tree as from its own loop.
+ *
+ * A struct spf_csr is not mt-safe, but separate instances can be used by
+ * different pthreads.
+ */
+
+#define SPF_CSR_INFINITY UINT32_MAX
+#define SPF_CSR_NONE	 UINT32_MAX
+
+/* children of a heap node, 4 keeps sibling comparisons in one cache line */
+#define SPF_CSR_HEAP_ARITY 4
+
+struct spf_csr {
+	/* graph */
+	uint32_t nvertices;
+	uint32_t nedges;
+	uint32_t *row;
+	uint32_t *src;
+	uint32_t *dst;
+	uint32_t *cost;
+	uint32_t *cookie;
+	uint8_t *tiebreak;
+
+	/* edges added since spf_csr_reset(), sorted into the arrays above
+	 * by spf_csr_finalize()
+	 */
+	uint32_t nadded;
+	uint32_t *add_src;
+	uint32_t *add_dst;
+	uint32_t *add_cost;
+	uint32_t *add_cookie;
+
+	/* paths longer than this are ignored */
+	uint32_t max_dist;
+
+	/* result */
+	uint32_t root;
+	uint32_t *dist;
+	uint32_t norder;
+	uint32_t *order;
+	uint32_t *parent_head;
+	uint32_t *parent_tail;
+	uint32_t *parent_next;
+
+	/* order in which vertices got their current distance, for ties */
+	uint32_t *seq;
+	uint32_t nextseq;
+
+	/* indexed d-ary heap of candidate vertices */
+	uint32_t heap_len;
+	uint32_t *heap;
+	uint32_t *heap_pos;
+
+	/* allocated sizes */
+	uint32_t vertices_alloc;
+	uint32_t edges_alloc;
+	uint32_t added_alloc;
+};
+
+extern void spf_csr_init(struct spf_csr *csr);
+extern void spf_csr_fini(struct spf_csr *csr);
+
+/* start building a new graph with the given number of vertices */
+extern void spf_csr_reset(struct spf_csr *csr, uint32_t nvertices);
+/* add one more vertex before finalizing, returns its index */
+extern uint32_t spf_csr_add_vertex(struct spf_csr *csr);
+/* vertices with lower values are settled first among equal distances */
+extern void spf_csr_set_tiebreak(struct spf_csr *csr, uint32_t v,
+				 uint8_t tiebreak);
+extern void spf_csr_add_edge(struct spf_csr *csr, uint32_t src, uint32_t dst,
+			     uint32_t cost, uint32_t cookie);
+/* sort the added edges into CSR form, needs to be called before running */
+extern void spf_csr_finalize(struct spf_csr *csr);
+/* don't reach vertices further away than max_dist, reset by spf_csr_reset */
+extern void spf_csr_set_max_dist(struct spf_csr *csr, uint32_t max_dist);
+
+extern void spf_csr_run(struct spf_csr *csr, uint32_t root);
+
+static inline uint32_t spf_csr_dist(const struct spf_csr *csr, uint32_t v)
+{
+	return csr->dist[v];
+}
+
+/* iterate settled vertices, starting with the root */
+#define spf_csr_foreach_settled(csr, i, v)                                     \
+	for ((i) = 0; (i) < (csr)->norder && ((v) = (csr)->order[(i)], 1);     \
+	     (i)++)
+
+/* iterate the equal cost parent edges of a settled vertex */
+#define spf_csr_foreach_parent(csr, v, e)                                      \
+	for ((e) = (csr)->parent_head[(v)]; (e) != SPF_CSR_NONE;               \
+	     (e) = (csr)->parent_next[(e)])
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _FRR_SPF_CSR_H */
@@ -16,6 +16,31 @@
 DEFINE_MTYPE(LIB, WORK_QUEUE, "Work queue");
 DEFINE_MTYPE_STATIC(LIB, WORK_QUEUE_ITEM, "Work queue item");
 DEFINE_MTYPE_STATIC(LIB, WORK_QUEUE_NAME, "Work queue name string");
+DEFINE_MTYPE_STATIC(LIB, WORK_QUEUE_SCHED, "Work queue scheduler");
+
+DECLARE_DLIST(work_queue_runq, struct work_queue, runq_item);
+
+/* Loop-wide scheduler, one per event loop that has work queues.  Runnable
+ * queues wait on runq[] until the scheduler event gives them a timeslice.
+ */
+struct work_queue_sched {
+	struct event_loop *master;
+	struct event *event;
+
+	/* number of work queues using this scheduler */
+	unsigned int refcnt;
+	/* inside work_queue_sched_run(), don't free */
+	bool running;
+
+	/* loop-wide timeslice, in us */
+	unsigned long slice;
+
+	struct work_queue_runq_head runq[WQ_PRIO_MAX];
+
+	unsigned long passes;	 /* scheduler runs */
+	unsigned long preempted; /* runs that ended with queues still waiting */
+	uint64_t runtime_max;	 /* longest scheduler run, us */
+};
 
 /* master list of work_queues */
 static struct list _work_queues;
@@ -24,8 +49,86 @@ static struct list _work_queues;
  */
 static struct list *work_queues = &_work_queues;
 
+static struct list _work_queue_scheds;
+static struct list *work_queue_scheds = &_work_queue_scheds;
+
 #define WORK_QUEUE_MIN_GRANULARITY 1
 
+static void work_queue_sched_run(struct event *event);
+
+static struct work_queue_sched *work_queue_sched_find(struct event_loop *m)
+{
+	struct listnode *node;
+	struct work_queue_sched *sched;
+
+	for (ALL_LIST_ELEMENTS_RO(work_queue_scheds, node, sched))
+		if (sched->master == m)
+			return sched;
+
+	sched = XCALLOC(MTYPE_WORK_QUEUE_SCHED, sizeof(*sched));
+	sched->master = m;
+	sched->slice = EVENT_YIELD_TIME_SLOT;
+	for (int prio = 0; prio < WQ_PRIO_MAX; prio++)
+		work_queue_runq_init(&sched->runq[prio]);
+
+	listnode_add(work_queue_scheds, sched);
+	return sched;
+}
+
+static void work_queue_sched_free(struct work_queue_sched *sched)
+{
+	event_cancel(&sched->event);
+	for (int prio = 0; prio < WQ_PRIO_MAX; prio++)
+		work_queue_runq_fini(&sched->runq[prio]);
+
+	listnode_delete(work_queue_scheds, sched);
+	XFREE(MTYPE_WORK_QUEUE_SCHED, sched);
+}
+
+static void work_queue_sched_put(struct work_queue_sched *sched)
+{
+	assert(sched->refcnt > 0);
+
+	if (--sched->refcnt == 0 && !sched->running)
+		work_queue_sched_free(sched);
+}
+
+void work_queue_sched_slice(struct event_loop *m, unsigned long usec)
+{
+	struct work_queue_sched *sched = work_queue_sched_find(m);
+
+	sched->slice = usec ?: EVENT_YIELD_TIME_SLOT;
+}
+
+/* put a queue on its scheduler's run queue */
+static void work_queue_sched_add(struct work_queue *wq)
+{
+	struct work_queue_sched *sched = wq->sched;
+
+	if (wq->runnable)
+		return;
+
+	assert(wq->spec.priority < WQ_PRIO_MAX);
+
+	wq->runnable = true;
+	wq->skipped = 0;
+	wq->runq_prio = wq->spec.priority;
+	monotime(&wq->runnable_since);
+	work_queue_runq_add_tail(&sched->runq[wq->runq_prio], wq);
+
+	event_add_event(sched->master, work_queue_sched_run, sched, 0,
+			&sched->event);
+}
+
+static void work_queue_sched_del(struct work_queue *wq)
+{
+	if (!wq->runnable)
+		return;
+
+	work_queue_runq_del(&wq->sched->runq[wq->runq_prio], wq);
+	wq->runnable = false;
+}
+
 static struct work_queue_item *work_queue_item_new(struct work_queue *wq)
 {
 	struct work_queue_item *item;
@@ -76,6 +179,8 @@ struct work_queue *work_queue_new(struct event_loop *m, const char *queue_name)
 
 	new->name = XSTRDUP(MTYPE_WORK_QUEUE_NAME, queue_name);
 	new->master = m;
+	new->sched = work_queue_sched_find(m);
+	new->sched->refcnt++;
 	SET_FLAG(new->flags, WQ_UNPLUGGED);
 
 	STAILQ_INIT(&new->items);
@@ -88,6 +193,7 @@ struct work_queue *work_queue_new(struct event_loop *m, const char *queue_name)
 	new->spec.hold = WORK_QUEUE_DEFAULT_HOLD;
 	new->spec.yield = EVENT_YIELD_TIME_SLOT;
 	new->spec.retry = WORK_QUEUE_DEFAULT_RETRY;
+	new->spec.priority = WQ_PRIO_NORMAL;
 
 	return new;
 }
@@ -97,6 +203,7 @@ void work_queue_free_and_null(struct work_queue **wqp)
 	struct work_queue *wq = *wqp;
 
 	event_cancel(&wq->event);
+	work_queue_sched_del(wq);
 
 	while (!work_queue_empty(wq)) {
 		struct work_queue_item *item = work_queue_last_item(wq);
@@ -105,6 +212,7 @@ void work_queue_free_and_null(struct work_queue **wqp)
 	}
 
 	listnode_delete(work_queues, wq);
+	work_queue_sched_put(wq->sched);
 
 	XFREE(MTYPE_WORK_QUEUE_NAME, wq->name);
 	XFREE(MTYPE_WORK_QUEUE, wq);
@@ -114,26 +222,22 @@ void work_queue_free_and_null(struct work_queue **wqp)
 
 bool work_queue_is_scheduled(struct work_queue *wq)
 {
-	return event_is_scheduled(wq->event);
+	return event_is_scheduled(wq->event) || wq->runnable;
 }
 
 static int work_queue_schedule(struct work_queue *wq, unsigned int delay)
 {
 	/* if appropriate, schedule work queue thread */
-	if (CHECK_FLAG(wq->flags, WQ_UNPLUGGED) && !event_is_scheduled(wq->event) &&
+	if (CHECK_FLAG(wq->flags, WQ_UNPLUGGED) && !work_queue_is_scheduled(wq) &&
 	    !work_queue_empty(wq)) {
-		/* Schedule timer if there's a delay, otherwise just schedule
-		 * as an 'event'
+		/* Schedule timer if there's a delay, otherwise the queue
+		 * waits for the scheduler to give it a timeslice right away
 		 */
 		if (delay > 0) {
 			event_add_timer_msec(wq->master, work_queue_run, wq, delay, &wq->event);
 			event_ignore_late_timer(wq->event);
 		} else
-			event_add_event(wq->master, work_queue_run, wq, 0, &wq->event);
-
-		/* set thread yield time, if needed */
-		if (event_is_scheduled(wq->event) && wq->spec.yield != EVENT_YIELD_TIME_SLOT)
-			event_set_yield_time(wq->event, wq->spec.yield);
+			work_queue_sched_add(wq);
 		return 1;
 	} else
 		return 0;
@@ -177,8 +281,21 @@ DEFUN (show_work_queues,
        SHOW_STR
        "Work Queue information\n")
 {
+	static const char prio_chars[WQ_PRIO_MAX] = {
+		[WQ_PRIO_LOW] = 'L',
+		[WQ_PRIO_NORMAL] = 'N',
+		[WQ_PRIO_HIGH] = 'H',
+	};
 	struct listnode *node;
 	struct work_queue *wq;
+	struct work_queue_sched *sched;
+
+	for (ALL_LIST_ELEMENTS_RO(work_queue_scheds, node, sched))
+		vty_out(vty,
+			"Scheduler: slice %lu us, %lu runs, %lu preempted, max run %" PRIu64
+			" us\n",
+			sched->slice, sched->passes, sched->preempted,
+			sched->runtime_max);
 
 	vty_out(vty, "%c %8s %5s %8s %8s %21s\n", ' ', "List", "(ms) ",
 		"Q. Runs", "Yields", "Cycle Counts   ");
@@ -197,6 +314,24 @@ DEFUN (show_work_queues,
 			wq->name);
 	}
 
+	vty_out(vty, "\n");
+	vty_out(vty, "%c %8s %10s %10s %10s %10s %10s %s\n", ' ', "Budget",
+		"Runtime", "Run Max", "Run Avg", "Wait Max", "Wait Avg", "");
+	vty_out(vty, "%c %8s %10s %10s %10s %10s %10s %s\n", 'P', "(us)",
+		"(ms)", "(us)", "(us)", "(us)", "(us)", "Name");
+
+	for (ALL_LIST_ELEMENTS_RO(work_queues, node, wq)) {
+		vty_out(vty,
+			"%c %8lu %10" PRIu64 " %10" PRIu64 " %10" PRIu64
+			" %10" PRIu64 " %10" PRIu64 " %s\n",
+			prio_chars[wq->spec.priority], wq->spec.yield,
+			wq->stats.runtime / 1000, wq->stats.runtime_max,
+			wq->runs ? wq->stats.runtime / wq->runs : 0,
+			wq->stats.wait_max,
+			wq->runs ? wq->stats.wait_total / wq->runs : 0,
+			wq->name);
+	}
+
 	return CMD_SUCCESS;
 }
 
@@ -211,6 +346,7 @@ void workqueue_cmd_init(void)
 void work_queue_plug(struct work_queue *wq)
 {
 	event_cancel(&wq->event);
+	work_queue_sched_del(wq);
 
 	UNSET_FLAG(wq->flags, WQ_UNPLUGGED);
 }
@@ -226,21 +362,30 @@ void work_queue_unplug(struct work_queue *wq)
 	work_queue_schedule(wq, wq->spec.hold);
 }
 
-/* timer thread to process a work queue
- * will reschedule itself if required,
- * otherwise work_queue_item_add
- */
+/* hold / retry timer expired, queue is ready to run */
 void work_queue_run(struct event *event)
 {
-	struct work_queue *wq;
+	struct work_queue *wq = EVENT_ARG(event);
+
+	assert(wq);
+
+	work_queue_sched_add(wq);
+}
+
+/* Process a work queue for up to its spec.yield time budget.  Reschedules
+ * the queue if required, otherwise calls the completion callback.  wq may be
+ * freed by the completion callback, so don't touch it after this returns.
+ */
+static void work_queue_process(struct work_queue *wq)
+{
 	struct work_queue_item *item, *titem;
 	wq_item_status ret = WQ_SUCCESS;
 	unsigned int cycles = 0;
 	char yielded = 0;
+	struct timeval start;
+	uint64_t runtime;
 
-	wq = EVENT_ARG(event);
-
-	assert(wq);
+	monotime(&start);
 
 	/* calculate cycle granularity:
 	 * list iteration == 1 run
@@ -317,7 +462,7 @@ void work_queue_run(struct event *event)
 
 		/* test if we should yield */
 		if (!(cycles % wq->cycles.granularity) &&
-		    event_should_yield(event)) {
+		    monotime_since(&start, NULL) > (int64_t)wq->spec.yield) {
 			yielded = 1;
 			goto stats;
 		}
@@ -354,6 +499,11 @@ stats:
 	if (yielded)
 		wq->yields++;
 
+	runtime = monotime_since(&start, NULL);
+	wq->stats.runtime += runtime;
+	if (runtime > wq->stats.runtime_max)
+		wq->stats.runtime_max = runtime;
+
 	/* Is the queue done yet? If it is, call the completion callback. */
 	if (!work_queue_empty(wq)) {
 		if (ret == WQ_QUEUE_BLOCKED)
@@ -364,3 +514,89 @@ stats:
 	} else if (wq->spec.completion_func)
 		wq->spec.completion_func(wq);
 }
+
+/* Pick the next queue to run:  a queue that has been passed over too often
+ * goes first, otherwise the head of the highest priority run queue.  Queues
+ * that became runnable after this scheduler run started wait for the next
+ * one, so each queue runs at most once per scheduler run.
+ */
+static struct work_queue *work_queue_sched_pick(struct work_queue_sched *sched,
+						const struct timeval *start)
+{
+	struct work_queue *wq, *best = NULL;
+	int prio;
+
+	/* run queues are in order of becoming runnable, so the head of each
+	 * has been waiting longest
+	 */
+	for (prio = 0; prio < WQ_PRIO_MAX; prio++) {
+		wq = work_queue_runq_first(&sched->runq[prio]);
+		if (wq && wq->skipped >= WORK_QUEUE_SCHED_MAX_SKIP &&
+		    (!best || wq->skipped > best->skipped))
+			best = wq;
+	}
+	if (best)
+		return best;
+
+	for (prio = WQ_PRIO_MAX - 1; prio >= 0; prio--) {
+		wq = work_queue_runq_first(&sched->runq[prio]);
+		if (wq && timercmp(&wq->runnable_since, start, <))
+			return wq;
+	}
+	return NULL;
+}
+
+static void work_queue_sched_run(struct event *event)
+{
+	struct work_queue_sched *sched = EVENT_ARG(event);
+	struct work_queue *wq;
+	struct timeval start;
+	uint64_t wait, runtime;
+	bool waiting = false;
+
+	monotime(&start);
+	sched->passes++;
+	sched->running = true;
+
+	while ((wq = work_queue_sched_pick(sched, &start))) {
+		work_queue_sched_del(wq);
+		wq->skipped = 0;
+
+		wait = monotime_since(&wq->runnable_since, NULL);
+		wq->stats.wait_total += wait;
+		if (wait > wq->stats.wait_max)
+			wq->stats.wait_max = wait;
+
+		work_queue_process(wq);
+
+		if (monotime_since(&start, NULL) >= (int64_t)sched->slice)
+			break;
+	}
+
+	sched->running = false;
+	if (sched->refcnt == 0) {
+		/* last work queue was freed by one of the callbacks */
+		work_queue_sched_free(sched);
+		return;
+	}
+
+	runtime = monotime_since(&start, NULL);
+	if (runtime > sched->runtime_max)
+		sched->runtime_max = runtime;
+
+	/* everyone that was already waiting got passed over this time */
+	for (int prio = 0; prio < WQ_PRIO_MAX; prio++) {
+		frr_each (work_queue_runq, &sched->runq[prio], wq) {
+			waiting = true;
+			if (timercmp(&wq->runnable_since, &start, <))
+				wq->skipped++;
+		}
+	}
+
+	if (waiting) {
+		sched->preempted++;
+		/* back to the event loop for I/O, then continue */
+		event_add_event(sched->master, work_queue_sched_run, sched, 0,
+				&sched->event);
+	}
+}
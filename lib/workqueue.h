@@ -10,6 +10,7 @@
 
 #include "memory.h"
 #include "queue.h"
+#include "typesafe.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -23,6 +24,23 @@ DECLARE_MTYPE(WORK_QUEUE);
 /* Retry for queue that is 'blocked' or 'retry later' */
 #define WORK_QUEUE_DEFAULT_RETRY 0
 
+/* Scheduling priority of a work queue.  All work queues on an event loop
+ * share one scheduler, which runs runnable queues in priority order (round
+ * robin among equal priorities) until the loop-wide timeslice is used up, and
+ * then returns to the event loop so I/O and timers get serviced.  A queue
+ * that has been passed over WORK_QUEUE_SCHED_MAX_SKIP times is run first
+ * regardless of its priority, so low priority queues can't starve.
+ */
+enum work_queue_prio {
+	WQ_PRIO_LOW = 0,
+	WQ_PRIO_NORMAL,
+	WQ_PRIO_HIGH,
+
+	WQ_PRIO_MAX,
+};
+
+#define WORK_QUEUE_SCHED_MAX_SKIP 8
+
 /* action value, for use by item processor and item error handlers */
 typedef enum {
 	WQ_SUCCESS = 0,
@@ -41,6 +59,8 @@ struct work_queue_item {
 
 #define WQ_UNPLUGGED	(1 << 0) /* available for draining */
 
+PREDECL_DLIST(work_queue_runq);
+
 struct work_queue {
 	/* Everything but the specification struct is private
 	 * the following may be read
@@ -74,8 +94,11 @@ struct work_queue {
 
 		unsigned int hold; /* hold time for first run, in ms */
 
-		unsigned long
-			yield; /* yield time in us for associated thread */
+		/* time budget in us for one run of the queue */
+		unsigned long yield;
+
+		/* priority against other queues on the same event loop */
+		enum work_queue_prio priority;
 
 		uint32_t retry; /* Optional retry timeout if queue is blocked */
 	} spec;
@@ -93,8 +116,23 @@ struct work_queue {
 		unsigned long total;
 	} cycles; /* cycle counts */
 
+	struct {
+		uint64_t runtime;     /* total time spent running, us */
+		uint64_t runtime_max; /* longest single run, us */
+		uint64_t wait_total;  /* total time runnable but not run, us */
+		uint64_t wait_max;    /* longest wait for a timeslice, us */
+	} stats;
+
 	/* private state */
 	uint16_t flags; /* user set flag */
+
+	/* scheduler state */
+	struct work_queue_sched *sched;
+	struct work_queue_runq_item runq_item;
+	enum work_queue_prio runq_prio;
+	bool runnable;
+	unsigned int skipped;
+	struct timeval runnable_since;
 };
 
 /* User API */
@@ -139,6 +177,14 @@ extern void work_queue_unplug(struct work_queue *wq);
 
 bool work_queue_is_scheduled(struct work_queue *wq);
 
+/* Set the loop-wide timeslice, in us, for all work queues on the given event
+ * loop.  Once that much time has been spent running work queues, control is
+ * returned to the event loop before the next queue gets to run.  A queue that
+ * is picked always gets its own spec.yield budget, so the longest stretch
+ * without servicing I/O is bounded by the slice plus the largest budget.
+ */
+extern void work_queue_sched_slice(struct event_loop *m, unsigned long usec);
+
 /* Helpers, exported for thread.c and command.c */
 extern void work_queue_run(struct event *event);
 
@@ -384,6 +384,11 @@ enum zclient_send_status zclient_send_message(struct zclient *zclient)
 {
 	if (zclient->sock < 0)
 		return ZCLIENT_SEND_FAILURE;
+	if (zclient->corked) {
+		buffer_put(zclient->wb, STREAM_DATA(zclient->obuf),
+			   stream_get_endp(zclient->obuf));
+		return ZCLIENT_SEND_BUFFERED;
+	}
 	switch (buffer_write(zclient->wb, zclient->sock,
 			     STREAM_DATA(zclient->obuf),
 			     stream_get_endp(zclient->obuf))) {
@@ -405,6 +410,37 @@ enum zclient_send_status zclient_send_message(struct zclient *zclient)
 	return ZCLIENT_SEND_SUCCESS;
 }
 
+void zclient_cork(struct zclient *zclient)
+{
+	zclient->corked = true;
+}
+
+void zclient_uncork(struct zclient *zclient)
+{
+	if (!zclient->corked)
+		return;
+	zclient->corked = false;
+
+	if (zclient->sock < 0 || buffer_empty(zclient->wb)
+	    || event_is_scheduled(zclient->t_write))
+		return;
+
+	switch (buffer_flush_available(zclient->wb, zclient->sock)) {
+	case BUFFER_ERROR:
+		flog_err(EC_LIB_ZAPI_SOCKET,
+			 "%s: buffer_flush_available failed on zclient fd %d, closing",
+			 __func__, zclient->sock);
+		zclient_failed(zclient);
+		break;
+	case BUFFER_PENDING:
+		event_add_write(zclient->master, zclient_flush_data, zclient,
+				zclient->sock, &zclient->t_write);
+		break;
+	case BUFFER_EMPTY:
+		break;
+	}
+}
+
 /*
  * If we add more data to this structure please ensure that
  * struct zmsghdr in lib/zclient.h is updated as appropriate.
@@ -238,7 +238,16 @@ typedef enum {
 	ZEBRA_TC_FILTER_DELETE,
 	ZEBRA_OPAQUE_NOTIFY,
 	ZEBRA_SRV6_SID_NOTIFY,
+	ZEBRA_IPMR_ROUTE_STATS_BULK,
 } zebra_message_types_t;
+
+/*
+ * ZEBRA_IPMR_ROUTE_STATS_BULK asks for the counters of all mroutes of a
+ * vrf.  The answer is split over as many messages as needed, the last one
+ * carries this flag.
+ */
+#define ZAPI_IPMR_STATS_BULK_LAST 0x01
+
 /* Zebra message types. Please update the corresponding
  * command_types array with any changes!
  */
@@ -346,6 +355,9 @@ struct zclient {
 	/* Buffer of data waiting to be written to zebra. */
 	struct buffer *wb;
 
+	/* Messages are only queued in wb until zclient_uncork() */
+	bool corked;
+
 	/* Read and connect thread. */
 	struct event *t_read;
 	struct event *t_connect;
@@ -1033,6 +1045,11 @@ extern void zclient_redistribute_default(int command, struct zclient *zclient, a
  *  1 data was buffered for future usage
  */
 extern enum zclient_send_status zclient_send_message(struct zclient *zclient);
+/* Hold messages back while a burst of updates is generated, so that they go
+ * out in as few writes as possible.
+ */
+extern void zclient_cork(struct zclient *zclient);
+extern void zclient_uncork(struct zclient *zclient);
 
 /* create header for command, length to be filled in by user later */
 extern void zclient_create_header(struct stream *s, uint16_t command, vrf_id_t vrf_id);
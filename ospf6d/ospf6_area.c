@@ -502,7 +502,10 @@ void ospf6_area_show(struct vty *vty, struct ospf6_area *oa,
 			}
 		} else
 			json_object_boolean_false_add(json_area, "spfHasRun");
-
+		json_object_int_add(json_area, "intraRouteCalculationsFull",
+				    oa->intra_calculation_full);
+		json_object_int_add(json_area, "intraRouteCalculationsChanged",
+				    oa->intra_calculation_changed);
 
 		json_object_object_add(json_areas, oa->name, json_area);
 
@@ -542,6 +545,10 @@ void ospf6_area_show(struct vty *vty, struct ospf6_area *oa,
 			}
 		} else
 			vty_out(vty, "SPF has not been run\n");
+		vty_out(vty,
+			"     Intra-area routes recalculated %u times fully, %u times for changed vertices\n",
+			oa->intra_calculation_full,
+			oa->intra_calculation_changed);
 	}
 }
 
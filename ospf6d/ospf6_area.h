@@ -59,6 +59,9 @@ struct ospf6_area {
 	struct ospf6_route_table *route_table;
 
 	uint32_t spf_calculation; /* SPF calculation count */
+	/* intra-area route calculations over all / only changed vertices */
+	uint32_t intra_calculation_full;
+	uint32_t intra_calculation_changed;
 
 	struct event *thread_router_lsa;
 	struct event *thread_intra_prefix_lsa;
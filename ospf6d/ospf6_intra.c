@@ -1596,11 +1596,16 @@ void ospf6_intra_prefix_route_ecmp_path(struct ospf6_area *oa,
 	}
 }
 
-void ospf6_intra_prefix_lsa_add(struct ospf6_lsa *lsa)
+/* Install the prefixes of an Intra-Area-Prefix LSA, restricted to those in
+ * dests unless that is NULL.
+ */
+static void ospf6_intra_prefix_lsa_add_dests(struct ospf6_lsa *lsa,
+					     struct route_table *dests)
 {
 	struct ospf6_area *oa;
 	struct ospf6_intra_prefix_lsa *intra_prefix_lsa;
-	struct prefix ls_prefix;
+	struct prefix ls_prefix, prefix;
+	struct route_node *rn;
 	struct ospf6_route *route, *ls_entry, *old;
 	int prefix_num;
 	struct ospf6_prefix *op;
@@ -1669,13 +1674,23 @@ void ospf6_intra_prefix_lsa_add(struct ospf6_lsa *lsa)
 			continue;
 		}
 
+		memset(&prefix, 0, sizeof(prefix));
+		prefix.family = AF_INET6;
+		prefix.prefixlen = op->prefix_length;
+		ospf6_prefix_in6_addr(&prefix.u.prefix6, intra_prefix_lsa, op);
+
+		if (dests) {
+			rn = route_node_lookup(dests, &prefix);
+			if (!rn) {
+				prefix_num--;
+				continue;
+			}
+			route_unlock_node(rn);
+		}
+
 		route = ospf6_route_create(oa->ospf6);
 
-		memset(&route->prefix, 0, sizeof(struct prefix));
-		route->prefix.family = AF_INET6;
-		route->prefix.prefixlen = op->prefix_length;
-		ospf6_prefix_in6_addr(&route->prefix.u.prefix6,
-				      intra_prefix_lsa, op);
+		prefix_copy(&route->prefix, &prefix);
 		route->prefix_options = op->prefix_options;
 
 		route->type = OSPF6_DEST_TYPE_NETWORK;
@@ -1740,6 +1755,11 @@ void ospf6_intra_prefix_lsa_add(struct ospf6_lsa *lsa)
 		zlog_debug("Trailing garbage ignored");
 }
 
+void ospf6_intra_prefix_lsa_add(struct ospf6_lsa *lsa)
+{
+	ospf6_intra_prefix_lsa_add_dests(lsa, NULL);
+}
+
 static void ospf6_intra_prefix_lsa_remove_update_route(struct ospf6_lsa *lsa,
 						  struct ospf6_area *oa,
 						  struct ospf6_route *route)
@@ -1915,6 +1935,44 @@ void ospf6_intra_prefix_lsa_remove(struct ospf6_lsa *lsa)
 		zlog_debug("Trailing garbage ignored");
 }
 
+/* Settle a route after its Intra-Area-Prefix LSAs have been re-added with
+ * the table hooks disabled.
+ */
+static void ospf6_intra_route_finish(struct ospf6_area *oa,
+				     struct ospf6_route *route,
+				     void (*hook_add)(struct ospf6_route *))
+{
+	if (IS_OSPF6_DEBUG_EXAMIN(INTRA_PREFIX))
+		zlog_debug("%s: route %pFX, flag 0x%x", __func__,
+			   &route->prefix, route->flag);
+
+	if (CHECK_FLAG(route->flag, OSPF6_ROUTE_REMOVE)
+	    && CHECK_FLAG(route->flag, OSPF6_ROUTE_ADD)) {
+		UNSET_FLAG(route->flag, OSPF6_ROUTE_REMOVE);
+		UNSET_FLAG(route->flag, OSPF6_ROUTE_ADD);
+	}
+
+	if (CHECK_FLAG(route->flag, OSPF6_ROUTE_REMOVE))
+		ospf6_route_remove(route, oa->route_table);
+	else if (CHECK_FLAG(route->flag, OSPF6_ROUTE_ADD)
+		 || CHECK_FLAG(route->flag, OSPF6_ROUTE_CHANGE)) {
+		if (hook_add)
+			(*hook_add)(route);
+		route->flag = 0;
+	} else {
+		/* Redo the summaries as things might have changed.
+		 * Note: Not strictly needed since we're called by
+		 * ospf6_spf_calculation_thread() which calls
+		 * ospf6_abr_task() anyway, but make it explicit.
+		 */
+		if (IS_OSPF6_DEBUG_EXAMIN(INTRA_PREFIX))
+			zlog_debug("%s: Schedule summary origination for route %pFX",
+				   __func__, &route->prefix);
+		ospf6_schedule_abr_task(oa->ospf6);
+		route->flag = 0;
+	}
+}
+
 void ospf6_intra_route_calculation(struct ospf6_area *oa)
 {
 	struct ospf6_route *route, *nroute;
@@ -1922,7 +1980,6 @@ void ospf6_intra_route_calculation(struct ospf6_area *oa)
 	struct ospf6_lsa *lsa;
 	void (*hook_add)(struct ospf6_route *) = NULL;
 	void (*hook_remove)(struct ospf6_route *) = NULL;
-	char buf[PREFIX2STR_BUFFER];
 
 	if (IS_OSPF6_DEBUG_EXAMIN(INTRA_PREFIX))
 		zlog_debug("Re-examin intra-routes for area %s", oa->name);
@@ -1944,42 +2001,170 @@ void ospf6_intra_route_calculation(struct ospf6_area *oa)
 	oa->route_table->hook_remove = hook_remove;
 
 	for (route = ospf6_route_head(oa->route_table); route; route = nroute) {
-		if (IS_OSPF6_DEBUG_EXAMIN(INTRA_PREFIX)) {
-			prefix2str(&route->prefix, buf, sizeof(buf));
-			zlog_debug("%s: route %s, flag 0x%x", __func__, buf,
-				   route->flag);
+		nroute = ospf6_route_next(route);
+		ospf6_intra_route_finish(oa, route, hook_add);
+	}
+
+	if (IS_OSPF6_DEBUG_EXAMIN(INTRA_PREFIX))
+		zlog_debug("Re-examin intra-routes for area %s: Done",
+			   oa->name);
+}
+
+/* Remember an Intra-Area-Prefix LSA and, with dests, the prefixes it
+ * carries
+ */
+static void ospf6_intra_changed_lsa(struct ospf6_lsa *lsa,
+				    struct route_table *lsas,
+				    struct route_table *dests)
+{
+	struct ospf6_intra_prefix_lsa *intra_prefix_lsa;
+	struct ospf6_prefix *op;
+	struct route_node *rn;
+	struct prefix prefix;
+	char *current, *end;
+	int prefix_num;
+
+	if (OSPF6_LSA_IS_MAXAGE(lsa))
+		return;
+
+	ospf6_linkstate_prefix(lsa->header->adv_router, lsa->header->id,
+			       &prefix);
+	rn = route_node_get(lsas, &prefix);
+	if (rn->info) {
+		route_unlock_node(rn);
+		return;
+	}
+	rn->info = lsa;
+
+	if (!dests)
+		return;
+
+	intra_prefix_lsa = lsa_after_header(lsa->header);
+	prefix_num = ntohs(intra_prefix_lsa->prefix_num);
+	end = ospf6_lsa_end(lsa->header);
+	for (current = (caddr_t)intra_prefix_lsa
+		       + sizeof(struct ospf6_intra_prefix_lsa);
+	     current < end && prefix_num; current += OSPF6_PREFIX_SIZE(op)) {
+		op = (struct ospf6_prefix *)current;
+		if (end < current + OSPF6_PREFIX_SIZE(op))
+			break;
+		prefix_num--;
+		if (CHECK_FLAG(op->prefix_options, OSPF6_PREFIX_OPTION_NU))
+			continue;
+
+		memset(&prefix, 0, sizeof(prefix));
+		prefix.family = AF_INET6;
+		prefix.prefixlen = op->prefix_length;
+		ospf6_prefix_in6_addr(&prefix.u.prefix6, intra_prefix_lsa, op);
+
+		rn = route_node_get(dests, &prefix);
+		if (rn->info)
+			route_unlock_node(rn);
+		else
+			rn->info = (void *)1;
+	}
+}
+
+/*
+ * Same result as ospf6_intra_route_calculation(), but only redoing the
+ * routes that depend on the vertices whose cost or nexthops changed in the
+ * last SPF run.  Changes of the Intra-Area-Prefix LSAs themselves are
+ * applied as they are received, so all other routes are still correct.
+ */
+void ospf6_intra_route_calculation_changed(struct ospf6_area *oa,
+					   struct route_table *changed)
+{
+	struct route_table *lsas, *dests;
+	struct route_node *rn;
+	struct ospf6_route *route, *nroute;
+	struct ospf6_intra_prefix_lsa *intra_prefix_lsa;
+	struct ospf6_lsa *lsa;
+	struct ospf6_path *path;
+	struct listnode *node;
+	uint32_t adv_router;
+	uint16_t type;
+	void (*hook_add)(struct ospf6_route *) = NULL;
+	void (*hook_remove)(struct ospf6_route *) = NULL;
+
+	if (IS_OSPF6_DEBUG_EXAMIN(INTRA_PREFIX))
+		zlog_debug("Re-examin intra-routes of changed vertices for area %s",
+			   oa->name);
+
+	lsas = route_table_init();
+	dests = route_table_init();
+	type = htons(OSPF6_LSTYPE_INTRA_PREFIX);
+
+	/* Intra-Area-Prefix LSAs referencing a changed vertex are originated
+	 * by the router (or DR) the vertex stands for.
+	 */
+	for (rn = route_top(changed); rn; rn = route_next(rn)) {
+		if (!rn->info)
+			continue;
+
+		adv_router = ospf6_linkstate_prefix_adv_router(&rn->p);
+		for (ALL_LSDB_TYPED_ADVRTR(oa->lsdb, type, adv_router, lsa)) {
+			intra_prefix_lsa = lsa_after_header(lsa->header);
+			if (intra_prefix_lsa->ref_adv_router != adv_router
+			    || intra_prefix_lsa->ref_id
+				       != ospf6_linkstate_prefix_id(&rn->p))
+				continue;
+			ospf6_intra_changed_lsa(lsa, lsas, dests);
 		}
+	}
 
-		nroute = ospf6_route_next(route);
-		if (CHECK_FLAG(route->flag, OSPF6_ROUTE_REMOVE)
-		    && CHECK_FLAG(route->flag, OSPF6_ROUTE_ADD)) {
-			UNSET_FLAG(route->flag, OSPF6_ROUTE_REMOVE);
-			UNSET_FLAG(route->flag, OSPF6_ROUTE_ADD);
+	/* The routes to those prefixes are rebuilt from scratch, so the LSAs
+	 * contributing other paths to them need to be re-added as well.
+	 */
+	for (rn = route_top(dests); rn; rn = route_next(rn)) {
+		if (!rn->info)
+			continue;
+
+		for (route = ospf6_route_lookup(&rn->p, oa->route_table);
+		     route && prefix_same(&route->prefix, &rn->p);
+		     route = route->next) {
+			route->flag = OSPF6_ROUTE_REMOVE;
+			for (ALL_LIST_ELEMENTS_RO(route->paths, node, path)) {
+				lsa = ospf6_lsdb_lookup(path->origin.type,
+							path->origin.id,
+							path->origin.adv_router,
+							oa->lsdb);
+				if (lsa)
+					ospf6_intra_changed_lsa(lsa, lsas,
+								NULL);
+			}
 		}
+	}
 
-		if (CHECK_FLAG(route->flag, OSPF6_ROUTE_REMOVE))
-			ospf6_route_remove(route, oa->route_table);
-		else if (CHECK_FLAG(route->flag, OSPF6_ROUTE_ADD)
-			 || CHECK_FLAG(route->flag, OSPF6_ROUTE_CHANGE)) {
-			if (hook_add)
-				(*hook_add)(route);
-			route->flag = 0;
-		} else {
-			/* Redo the summaries as things might have changed.
-			 * Note: Not strictly needed since we're called by
-			 * ospf6_spf_calculation_thread() which calls
-			 * ospf6_abr_task() anyway, but make it explicit.
-			 */
-			if (IS_OSPF6_DEBUG_EXAMIN(INTRA_PREFIX))
-				zlog_debug("%s: Schedule summary origination for route %s",
-					   __func__, buf);
-			ospf6_schedule_abr_task(oa->ospf6);
-			route->flag = 0;
+	hook_add = oa->route_table->hook_add;
+	hook_remove = oa->route_table->hook_remove;
+	oa->route_table->hook_add = NULL;
+	oa->route_table->hook_remove = NULL;
+
+	for (rn = route_top(lsas); rn; rn = route_next(rn))
+		if (rn->info)
+			ospf6_intra_prefix_lsa_add_dests(rn->info, dests);
+
+	oa->route_table->hook_add = hook_add;
+	oa->route_table->hook_remove = hook_remove;
+
+	for (rn = route_top(dests); rn; rn = route_next(rn)) {
+		if (!rn->info)
+			continue;
+
+		for (route = ospf6_route_lookup(&rn->p, oa->route_table);
+		     route && prefix_same(&route->prefix, &rn->p);
+		     route = nroute) {
+			nroute = route->next;
+			if (route->flag)
+				ospf6_intra_route_finish(oa, route, hook_add);
 		}
 	}
 
+	route_table_finish(lsas);
+	route_table_finish(dests);
+
 	if (IS_OSPF6_DEBUG_EXAMIN(INTRA_PREFIX))
-		zlog_debug("Re-examin intra-routes for area %s: Done",
+		zlog_debug("Re-examin intra-routes of changed vertices for area %s: Done",
 			   oa->name);
 }
 
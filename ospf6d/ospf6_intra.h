@@ -186,6 +186,8 @@ extern void ospf6_intra_prefix_lsa_add(struct ospf6_lsa *lsa);
 extern void ospf6_intra_prefix_lsa_remove(struct ospf6_lsa *lsa);
 extern void ospf6_orig_as_external_lsa(struct event *event);
 extern void ospf6_intra_route_calculation(struct ospf6_area *oa);
+extern void ospf6_intra_route_calculation_changed(struct ospf6_area *oa,
+						  struct route_table *changed);
 extern void ospf6_intra_brouter_calculation(struct ospf6_area *oa);
 extern void ospf6_intra_prefix_route_ecmp_path(struct ospf6_area *oa,
 					       struct ospf6_route *old,
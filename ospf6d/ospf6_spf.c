@@ -589,6 +589,91 @@ static void ospf6_spf_log_database(struct ospf6_area *oa)
 	zlog_debug("%s", buffer);
 }
 
+/* Collect the vertices whose cost or nexthops differ between two SPF runs,
+ * returns how many there are.
+ */
+static unsigned int ospf6_spf_table_diff(struct ospf6_route_table *old,
+					 struct ospf6_route_table *new,
+					 struct route_table *changed)
+{
+	struct ospf6_route *route, *other;
+	struct route_node *rn;
+	unsigned int count = 0;
+
+	for (route = ospf6_route_head(old); route;
+	     route = ospf6_route_next(route)) {
+		other = ospf6_route_lookup(&route->prefix, new);
+		if (other && other->path.cost == route->path.cost
+		    && ospf6_route_cmp_nexthops(other, route))
+			continue;
+
+		rn = route_node_get(changed, &route->prefix);
+		if (rn->info) {
+			route_unlock_node(rn);
+			continue;
+		}
+		rn->info = (void *)1;
+		count++;
+	}
+
+	for (route = ospf6_route_head(new); route;
+	     route = ospf6_route_next(route)) {
+		if (ospf6_route_lookup(&route->prefix, old))
+			continue;
+
+		rn = route_node_get(changed, &route->prefix);
+		if (rn->info) {
+			route_unlock_node(rn);
+			continue;
+		}
+		rn->info = (void *)1;
+		count++;
+	}
+
+	return count;
+}
+
+/* Run SPF for an area and update its intra-area routes.  Unless the whole
+ * configuration might have changed, only the routes through vertices that
+ * ended up with a different cost or nexthops are recalculated.
+ */
+static void ospf6_spf_area_calculation(struct ospf6 *ospf6,
+				       struct ospf6_area *oa)
+{
+	struct ospf6_route_table *old_table = oa->spf_table;
+	struct route_table *changed;
+	unsigned int nchanged;
+
+	oa->spf_table = OSPF6_ROUTE_TABLE_CREATE(AREA, SPF_RESULTS);
+	oa->spf_table->scope = oa;
+	ospf6_spf_calculation(ospf6->router_id, oa->spf_table, oa);
+
+	changed = route_table_init();
+	nchanged = ospf6_spf_table_diff(old_table, oa->spf_table, changed);
+
+	if (CHECK_FLAG(ospf6->spf_reason, OSPF6_SPF_FLAGS_CONFIG_CHANGE
+						  | OSPF6_SPF_FLAGS_GR_FINISH)
+	    || nchanged * 2 > oa->spf_table->count) {
+		if (IS_OSPF6_DEBUG_SPF(PROCESS))
+			zlog_debug("SPF for Area %s: %u of %u vertices changed, full intra-area route calculation",
+				   oa->name, nchanged, oa->spf_table->count);
+		ospf6_intra_route_calculation(oa);
+		oa->intra_calculation_full++;
+	} else if (nchanged) {
+		if (IS_OSPF6_DEBUG_SPF(PROCESS))
+			zlog_debug("SPF for Area %s: %u of %u vertices changed",
+				   oa->name, nchanged, oa->spf_table->count);
+		ospf6_intra_route_calculation_changed(oa, changed);
+		oa->intra_calculation_changed++;
+	}
+
+	route_table_finish(changed);
+	ospf6_spf_table_finish(old_table);
+	ospf6_route_table_delete(old_table);
+
+	ospf6_intra_brouter_calculation(oa);
+}
+
 static void ospf6_spf_calculation_thread(struct event *t)
 {
 	struct ospf6_area *oa;
@@ -607,6 +692,9 @@ static void ospf6_spf_calculation_thread(struct event *t)
 	if (ospf6_check_and_set_router_abr(ospf6))
 		ospf6_abr_range_reset_cost(ospf6);
 
+	/* queue all resulting route updates and send them to zebra at once */
+	zclient_cork(ospf6_zclient);
+
 	for (ALL_LIST_ELEMENTS_RO(ospf6->area_list, node, oa)) {
 
 		if (oa == ospf6->backbone)
@@ -618,9 +706,7 @@ static void ospf6_spf_calculation_thread(struct event *t)
 		if (IS_OSPF6_DEBUG_SPF(DATABASE))
 			ospf6_spf_log_database(oa);
 
-		ospf6_spf_calculation(ospf6->router_id, oa->spf_table, oa);
-		ospf6_intra_route_calculation(oa);
-		ospf6_intra_brouter_calculation(oa);
+		ospf6_spf_area_calculation(ospf6, oa);
 
 		areas_processed++;
 	}
@@ -633,11 +719,7 @@ static void ospf6_spf_calculation_thread(struct event *t)
 		if (IS_OSPF6_DEBUG_SPF(DATABASE))
 			ospf6_spf_log_database(ospf6->backbone);
 
-		ospf6_spf_calculation(ospf6->router_id,
-				      ospf6->backbone->spf_table,
-				      ospf6->backbone);
-		ospf6_intra_route_calculation(ospf6->backbone);
-		ospf6_intra_brouter_calculation(ospf6->backbone);
+		ospf6_spf_area_calculation(ospf6, ospf6->backbone);
 		areas_processed++;
 	}
 
@@ -647,6 +729,8 @@ static void ospf6_spf_calculation_thread(struct event *t)
 	if (ospf6_check_and_set_router_abr(ospf6))
 		ospf6_abr_task(ospf6);
 
+	zclient_uncork(ospf6_zclient);
+
 	monotime(&end);
 	timersub(&end, &start, &runtime);
 
@@ -15,6 +15,7 @@
 #include "table.h"
 #include "vty.h"
 #include "log.h"
+#include "jhash.h"
 
 #include "ospfd/ospfd.h"
 #include "ospfd/ospf_interface.h"
@@ -30,6 +31,77 @@
 #include "ospfd/ospf_zebra.h"
 #include "ospfd/ospf_dump.h"
 
+DEFINE_MTYPE_STATIC(OSPFD, OSPF_ASE_DEP, "OSPF external route dependency");
+
+/*
+ * External route dependency index.
+ *
+ * Every AS-external-LSA (and Type-7) depends on the route to its ASBR and,
+ * if it has one, on the route to its forwarding address.  The index keeps
+ * the LSAs depending on each ASBR and forwarding address, along with what
+ * that dependency resolved to at the last calculation.  After SPF only the
+ * destinations of LSAs whose dependencies changed are recalculated, see
+ * ospf_ase_calculate_incremental().
+ */
+PREDECL_HASH(ospf_ase_deps);
+PREDECL_DLIST(ospf_ase_dep_lsas);
+
+struct ospf_ase_dep {
+	struct ospf_ase_deps_item item;
+
+	struct in_addr addr;
+	bool fwd_addr; /* forwarding address rather than ASBR */
+
+	struct ospf_ase_dep_lsas_head lsas;
+
+	/* What the dependency resolved to at the last calculation */
+	bool resolved;
+	bool local;		 /* forwarding address is our own */
+	struct prefix_ipv4 match; /* route matching the forwarding address */
+	struct ospf_route *route; /* copy, NULL if unreachable */
+};
+
+struct ospf_ase_dep_ref {
+	struct ospf_ase_dep_lsas_item item;
+	struct ospf_ase_dep *dep;
+	struct ospf_lsa *lsa;
+};
+
+/* Hung off an external LSA while it is registered */
+struct ospf_ase_lsa_deps {
+	struct ospf_ase_dep_ref asbr;
+	struct ospf_ase_dep_ref fwd;
+};
+
+struct ospf_ase_dep_index {
+	struct ospf_ase_deps_head deps;
+
+	/* Destinations with an intra or inter-area route at the last
+	 * calculation, these take precedence over external routes.
+	 */
+	struct route_table *shadow;
+
+	/* Snapshots are consistent with old_external_route */
+	bool valid;
+};
+
+static int ospf_ase_dep_cmp(const struct ospf_ase_dep *a,
+			    const struct ospf_ase_dep *b)
+{
+	if (a->fwd_addr != b->fwd_addr)
+		return a->fwd_addr ? 1 : -1;
+	return IPV4_ADDR_CMP(&a->addr, &b->addr);
+}
+
+static uint32_t ospf_ase_dep_hash(const struct ospf_ase_dep *dep)
+{
+	return jhash_2words(dep->addr.s_addr, dep->fwd_addr, 0);
+}
+
+DECLARE_HASH(ospf_ase_deps, struct ospf_ase_dep, item, ospf_ase_dep_cmp,
+	     ospf_ase_dep_hash);
+DECLARE_DLIST(ospf_ase_dep_lsas, struct ospf_ase_dep_ref, item);
+
 struct ospf_route *ospf_find_asbr_route(struct ospf *ospf,
 					struct route_table *rtrs,
 					struct prefix_ipv4 *asbr)
@@ -551,14 +623,427 @@ static int ospf_ase_compare_tables(struct ospf *ospf,
 	return 0;
 }
 
-static void ospf_ase_calculate_timer(struct event *t)
+static void ospf_ase_lsa_prefix(struct ospf_lsa *lsa, struct prefix_ipv4 *p)
+{
+	struct as_external_lsa *al = (struct as_external_lsa *)lsa->data;
+
+	p->family = AF_INET;
+	p->prefix = lsa->data->id;
+	p->prefixlen = ip_masklen(al->mask);
+	apply_mask_ipv4(p);
+}
+
+/* Add a destination to a set of destinations */
+static void ospf_ase_prefix_mark(struct route_table *rt, struct prefix *p)
+{
+	struct route_node *rn;
+
+	rn = route_node_get(rt, p);
+	if (rn->info)
+		route_unlock_node(rn);
+	else
+		rn->info = rt;
+}
+
+static bool ospf_ase_prefix_has_lsas(struct ospf *ospf, struct prefix *p)
+{
+	struct route_node *rn;
+	bool ret;
+
+	rn = route_node_lookup(ospf->external_lsas, p);
+	if (!rn)
+		return false;
+
+	ret = listcount((struct list *)rn->info) > 0;
+	route_unlock_node(rn);
+	return ret;
+}
+
+static struct ospf_route *ospf_ase_route_dup(const struct ospf_route *or)
+{
+	struct ospf_route *new;
+	struct list *paths;
+
+	new = ospf_route_new();
+	paths = new->paths;
+	*new = *or;
+	new->paths = paths;
+	ospf_route_copy_nexthops(new, or->paths);
+
+	return new;
+}
+
+static bool ospf_ase_dep_route_same(const struct ospf_route *or1,
+				    const struct ospf_route *or2)
+{
+	if (!or1 || !or2)
+		return or1 == or2;
+
+	return ospf_route_same(or1, or2) &&
+	       or1->u.std.flags == or2->u.std.flags &&
+	       or1->u.std.external_routing == or2->u.std.external_routing;
+}
+
+/* Resolve a dependency the same way ospf_ase_calculate_route() does. */
+static struct ospf_route *ospf_ase_dep_resolve(struct ospf *ospf,
+					       struct ospf_ase_dep *dep,
+					       struct prefix_ipv4 *match,
+					       bool *local)
+{
+	struct ospf_route *or = NULL;
+	struct prefix_ipv4 p;
+	struct route_node *rn;
+
+	p.family = AF_INET;
+	p.prefix = dep->addr;
+	p.prefixlen = IPV4_MAX_BITLEN;
+
+	if (!dep->fwd_addr)
+		return ospf_find_asbr_route(ospf, ospf->new_rtrs, &p);
+
+	*local = !ospf_ase_forward_address_check(ospf, dep->addr);
+
+	rn = route_node_match(ospf->new_table, (struct prefix *)&p);
+	if (rn) {
+		or = rn->info;
+		if (or)
+			prefix_copy(match, &rn->p);
+		route_unlock_node(rn);
+	}
+
+	return or;
+}
+
+/* Refresh the snapshot of a dependency, returns true if it changed. */
+static bool ospf_ase_dep_update(struct ospf *ospf, struct ospf_ase_dep *dep)
+{
+	struct prefix_ipv4 match = { .family = AF_INET };
+	struct ospf_route *or;
+	bool local = false;
+
+	or = ospf_ase_dep_resolve(ospf, dep, &match, &local);
+
+	if (dep->resolved && dep->local == local &&
+	    prefix_same(&dep->match, &match) &&
+	    ospf_ase_dep_route_same(dep->route, or))
+		return false;
+
+	if (dep->route)
+		ospf_route_free(dep->route);
+	dep->route = or ? ospf_ase_route_dup(or) : NULL;
+	dep->match = match;
+	dep->local = local;
+	dep->resolved = true;
+
+	return true;
+}
+
+static void ospf_ase_dep_ref_add(struct ospf_ase_dep_index *idx,
+				 struct ospf_ase_dep_ref *ref,
+				 struct ospf_lsa *lsa, struct in_addr addr,
+				 bool fwd_addr)
+{
+	struct ospf_ase_dep ref_dep = {}, *dep;
+
+	ref_dep.addr = addr;
+	ref_dep.fwd_addr = fwd_addr;
+
+	dep = ospf_ase_deps_find(&idx->deps, &ref_dep);
+	if (!dep) {
+		dep = XCALLOC(MTYPE_OSPF_ASE_DEP, sizeof(*dep));
+		dep->addr = addr;
+		dep->fwd_addr = fwd_addr;
+		ospf_ase_dep_lsas_init(&dep->lsas);
+		ospf_ase_deps_add(&idx->deps, dep);
+	}
+
+	ref->dep = dep;
+	ref->lsa = lsa;
+	ospf_ase_dep_lsas_add_tail(&dep->lsas, ref);
+}
+
+static void ospf_ase_dep_ref_del(struct ospf_ase_dep_index *idx,
+				 struct ospf_ase_dep_ref *ref)
+{
+	struct ospf_ase_dep *dep = ref->dep;
+
+	if (!dep)
+		return;
+
+	ospf_ase_dep_lsas_del(&dep->lsas, ref);
+	ref->dep = NULL;
+
+	if (ospf_ase_dep_lsas_count(&dep->lsas))
+		return;
+
+	ospf_ase_deps_del(&idx->deps, dep);
+	ospf_ase_dep_lsas_fini(&dep->lsas);
+	if (dep->route)
+		ospf_route_free(dep->route);
+	XFREE(MTYPE_OSPF_ASE_DEP, dep);
+}
+
+static void ospf_ase_lsa_deps_add(struct ospf *ospf, struct ospf_lsa *lsa)
+{
+	struct as_external_lsa *al = (struct as_external_lsa *)lsa->data;
+	struct ospf_ase_dep_index *idx = ospf->ase_deps;
+
+	if (lsa->ase_deps)
+		return;
+
+	if (!idx) {
+		idx = XCALLOC(MTYPE_OSPF_ASE_DEP, sizeof(*idx));
+		ospf_ase_deps_init(&idx->deps);
+		idx->shadow = route_table_init();
+		ospf->ase_deps = idx;
+	}
+
+	lsa->ase_deps = XCALLOC(MTYPE_OSPF_ASE_DEP, sizeof(*lsa->ase_deps));
+	ospf_ase_dep_ref_add(idx, &lsa->ase_deps->asbr, lsa,
+			     lsa->data->adv_router, false);
+	if (al->e[0].fwd_addr.s_addr != INADDR_ANY)
+		ospf_ase_dep_ref_add(idx, &lsa->ase_deps->fwd, lsa,
+				     al->e[0].fwd_addr, true);
+}
+
+static void ospf_ase_lsa_deps_del(struct ospf *ospf, struct ospf_lsa *lsa)
+{
+	if (!lsa->ase_deps)
+		return;
+
+	ospf_ase_dep_ref_del(ospf->ase_deps, &lsa->ase_deps->asbr);
+	ospf_ase_dep_ref_del(ospf->ase_deps, &lsa->ase_deps->fwd);
+	XFREE(MTYPE_OSPF_ASE_DEP, lsa->ase_deps);
+}
+
+/*
+ * Intra and inter-area routes take precedence over external routes to the
+ * same destination.  Mark the external destinations for which that changed
+ * since the last calculation and remember the current set.
+ */
+static void ospf_ase_shadow_update(struct ospf *ospf,
+				   struct route_table *affected)
+{
+	struct ospf_ase_dep_index *idx = ospf->ase_deps;
+	struct route_table *shadow;
+	struct route_node *rn, *srn;
+
+	shadow = route_table_init();
+	for (rn = route_top(ospf->new_table); rn; rn = route_next(rn)) {
+		if (!rn->info)
+			continue;
+
+		ospf_ase_prefix_mark(shadow, &rn->p);
+		if (!affected)
+			continue;
+
+		srn = route_node_lookup(idx->shadow, &rn->p);
+		if (srn)
+			route_unlock_node(srn);
+		else if (ospf_ase_prefix_has_lsas(ospf, &rn->p))
+			ospf_ase_prefix_mark(affected, &rn->p);
+	}
+
+	for (rn = affected ? route_top(idx->shadow) : NULL; rn;
+	     rn = route_next(rn)) {
+		if (!rn->info)
+			continue;
+
+		srn = route_node_lookup(shadow, &rn->p);
+		if (srn)
+			route_unlock_node(srn);
+		else if (ospf_ase_prefix_has_lsas(ospf, &rn->p))
+			ospf_ase_prefix_mark(affected, &rn->p);
+	}
+
+	route_table_finish(idx->shadow);
+	idx->shadow = shadow;
+}
+
+/*
+ * Recalculate the external routes to the given destinations, install the
+ * differences to zebra and move the results to ospf->old_external_route.
+ */
+static void ospf_ase_update_prefixes(struct ospf *ospf,
+				     struct route_table *affected)
+{
+	struct route_node *rn, *lrn, *orn, *nrn;
+	struct route_table *tmp_old;
+	struct listnode *node;
+	struct ospf_lsa *lsa;
+
+	for (rn = route_top(affected); rn; rn = route_next(rn)) {
+		if (!rn->info)
+			continue;
+
+		lrn = route_node_lookup(ospf->external_lsas, &rn->p);
+		if (!lrn)
+			continue;
+		for (ALL_LIST_ELEMENTS_RO((struct list *)lrn->info, node, lsa))
+			ospf_ase_calculate_route(ospf, lsa);
+		route_unlock_node(lrn);
+	}
+
+	/* prepare temporary old routing table for compare */
+	tmp_old = route_table_init();
+	for (rn = route_top(affected); rn; rn = route_next(rn)) {
+		if (!rn->info)
+			continue;
+
+		orn = route_node_lookup(ospf->old_external_route, &rn->p);
+		if (orn) {
+			route_node_get(tmp_old, &rn->p)->info = orn->info;
+			route_unlock_node(orn);
+		}
+	}
+
+	/* install changes to zebra */
+	ospf_ase_compare_tables(ospf, ospf->new_external_route, tmp_old);
+	route_table_finish(tmp_old);
+
+	/* update ospf->old_external_route table */
+	for (rn = route_top(affected); rn; rn = route_next(rn)) {
+		if (!rn->info)
+			continue;
+
+		orn = route_node_lookup(ospf->old_external_route, &rn->p);
+		if (orn) {
+			ospf_route_free(orn->info);
+			orn->info = NULL;
+			route_unlock_node(orn); /* route */
+			route_unlock_node(orn); /* route_node_lookup */
+		}
+
+		nrn = route_node_lookup(ospf->new_external_route, &rn->p);
+		if (nrn) {
+			orn = route_node_get(ospf->old_external_route,
+					     &rn->p);
+			orn->info = nrn->info;
+			nrn->info = NULL;
+			route_unlock_node(nrn); /* route */
+			route_unlock_node(nrn); /* route_node_lookup */
+		}
+	}
+}
+
+/* Recalculate the destinations whose ASBR or forwarding routes changed. */
+static unsigned long ospf_ase_calculate_incremental(struct ospf *ospf)
+{
+	struct ospf_ase_dep_index *idx = ospf->ase_deps;
+	struct ospf_ase_dep_ref *ref;
+	struct ospf_ase_dep *dep;
+	struct route_table *affected;
+	struct route_node *rn;
+	struct prefix_ipv4 p;
+	unsigned long count = 0;
+
+	affected = route_table_init();
+
+	frr_each (ospf_ase_deps, &idx->deps, dep) {
+		if (!ospf_ase_dep_update(ospf, dep))
+			continue;
+
+		if (IS_DEBUG_OSPF_EVENT)
+			zlog_debug("%s: %s %pI4 changed, %zu LSAs", __func__,
+				   dep->fwd_addr ? "forwarding address"
+						 : "ASBR",
+				   &dep->addr,
+				   ospf_ase_dep_lsas_count(&dep->lsas));
+
+		frr_each (ospf_ase_dep_lsas, &dep->lsas, ref) {
+			ospf_ase_lsa_prefix(ref->lsa, &p);
+			ospf_ase_prefix_mark(affected, (struct prefix *)&p);
+		}
+	}
+	ospf_ase_shadow_update(ospf, affected);
+
+	for (rn = route_top(affected); rn; rn = route_next(rn))
+		if (rn->info)
+			count++;
+	if (count)
+		ospf_ase_update_prefixes(ospf, affected);
+	route_table_finish(affected);
+
+	return count;
+}
+
+/* Take the snapshots after a full calculation. */
+static void ospf_ase_deps_refresh(struct ospf *ospf)
+{
+	struct ospf_ase_dep_index *idx = ospf->ase_deps;
+	struct ospf_ase_dep *dep;
+
+	if (!idx)
+		return;
+
+	frr_each (ospf_ase_deps, &idx->deps, dep)
+		ospf_ase_dep_update(ospf, dep);
+	ospf_ase_shadow_update(ospf, NULL);
+	idx->valid = true;
+}
+
+void ospf_ase_deps_finish(struct ospf *ospf)
+{
+	struct ospf_ase_dep_index *idx = ospf->ase_deps;
+	struct ospf_ase_dep_ref *ref;
+	struct ospf_ase_dep *dep;
+
+	if (!idx)
+		return;
+
+	while ((dep = ospf_ase_deps_first(&idx->deps))) {
+		ref = ospf_ase_dep_lsas_first(&dep->lsas);
+		ospf_ase_lsa_deps_del(ospf, ref->lsa);
+	}
+	ospf_ase_deps_fini(&idx->deps);
+	route_table_finish(idx->shadow);
+	XFREE(MTYPE_OSPF_ASE_DEP, ospf->ase_deps);
+}
+
+static void ospf_ase_calculate_full(struct ospf *ospf)
 {
-	struct ospf *ospf;
 	struct ospf_lsa *lsa;
 	struct route_node *rn;
 	struct listnode *node;
 	struct ospf_area *area;
+
+	/* Calculate external route for each AS-external-LSA */
+	LSDB_LOOP (EXTERNAL_LSDB(ospf), rn, lsa)
+		ospf_ase_calculate_route(ospf, lsa);
+
+	/*  This version simple adds to the table all NSSA areas  */
+	if (ospf->anyNSSA)
+		for (ALL_LIST_ELEMENTS_RO(ospf->areas, node, area)) {
+			if (IS_DEBUG_OSPF_NSSA)
+				zlog_debug("%s: looking at area %pI4",
+					   __func__, &area->area_id);
+
+			if (area->external_routing == OSPF_AREA_NSSA)
+				LSDB_LOOP (NSSA_LSDB(area), rn, lsa)
+					ospf_ase_calculate_route(ospf, lsa);
+		}
+	/* kevinm: And add the NSSA routes in ospf_top */
+	LSDB_LOOP (NSSA_LSDB(ospf), rn, lsa)
+		ospf_ase_calculate_route(ospf, lsa);
+
+	/* Compare old and new external routing table and install the
+	   difference info zebra/kernel */
+	ospf_ase_compare_tables(ospf, ospf->new_external_route,
+				ospf->old_external_route);
+
+	/* Delete old external routing table */
+	ospf_route_table_free(ospf->old_external_route);
+	ospf->old_external_route = ospf->new_external_route;
+	ospf->new_external_route = route_table_init();
+
+	ospf_ase_deps_refresh(ospf);
+}
+
+static void ospf_ase_calculate_timer(struct event *t)
+{
+	struct ospf *ospf;
 	struct timeval start_time, stop_time;
+	unsigned long count;
 
 	ospf = EVENT_ARG(t);
 	ospf->t_ase_calc = NULL;
@@ -568,35 +1053,23 @@ static void ospf_ase_calculate_timer(struct event *t)
 
 		monotime(&start_time);
 
-		/* Calculate external route for each AS-external-LSA */
-		LSDB_LOOP (EXTERNAL_LSDB(ospf), rn, lsa)
-			ospf_ase_calculate_route(ospf, lsa);
-
-		/*  This version simple adds to the table all NSSA areas  */
-		if (ospf->anyNSSA)
-			for (ALL_LIST_ELEMENTS_RO(ospf->areas, node, area)) {
-				if (IS_DEBUG_OSPF_NSSA)
-					zlog_debug("%s: looking at area %pI4",
-						   __func__, &area->area_id);
-
-				if (area->external_routing == OSPF_AREA_NSSA)
-					LSDB_LOOP (NSSA_LSDB(area), rn, lsa)
-						ospf_ase_calculate_route(ospf,
-									 lsa);
-			}
-		/* kevinm: And add the NSSA routes in ospf_top */
-		LSDB_LOOP (NSSA_LSDB(ospf), rn, lsa)
-			ospf_ase_calculate_route(ospf, lsa);
-
-		/* Compare old and new external routing table and install the
-		   difference info zebra/kernel */
-		ospf_ase_compare_tables(ospf, ospf->new_external_route,
-					ospf->old_external_route);
-
-		/* Delete old external routing table */
-		ospf_route_table_free(ospf->old_external_route);
-		ospf->old_external_route = ospf->new_external_route;
-		ospf->new_external_route = route_table_init();
+		/*
+		 * External routes only need to be recalculated where the
+		 * route to the ASBR or forwarding address changed, unless
+		 * something else (configuration, restart) invalidated them.
+		 */
+		if (!ospf->ase_calc_full && ospf->ase_deps &&
+		    ospf->ase_deps->valid) {
+			count = ospf_ase_calculate_incremental(ospf);
+			ospf->ase_incremental_runs++;
+			if (IS_DEBUG_OSPF_EVENT)
+				zlog_debug("%s: %lu external destinations recalculated",
+					   __func__, count);
+		} else {
+			ospf->ase_calc_full = false;
+			ospf_ase_calculate_full(ospf);
+			ospf->ase_full_runs++;
+		}
 
 		monotime(&stop_time);
 
@@ -642,13 +1115,8 @@ void ospf_ase_register_external_lsa(struct ospf_lsa *lsa, struct ospf *top)
 	struct route_node *rn;
 	struct prefix_ipv4 p;
 	struct list *lst;
-	struct as_external_lsa *al;
 
-	al = (struct as_external_lsa *)lsa->data;
-	p.family = AF_INET;
-	p.prefix = lsa->data->id;
-	p.prefixlen = ip_masklen(al->mask);
-	apply_mask_ipv4(&p);
+	ospf_ase_lsa_prefix(lsa, &p);
 
 	rn = route_node_get(top->external_lsas, (struct prefix *)&p);
 	if ((lst = rn->info) == NULL)
@@ -659,6 +1127,8 @@ void ospf_ase_register_external_lsa(struct ospf_lsa *lsa, struct ospf *top)
 	/* We assume that if LSA is deleted from DB
 	   is is also deleted from this RT */
 	listnode_add(lst, ospf_lsa_lock(lsa)); /* external_lsas lst */
+
+	ospf_ase_lsa_deps_add(top, lsa);
 }
 
 void ospf_ase_unregister_external_lsa(struct ospf_lsa *lsa, struct ospf *top)
@@ -666,13 +1136,8 @@ void ospf_ase_unregister_external_lsa(struct ospf_lsa *lsa, struct ospf *top)
 	struct route_node *rn;
 	struct prefix_ipv4 p;
 	struct list *lst;
-	struct as_external_lsa *al;
 
-	al = (struct as_external_lsa *)lsa->data;
-	p.family = AF_INET;
-	p.prefix = lsa->data->id;
-	p.prefixlen = ip_masklen(al->mask);
-	apply_mask_ipv4(&p);
+	ospf_ase_lsa_prefix(lsa, &p);
 
 	rn = route_node_lookup(top->external_lsas, (struct prefix *)&p);
 
@@ -682,6 +1147,8 @@ void ospf_ase_unregister_external_lsa(struct ospf_lsa *lsa, struct ospf *top)
 		/* Unlock lsa only if node is present in the list */
 		if (node) {
 			listnode_delete(lst, lsa);
+			if (!listnode_lookup(lst, lsa))
+				ospf_ase_lsa_deps_del(top, lsa);
 			ospf_lsa_unlock(&lsa); /* external_lsas list */
 		}
 
@@ -708,18 +1175,11 @@ void ospf_ase_external_lsas_finish(struct route_table *rt)
 
 void ospf_ase_incremental_update(struct ospf *ospf, struct ospf_lsa *lsa)
 {
-	struct list *lsas;
-	struct listnode *node;
-	struct route_node *rn, *rn2;
+	struct route_node *rn;
 	struct prefix_ipv4 p;
-	struct route_table *tmp_old;
-	struct as_external_lsa *al;
+	struct route_table *affected;
 
-	al = (struct as_external_lsa *)lsa->data;
-	p.family = AF_INET;
-	p.prefix = lsa->data->id;
-	p.prefixlen = ip_masklen(al->mask);
-	apply_mask_ipv4(&p);
+	ospf_ase_lsa_prefix(lsa, &p);
 
 	/* if new_table is NULL, there was no spf calculation, thus
 	   incremental update is unneeded */
@@ -737,53 +1197,8 @@ void ospf_ase_incremental_update(struct ospf *ospf, struct ospf_lsa *lsa)
 			return;
 	}
 
-	rn = route_node_lookup(ospf->external_lsas, (struct prefix *)&p);
-	assert(rn);
-	assert(rn->info);
-	lsas = rn->info;
-	route_unlock_node(rn);
-
-	for (ALL_LIST_ELEMENTS_RO(lsas, node, lsa))
-		ospf_ase_calculate_route(ospf, lsa);
-
-	/* prepare temporary old routing table for compare */
-	tmp_old = route_table_init();
-	rn = route_node_lookup(ospf->old_external_route, (struct prefix *)&p);
-	if (rn && rn->info) {
-		rn2 = route_node_get(tmp_old, (struct prefix *)&p);
-		rn2->info = rn->info;
-		route_unlock_node(rn);
-	}
-
-	/* install changes to zebra */
-	ospf_ase_compare_tables(ospf, ospf->new_external_route, tmp_old);
-
-	/* update ospf->old_external_route table */
-	if (rn && rn->info)
-		ospf_route_free((struct ospf_route *)rn->info);
-
-	rn2 = route_node_lookup(ospf->new_external_route, (struct prefix *)&p);
-	/* if new route exists, install it to ospf->old_external_route */
-	if (rn2 && rn2->info) {
-		if (!rn)
-			rn = route_node_get(ospf->old_external_route,
-					    (struct prefix *)&p);
-		rn->info = rn2->info;
-	} else {
-		/* remove route node from ospf->old_external_route */
-		if (rn) {
-			rn->info = NULL;
-			route_unlock_node(rn);
-		}
-	}
-
-	if (rn2) {
-		/* rn2->info is stored in route node of ospf->old_external_route
-		 */
-		rn2->info = NULL;
-		route_unlock_node(rn2);
-		route_unlock_node(rn2);
-	}
-
-	route_table_finish(tmp_old);
+	affected = route_table_init();
+	ospf_ase_prefix_mark(affected, (struct prefix *)&p);
+	ospf_ase_update_prefixes(ospf, affected);
+	route_table_finish(affected);
 }
@@ -18,6 +18,7 @@ extern void ospf_ase_calculate_schedule(struct ospf *ospf);
 extern void ospf_ase_calculate_timer_add(struct ospf *ospf);
 
 extern void ospf_ase_external_lsas_finish(struct route_table *rt);
+extern void ospf_ase_deps_finish(struct ospf *ospf);
 extern void ospf_ase_incremental_update(struct ospf *ospf, struct ospf_lsa *lsa);
 extern void ospf_ase_register_external_lsa(struct ospf_lsa *lsa, struct ospf *top);
 extern void ospf_ase_unregister_external_lsa(struct ospf_lsa *lsa, struct ospf *top);
@@ -50,6 +50,11 @@ struct ospf_if_params {
 			 retransmit_interval); /* Retransmission Interval */
 	DECLARE_IF_PARAM(uint32_t,
 			 retransmit_window); /* Retransmission Window */
+	/* LS Update pacing, packets per second (0 = unpaced) and burst */
+	DECLARE_IF_PARAM(uint32_t, ls_upd_pacing);
+	DECLARE_IF_PARAM(uint32_t, ls_upd_burst);
+#define OSPF_LS_UPD_PACING_DEFAULT 0
+#define OSPF_LS_UPD_BURST_DEFAULT  10
 	DECLARE_IF_PARAM(uint8_t, passive_interface); /* OSPF Interface is
 							passive: no sending or
 							receiving (no need to
@@ -276,12 +281,19 @@ struct ospf_interface {
 	/* Timer values. */
 	uint32_t v_ls_ack_delayed; /* Delayed Link State Acknowledgment */
 
+	/*
+	 * LS Update pacing token bucket, in thousandths of a packet, and the
+	 * last time it was refilled.
+	 */
+	uint32_t ls_upd_tokens;
+	struct timeval ls_upd_refill;
+
 	/* Threads. */
 	struct event *t_hello;		 /* timer */
 	struct event *t_wait;		 /* timer */
 	struct event *t_ls_ack_delayed;	 /* timer */
 	struct event *t_ls_ack_direct;	 /* event */
-	struct event *t_ls_upd_event;	 /* event */
+	struct event *t_ls_upd_event;	 /* event, or timer when paced */
 	struct event *t_opaque_lsa_self; /* Type-9 Opaque-LSAs */
 
 	int on_write_q;
@@ -295,6 +307,7 @@ struct ospf_interface {
 	uint32_t ls_req_out;   /* LS request message output count. */
 	uint32_t ls_upd_in;    /* LS update message input count. */
 	uint32_t ls_upd_out;   /* LS update message output count. */
+	uint32_t ls_upd_paced; /* LS update sends delayed by pacing. */
 	uint32_t ls_ack_in;    /* LS Ack message input count. */
 	uint32_t ls_ack_out;   /* LS Ack message output count. */
 	uint32_t discarded;    /* discarded input count by error. */
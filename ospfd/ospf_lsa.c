@@ -236,6 +236,7 @@ struct ospf_lsa *ospf_lsa_dup(struct ospf_lsa *lsa)
 	   queue (which it's not a member of.)
 	   XXX: Should we add the LSA to the refresh_list queue? */
 	new->refresh_list = -1;
+	new->ase_deps = NULL;
 
 	if (IS_DEBUG_OSPF(lsa, LSA))
 		zlog_debug("LSA: duplicated %p (new: %p)", (void *)lsa,
@@ -2945,6 +2946,7 @@ void ospf_discard_from_db(struct ospf *ospf, struct ospf_lsdb *lsdb,
 		break;
 	default:
 		ospf_ls_retransmit_delete_nbr_area(old->area, old);
+		ospf_spf_lsa_remove(old);
 		break;
 	}
 
@@ -3062,6 +3064,9 @@ struct ospf_lsa *ospf_lsa_install(struct ospf *ospf, struct ospf_interface *oi,
 		}
 	}
 
+	/* keep saved SPF trees in sync, see ospf_spf_calculate_area() */
+	ospf_spf_lsa_install(old, lsa);
+
 	/* discard old LSA from LSDB */
 	if (old != NULL) {
 		if (rt_recalc && !IS_LSA_SELF(lsa) && (lsa->data->type == OSPF_AS_EXTERNAL_LSA) &&
@@ -3353,6 +3358,8 @@ void ospf_lsa_maxage(struct ospf *ospf, struct ospf_lsa *lsa)
 		return;
 	}
 
+	ospf_spf_lsa_remove(lsa);
+
 	memset(&lsa_prefix, 0, sizeof(lsa_prefix));
 	lsa_prefix.family = AF_UNSPEC;
 	lsa_prefix.prefixlen = sizeof(lsa_prefix.u.ptr) * CHAR_BIT;
@@ -86,6 +86,9 @@ struct ospf_lsa {
 	/* Flags for the SPF calculation. */
 	struct vertex *stat;
 
+	/* Vertex index in the SPF kernel graph (ospf_spf_csr_build()). */
+	uint32_t spf_index;
+
 	/* References to this LSA in neighbor retransmission lists*/
 	int retransmit_counter;
 
@@ -98,6 +101,9 @@ struct ospf_lsa {
 	/* Related Route. */
 	void *route;
 
+	/* External route dependencies, see ospf_ase_register_external_lsa() */
+	struct ospf_ase_lsa_deps *ase_deps;
+
 	/* Refreshement List or Queue */
 	int refresh_list;
 
@@ -10,12 +10,36 @@
 #include "table.h"
 #include "memory.h"
 #include "log.h"
+#include "jhash.h"
 
 #include "ospfd/ospfd.h"
 #include "ospfd/ospf_asbr.h"
 #include "ospfd/ospf_lsa.h"
 #include "ospfd/ospf_lsdb.h"
 
+static int ospf_lsdb_hash_cmp(const struct ospf_lsdb_node *a,
+			      const struct ospf_lsdb_node *b)
+{
+	const struct prefix_ls *pa = (const struct prefix_ls *)&a->p;
+	const struct prefix_ls *pb = (const struct prefix_ls *)&b->p;
+
+	if (pa->id.s_addr != pb->id.s_addr)
+		return pa->id.s_addr < pb->id.s_addr ? -1 : 1;
+	if (pa->adv_router.s_addr != pb->adv_router.s_addr)
+		return pa->adv_router.s_addr < pb->adv_router.s_addr ? -1 : 1;
+	return 0;
+}
+
+static uint32_t ospf_lsdb_hash_key(const struct ospf_lsdb_node *node)
+{
+	const struct prefix_ls *lp = (const struct prefix_ls *)&node->p;
+
+	return jhash_2words(lp->id.s_addr, lp->adv_router.s_addr, 0);
+}
+
+DECLARE_HASH(ospf_lsdb_hash, struct ospf_lsdb_node, hash_item,
+	     ospf_lsdb_hash_cmp, ospf_lsdb_hash_key);
+
 struct ospf_lsdb *ospf_lsdb_new(void)
 {
 	struct ospf_lsdb *new;
@@ -26,12 +50,39 @@ struct ospf_lsdb *ospf_lsdb_new(void)
 	return new;
 }
 
+static struct route_node *ospf_lsdb_node_create(route_table_delegate_t *delegate,
+						 struct route_table *table)
+{
+	struct ospf_lsdb_node *node;
+
+	node = XCALLOC(MTYPE_OSPF_LSDB_NODE, sizeof(struct ospf_lsdb_node));
+
+	return (struct route_node *)node;
+}
+
+static void ospf_lsdb_node_destroy(route_table_delegate_t *delegate,
+				   struct route_table *table,
+				   struct route_node *node)
+{
+	struct ospf_lsdb_node *lsdb_node = (struct ospf_lsdb_node *)node;
+
+	XFREE(MTYPE_OSPF_LSDB_NODE, lsdb_node);
+}
+
+static route_table_delegate_t ospf_lsdb_table_delegate = {
+	.create_node = ospf_lsdb_node_create,
+	.destroy_node = ospf_lsdb_node_destroy,
+};
+
 void ospf_lsdb_init(struct ospf_lsdb *lsdb)
 {
 	int i;
 
-	for (i = OSPF_MIN_LSA; i < OSPF_MAX_LSA; i++)
-		lsdb->type[i].db = route_table_init();
+	for (i = OSPF_MIN_LSA; i < OSPF_MAX_LSA; i++) {
+		lsdb->type[i].db =
+			route_table_init_with_delegate(&ospf_lsdb_table_delegate);
+		ospf_lsdb_hash_init(&lsdb->type[i].hash);
+	}
 }
 
 static struct route_node *
@@ -65,26 +116,33 @@ void ospf_lsdb_linked_init(struct ospf_lsdb *lsdb)
 {
 	int i;
 
-	for (i = OSPF_MIN_LSA; i < OSPF_MAX_LSA; i++)
+	for (i = OSPF_MIN_LSA; i < OSPF_MAX_LSA; i++) {
 		lsdb->type[i].db = route_table_init_with_delegate(
 			&ospf_lsdb_linked_table_delegate);
+		ospf_lsdb_hash_init(&lsdb->type[i].hash);
+	}
 }
 
-struct ospf_lsdb_linked_node *ospf_lsdb_linked_lookup(struct ospf_lsdb *lsdb,
-						      struct ospf_lsa *lsa)
+/* Find the node holding the LSA with the given key, no lock is taken. */
+static struct route_node *ospf_lsdb_node_find(struct ospf_lsdb *lsdb,
+					      uint8_t type, struct in_addr id,
+					      struct in_addr adv_router)
 {
-	struct ospf_lsdb_linked_node *lsdb_linked_node;
-	struct route_table *table;
-	struct prefix_ls lp;
+	struct ospf_lsdb_node ref;
+	struct prefix_ls *lp = (struct prefix_ls *)&ref.p;
 
-	table = lsdb->type[lsa->data->type].db;
-	ls_prefix_set(&lp, lsa);
-	lsdb_linked_node = (struct ospf_lsdb_linked_node *)
-		route_node_lookup(table, (struct prefix *)&lp);
-	if (lsdb_linked_node)
-		route_unlock_node((struct route_node *)lsdb_linked_node);
+	lp->id = id;
+	lp->adv_router = adv_router;
 
-	return lsdb_linked_node;
+	return (struct route_node *)ospf_lsdb_hash_find(&lsdb->type[type].hash,
+							&ref);
+}
+
+struct ospf_lsdb_linked_node *ospf_lsdb_linked_lookup(struct ospf_lsdb *lsdb,
+						      struct ospf_lsa *lsa)
+{
+	return (struct ospf_lsdb_linked_node *)ospf_lsdb_node_find(
+		lsdb, lsa->data->type, lsa->data->id, lsa->data->adv_router);
 }
 
 void ospf_lsdb_free(struct ospf_lsdb *lsdb)
@@ -101,8 +159,10 @@ void ospf_lsdb_cleanup(struct ospf_lsdb *lsdb)
 
 	ospf_lsdb_delete_all(lsdb);
 
-	for (i = OSPF_MIN_LSA; i < OSPF_MAX_LSA; i++)
+	for (i = OSPF_MIN_LSA; i < OSPF_MAX_LSA; i++) {
+		ospf_lsdb_hash_fini(&lsdb->type[i].hash);
 		route_table_finish(lsdb->type[i].db);
+	}
 }
 
 void ls_prefix_set(struct prefix_ls *lp, struct ospf_lsa *lsa)
@@ -129,6 +189,8 @@ static void ospf_lsdb_delete_entry(struct ospf_lsdb *lsdb,
 		lsdb->type[lsa->data->type].count_self--;
 	lsdb->type[lsa->data->type].count--;
 	lsdb->type[lsa->data->type].checksum -= ntohs(lsa->data->checksum);
+	lsdb->type[lsa->data->type].mem -=
+		sizeof(struct ospf_lsa) + ntohs(lsa->data->length);
 	lsdb->total--;
 
 	/* Decrement number of router LSAs received with DC bit set */
@@ -145,6 +207,8 @@ static void ospf_lsdb_delete_entry(struct ospf_lsdb *lsdb,
 	    (lsa->area->fr_info.indication_lsa_self == lsa))
 		lsa->area->fr_info.indication_lsa_self = NULL;
 
+	ospf_lsdb_hash_del(&lsdb->type[lsa->data->type].hash,
+			   (struct ospf_lsdb_node *)rn);
 	rn->info = NULL;
 	route_unlock_node(rn);
 	ospf_lsa_unlock(&lsa); /* lsdb */
@@ -184,25 +248,27 @@ void ospf_lsdb_add(struct ospf_lsdb *lsdb, struct ospf_lsa *lsa)
 		lsa->area->fr_info.router_lsas_recv_dc_bit++;
 
 	lsdb->type[lsa->data->type].checksum += ntohs(lsa->data->checksum);
+	lsdb->type[lsa->data->type].mem +=
+		sizeof(struct ospf_lsa) + ntohs(lsa->data->length);
 	rn->info = ospf_lsa_lock(lsa); /* lsdb */
+	ospf_lsdb_hash_add(&lsdb->type[lsa->data->type].hash,
+			   (struct ospf_lsdb_node *)rn);
 }
 
 void ospf_lsdb_delete(struct ospf_lsdb *lsdb, struct ospf_lsa *lsa)
 {
-	struct route_table *table;
-	struct prefix_ls lp;
 	struct route_node *rn;
 
 	if (!lsdb || !lsa)
 		return;
 
 	assert(lsa->data->type < OSPF_MAX_LSA);
-	table = lsdb->type[lsa->data->type].db;
-	ls_prefix_set(&lp, lsa);
-	if ((rn = route_node_lookup(table, (struct prefix *)&lp))) {
-		if (rn->info == lsa)
-			ospf_lsdb_delete_entry(lsdb, rn);
-		route_unlock_node(rn); /* route_node_lookup */
+	rn = ospf_lsdb_node_find(lsdb, lsa->data->type, lsa->data->id,
+				 lsa->data->adv_router);
+	if (rn && rn->info == lsa) {
+		route_lock_node(rn);
+		ospf_lsdb_delete_entry(lsdb, rn);
+		route_unlock_node(rn);
 	}
 }
 
@@ -222,46 +288,23 @@ void ospf_lsdb_delete_all(struct ospf_lsdb *lsdb)
 
 struct ospf_lsa *ospf_lsdb_lookup(struct ospf_lsdb *lsdb, struct ospf_lsa *lsa)
 {
-	struct route_table *table;
-	struct prefix_ls lp;
 	struct route_node *rn;
-	struct ospf_lsa *find;
 
-	table = lsdb->type[lsa->data->type].db;
-	ls_prefix_set(&lp, lsa);
-	rn = route_node_lookup(table, (struct prefix *)&lp);
-	if (rn) {
-		find = rn->info;
-		route_unlock_node(rn);
-		return find;
-	}
-	return NULL;
+	rn = ospf_lsdb_node_find(lsdb, lsa->data->type, lsa->data->id,
+				 lsa->data->adv_router);
+
+	return rn ? rn->info : NULL;
 }
 
 struct ospf_lsa *ospf_lsdb_lookup_by_id(struct ospf_lsdb *lsdb, uint8_t type,
 					struct in_addr id,
 					struct in_addr adv_router)
 {
-	struct route_table *table;
-	struct prefix_ls lp;
 	struct route_node *rn;
-	struct ospf_lsa *find;
 
-	table = lsdb->type[type].db;
+	rn = ospf_lsdb_node_find(lsdb, type, id, adv_router);
 
-	memset(&lp, 0, sizeof(lp));
-	lp.family = AF_UNSPEC;
-	lp.prefixlen = 64;
-	lp.id = id;
-	lp.adv_router = adv_router;
-
-	rn = route_node_lookup(table, (struct prefix *)&lp);
-	if (rn) {
-		find = rn->info;
-		route_unlock_node(rn);
-		return find;
-	}
-	return NULL;
+	return rn ? rn->info : NULL;
 }
 
 struct ospf_lsa *ospf_lsdb_lookup_by_id_next(struct ospf_lsdb *lsdb,
@@ -269,26 +312,16 @@ struct ospf_lsa *ospf_lsdb_lookup_by_id_next(struct ospf_lsdb *lsdb,
 					     struct in_addr adv_router,
 					     int first)
 {
-	struct route_table *table;
-	struct prefix_ls lp;
 	struct route_node *rn;
 	struct ospf_lsa *find;
 
-	table = lsdb->type[type].db;
-
-	memset(&lp, 0, sizeof(lp));
-	lp.family = AF_UNSPEC;
-	lp.prefixlen = 64;
-	lp.id = id;
-	lp.adv_router = adv_router;
-
 	if (first)
-		rn = route_top(table);
+		rn = route_top(lsdb->type[type].db);
 	else {
-		if ((rn = route_node_lookup(table, (struct prefix *)&lp))
-		    == NULL)
+		rn = ospf_lsdb_node_find(lsdb, type, id, adv_router);
+		if (rn == NULL)
 			return NULL;
-		rn = route_next(rn);
+		rn = route_next(route_lock_node(rn));
 	}
 
 	for (; rn; rn = route_next(rn))
@@ -327,3 +360,24 @@ unsigned long ospf_lsdb_isempty(struct ospf_lsdb *lsdb)
 {
 	return (lsdb->total == 0);
 }
+
+/* Approximate memory used by the LSDB, including the LSAs it holds. */
+size_t ospf_lsdb_memory(struct ospf_lsdb *lsdb)
+{
+	size_t mem = 0;
+	int i;
+
+	for (i = OSPF_MIN_LSA; i < OSPF_MAX_LSA; i++) {
+		struct route_table *table = lsdb->type[i].db;
+
+		mem += lsdb->type[i].mem;
+		mem += table->count *
+		       (table->delegate == &ospf_lsdb_linked_table_delegate
+				? sizeof(struct ospf_lsdb_linked_node)
+				: sizeof(struct ospf_lsdb_node));
+		mem += HASH_SIZE(lsdb->type[i].hash.hh) *
+		       sizeof(struct thash_item *);
+	}
+
+	return mem;
+}
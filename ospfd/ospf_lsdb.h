@@ -9,6 +9,9 @@
 
 #include "prefix.h"
 #include "table.h"
+#include "typesafe.h"
+
+PREDECL_HASH(ospf_lsdb_hash);
 
 /* OSPF LSDB structure. */
 struct ospf_lsdb {
@@ -16,7 +19,12 @@ struct ospf_lsdb {
 		unsigned long count;
 		unsigned long count_self;
 		unsigned int checksum;
+		/* Bytes of LSAs held */
+		size_t mem;
+		/* Ordered by (id, adv_router), used for walks */
 		struct route_table *db;
+		/* Exact (id, adv_router) index of the nodes holding an LSA */
+		struct ospf_lsdb_hash_head hash;
 	} type[OSPF_MAX_LSA];
 	unsigned long total;
 };
@@ -40,6 +48,22 @@ struct ospf_lsdb {
 #define AREA_LSDB(A,T)       ((A)->lsdb->type[(T)].db)
 #define AS_LSDB(O,T)         ((O)->lsdb->type[(T)].db)
 
+/*
+ * Route node structure for LSDB nodes. Nodes holding an LSA are also on
+ * the per-type hash, which is what exact lookups use.
+ */
+#define OSPF_LSDB_NODE_FIELDS                                                  \
+	ROUTE_NODE_FIELDS                                                      \
+                                                                               \
+	struct ospf_lsdb_hash_item hash_item;
+
+struct ospf_lsdb_node {
+	/*
+	 * Caution these must be the very first fields
+	 */
+	OSPF_LSDB_NODE_FIELDS
+};
+
 /*
  * Alternate route node structure for LSDB nodes linked to
  * list elements.
@@ -48,7 +72,7 @@ struct ospf_lsdb_linked_node {
 	/*
 	 * Caution these must be the very first fields
 	 */
-	ROUTE_NODE_FIELDS
+	OSPF_LSDB_NODE_FIELDS
 
 	/*
 	 * List entry on an LSA list, e.g., a neighbor
@@ -80,5 +104,6 @@ extern unsigned long ospf_lsdb_count(struct ospf_lsdb *lsdb, int type);
 extern unsigned long ospf_lsdb_count_self(struct ospf_lsdb *lsdb, int type);
 extern unsigned int ospf_lsdb_checksum(struct ospf_lsdb *lsdb, int type);
 extern unsigned long ospf_lsdb_isempty(struct ospf_lsdb *lsdb);
+extern size_t ospf_lsdb_memory(struct ospf_lsdb *lsdb);
 
 #endif /* _ZEBRA_OSPF_LSDB_H */
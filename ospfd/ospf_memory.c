@@ -46,4 +46,4 @@ DEFINE_MTYPE(OSPFD, OSPF_EXTERNAL_RT_AGGR, "OSPF External Route Summarisation");
 DEFINE_MTYPE(OSPFD, OSPF_P_SPACE, "OSPF TI-LFA P-Space");
 DEFINE_MTYPE(OSPFD, OSPF_Q_SPACE, "OSPF TI-LFA Q-Space");
 DEFINE_MTYPE(OSPFD, OSPF_LSA_LIST, "OSPF LSA List");
-DEFINE_MTYPE(OSPFD, OSPF_LSDB_NODE, "OSPF LSDB Linked Node");
+DEFINE_MTYPE(OSPFD, OSPF_LSDB_NODE, "OSPF LSDB Node");
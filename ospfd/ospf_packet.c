@@ -3871,12 +3871,48 @@ void ospf_ls_upd_queue_send(struct ospf_interface *oi, struct list *update,
 	}
 }
 
+/*
+ * LS Update pacing.  Every queued update packet takes a token from the
+ * interface bucket, which refills at the configured packets per second up to
+ * the burst size.  Returns 0 when a packet may be sent, otherwise the number
+ * of milliseconds until the next token is available.
+ */
+static uint32_t ospf_ls_upd_pacing_take(struct ospf_interface *oi)
+{
+	uint32_t rate = OSPF_IF_PARAM(oi, ls_upd_pacing);
+	uint64_t limit, tokens;
+	int64_t elapsed;
+
+	if (!rate)
+		return 0;
+
+	limit = (uint64_t)OSPF_IF_PARAM(oi, ls_upd_burst) * 1000;
+	elapsed = monotime_since(&oi->ls_upd_refill, NULL);
+	monotime(&oi->ls_upd_refill);
+
+	/* no need to count idle time beyond what fills the bucket */
+	if (elapsed < 0)
+		elapsed = 0;
+	else if ((uint64_t)elapsed > limit * 1000 / rate)
+		elapsed = limit * 1000 / rate;
+	tokens = oi->ls_upd_tokens + (uint64_t)elapsed * rate / 1000;
+	oi->ls_upd_tokens = MIN(tokens, limit);
+
+	if (oi->ls_upd_tokens >= 1000) {
+		oi->ls_upd_tokens -= 1000;
+		return 0;
+	}
+
+	return ((1000 - oi->ls_upd_tokens) + rate - 1) / rate;
+}
+
 static void ospf_ls_upd_send_queue_event(struct event *event)
 {
 	struct ospf_interface *oi = EVENT_ARG(event);
 	struct route_node *rn;
 	struct route_node *rnext;
 	struct list *update;
+	uint32_t delay = 0;
 	char again = 0;
 
 	oi->t_ls_upd_event = NULL;
@@ -3892,6 +3928,15 @@ static void ospf_ls_upd_send_queue_event(struct event *event)
 
 		update = (struct list *)rn->info;
 
+		delay = ospf_ls_upd_pacing_take(oi);
+		if (delay) {
+			oi->ls_upd_paced++;
+			if (rnext)
+				route_unlock_node(rnext);
+			again = 1;
+			break;
+		}
+
 		ospf_ls_upd_queue_send(oi, update, rn->p.u.prefix4, 0);
 
 		/* list might not be empty. */
@@ -3902,7 +3947,13 @@ static void ospf_ls_upd_send_queue_event(struct event *event)
 			again = 1;
 	}
 
-	if (again != 0) {
+	if (delay) {
+		if (IS_DEBUG_OSPF_EVENT)
+			zlog_debug("%s: [%s] update pacing, next send in %ums",
+				   __func__, IF_NAME(oi), delay);
+		event_add_timer_msec(master, ospf_ls_upd_send_queue_event, oi,
+				     delay, &oi->t_ls_upd_event);
+	} else if (again != 0) {
 		if (IS_DEBUG_OSPF_EVENT)
 			zlog_debug(
 				"%s: update lists not cleared, %d nodes to try again, raising new event",
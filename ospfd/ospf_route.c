@@ -243,6 +243,122 @@ int ospf_route_match_same(struct route_table *rt, struct prefix_ipv4 *prefix,
 	return 0;
 }
 
+/* Same destination type, cost and paths? */
+bool ospf_route_same(const struct ospf_route *or1,
+		     const struct ospf_route *or2)
+{
+	struct listnode *n1, *n2;
+	struct ospf_path *op1, *op2;
+
+	if (or1->type != or2->type || or1->path_type != or2->path_type ||
+	    or1->cost != or2->cost ||
+	    !IPV4_ADDR_SAME(&or1->u.std.area_id, &or2->u.std.area_id) ||
+	    or1->paths->count != or2->paths->count)
+		return false;
+
+	for (n1 = listhead(or1->paths), n2 = listhead(or2->paths); n1 && n2;
+	     n1 = listnextnode_unchecked(n1), n2 = listnextnode_unchecked(n2)) {
+		op1 = listgetdata(n1);
+		op2 = listgetdata(n2);
+
+		if (!IPV4_ADDR_SAME(&op1->nexthop, &op2->nexthop) ||
+		    op1->ifindex != op2->ifindex)
+			return false;
+	}
+	return true;
+}
+
+/* Skip empty nodes, and discard routes which the ABR adds after SPF. */
+static struct route_node *ospf_route_next_used(struct route_node *rn,
+					       bool rtrs)
+{
+	struct ospf_route *or;
+
+	for (; rn; rn = route_next(rn)) {
+		if (!rn->info)
+			continue;
+		if (rtrs)
+			return rn;
+
+		or = rn->info;
+		if (or->type != OSPF_DESTINATION_DISCARD)
+			return rn;
+	}
+	return NULL;
+}
+
+static bool ospf_route_node_same(struct route_node *rn1,
+				 struct route_node *rn2, bool rtrs)
+{
+	struct list *l1, *l2;
+	struct listnode *n1, *n2;
+
+	if (!prefix_same(&rn1->p, &rn2->p))
+		return false;
+	if (!rtrs)
+		return ospf_route_same(rn1->info, rn2->info);
+
+	/* router routing table, one route per area */
+	l1 = rn1->info;
+	l2 = rn2->info;
+	if (l1->count != l2->count)
+		return false;
+	for (n1 = listhead(l1), n2 = listhead(l2); n1 && n2;
+	     n1 = listnextnode_unchecked(n1), n2 = listnextnode_unchecked(n2)) {
+		struct ospf_route *or1 = listgetdata(n1);
+		struct ospf_route *or2 = listgetdata(n2);
+
+		if (!ospf_route_same(or1, or2))
+			return false;
+
+		/* the E/B bits and area type decide what AS external
+		 * routes are calculated through the router
+		 */
+		if (or1->u.std.flags != or2->u.std.flags ||
+		    or1->u.std.external_routing != or2->u.std.external_routing)
+			return false;
+	}
+	return true;
+}
+
+static bool ospf_route_tables_same(struct route_table *rt1,
+				   struct route_table *rt2, bool rtrs)
+{
+	struct route_node *rn1, *rn2;
+
+	if (!rt1 || !rt2)
+		return false;
+
+	rn1 = ospf_route_next_used(route_top(rt1), rtrs);
+	rn2 = ospf_route_next_used(route_top(rt2), rtrs);
+
+	while (rn1 && rn2 && ospf_route_node_same(rn1, rn2, rtrs)) {
+		rn1 = ospf_route_next_used(route_next(rn1), rtrs);
+		rn2 = ospf_route_next_used(route_next(rn2), rtrs);
+	}
+
+	if (rn1 || rn2) {
+		if (rn1)
+			route_unlock_node(rn1);
+		if (rn2)
+			route_unlock_node(rn2);
+		return false;
+	}
+	return true;
+}
+
+/* Do two network routing tables have the same routes and paths? */
+bool ospf_route_table_same(struct route_table *rt1, struct route_table *rt2)
+{
+	return ospf_route_tables_same(rt1, rt2, false);
+}
+
+/* Same for ABR/ASBR routing tables */
+bool ospf_rtrs_table_same(struct route_table *rt1, struct route_table *rt2)
+{
+	return ospf_route_tables_same(rt1, rt2, true);
+}
+
 /* delete routes generated from AS-External routes if there is a inter/intra
  * area route
  */
@@ -125,6 +125,12 @@ extern void ospf_route_delete(struct ospf *ospf, struct route_table *rt);
 extern void ospf_route_table_free(struct route_table *rt);
 
 extern void ospf_route_install(struct ospf *ospf, struct route_table *rt);
+extern bool ospf_route_same(const struct ospf_route *or1,
+			    const struct ospf_route *or2);
+extern bool ospf_route_table_same(struct route_table *rt1,
+				  struct route_table *rt2);
+extern bool ospf_rtrs_table_same(struct route_table *rt1,
+				 struct route_table *rt2);
 extern void ospf_route_table_dump(struct route_table *rt);
 extern void ospf_router_route_table_dump(struct route_table *rt);
 
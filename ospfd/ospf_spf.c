@@ -15,6 +15,7 @@
 #include "table.h"
 #include "log.h"
 #include "sockunion.h" /* for inet_ntop () */
+#include "spf_csr.h"
 
 #include "ospfd/ospfd.h"
 #include "ospfd/ospf_interface.h"
@@ -1258,7 +1259,7 @@ static int ospf_spf_is_protected_resource(struct ospf_area *area,
  *
  * TODO: Only P2P supported by now!
  */
-static uint16_t get_reverse_distance(struct vertex *v,
+static uint16_t get_reverse_distance(struct in_addr v_id,
 				     struct router_lsa_link *l,
 				     struct ospf_lsa *w_lsa)
 {
@@ -1278,7 +1279,7 @@ static uint16_t get_reverse_distance(struct vertex *v,
 
 		/* Only care about P2P with link ID equal to V's router id */
 		if (w_link->m[0].type == LSA_LINK_TYPE_POINTOPOINT
-		    && w_link->link_id.s_addr == v->id.s_addr) {
+		    && w_link->link_id.s_addr == v_id.s_addr) {
 			distance = ntohs(w_link->m[0].metric);
 			break;
 		}
@@ -1409,7 +1410,7 @@ static void ospf_spf_next(struct vertex *v, struct ospf_area *area,
 			if (type == LSA_LINK_TYPE_POINTOPOINT
 			    && area->spf_reversed)
 				link_distance =
-					get_reverse_distance(v, l, w_lsa);
+					get_reverse_distance(v->id, l, w_lsa);
 			else
 				link_distance = ntohs(l->m[0].metric);
 
@@ -1689,6 +1690,313 @@ void ospf_spf_cleanup(struct vertex *spf, struct list *vertex_list)
 		list_delete(&vertex_list);
 }
 
+/*
+ * Dijkstra on the shared SPF kernel (lib/spf_csr.h).
+ *
+ * The router- and network-LSAs of the area are translated into a graph with
+ * exactly the edges ospf_spf_next() would look at: no stub links, no TI-LFA
+ * protected resources, no MaxAge LSAs and only links that have a link back.
+ * After the kernel has run, vertices are created for the reached LSAs in the
+ * order they were settled and the nexthops are calculated from the final
+ * equal cost parents only, instead of for every candidate path found on the
+ * way.
+ *
+ * If a nexthop calculation fails (e.g. no interface for a link of the root)
+ * the classic code would go on to look for a longer path to the vertex, so
+ * the tree is thrown away and ospf_spf_next() does the work instead.
+ */
+DEFINE_MTYPE_STATIC(OSPFD, OSPF_SPF_CSR, "OSPF SPF kernel data");
+
+struct ospf_spf_csr_link {
+	/* offset of the router-LSA link in V's LSA, 0 if V is a network */
+	uint16_t offset;
+	int lsa_pos;
+};
+
+struct ospf_spf_csr {
+	struct spf_csr csr;
+
+	/* vertex index -> LSA and, after the run, SPF vertex */
+	uint32_t nlsas;
+	uint32_t lsas_alloc;
+	struct ospf_lsa **lsas;
+	struct vertex **vertices;
+
+	/* edge cookie -> link */
+	uint32_t nlinks;
+	uint32_t links_alloc;
+	struct ospf_spf_csr_link *links;
+};
+
+void ospf_spf_csr_free(struct ospf_area *area)
+{
+	struct ospf_spf_csr *sc = area->spf_csr;
+
+	if (!sc)
+		return;
+
+	spf_csr_fini(&sc->csr);
+	XFREE(MTYPE_OSPF_SPF_CSR, sc->lsas);
+	XFREE(MTYPE_OSPF_SPF_CSR, sc->vertices);
+	XFREE(MTYPE_OSPF_SPF_CSR, sc->links);
+	XFREE(MTYPE_OSPF_SPF_CSR, area->spf_csr);
+}
+
+static void ospf_spf_csr_add_lsa(struct ospf_spf_csr *sc, struct ospf_lsa *lsa)
+{
+	if (sc->nlsas == sc->lsas_alloc) {
+		sc->lsas_alloc = sc->lsas_alloc ? sc->lsas_alloc * 2 : 64;
+		sc->lsas = XREALLOC(MTYPE_OSPF_SPF_CSR, sc->lsas,
+				    sc->lsas_alloc * sizeof(*sc->lsas));
+		sc->vertices = XREALLOC(MTYPE_OSPF_SPF_CSR, sc->vertices,
+					sc->lsas_alloc * sizeof(*sc->vertices));
+	}
+
+	lsa->spf_index = sc->nlsas;
+	sc->lsas[sc->nlsas++] = lsa;
+}
+
+static void ospf_spf_csr_add_link(struct ospf_spf_csr *sc, uint32_t v,
+				  struct ospf_lsa *w_lsa, uint32_t distance,
+				  uint16_t offset, int lsa_pos)
+{
+	uint32_t w = w_lsa->spf_index;
+
+	/* LSA not in the graph (not in this area's LSDB) */
+	if (w >= sc->nlsas || sc->lsas[w] != w_lsa)
+		return;
+
+	if (sc->nlinks == sc->links_alloc) {
+		sc->links_alloc = sc->links_alloc ? sc->links_alloc * 2 : 256;
+		sc->links = XREALLOC(MTYPE_OSPF_SPF_CSR, sc->links,
+				     sc->links_alloc * sizeof(*sc->links));
+	}
+
+	sc->links[sc->nlinks].offset = offset;
+	sc->links[sc->nlinks].lsa_pos = lsa_pos;
+	spf_csr_add_edge(&sc->csr, v, w, distance, sc->nlinks);
+	sc->nlinks++;
+}
+
+/* Add the edges of vertex V, same checks as ospf_spf_next(). */
+static void ospf_spf_csr_add_links(struct ospf_area *area,
+				   struct ospf_spf_csr *sc, uint32_t v)
+{
+	struct lsa_header *v_lsa = sc->lsas[v]->data;
+	struct ospf_lsa *w_lsa;
+	struct router_lsa_link *l;
+	struct in_addr *r;
+	uint8_t *p, *lim;
+	int lsa_pos = 0;
+	uint32_t distance;
+
+	p = ((uint8_t *)v_lsa) + OSPF_LSA_HEADER_SIZE + 4;
+	lim = ((uint8_t *)v_lsa) + ntohs(v_lsa->length);
+
+	while (p < lim) {
+		uint16_t offset = p - (uint8_t *)v_lsa;
+
+		if (v_lsa->type != OSPF_ROUTER_LSA) {
+			r = (struct in_addr *)p;
+			p += sizeof(struct in_addr);
+
+			w_lsa = ospf_lsa_lookup_by_id(area, OSPF_ROUTER_LSA,
+						      *r);
+			if (!w_lsa || IS_LSA_MAXAGE(w_lsa)
+			    || ospf_lsa_has_link(w_lsa->data, v_lsa) < 0)
+				continue;
+
+			ospf_spf_csr_add_link(sc, v, w_lsa, 0, 0, -1);
+			continue;
+		}
+
+		l = (struct router_lsa_link *)p;
+		p += (OSPF_ROUTER_LSA_LINK_SIZE
+		      + (l->m[0].tos_count * OSPF_ROUTER_LSA_TOS_SIZE));
+		lsa_pos++;
+
+		if (l->m[0].type == LSA_LINK_TYPE_STUB)
+			continue;
+		if (ospf_spf_is_protected_resource(area, l, v_lsa))
+			continue;
+
+		switch (l->m[0].type) {
+		case LSA_LINK_TYPE_POINTOPOINT:
+		case LSA_LINK_TYPE_VIRTUALLINK:
+			w_lsa = ospf_lsa_lookup(area->ospf, area,
+						OSPF_ROUTER_LSA, l->link_id,
+						l->link_id);
+			break;
+		case LSA_LINK_TYPE_TRANSIT:
+			w_lsa = ospf_lsa_lookup_by_id(area, OSPF_NETWORK_LSA,
+						      l->link_id);
+			break;
+		default:
+			flog_warn(EC_OSPF_LSA, "Invalid LSA link type %d",
+				  l->m[0].type);
+			continue;
+		}
+
+		if (!w_lsa || IS_LSA_MAXAGE(w_lsa)
+		    || ospf_lsa_has_link(w_lsa->data, v_lsa) < 0)
+			continue;
+
+		if (l->m[0].type == LSA_LINK_TYPE_POINTOPOINT
+		    && area->spf_reversed)
+			distance = get_reverse_distance(v_lsa->id, l, w_lsa);
+		else
+			distance = ntohs(l->m[0].metric);
+
+		ospf_spf_csr_add_link(sc, v, w_lsa, distance, offset,
+				      lsa_pos - 1);
+	}
+}
+
+static void ospf_spf_csr_build(struct ospf_area *area,
+			       struct ospf_lsa *root_lsa)
+{
+	struct ospf_spf_csr *sc = area->spf_csr;
+	struct route_node *rn;
+	struct ospf_lsa *lsa;
+
+	if (!sc)
+		sc = area->spf_csr =
+			XCALLOC(MTYPE_OSPF_SPF_CSR, sizeof(*area->spf_csr));
+
+	/* The root is vertex 0. */
+	sc->nlsas = 0;
+	sc->nlinks = 0;
+	ospf_spf_csr_add_lsa(sc, root_lsa);
+	LSDB_LOOP (ROUTER_LSDB(area), rn, lsa)
+		if (lsa != root_lsa && !IS_LSA_MAXAGE(lsa))
+			ospf_spf_csr_add_lsa(sc, lsa);
+	LSDB_LOOP (NETWORK_LSDB(area), rn, lsa)
+		if (lsa != root_lsa && !IS_LSA_MAXAGE(lsa))
+			ospf_spf_csr_add_lsa(sc, lsa);
+
+	spf_csr_reset(&sc->csr, sc->nlsas);
+	for (uint32_t v = 0; v < sc->nlsas; v++) {
+		/* Network vertices go first among equal distances. */
+		if (sc->lsas[v]->data->type == OSPF_ROUTER_LSA)
+			spf_csr_set_tiebreak(&sc->csr, v, 1);
+		ospf_spf_csr_add_links(area, sc, v);
+	}
+	spf_csr_finalize(&sc->csr);
+}
+
+/* Create the SPF vertices and their nexthops from the kernel's result. */
+static bool ospf_spf_csr_vertices(struct ospf_area *area)
+{
+	struct ospf_spf_csr *sc = area->spf_csr;
+	struct spf_csr *csr = &sc->csr;
+	struct ospf_spf_csr_link *link;
+	struct router_lsa_link *l;
+	struct vertex *v, *w;
+	uint32_t i, idx, e;
+	unsigned int added;
+
+	spf_csr_foreach_settled (csr, i, idx) {
+		if (i == 0) {
+			sc->vertices[idx] = area->spf;
+			continue;
+		}
+
+		w = ospf_vertex_new(area, sc->lsas[idx]);
+		sc->vertices[idx] = w;
+
+		added = 0;
+		spf_csr_foreach_parent (csr, idx, e) {
+			link = &sc->links[csr->cookie[e]];
+			v = sc->vertices[csr->src[e]];
+			l = link->offset ? (struct router_lsa_link
+						    *)((uint8_t *)v->lsa
+						       + link->offset)
+					 : NULL;
+			added += ospf_nexthop_calculation(area, v, w, l,
+							  spf_csr_dist(csr, idx),
+							  link->lsa_pos);
+		}
+		if (!added) {
+			if (IS_DEBUG_OSPF_EVENT)
+				zlog_debug("%s: Nexthop Calc failed for %s vertex %pI4",
+					   __func__,
+					   w->type == OSPF_VERTEX_ROUTER
+						   ? "Router"
+						   : "Network",
+					   &w->lsa->id);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/*
+ * RFC2328 16.1 (2) - (5) on the SPF kernel.  Returns false if the classic
+ * ospf_spf_next() loop needs to do the calculation.
+ */
+static bool ospf_spf_dijkstra_csr(struct ospf_area *area,
+				  struct ospf_lsa *root_lsa,
+				  struct route_table *new_table,
+				  struct route_table *all_rtrs,
+				  struct route_table *new_rtrs)
+{
+	struct spf_csr *csr;
+	struct vertex *v;
+	uint32_t i, idx;
+
+	ospf_spf_csr_build(area, root_lsa);
+	csr = &area->spf_csr->csr;
+	if (IS_DEBUG_OSPF_EVENT)
+		zlog_debug("%s: area %pI4: %u vertices, %u links", __func__,
+			   &area->area_id, area->spf_csr->nlsas,
+			   area->spf_csr->nlinks);
+
+	spf_csr_run(csr, 0);
+
+	if (!ospf_spf_csr_vertices(area)) {
+		/* Start over. */
+		ospf_spf_cleanup(area->spf, area->spf_vertex_list);
+		lsdb_clean_stat(area->lsdb);
+		ospf_spf_init(area, root_lsa, area->spf_dry_run,
+			      area->spf_root_node);
+		return false;
+	}
+
+	spf_csr_foreach_settled (csr, i, idx) {
+		v = area->spf_csr->vertices[idx];
+		v->lsa_p->stat = LSA_SPF_IN_SPFTREE;
+
+		if (IS_DEBUG_OSPF_EVENT)
+			zlog_debug("%s: %s vertex %pI4 at distance %u, %d parent(s)",
+				   __func__,
+				   v->type == OSPF_VERTEX_ROUTER ? "Router"
+								 : "Network",
+				   &v->lsa->id, v->distance,
+				   listcount(v->parents));
+
+		if (v->type == OSPF_VERTEX_ROUTER
+		    && IS_ROUTER_LSA_VIRTUAL((struct router_lsa *)v->lsa))
+			area->transit = OSPF_TRANSIT_TRUE;
+
+		if (v == area->spf)
+			continue;
+
+		ospf_vertex_add_parent(v);
+
+		if (v->type != OSPF_VERTEX_ROUTER)
+			ospf_intra_add_transit(new_table, v, area);
+		else {
+			if (new_rtrs)
+				ospf_intra_add_router(new_rtrs, v, area, false);
+			if (all_rtrs)
+				ospf_intra_add_router(all_rtrs, v, area, true);
+		}
+	}
+
+	return true;
+}
+
 /* Calculating the shortest-path tree for an area, see RFC2328 16.1. */
 void ospf_spf_calculate(struct ospf_area *area, struct ospf_lsa *root_lsa,
 			struct route_table *new_table,
@@ -1738,6 +2046,10 @@ void ospf_spf_calculate(struct ospf_area *area, struct ospf_lsa *root_lsa,
 	area->transit = OSPF_TRANSIT_FALSE;
 	area->shortcut_capability = 1;
 
+	if (ospf_spf_dijkstra_csr(area, root_lsa, new_table, all_rtrs,
+				  new_rtrs))
+		goto tree_done;
+
 	/*
 	 * Use the root vertex for the start of the SPF algorithm and make it
 	 * part of the tree.
@@ -1772,6 +2084,7 @@ void ospf_spf_calculate(struct ospf_area *area, struct ospf_lsa *root_lsa,
 		/* Iterate back to (2), see RFC2328 16.1. (5). */
 	}
 
+tree_done:
 	if (IS_DEBUG_OSPF_EVENT) {
 		ospf_spf_dump(area->spf, 0);
 		ospf_route_table_dump(new_table);
@@ -1798,11 +2111,274 @@ void ospf_spf_calculate(struct ospf_area *area, struct ospf_lsa *root_lsa,
 			   mtype_stats_alloc(MTYPE_OSPF_VERTEX));
 }
 
+/*
+ * Incremental SPF.
+ *
+ * The SPF tree of each area is kept after a full run.  Router- and
+ * network-LSA changes are classified as they are installed (or removed):
+ * changes that only touch stub links leave the tree intact, the affected
+ * vertex is just pointed at the new LSA instance.  Anything that can change
+ * the tree (non-stub links, a tree vertex going away, a new transit
+ * vertex) drops the saved tree, and the area gets a full Dijkstra run.
+ *
+ * Areas whose tree survived only need the route calculation redone from
+ * the saved tree ("partial route calculation"), which is what summary-LSA
+ * and stub link changes need as well.
+ *
+ * lsa->stat points to the LSA's vertex while its tree is saved.
+ */
+static bool ospf_lsa_in_saved_spf(struct ospf_lsa *lsa)
+{
+	return lsa->stat != LSA_SPF_NOT_EXPLORED &&
+	       lsa->stat != LSA_SPF_IN_SPFTREE;
+}
+
+/*
+ * Do two router-LSAs result in the same SPF tree?  Only the stub links may
+ * differ; the position of all other links must be the same too since
+ * nexthops (lsa_pos) and virtual links (backlink) refer to them by index.
+ */
+static bool ospf_router_lsa_topo_same(struct lsa_header *lsa1,
+				      struct lsa_header *lsa2)
+{
+	uint8_t *p1 = NULL, *p2 = NULL, *lim1 = NULL, *lim2 = NULL;
+	struct router_lsa_link *l1, *l2;
+	size_t len1, len2;
+
+	if (lsa1) {
+		p1 = ((uint8_t *)lsa1) + OSPF_LSA_HEADER_SIZE + 4;
+		lim1 = ((uint8_t *)lsa1) + ntohs(lsa1->length);
+	}
+	if (lsa2) {
+		p2 = ((uint8_t *)lsa2) + OSPF_LSA_HEADER_SIZE + 4;
+		lim2 = ((uint8_t *)lsa2) + ntohs(lsa2->length);
+	}
+
+	while (p1 < lim1 || p2 < lim2) {
+		l1 = p1 < lim1 ? (struct router_lsa_link *)p1 : NULL;
+		l2 = p2 < lim2 ? (struct router_lsa_link *)p2 : NULL;
+		len1 = l1 ? OSPF_ROUTER_LSA_LINK_SIZE +
+				    l1->m[0].tos_count * OSPF_ROUTER_LSA_TOS_SIZE
+			  : 0;
+		len2 = l2 ? OSPF_ROUTER_LSA_LINK_SIZE +
+				    l2->m[0].tos_count * OSPF_ROUTER_LSA_TOS_SIZE
+			  : 0;
+
+		if ((l1 && l1->m[0].type != LSA_LINK_TYPE_STUB) ||
+		    (l2 && l2->m[0].type != LSA_LINK_TYPE_STUB)) {
+			if (!l1 || !l2 || len1 != len2 || memcmp(l1, l2, len1))
+				return false;
+		}
+
+		p1 += len1;
+		p2 += len2;
+	}
+
+	return true;
+}
+
+static bool ospf_network_lsa_topo_same(struct lsa_header *lsa1,
+				       struct lsa_header *lsa2)
+{
+	if (!lsa1 || !lsa2 || lsa1->length != lsa2->length)
+		return false;
+
+	return !memcmp((uint8_t *)lsa1 + OSPF_LSA_HEADER_SIZE,
+		       (uint8_t *)lsa2 + OSPF_LSA_HEADER_SIZE,
+		       ntohs(lsa1->length) - OSPF_LSA_HEADER_SIZE);
+}
+
+void ospf_spf_saved_free(struct ospf_area *area)
+{
+	if (!area->spf_saved)
+		return;
+
+	ospf_spf_cleanup(area->spf_saved, area->spf_saved_vertex_list);
+
+	area->spf_saved = NULL;
+	area->spf_saved_vertex_list = NULL;
+}
+
+static void ospf_spf_saved_drop(struct ospf_area *area, struct ospf_lsa *lsa,
+				const char *why)
+{
+	if (IS_DEBUG_OSPF_EVENT)
+		zlog_debug("SPF: area %pI4 needs full SPF, LSA[%s] %s",
+			   &area->area_id, dump_lsa_key(lsa), why);
+
+	ospf_spf_saved_free(area);
+}
+
+/* Called before new replaces old (if any) in the area's LSDB. */
+void ospf_spf_lsa_install(struct ospf_lsa *old, struct ospf_lsa *new)
+{
+	struct ospf_area *area = new->area;
+	struct lsa_header *old_data = NULL;
+	struct vertex *v = NULL;
+	bool same;
+
+	if (!area || !area->spf_saved || old == new)
+		return;
+
+	if (old && ospf_lsa_in_saved_spf(old))
+		v = old->stat;
+	/* MaxAge LSAs are ignored by SPF, as if they didn't exist */
+	if (old && !IS_LSA_MAXAGE(old))
+		old_data = old->data;
+
+	switch (new->data->type) {
+	case OSPF_ROUTER_LSA:
+		if (IS_LSA_MAXAGE(new))
+			/* removing something that isn't in the tree doesn't
+			 * change the tree
+			 */
+			same = !v;
+		else
+			same = ospf_router_lsa_topo_same(old_data, new->data);
+		break;
+	case OSPF_NETWORK_LSA:
+		if (IS_LSA_MAXAGE(new))
+			same = !v;
+		else
+			same = ospf_network_lsa_topo_same(old_data, new->data);
+		break;
+	default:
+		return;
+	}
+
+	if (!same) {
+		ospf_spf_saved_drop(area, new, "changes topology");
+		return;
+	}
+
+	if (v) {
+		old->stat = LSA_SPF_NOT_EXPLORED;
+		new->stat = v;
+		v->lsa_p = new;
+		v->lsa = new->data;
+	}
+}
+
+/* Called when an LSA goes MaxAge or leaves the area's LSDB. */
+void ospf_spf_lsa_remove(struct ospf_lsa *lsa)
+{
+	struct ospf_area *area = lsa->area;
+
+	if (!area || !area->spf_saved)
+		return;
+
+	if (lsa->data->type != OSPF_ROUTER_LSA &&
+	    lsa->data->type != OSPF_NETWORK_LSA)
+		return;
+
+	if (ospf_lsa_in_saved_spf(lsa))
+		ospf_spf_saved_drop(area, lsa, "removed from SPF tree");
+}
+
+static void ospf_spf_save(struct ospf_area *area)
+{
+	struct listnode *node;
+	struct vertex *v;
+
+	lsdb_clean_stat(area->lsdb);
+
+	for (ALL_LIST_ELEMENTS_RO(area->spf_vertex_list, node, v))
+		v->lsa_p->stat = v;
+
+	area->spf_saved = area->spf;
+	area->spf_saved_vertex_list = area->spf_vertex_list;
+}
+
+/*
+ * Redo the route calculation for an area from its saved SPF tree, without
+ * running Dijkstra.  The result is the same as ospf_spf_calculate() for
+ * the same tree.
+ */
+static bool ospf_spf_calculate_partial(struct ospf *ospf,
+				       struct ospf_area *area,
+				       struct route_table *new_table,
+				       struct route_table *all_rtrs,
+				       struct route_table *new_rtrs)
+{
+	struct listnode *node;
+	struct vertex *v;
+
+	if (!area->spf_saved || ospf->ti_lfa_enabled)
+		return false;
+
+	/* e.g. router-id change */
+	if (area->spf_saved->lsa_p != area->router_lsa_self)
+		return false;
+
+	if (IS_DEBUG_OSPF_EVENT)
+		zlog_debug("%s: partial route calculation for area %pI4",
+			   __func__, &area->area_id);
+
+	area->spf = area->spf_saved;
+	area->spf_vertex_list = area->spf_saved_vertex_list;
+	area->spf_dry_run = false;
+	area->spf_root_node = true;
+
+	area->abr_count = 0;
+	area->asbr_count = 0;
+	area->transit = OSPF_TRANSIT_FALSE;
+	area->shortcut_capability = 1;
+
+	/* RFC2328 16.1. (4), for all vertices but the root */
+	for (ALL_LIST_ELEMENTS_RO(area->spf_vertex_list, node, v)) {
+		UNSET_FLAG(v->flags, OSPF_VERTEX_PROCESSED);
+
+		/* as ospf_spf_next() does, the root included */
+		if (v->type == OSPF_VERTEX_ROUTER
+		    && IS_ROUTER_LSA_VIRTUAL((struct router_lsa *)v->lsa))
+			area->transit = OSPF_TRANSIT_TRUE;
+
+		if (v == area->spf)
+			continue;
+
+		if (v->type != OSPF_VERTEX_ROUTER)
+			ospf_intra_add_transit(new_table, v, area);
+		else {
+			if (new_rtrs)
+				ospf_intra_add_router(new_rtrs, v, area, false);
+			if (all_rtrs)
+				ospf_intra_add_router(all_rtrs, v, area, true);
+		}
+	}
+
+	ospf_spf_process_stubs(area, area->spf, new_table, 0);
+
+	area->spf = NULL;
+	area->spf_vertex_list = NULL;
+
+	area->spf_partial_calculation++;
+
+	monotime(&ospf->ts_spf);
+	area->ts_spf = ospf->ts_spf;
+
+	return true;
+}
+
 void ospf_spf_calculate_area(struct ospf *ospf, struct ospf_area *area,
 			     struct route_table *new_table,
 			     struct route_table *all_rtrs,
 			     struct route_table *new_rtrs)
 {
+	struct timeval start;
+	unsigned long elapsed;
+
+	monotime(&start);
+
+	if (ospf_spf_calculate_partial(ospf, area, new_table, all_rtrs,
+				       new_rtrs)) {
+		elapsed = monotime_since(&start, NULL);
+		if (area->spf_full_time > elapsed)
+			ospf->spf_time_saved += area->spf_full_time - elapsed;
+		return;
+	}
+
+	ospf_spf_saved_free(area);
+
 	ospf_spf_calculate(area, area->router_lsa_self, new_table, all_rtrs,
 			   new_rtrs, false, true);
 
@@ -1810,7 +2386,13 @@ void ospf_spf_calculate_area(struct ospf *ospf, struct ospf_area *area,
 		ospf_ti_lfa_compute(area, new_table,
 				    ospf->ti_lfa_protection_type);
 
-	ospf_spf_cleanup(area->spf, area->spf_vertex_list);
+	area->spf_full_time = monotime_since(&start, NULL);
+
+	/* TI-LFA backup paths are computed along with the full SPF only */
+	if (area->spf && !ospf->ti_lfa_enabled)
+		ospf_spf_save(area);
+	else
+		ospf_spf_cleanup(area->spf, area->spf_vertex_list);
 
 	area->spf = NULL;
 	area->spf_vertex_list = NULL;
@@ -1849,6 +2431,9 @@ static void ospf_spf_calculate_schedule_worker(struct event *event)
 	struct timeval start_time, spf_start_time;
 	unsigned long ia_time, prune_time, rt_time;
 	unsigned long abr_time, total_spf_time, spf_time;
+	struct ospf_area *area;
+	struct listnode *node;
+	long full_count; /* areas that needed Dijkstra */
 	char rbuf[32]; /* reason_buf */
 
 	if (IS_DEBUG_OSPF_EVENT)
@@ -1856,6 +2441,13 @@ static void ospf_spf_calculate_schedule_worker(struct event *event)
 
 	ospf->t_spf_calc = NULL;
 
+	if (ospf->spf_full_pending) {
+		for (ALL_LIST_ELEMENTS_RO(ospf->areas, node, area))
+			ospf_spf_saved_free(area);
+		ospf->spf_full_pending = false;
+		ospf->ase_calc_full = true;
+	}
+
 	ospf_vl_unapprove(ospf);
 
 	/* Execute SPF for each area including backbone, see RFC 2328 16.1. */
@@ -1867,9 +2459,20 @@ static void ospf_spf_calculate_schedule_worker(struct event *event)
 	if (CHECK_FLAG(ospf->opaque, OPAQUE_OPERATION_READY_BIT))
 		all_rtrs = route_table_init();
 
+	full_count = 0;
+	for (ALL_LIST_ELEMENTS_RO(ospf->areas, node, area))
+		full_count += area->spf_calculation;
+
 	ospf_spf_calculate_areas(ospf, new_table, all_rtrs, new_rtrs);
 	spf_time = monotime_since(&spf_start_time, NULL);
 
+	for (ALL_LIST_ELEMENTS_RO(ospf->areas, node, area))
+		full_count -= area->spf_calculation;
+	if (full_count)
+		ospf->spf_full_runs++;
+	else
+		ospf->spf_incremental_runs++;
+
 	ospf_vl_shut_unapproved(ospf);
 
 	/* Calculate inter-area routes, see RFC 2328 16.2. */
@@ -1890,10 +2493,17 @@ static void ospf_spf_calculate_schedule_worker(struct event *event)
 	/*
 	 * Calculate AS external routes, see RFC 2328 16.4.
 	 * There is a dedicated routing table for external routes which is not
-	 * handled here directly
+	 * handled here directly.
+	 *
+	 * External routes only depend on the routes to ASBRs and forwarding
+	 * addresses, if none of these changed there is nothing to do.
 	 */
-	ospf_ase_calculate_schedule(ospf);
-	ospf_ase_calculate_timer_add(ospf);
+	if (full_count || !ospf_route_table_same(ospf->new_table, new_table) ||
+	    !ospf_rtrs_table_same(ospf->new_rtrs, new_rtrs)) {
+		ospf_ase_calculate_schedule(ospf);
+		ospf_ase_calculate_timer_add(ospf);
+	} else if (IS_DEBUG_OSPF_EVENT)
+		zlog_debug("SPF: routes unchanged, skipping AS external routes");
 
 	if (IS_DEBUG_OSPF_EVENT)
 		zlog_debug(
@@ -2002,6 +2612,24 @@ void ospf_spf_calculate_schedule(struct ospf *ospf, ospf_spf_reason_t reason)
 
 	ospf_spf_set_reason(reason);
 
+	/* LSA changes are classified as they are installed, see
+	 * ospf_spf_lsa_install().  Anything else recomputes everything.
+	 */
+	switch (reason) {
+	case SPF_FLAG_ROUTER_LSA_INSTALL:
+	case SPF_FLAG_NETWORK_LSA_INSTALL:
+	case SPF_FLAG_SUMMARY_LSA_INSTALL:
+	case SPF_FLAG_ASBR_SUMMARY_LSA_INSTALL:
+	case SPF_FLAG_MAXAGE:
+		break;
+	case SPF_FLAG_ABR_STATUS_CHANGE:
+	case SPF_FLAG_ASBR_STATUS_CHANGE:
+	case SPF_FLAG_CONFIG_CHANGE:
+	case SPF_FLAG_GR_FINISH:
+		ospf->spf_full_pending = true;
+		break;
+	}
+
 	/* SPF calculation timer is already scheduled. */
 	if (ospf->t_spf_calc) {
 		if (IS_DEBUG_OSPF_EVENT)
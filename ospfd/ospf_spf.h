@@ -88,6 +88,11 @@ extern int vertex_parent_cmp(void *aa, void *bb);
 
 extern void ospf_vertex_free(void *data);
 
+extern void ospf_spf_lsa_install(struct ospf_lsa *old, struct ospf_lsa *new);
+extern void ospf_spf_lsa_remove(struct ospf_lsa *lsa);
+extern void ospf_spf_saved_free(struct ospf_area *area);
+extern void ospf_spf_csr_free(struct ospf_area *area);
+
 extern void ospf_spf_print(struct vty *vty, struct vertex *v, int i);
 extern void ospf_restart_spf(struct ospf *ospf);
 /* void ospf_spf_calculate_timer_add (); */
@@ -1114,6 +1114,11 @@ void ospf_ti_lfa_compute(struct ospf_area *area, struct route_table *new_table,
 	 * Generate P spaces per protected link/node and their respective Q
 	 * spaces, generate backup paths (MPLS label stacks) by finding P/Q
 	 * nodes.
+	 *
+	 * This is done one SPF run at a time: a run keeps its state in the
+	 * area (spf, spf_vertex_list, spf_protected_resource, ...) and in the
+	 * stat field of every LSA of the shared LSDB, so two runs can't
+	 * overlap.
 	 */
 	ospf_ti_lfa_generate_p_spaces(area, protection_type);
 
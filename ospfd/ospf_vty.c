@@ -2887,7 +2887,11 @@ static void show_ip_ospf_area(struct vty *vty, struct ospf_area *area,
 		/* Show SPF calculation times. */
 		json_object_int_add(json_area, "spfExecutedCounter",
 				    area->spf_calculation);
+		json_object_int_add(json_area, "spfPartialCounter",
+				    area->spf_partial_calculation);
 		json_object_int_add(json_area, "lsaNumber", area->lsdb->total);
+		json_object_int_add(json_area, "lsdbMemoryBytes",
+				    ospf_lsdb_memory(area->lsdb));
 		json_object_int_add(
 			json_area, "lsaRouterNumber",
 			ospf_lsdb_count(area->lsdb, OSPF_ROUTER_LSA));
@@ -2941,9 +2945,13 @@ static void show_ip_ospf_area(struct vty *vty, struct ospf_area *area,
 		/* Show SPF calculation times. */
 		vty_out(vty, "   SPF algorithm executed %d times\n",
 			area->spf_calculation);
+		vty_out(vty,
+			"   Partial route calculation executed %d times\n",
+			area->spf_partial_calculation);
 
 		/* Show number of LSA. */
-		vty_out(vty, "   Number of LSA %ld\n", area->lsdb->total);
+		vty_out(vty, "   Number of LSA %ld, LSDB memory %zu bytes\n",
+			area->lsdb->total, ospf_lsdb_memory(area->lsdb));
 		vty_out(vty,
 			"   Number of router LSA %ld. Checksum Sum 0x%08x\n",
 			ospf_lsdb_count(area->lsdb, OSPF_ROUTER_LSA),
@@ -3188,6 +3196,17 @@ static int show_ip_ospf_common(struct vty *vty, struct ospf *ospf,
 					    time_store);
 		} else
 			json_object_boolean_true_add(json_vrf, "spfHasNotRun");
+
+		json_object_int_add(json_vrf, "spfFullRuns",
+				    ospf->spf_full_runs);
+		json_object_int_add(json_vrf, "spfIncrementalRuns",
+				    ospf->spf_incremental_runs);
+		json_object_int_add(json_vrf, "spfTimeSavedMsecs",
+				    ospf->spf_time_saved / 1000);
+		json_object_int_add(json_vrf, "externalCalcFullRuns",
+				    ospf->ase_full_runs);
+		json_object_int_add(json_vrf, "externalCalcIncrementalRuns",
+				    ospf->ase_incremental_runs);
 	} else {
 		vty_out(vty, " SPF algorithm ");
 		if (ospf->ts_spf.tv_sec || ospf->ts_spf.tv_usec) {
@@ -3200,6 +3219,13 @@ static int show_ip_ospf_common(struct vty *vty, struct ospf *ospf,
 						  timebuf, sizeof(timebuf)));
 		} else
 			vty_out(vty, "has not been run\n");
+		vty_out(vty,
+			" SPF runs: %u full, %u incremental, approx. %" PRIu64
+			" msec(s) saved\n",
+			ospf->spf_full_runs, ospf->spf_incremental_runs,
+			ospf->spf_time_saved / 1000);
+		vty_out(vty, " External route calculations: %u full, %u incremental\n",
+			ospf->ase_full_runs, ospf->ase_incremental_runs);
 	}
 
 	if (json) {
@@ -3311,6 +3337,13 @@ static int show_ip_ospf_common(struct vty *vty, struct ospf *ospf,
 			ospf_lsdb_checksum(ospf->lsdb, OSPF_AS_EXTERNAL_LSA));
 	}
 
+	if (json)
+		json_object_int_add(json_vrf, "lsdbMemoryBytes",
+				    ospf_lsdb_memory(ospf->lsdb));
+	else
+		vty_out(vty, " AS scope LSDB memory %zu bytes\n",
+			ospf_lsdb_memory(ospf->lsdb));
+
 	if (json) {
 		json_object_int_add(
 			json_vrf, "lsaAsopaqueCounter",
@@ -3880,6 +3913,27 @@ static void show_ip_ospf_interface_sub(struct vty *vty, struct ospf *ospf,
 				OSPF_IF_PARAM(oi, retransmit_interval));
 		}
 
+		if (OSPF_IF_PARAM(oi, ls_upd_pacing)) {
+			if (use_json) {
+				json_object_int_add(json_interface_sub,
+						    "updatePacingPps",
+						    OSPF_IF_PARAM(oi,
+								  ls_upd_pacing));
+				json_object_int_add(json_interface_sub,
+						    "updatePacingBurst",
+						    OSPF_IF_PARAM(oi,
+								  ls_upd_burst));
+				json_object_int_add(json_interface_sub,
+						    "updatePacingDelayed",
+						    oi->ls_upd_paced);
+			} else
+				vty_out(vty,
+					"  LS Update pacing %u packets/s, burst %u, %u sends delayed\n",
+					OSPF_IF_PARAM(oi, ls_upd_pacing),
+					OSPF_IF_PARAM(oi, ls_upd_burst),
+					oi->ls_upd_paced);
+		}
+
 		if (OSPF_IF_PASSIVE_STATUS(oi) == OSPF_IF_ACTIVE) {
 			char timebuf[OSPF_TIME_DUMP_SIZE];
 			if (use_json) {
@@ -8800,6 +8854,50 @@ DEFPY(ip_ospf_retransmit_window, ip_ospf_retransmit_window_addr_cmd,
 	return CMD_SUCCESS;
 }
 
+DEFPY(ip_ospf_update_pacing, ip_ospf_update_pacing_addr_cmd,
+      "[no] ip ospf update-pacing ![(1-100000)$rate [burst (1-1000)$burst_pkts]] [A.B.C.D]$ip_addr",
+      NO_STR
+      "IP Information\n"
+      "OSPF interface commands\n"
+      "Pace the transmission of Link State Update packets\n"
+      "Packets per second\n"
+      "Packets that may be sent back to back\n"
+      "Packets\n"
+      "Address of interface\n")
+{
+	VTY_DECLVAR_CONTEXT(interface, ifp);
+	struct ospf_if_params *params;
+
+	params = IF_DEF_PARAMS(ifp);
+
+	if (ip_addr.s_addr != INADDR_ANY) {
+		params = ospf_get_if_params(ifp, ip_addr);
+		ospf_if_update_params(ifp, ip_addr);
+	}
+
+	if (no) {
+		UNSET_IF_PARAM(params, ls_upd_pacing);
+		UNSET_IF_PARAM(params, ls_upd_burst);
+		params->ls_upd_pacing = OSPF_LS_UPD_PACING_DEFAULT;
+		params->ls_upd_burst = OSPF_LS_UPD_BURST_DEFAULT;
+		if (params != IF_DEF_PARAMS(ifp))
+			ospf_free_if_params(ifp, ip_addr);
+	} else {
+		SET_IF_PARAM(params, ls_upd_pacing);
+		SET_IF_PARAM(params, ls_upd_burst);
+		params->ls_upd_pacing = rate;
+		params->ls_upd_burst = burst_pkts_str
+					       ? burst_pkts
+					       : OSPF_LS_UPD_BURST_DEFAULT;
+	}
+
+	/*
+	 * The token bucket picks up the new rate the next time the interface
+	 * update queue is serviced.
+	 */
+	return CMD_SUCCESS;
+}
+
 DEFPY (ip_ospf_gr_hdelay,
        ip_ospf_gr_hdelay_cmd,
        "ip ospf graceful-restart hello-delay (1-1800)",
@@ -12342,6 +12440,20 @@ static int config_write_interface_one(struct vty *vty, struct vrf *vrf)
 				vty_out(vty, "\n");
 			}
 
+			/* LS Update pacing print. */
+			if (OSPF_IF_PARAM_CONFIGURED(params, ls_upd_pacing) &&
+			    params->ls_upd_pacing != OSPF_LS_UPD_PACING_DEFAULT) {
+				vty_out(vty, " ip ospf update-pacing %u",
+					params->ls_upd_pacing);
+				if (params->ls_upd_burst !=
+				    OSPF_LS_UPD_BURST_DEFAULT)
+					vty_out(vty, " burst %u",
+						params->ls_upd_burst);
+				if (params != IF_DEF_PARAMS(ifp) && rn)
+					vty_out(vty, " %pI4", &rn->p.u.prefix4);
+				vty_out(vty, "\n");
+			}
+
 			/* Transmit Delay print. */
 			if (OSPF_IF_PARAM_CONFIGURED(params, transmit_delay)
 			    && params->transmit_delay
@@ -13254,6 +13366,7 @@ static void ospf_vty_if_init(void)
 
 	/* "ip ospf retransmit-window" commands. */
 	install_element(INTERFACE_NODE, &ip_ospf_retransmit_window_addr_cmd);
+	install_element(INTERFACE_NODE, &ip_ospf_update_pacing_addr_cmd);
 
 	/* "ip ospf transmit-delay" commands. */
 	install_element(INTERFACE_NODE, &ip_ospf_transmit_delay_addr_cmd);
@@ -808,6 +808,7 @@ static void ospf_finish_final(struct ospf *ospf)
 			ospf_route_delete(ospf, ospf->old_external_route);
 		ospf_route_table_free(ospf->old_external_route);
 	}
+	ospf_ase_deps_finish(ospf);
 	if (ospf->external_lsas) {
 		ospf_ase_external_lsas_finish(ospf->external_lsas);
 	}
@@ -976,6 +977,9 @@ void ospf_area_lsdb_discard_delete(struct ospf_area *area)
 
 static void ospf_area_free(struct ospf_area *area)
 {
+	ospf_spf_saved_free(area);
+	ospf_spf_csr_free(area);
+
 	ospf_opaque_type10_lsa_term(area);
 
 	/* Free LSDBs. */
@@ -235,6 +235,7 @@ struct ospf {
 
 	/* Flags. */
 	int ase_calc;	/* ASE calculation flag. */
+	bool ase_calc_full; /* recalculate all external routes */
 
 	struct list *opaque_lsa_self; /* Type-11 Opaque-LSAs */
 
@@ -253,11 +254,21 @@ struct ospf {
 
 	struct route_table *external_lsas; /* Database of external LSAs,
 					      prefix is LSA's adv. network*/
+	/* External LSAs by ASBR and forwarding address, see ospf_ase.c */
+	struct ospf_ase_dep_index *ase_deps;
+	uint32_t ase_full_runs;
+	uint32_t ase_incremental_runs;
 
 	/* Time stamps */
 	struct timeval ts_spf;		/* SPF calculation time stamp. */
 	struct timeval ts_spf_duration; /* Execution time of last SPF */
 
+	/* Incremental SPF, see ospf_spf_calculate_area() */
+	bool spf_full_pending;	      /* all areas need a full SPF run */
+	uint32_t spf_full_runs;	      /* runs with Dijkstra in any area */
+	uint32_t spf_incremental_runs; /* runs with only partial calculation */
+	uint64_t spf_time_saved;      /* usecs, estimated */
+
 	struct route_table *maxage_lsa; /* List of MaxAge LSA for deletion. */
 	int redistribute;		/* Num of redistributed protocols. */
 
@@ -600,6 +611,14 @@ struct ospf_area {
 	struct vertex *spf;
 	struct list *spf_vertex_list;
 
+	/* Graph and scratch space of the SPF kernel, kept between runs */
+	struct ospf_spf_csr *spf_csr;
+
+	/* SPF tree kept from the last full run for incremental SPF */
+	struct vertex *spf_saved;
+	struct list *spf_saved_vertex_list;
+	unsigned long spf_full_time; /* usecs of the last full run */
+
 	bool spf_dry_run;   /* flag for checking if the SPF calculation is
 			       intended for the local RIB */
 	bool spf_root_node; /* flag for checking if the calculating node is the
@@ -617,6 +636,7 @@ struct ospf_area {
 
 	/* Statistics field. */
 	uint32_t spf_calculation; /* SPF Calculation Count. */
+	uint32_t spf_partial_calculation; /* Partial route calculations. */
 
 	/* reverse SPF (used for TI-LFA Q spaces) */
 	bool spf_reversed;
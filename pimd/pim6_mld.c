@@ -32,6 +32,7 @@
 #include "pimd/pim_cmd_common.h"
 #include "pimd/pim_util.h"
 #include "pimd/pim_tib.h"
+#include "pimd/pim_time.h"
 #include "pimd/pimd.h"
 
 #ifndef IPV6_MULTICAST_ALL
@@ -2048,6 +2049,11 @@ static void gm_t_query(struct event *t)
 	if (gm_ifp->n_startup) {
 		timer_ms /= 4;
 		gm_ifp->n_startup--;
+	} else {
+		/* keep interfaces from querying (and getting all their
+		 * reports back) in lockstep, see pim_igmp_general_query_on()
+		 */
+		timer_ms = pim_time_phase_msec(gm_ifp->ifp->ifindex, timer_ms);
 	}
 
 	event_add_timer_msec(router->master, gm_t_query, gm_ifp, timer_ms,
@@ -924,7 +924,8 @@ static void igmp_group_print(struct interface *ifp, struct vty *vty, bool uj,
 
 	pim_inet4_dump("<group?>", grp->group_addr, group_str,
 		       sizeof(group_str));
-	pim_time_timer_to_hhmmss(hhmmss, sizeof(hhmmss), grp->t_group_timer);
+	pim_time_expiry_to_hhmmss(hhmmss, sizeof(hhmmss), grp->t_group_timer,
+				  &grp->group_timer_expiry);
 	pim_time_uptime(uptime, sizeof(uptime), now - grp->group_creation);
 
 	if (uj) {
@@ -989,9 +990,10 @@ static void igmp_group_print(struct interface *ifp, struct vty *vty, bool uj,
 					pim_inet4_dump(
 						"<source?>", src->source_addr,
 						source_str, sizeof(source_str));
-					pim_time_timer_to_mmss(
+					pim_time_expiry_to_mmss(
 						mmss, sizeof(mmss),
-						src->t_source_timer);
+						src->t_source_timer,
+						&src->source_timer_expiry);
 					pim_time_uptime(
 						src_uptime, sizeof(src_uptime),
 						now - src->source_creation);
@@ -1257,7 +1259,8 @@ static void igmp_sources_print(struct interface *ifp, char *group_str,
 
 	pim_inet4_dump("<source?>", src->source_addr, source_str,
 		       sizeof(source_str));
-	pim_time_timer_to_mmss(mmss, sizeof(mmss), src->t_source_timer);
+	pim_time_expiry_to_mmss(mmss, sizeof(mmss), src->t_source_timer,
+				&src->source_timer_expiry);
 	pim_time_uptime(uptime, sizeof(uptime), now - src->source_creation);
 
 	if (uj) {
@@ -8249,7 +8252,6 @@ DEFPY(clear_ip_msdp_peer_counters, clear_ip_msdp_peer_counters_cmd,
 
 static void ip_msdp_show_sa(struct pim_instance *pim, struct vty *vty, bool uj)
 {
-	struct listnode *sanode;
 	struct pim_msdp_sa *sa;
 	char rp_str[INET_ADDRSTRLEN];
 	char timebuf[PIM_MSDP_UPTIME_STRLEN];
@@ -8267,7 +8269,7 @@ static void ip_msdp_show_sa(struct pim_instance *pim, struct vty *vty, bool uj)
 			"Source                     Group               RP  Local  SPT    Uptime\n");
 	}
 
-	for (ALL_LIST_ELEMENTS_RO(pim->msdp.sa_list, sanode, sa)) {
+	frr_each (msdp_sa_tree, pim->msdp.sa_tree, sa) {
 		now = pim_time_monotonic_sec();
 		pim_time_uptime(timebuf, sizeof(timebuf), now - sa->uptime);
 		if (sa->flags & PIM_MSDP_SAF_PEER) {
@@ -8398,7 +8400,6 @@ static void ip_msdp_show_sa_entry_detail(struct pim_msdp_sa *sa,
 static void ip_msdp_show_sa_detail(struct pim_instance *pim, struct vty *vty,
 				   bool uj)
 {
-	struct listnode *sanode;
 	struct pim_msdp_sa *sa;
 	json_object *json = NULL;
 
@@ -8406,7 +8407,7 @@ static void ip_msdp_show_sa_detail(struct pim_instance *pim, struct vty *vty,
 		json = json_object_new_object();
 	}
 
-	for (ALL_LIST_ELEMENTS_RO(pim->msdp.sa_list, sanode, sa)) {
+	frr_each (msdp_sa_tree, pim->msdp.sa_tree, sa) {
 		char src_str[PIM_ADDRSTRLEN];
 		char grp_str[PIM_ADDRSTRLEN];
 
@@ -8480,7 +8481,6 @@ DEFUN (show_ip_msdp_sa_detail_vrf_all,
 static void ip_msdp_show_sa_addr(struct pim_instance *pim, struct vty *vty,
 				 const char *addr, bool uj)
 {
-	struct listnode *sanode;
 	struct pim_msdp_sa *sa;
 	json_object *json = NULL;
 
@@ -8488,7 +8488,7 @@ static void ip_msdp_show_sa_addr(struct pim_instance *pim, struct vty *vty,
 		json = json_object_new_object();
 	}
 
-	for (ALL_LIST_ELEMENTS_RO(pim->msdp.sa_list, sanode, sa)) {
+	frr_each (msdp_sa_tree, pim->msdp.sa_tree, sa) {
 		char src_str[PIM_ADDRSTRLEN];
 		char grp_str[PIM_ADDRSTRLEN];
 
@@ -8508,7 +8508,6 @@ static void ip_msdp_show_sa_addr(struct pim_instance *pim, struct vty *vty,
 static void ip_msdp_show_sa_sg(struct pim_instance *pim, struct vty *vty,
 			       const char *src, const char *grp, bool uj)
 {
-	struct listnode *sanode;
 	struct pim_msdp_sa *sa;
 	json_object *json = NULL;
 
@@ -8516,7 +8515,7 @@ static void ip_msdp_show_sa_sg(struct pim_instance *pim, struct vty *vty,
 		json = json_object_new_object();
 	}
 
-	for (ALL_LIST_ELEMENTS_RO(pim->msdp.sa_list, sanode, sa)) {
+	frr_each (msdp_sa_tree, pim->msdp.sa_tree, sa) {
 		char src_str[PIM_ADDRSTRLEN];
 		char grp_str[PIM_ADDRSTRLEN];
 
@@ -8533,6 +8532,64 @@ static void ip_msdp_show_sa_sg(struct pim_instance *pim, struct vty *vty,
 		vty_json(vty, json);
 }
 
+/* SAs are also indexed by RP, so this only visits the matching ones */
+static void ip_msdp_show_sa_rp(struct pim_instance *pim, struct vty *vty,
+			       struct in_addr rp, bool uj)
+{
+	struct pim_msdp_sa lookup = {};
+	struct pim_msdp_sa *sa, *next;
+	json_object *json = NULL;
+
+	if (uj) {
+		json = json_object_new_object();
+	}
+
+	lookup.rp = rp;
+	next = msdp_sa_rp_find_gteq(pim->msdp.sa_rp, &lookup);
+	frr_each_from (msdp_sa_rp, pim->msdp.sa_rp, sa, next) {
+		char src_str[PIM_ADDRSTRLEN];
+		char grp_str[PIM_ADDRSTRLEN];
+
+		if (sa->rp.s_addr != rp.s_addr)
+			break;
+
+		snprintfrr(grp_str, sizeof(grp_str), "%pPAs", &sa->sg.grp);
+		snprintfrr(src_str, sizeof(src_str), "%pPAs", &sa->sg.src);
+
+		ip_msdp_show_sa_entry_detail(sa, src_str, grp_str, vty, uj,
+					     json);
+	}
+
+	if (uj)
+		vty_json(vty, json);
+}
+
+DEFPY (show_ip_msdp_sa_rp,
+       show_ip_msdp_sa_rp_cmd,
+       "show ip msdp [vrf NAME] sa rp A.B.C.D$rp [json]",
+       SHOW_STR
+       IP_STR
+       MSDP_STR
+       VRF_CMD_HELP_STR
+       "MSDP active-source information\n"
+       "Originating RP\n"
+       "RP address\n"
+       JSON_STR)
+{
+	bool uj = use_json(argc, argv);
+	struct vrf *vrf;
+	int idx = 2;
+
+	vrf = pim_cmd_lookup_vrf(vty, argv, argc, &idx, uj);
+
+	if (!vrf)
+		return CMD_WARNING;
+
+	ip_msdp_show_sa_rp(vrf->info, vty, rp, uj);
+
+	return CMD_SUCCESS;
+}
+
 DEFUN (show_ip_msdp_sa_sg,
        show_ip_msdp_sa_sg_cmd,
        "show ip msdp [vrf NAME] sa [A.B.C.D [A.B.C.D]] [json]",
@@ -9463,6 +9520,7 @@ void pim_cmd_init(void)
 	install_element(VIEW_NODE, &show_ip_msdp_sa_detail_vrf_all_cmd);
 	install_element(VIEW_NODE, &show_ip_msdp_sa_sg_cmd);
 	install_element(VIEW_NODE, &show_ip_msdp_sa_sg_vrf_all_cmd);
+	install_element(VIEW_NODE, &show_ip_msdp_sa_rp_cmd);
 	install_element(VIEW_NODE, &show_ip_msdp_mesh_group_cmd);
 	install_element(VIEW_NODE, &show_ip_msdp_mesh_group_vrf_all_cmd);
 	install_element(VIEW_NODE, &show_ip_pim_ssm_range_cmd);
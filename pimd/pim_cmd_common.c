@@ -925,6 +925,8 @@ void pim_show_rpf_refresh_stats(struct vty *vty, struct pim_instance *pim,
 				    pim->nexthop_lookups);
 		json_object_int_add(json, "nexthopLookupsAvoided",
 				    pim->nexthop_lookups_avoided);
+		json_object_int_add(json, "nexthopLookupsDeduped",
+				    pim->nexthop_lookups_deduped);
 	} else {
 		vty_out(vty,
 			"RPF Cache Refresh Delay:    %ld msecs\n"
@@ -933,13 +935,15 @@ void pim_show_rpf_refresh_stats(struct vty *vty, struct pim_instance *pim,
 			"RPF Cache Refresh Events:   %lld\n"
 			"RPF Cache Refresh Last:     %s\n"
 			"Nexthop Lookups:            %lld\n"
-			"Nexthop Lookups Avoided:    %lld\n",
+			"Nexthop Lookups Avoided:    %lld\n"
+			"Nexthop Lookups Deduped:    %lld\n",
 			router->rpf_cache_refresh_delay_msec,
 			pim_time_timer_remain_msec(pim->rpf_cache_refresher),
 			(long long)pim->rpf_cache_refresh_requests,
 			(long long)pim->rpf_cache_refresh_events,
 			refresh_uptime, (long long)pim->nexthop_lookups,
-			(long long)pim->nexthop_lookups_avoided);
+			(long long)pim->nexthop_lookups_avoided,
+			(long long)pim->nexthop_lookups_deduped);
 	}
 }
 
@@ -1549,6 +1553,10 @@ void pim_show_upstream(struct pim_instance *pim, struct vty *vty,
 			json_object_int_add(json_row, "refCount",
 					    up->ref_count);
 			json_object_int_add(json_row, "sptBit", up->sptbit);
+			if (up->parent)
+				json_object_string_addf(json_row, "parent",
+							"%pSG",
+							&up->parent->sg);
 			json_object_object_add(json_group, src_str, json_row);
 		} else {
 			ttable_add_row(tt,
@@ -3107,12 +3115,14 @@ void pim_show_neighbors_single(struct pim_instance *pim, struct vty *vty,
 	int option_holdtime;
 	int option_lan_prune_delay;
 	int option_t_bit;
+	uint32_t jp_latency_avg;
 	char uptime[10];
 	char expire[10];
 	char neigh_src_str[PIM_ADDRSTRLEN];
 
 	json_object *json_ifp = NULL;
 	json_object *json_row = NULL;
+	json_object *json_jp = NULL;
 
 	now = pim_time_monotonic_sec();
 
@@ -3178,6 +3188,12 @@ void pim_show_neighbors_single(struct pim_instance *pim, struct vty *vty,
 				    PIM_OPTION_MASK_CAN_DISABLE_JOIN_SUPPRESSION))
 				option_t_bit = 1;
 
+			jp_latency_avg = 0;
+			if (neigh->jp_trigger_stats.runs)
+				jp_latency_avg =
+					neigh->jp_trigger_stats.latency_sum /
+					neigh->jp_trigger_stats.runs;
+
 			if (json) {
 
 				/* Does this ifp live in json? If not create it
@@ -3235,6 +3251,24 @@ void pim_show_neighbors_single(struct pim_instance *pim, struct vty *vty,
 					json_object_boolean_true_add(
 						json_row, "helloOptionTBit");
 
+				json_jp = json_object_new_object();
+				json_object_int_add(
+					json_jp, "queued",
+					neigh->jp_trigger_stats.queued);
+				json_object_int_add(
+					json_jp, "packets",
+					neigh->jp_trigger_stats.packets);
+				json_object_int_add(json_jp, "rounds",
+						    neigh->jp_trigger_stats.runs);
+				json_object_int_add(json_jp, "latencyAvgMsec",
+						    jp_latency_avg);
+				json_object_int_add(
+					json_jp, "latencyMaxMsec",
+					neigh->jp_trigger_stats.latency_max);
+				json_object_object_add(json_row,
+						       "triggeredJoinPrune",
+						       json_jp);
+
 				json_object_object_add(json_ifp, neigh_src_str,
 						       json_row);
 
@@ -3277,6 +3311,19 @@ void pim_show_neighbors_single(struct pim_instance *pim, struct vty *vty,
 				vty_out(vty,
 					"    Hello Option - T-bit           : %s\n",
 					option_t_bit ? "yes" : "no");
+				vty_out(vty,
+					"    Triggered J/P - Queued         : %u\n",
+					neigh->jp_trigger_stats.queued);
+				vty_out(vty,
+					"    Triggered J/P - Packets        : %u\n",
+					neigh->jp_trigger_stats.packets);
+				vty_out(vty,
+					"    Triggered J/P - Rounds         : %u\n",
+					neigh->jp_trigger_stats.runs);
+				vty_out(vty,
+					"    Triggered J/P - Latency (msec) : %u avg, %u max\n",
+					jp_latency_avg,
+					neigh->jp_trigger_stats.latency_max);
 				bfd_sess_show(vty, json_ifp,
 					      neigh->bfd_session);
 				vty_out(vty, "\n");
@@ -83,18 +83,21 @@ static void pim_ifchannel_find_new_children(struct pim_ifchannel *ch)
 	struct pim_ifchannel *child;
 
 	// Basic Sanity that we are not being silly
-	if (!pim_addr_is_any(ch->sg.src) && !pim_addr_is_any(ch->sg.grp))
+	if (!pim_addr_is_any(ch->sg.src) || pim_addr_is_any(ch->sg.grp))
 		return;
 
-	if (pim_addr_is_any(ch->sg.src) && pim_addr_is_any(ch->sg.grp))
-		return;
-
-	RB_FOREACH (child, pim_ifchannel_rb, &pim_ifp->ifchannel_rb) {
-		if (!pim_addr_is_any(ch->sg.grp) &&
-		    !pim_addr_cmp(child->sg.grp, ch->sg.grp) && (child != ch)) {
-			child->parent = ch;
-			listnode_add_sort(ch->sources, child);
-		}
+	/*
+	 * Sorted by group, then source: the (S,G)s of this group are the
+	 * entries right after where the (*,G) goes.
+	 */
+	for (child = RB_NFIND(pim_ifchannel_rb, &pim_ifp->ifchannel_rb, ch);
+	     child && !pim_addr_cmp(child->sg.grp, ch->sg.grp);
+	     child = RB_NEXT(pim_ifchannel_rb, child)) {
+		if (child == ch)
+			continue;
+		child->parent = ch;
+		/* in order already */
+		listnode_add(ch->sources, child);
 	}
 }
 
@@ -705,8 +708,8 @@ static void on_ifjoin_prune_pending_timer(struct event *t)
 			pim_upstream_update_join_desired(pim_ifp->pim,
 							 ch->upstream);
 
-			pim_jp_agg_single_upstream_send(&parent->rpf,
-							parent, true);
+			pim_jp_agg_upstream_trigger(&parent->rpf, parent,
+						    true);
 			/*
 			 * SGRpt prune pending expiry has to install
 			 * SG entry with empty olist to drop the SG
@@ -1510,5 +1513,5 @@ void pim_ifchannel_set_star_g_join_state(struct pim_ifchannel *ch, int eom,
 	}
 
 	if (send_upstream_starg)
-		pim_jp_agg_single_upstream_send(&starup->rpf, starup, true);
+		pim_jp_agg_upstream_trigger(&starup->rpf, starup, true);
 }
@@ -860,7 +860,7 @@ void pim_igmp_general_query_on(struct gm_sock *igmp)
 {
 	struct pim_interface *pim_ifp;
 	int startup_mode;
-	int query_interval;
+	long query_interval_msec;
 
 	/*
 	  Since this socket is starting as querier,
@@ -889,14 +889,23 @@ void pim_igmp_general_query_on(struct gm_sock *igmp)
 		 */
 		if (igmp->startup_query_count ==
 		    igmp->querier_robustness_variable)
-			query_interval = 1;
+			query_interval_msec = 1000;
 		else
-			query_interval = PIM_IGMP_SQI(
-				pim_ifp->gm_default_query_interval);
+			query_interval_msec =
+				PIM_IGMP_SQI(pim_ifp->gm_default_query_interval) *
+				1000;
 
 		--igmp->startup_query_count;
 	} else {
-		query_interval = igmp->querier_query_interval;
+		/*
+		 * Interfaces brought up together would otherwise keep
+		 * querying in lockstep, and have all of their hosts report
+		 * back at the same time.  Give each interface its own phase
+		 * within the query interval.
+		 */
+		query_interval_msec =
+			pim_time_phase_msec(igmp->interface->ifindex,
+					    igmp->querier_query_interval * 1000);
 	}
 
 	if (PIM_DEBUG_GM_TRACE) {
@@ -904,12 +913,13 @@ void pim_igmp_general_query_on(struct gm_sock *igmp)
 		pim_inet4_dump("<ifaddr?>", igmp->ifaddr, ifaddr_str,
 			       sizeof(ifaddr_str));
 		zlog_debug(
-			"Querier %s scheduling %d-second (%s) TIMER event for IGMP query on fd=%d",
-			ifaddr_str, query_interval,
+			"Querier %s scheduling %ld.%03ld sec (%s) TIMER event for IGMP query on fd=%d",
+			ifaddr_str, query_interval_msec / 1000,
+			query_interval_msec % 1000,
 			startup_mode ? "startup" : "non-startup", igmp->fd);
 	}
-	event_add_timer(router->master, pim_igmp_general_query, igmp,
-			query_interval, &igmp->t_igmp_query_timer);
+	event_add_timer_msec(router->master, pim_igmp_general_query, igmp,
+			     query_interval_msec, &igmp->t_igmp_query_timer);
 }
 
 void pim_igmp_general_query_off(struct gm_sock *igmp)
@@ -1348,9 +1358,17 @@ struct gm_sock *pim_igmp_sock_add(struct list *igmp_sock_list,
 static void igmp_group_timer(struct event *t)
 {
 	struct gm_group *group;
+	struct timeval remain;
 
 	group = EVENT_ARG(t);
 
+	/* refreshed since the event was armed, catch up with the expiry */
+	if (monotime_until(&group->group_timer_expiry, &remain) > 0) {
+		event_add_timer_tv(router->master, igmp_group_timer, group,
+				   &remain, &group->t_group_timer);
+		return;
+	}
+
 	if (PIM_DEBUG_GM_TRACE) {
 		char group_str[INET_ADDRSTRLEN];
 		pim_inet4_dump("<group?>", group->group_addr, group_str,
@@ -1406,6 +1424,10 @@ void igmp_group_timer_on(struct gm_group *group, long interval_msec,
 		.grp.ipa_type = IPADDR_V4,
 		.grp.ipaddr_v4 = group->group_addr,
 	};
+	struct timeval now, interval = {
+		.tv_sec = interval_msec / 1000,
+		.tv_usec = (interval_msec % 1000) * 1000,
+	};
 
 	if (interval_msec && !pim_filter_match(&pim_ifp->gmp_filter, &sg, group->interface)) {
 		if (PIM_DEBUG_GM_TRACE)
@@ -1415,8 +1437,6 @@ void igmp_group_timer_on(struct gm_group *group, long interval_msec,
 		return;
 	}
 
-	group_timer_off(group);
-
 	if (PIM_DEBUG_GM_EVENTS) {
 		char group_str[INET_ADDRSTRLEN];
 		pim_inet4_dump("<group?>", group->group_addr, group_str,
@@ -1436,6 +1456,21 @@ void igmp_group_timer_on(struct gm_group *group, long interval_msec,
 	*/
 	assert(group->group_filtermode_isexcl);
 
+	monotime(&now);
+	timeradd(&now, &interval, &group->group_timer_expiry);
+
+	/*
+	 * Every report refreshes the timer to GMI.  Don't cancel and re-add
+	 * the event for that, igmp_group_timer() re-arms itself for whatever
+	 * is left when it fires.  Only an earlier expiry (LMQT) needs the
+	 * event moved.
+	 */
+	if (group->t_group_timer &&
+	    event_timer_remain_msec(group->t_group_timer) <= interval_msec)
+		return;
+
+	group_timer_off(group);
+
 	event_add_timer_msec(router->master, igmp_group_timer, group,
 			     interval_msec, &group->t_group_timer);
 }
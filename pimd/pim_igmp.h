@@ -154,6 +154,7 @@ static inline void pim_igmp_other_querier_timer_off(struct gm_sock *igmp)
 struct gm_source {
 	pim_addr source_addr;
 	struct event *t_source_timer;
+	struct timeval source_timer_expiry;
 	struct gm_group *source_group; /* back pointer */
 	time_t source_creation;
 	uint32_t source_flags;
@@ -173,8 +174,12 @@ struct gm_group {
 	  The group timer is only used when a group is in EXCLUDE mode and it
 	  represents the time for the *filter-mode* of the group to expire and
 	  switch to INCLUDE mode.
+
+	  Refreshes only move group_timer_expiry; t_group_timer stays armed
+	  at the earlier expiry and catches up when it fires.
 	*/
 	struct event *t_group_timer;
+	struct timeval group_timer_expiry;
 
 	/* Shared between group-specific and
 	   group-and-source-specific retransmissions */
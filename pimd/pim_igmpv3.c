@@ -113,9 +113,17 @@ static void igmp_source_timer(struct event *t)
 {
 	struct gm_source *source;
 	struct gm_group *group;
+	struct timeval remain;
 
 	source = EVENT_ARG(t);
 
+	/* refreshed since the event was armed, catch up with the expiry */
+	if (monotime_until(&source->source_timer_expiry, &remain) > 0) {
+		event_add_timer_tv(router->master, igmp_source_timer, source,
+				   &remain, &source->t_source_timer);
+		return;
+	}
+
 	group = source->source_group;
 
 	if (PIM_DEBUG_GM_TRACE) {
@@ -195,8 +203,11 @@ static void source_timer_off(struct gm_group *group, struct gm_source *source)
 static void igmp_source_timer_on(struct gm_group *group,
 				 struct gm_source *source, long interval_msec)
 {
-	source_timer_off(group, source);
 	struct pim_interface *pim_ifp = group->interface->info;
+	struct timeval now, interval = {
+		.tv_sec = interval_msec / 1000,
+		.tv_usec = (interval_msec % 1000) * 1000,
+	};
 
 	if (PIM_DEBUG_GM_EVENTS) {
 		char group_str[INET_ADDRSTRLEN];
@@ -211,8 +222,16 @@ static void igmp_source_timer_on(struct gm_group *group,
 			source_str, group->interface->name);
 	}
 
-	event_add_timer_msec(router->master, igmp_source_timer, source,
-			     interval_msec, &source->t_source_timer);
+	monotime(&now);
+	timeradd(&now, &interval, &source->source_timer_expiry);
+
+	/* same as the group timer, only an earlier expiry moves the event */
+	if (!source->t_source_timer ||
+	    event_timer_remain_msec(source->t_source_timer) > interval_msec) {
+		source_timer_off(group, source);
+		event_add_timer_msec(router->master, igmp_source_timer, source,
+				     interval_msec, &source->t_source_timer);
+	}
 
 	/*
 	  RFC 3376: 6.3. IGMPv3 Source-Specific Forwarding Rules
@@ -1358,12 +1377,14 @@ static void group_retransmit_timer_on(struct gm_group *group)
 
 static long igmp_group_timer_remain_msec(struct gm_group *group)
 {
-	return pim_time_timer_remain_msec(group->t_group_timer);
+	return pim_time_expiry_remain_msec(group->t_group_timer,
+					   &group->group_timer_expiry);
 }
 
 static long igmp_source_timer_remain_msec(struct gm_source *source)
 {
-	return pim_time_timer_remain_msec(source->t_source_timer);
+	return pim_time_expiry_remain_msec(source->t_source_timer,
+					   &source->source_timer_expiry);
 }
 
 /*
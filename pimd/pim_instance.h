@@ -144,6 +144,11 @@ struct pim_instance {
 	// Upstream vrf specific information
 	struct rb_pim_upstream_head upstream_head;
 	struct timer_wheel *upstream_sg_wheel;
+	/* Mroute counters are fetched in bulk once per wheel period */
+	struct event *t_sg_stats;
+	bool sg_stats_pending;
+	/* Neighbors with triggered J/Ps waiting to go out */
+	uint32_t jp_trigger_nbrs;
 
 	/*
 	 * RP information
@@ -200,6 +205,9 @@ struct pim_instance {
 
 	int64_t nexthop_lookups;
 	int64_t nexthop_lookups_avoided;
+	int64_t nexthop_lookups_deduped;
+	/* Upstreams were updated from asynchronous nexthop lookups */
+	struct event *nht_lookup_resume;
 	int64_t last_route_change_time;
 
 	uint64_t gm_rx_drop_sys;
@@ -621,6 +621,7 @@ int pim_joinprune_send(struct pim_rpf *rpf, struct list *groups)
 	size_t packet_left = 0;
 	size_t packet_size = 0;
 	size_t group_size = 0;
+	int packets = 0;
 
 	if (rpf->source_nexthop.interface)
 		pim_ifp = rpf->source_nexthop.interface->info;
@@ -703,6 +704,7 @@ int pim_joinprune_send(struct pim_rpf *rpf, struct list *groups)
 					__func__,
 					rpf->source_nexthop.interface->name);
 			}
+			packets++;
 
 			msg = (struct pim_jp *)pim_msg;
 			memset(msg, 0, sizeof(*msg));
@@ -763,6 +765,7 @@ int pim_joinprune_send(struct pim_rpf *rpf, struct list *groups)
 					__func__,
 					rpf->source_nexthop.interface->name);
 			}
+			packets++;
 
 			new_packet = true;
 		}
@@ -781,8 +784,9 @@ int pim_joinprune_send(struct pim_rpf *rpf, struct list *groups)
 				"%s: could not send PIM message on interface %s",
 				__func__, rpf->source_nexthop.interface->name);
 		}
+		packets++;
 	}
-	return 0;
+	return packets;
 }
 
 int pim_graft_send(struct pim_rpf *rpf, struct list *groups)
@@ -19,6 +19,7 @@ int pim_joinprune_recv(struct interface *ifp, struct pim_neighbor *neigh,
 int pim_graft_recv(struct interface *ifp, struct pim_neighbor *neigh, pim_addr src_addr,
 		   uint8_t *tlv_buf, int tlv_buf_size, uint8_t pim_msg_type);
 
+/* Returns the number of packets sent, -1 if the RPF interface is unusable */
 int pim_joinprune_send(struct pim_rpf *nexthop, struct list *groups);
 
 int pim_graft_send(struct pim_rpf *nexthop, struct list *groups);
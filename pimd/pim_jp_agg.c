@@ -17,6 +17,8 @@
 #include "pim_jp_agg.h"
 #include "pim_join.h"
 #include "pim_iface.h"
+#include "pim_neighbor.h"
+#include "pim_time.h"
 
 void pim_jp_agg_group_list_free(struct pim_jp_agg_group *jag)
 {
@@ -243,10 +245,28 @@ void pim_jp_agg_add_group(struct list *group, struct pim_upstream *up,
 	struct listnode *node, *nnode;
 	struct pim_jp_agg_group *jag = NULL;
 	struct pim_jp_sources *js = NULL;
+	bool append = true;
+	int cmp;
 
-	for (ALL_LIST_ELEMENTS(group, node, nnode, jag)) {
-		if (!pim_addr_cmp(jag->group, up->sg.grp))
-			break;
+	/*
+	 * Upstreams are mostly walked in group order, so check the tail
+	 * before searching; otherwise large bursts go quadratic.
+	 */
+	node = listtail(group);
+	if (node) {
+		jag = listgetdata(node);
+		cmp = pim_addr_cmp(jag->group, up->sg.grp);
+		if (cmp > 0)
+			append = false;
+		if (cmp)
+			jag = NULL;
+	}
+
+	if (!jag && !append) {
+		for (ALL_LIST_ELEMENTS(group, node, nnode, jag)) {
+			if (!pim_addr_cmp(jag->group, up->sg.grp))
+				break;
+		}
 	}
 
 	if (!jag) {
@@ -256,7 +276,10 @@ void pim_jp_agg_add_group(struct list *group, struct pim_upstream *up,
 		jag->sources = list_new();
 		jag->sources->cmp = pim_jp_agg_src_cmp;
 		jag->sources->del = (void (*)(void *))pim_jp_agg_src_free;
-		listnode_add_sort(group, jag);
+		if (append)
+			listnode_add(group, jag);
+		else
+			listnode_add_sort(group, jag);
 	}
 
 	for (ALL_LIST_ELEMENTS(jag->sources, node, nnode, js)) {
@@ -287,6 +310,61 @@ void pim_jp_agg_add_group(struct list *group, struct pim_upstream *up,
 	}
 }
 
+static struct pim_jp_sources *pim_jp_agg_find_source(struct list *group,
+						     struct pim_upstream *up)
+{
+	struct listnode *gnode, *snode;
+	struct pim_jp_agg_group *jag;
+	struct pim_jp_sources *js;
+
+	for (ALL_LIST_ELEMENTS_RO(group, gnode, jag)) {
+		if (pim_addr_cmp(jag->group, up->sg.grp))
+			continue;
+
+		for (ALL_LIST_ELEMENTS_RO(jag->sources, snode, js)) {
+			if (js->up == up)
+				return js;
+		}
+		break;
+	}
+
+	return NULL;
+}
+
+static void pim_jp_agg_trigger_done(struct pim_neighbor *nbr)
+{
+	struct pim_interface *pim_ifp = nbr->interface->info;
+
+	event_cancel(&nbr->jp_trigger_timer);
+	if (pim_ifp && pim_ifp->pim->jp_trigger_nbrs)
+		pim_ifp->pim->jp_trigger_nbrs--;
+}
+
+/*
+ * Take up off nbr's triggered J/P queue.  Returns whether it was queued
+ * as a join (1) or a prune (0), or -1 if it was not queued at all.
+ */
+static int pim_jp_agg_trigger_drop(struct pim_neighbor *nbr,
+				   struct pim_upstream *up)
+{
+	struct pim_jp_sources *js;
+	int is_join;
+
+	if (!nbr)
+		return -1;
+
+	js = pim_jp_agg_find_source(nbr->upstream_jp_trigger, up);
+	if (!js)
+		return -1;
+
+	is_join = js->is_join;
+	pim_jp_agg_remove_group(nbr->upstream_jp_trigger, up, nbr);
+	if (!listcount(nbr->upstream_jp_trigger))
+		pim_jp_agg_trigger_done(nbr);
+
+	return is_join;
+}
+
 void pim_jp_agg_switch_interface(struct pim_rpf *orpf, struct pim_rpf *nrpf,
 				 struct pim_upstream *up)
 {
@@ -310,6 +388,11 @@ void pim_jp_agg_switch_interface(struct pim_rpf *orpf, struct pim_rpf *nrpf,
 	 * the Join Timer (JT) to expire after t_periodic seconds.
 	 */
 
+	/* a triggered J/P still queued for the old neighbor is stale now */
+	pim_jp_agg_trigger_drop(pim_neighbor_find(orpf->source_nexthop.interface,
+						  orpf->rpf_addr, true),
+				up);
+
 	/* send Prune(S,G) to the old upstream neighbor */
 	if (opius)
 		pim_jp_agg_add_group(opius->us, up, false, NULL);
@@ -350,3 +433,157 @@ void pim_jp_agg_single_upstream_send(struct pim_rpf *rpf,
 	list_delete_all_node(jag.sources);
 	list_delete_all_node(&groups);
 }
+
+static void pim_jp_agg_trigger_timer(struct event *t);
+
+/*
+ * Send what is queued on nbr, joins first since those are what restores
+ * forwarding.  A round is limited to PIM_JP_TRIGGER_BURST packets worth
+ * of groups and the rest waits for the next one.
+ */
+static void pim_jp_agg_trigger_send(struct pim_neighbor *nbr)
+{
+	struct list *queue = nbr->upstream_jp_trigger;
+	struct listnode *node, *nnode;
+	struct pim_jp_agg_group *jag;
+	struct pim_jp_sources *js;
+	struct pim_rpf rpf;
+	struct list batch;
+	size_t budget, size;
+	uint32_t latency;
+	int packets;
+	bool joins;
+
+	memset(&batch, 0, sizeof(batch));
+	budget = PIM_JP_TRIGGER_BURST * nbr->interface->mtu;
+
+	for (joins = true;; joins = false) {
+		for (ALL_LIST_ELEMENTS(queue, node, nnode, jag)) {
+			/* sources are sorted with joins first */
+			js = listnode_head(jag->sources);
+			if (!!js->is_join != joins)
+				continue;
+
+			size = pim_msg_get_jp_group_size(jag->sources);
+			if (listcount(&batch) && size > budget)
+				break;
+
+			budget -= MIN(size, budget);
+			list_delete_node(queue, node);
+			listnode_add(&batch, jag);
+		}
+
+		if (!joins)
+			break;
+	}
+
+	rpf.source_nexthop.interface = nbr->interface;
+	rpf.rpf_addr = nbr->source_addr;
+	packets = pim_joinprune_send(&rpf, &batch);
+	pim_jp_agg_clear_group(&batch);
+
+	latency = (pim_time_monotonic_usec() - nbr->jp_trigger_since) / 1000;
+	nbr->jp_trigger_stats.runs++;
+	if (packets > 0)
+		nbr->jp_trigger_stats.packets += packets;
+	nbr->jp_trigger_stats.latency_sum += latency;
+	if (latency > nbr->jp_trigger_stats.latency_max)
+		nbr->jp_trigger_stats.latency_max = latency;
+
+	if (PIM_DEBUG_PIM_J_P)
+		zlog_debug("%s: sent %d packets to %pPA on %s, %u groups left",
+			   __func__, packets, &nbr->source_addr,
+			   nbr->interface->name, listcount(queue));
+
+	if (listcount(queue))
+		event_add_timer_msec(router->master, pim_jp_agg_trigger_timer,
+				     nbr, PIM_JP_TRIGGER_DELAY_MSEC,
+				     &nbr->jp_trigger_timer);
+	else
+		pim_jp_agg_trigger_done(nbr);
+}
+
+static void pim_jp_agg_trigger_timer(struct event *t)
+{
+	struct pim_neighbor *nbr = EVENT_ARG(t);
+
+	pim_jp_agg_trigger_send(nbr);
+}
+
+void pim_jp_agg_upstream_trigger(struct pim_rpf *rpf, struct pim_upstream *up,
+				 bool is_join)
+{
+	struct pim_interface *pim_ifp;
+	struct pim_neighbor *nbr;
+
+	/* skip JP upstream messages if source is directly connected */
+	if (!up || !rpf->source_nexthop.interface ||
+	    pim_if_connected_to_source(rpf->source_nexthop.interface,
+				       up->sg.src) ||
+	    if_is_loopback(rpf->source_nexthop.interface))
+		return;
+
+	/* without a neighbor to queue on, pim_joinprune_send() decides */
+	nbr = pim_neighbor_find(rpf->source_nexthop.interface, rpf->rpf_addr,
+				true);
+	if (!nbr) {
+		pim_jp_agg_single_upstream_send(rpf, up, is_join);
+		return;
+	}
+
+	pim_ifp = nbr->interface->info;
+	if (!listcount(nbr->upstream_jp_trigger)) {
+		nbr->jp_trigger_since = pim_time_monotonic_usec();
+		pim_ifp->pim->jp_trigger_nbrs++;
+	}
+
+	pim_jp_agg_add_group(nbr->upstream_jp_trigger, up, is_join, NULL);
+	nbr->jp_trigger_stats.queued++;
+
+	/* the window starts with the first entry, later ones don't push it */
+	event_add_timer_msec(router->master, pim_jp_agg_trigger_timer, nbr,
+			     PIM_JP_TRIGGER_DELAY_MSEC, &nbr->jp_trigger_timer);
+}
+
+void pim_jp_agg_trigger_upstream_del(struct pim_instance *pim,
+				     struct pim_upstream *up)
+{
+	struct interface *ifp;
+	struct pim_interface *pim_ifp;
+	struct pim_neighbor *nbr;
+	struct listnode *node;
+	struct pim_rpf rpf;
+
+	if (!pim->jp_trigger_nbrs)
+		return;
+
+	FOR_ALL_INTERFACES (pim->vrf, ifp) {
+		pim_ifp = ifp->info;
+		if (!pim_ifp)
+			continue;
+
+		for (ALL_LIST_ELEMENTS_RO(pim_ifp->pim_neighbor_list, node,
+					  nbr)) {
+			/*
+			 * A pending join is moot now; a pending prune still
+			 * has to go out unless the caller sends one anyway.
+			 */
+			if (pim_jp_agg_trigger_drop(nbr, up) != 0 ||
+			    up->join_state == PIM_UPSTREAM_JOINED)
+				continue;
+
+			rpf.source_nexthop.interface = nbr->interface;
+			rpf.rpf_addr = nbr->source_addr;
+			pim_jp_agg_single_upstream_send(&rpf, up, false);
+		}
+	}
+}
+
+void pim_jp_agg_trigger_clear(struct pim_neighbor *nbr)
+{
+	if (listcount(nbr->upstream_jp_trigger)) {
+		pim_jp_agg_clear_group(nbr->upstream_jp_trigger);
+		pim_jp_agg_trigger_done(nbr);
+	}
+	event_cancel(&nbr->jp_trigger_timer);
+}
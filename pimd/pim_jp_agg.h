@@ -9,6 +9,13 @@
 
 #include "pim_rpf.h"
 
+/*
+ * Triggered J/Ps are coalesced per neighbor for this long, and each
+ * round sends at most this many packets worth of groups.
+ */
+#define PIM_JP_TRIGGER_DELAY_MSEC 10
+#define PIM_JP_TRIGGER_BURST 32
+
 struct pim_jp_sources {
 	struct pim_upstream *up;
 	int is_join;
@@ -37,4 +44,10 @@ void pim_jp_agg_switch_interface(struct pim_rpf *orpf, struct pim_rpf *nrpf,
 
 void pim_jp_agg_single_upstream_send(struct pim_rpf *rpf,
 				     struct pim_upstream *up, bool is_join);
+
+void pim_jp_agg_upstream_trigger(struct pim_rpf *rpf, struct pim_upstream *up,
+				 bool is_join);
+void pim_jp_agg_trigger_upstream_del(struct pim_instance *pim,
+				     struct pim_upstream *up);
+void pim_jp_agg_trigger_clear(struct pim_neighbor *nbr);
 #endif
@@ -760,7 +760,7 @@ int pim_mroute_msg_wrvifwhole(int fd, struct interface *ifp, const char *buf,
 					    up->parent->rpf.source_nexthop
 						    .interface) {
 					up->sptbit = PIM_UPSTREAM_SPTBIT_TRUE;
-					pim_jp_agg_single_upstream_send(
+					pim_jp_agg_upstream_trigger(
 						&up->parent->rpf, up->parent,
 						true);
 				}
@@ -1490,6 +1490,7 @@ void pim_mroute_update_counters(struct channel_oil *c_oil)
 	struct pim_instance *pim = c_oil->pim;
 	pim_sioc_sg_req sgreq;
 
+	c_oil->cc_fresh = false;
 	c_oil->cc.oldpktcnt = c_oil->cc.pktcnt;
 	c_oil->cc.oldbytecnt = c_oil->cc.bytecnt;
 	c_oil->cc.oldwrong_if = c_oil->cc.wrong_if;
@@ -1537,3 +1538,36 @@ void pim_mroute_update_counters(struct channel_oil *c_oil)
 	c_oil->cc.wrong_if = sgreq.wrong_if;
 	return;
 }
+
+/*
+ * Store the counters of an mroute from a bulk dump, they are then used
+ * instead of asking the kernel the next time they are needed.
+ */
+void pim_mroute_update_counters_bulk(struct pim_instance *pim, pim_sgaddr *sg,
+				     const struct channel_counts *cc)
+{
+	struct channel_oil *c_oil = pim_find_channel_oil(pim, sg);
+
+	if (!c_oil || !c_oil->installed)
+		return;
+
+	c_oil->cc.oldpktcnt = c_oil->cc.pktcnt;
+	c_oil->cc.oldbytecnt = c_oil->cc.bytecnt;
+	c_oil->cc.oldwrong_if = c_oil->cc.wrong_if;
+
+	c_oil->cc.lastused = cc->lastused;
+	c_oil->cc.pktcnt = cc->pktcnt;
+	c_oil->cc.bytecnt = cc->bytecnt;
+	c_oil->cc.wrong_if = cc->wrong_if;
+	c_oil->cc_fresh = true;
+}
+
+void pim_mroute_update_counters_cached(struct channel_oil *c_oil)
+{
+	if (c_oil->cc_fresh) {
+		c_oil->cc_fresh = false;
+		return;
+	}
+
+	pim_mroute_update_counters(c_oil);
+}
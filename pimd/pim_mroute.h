@@ -156,6 +156,7 @@ typedef struct sioc_sg_req6 pim_sioc_sg_req;
 */
 
 struct channel_oil;
+struct channel_counts;
 struct pim_instance;
 struct pim_upstream;
 struct pim_rpf;
@@ -177,6 +178,9 @@ void pim_static_mroute_iif_update(struct channel_oil *c_oil,
 int pim_mroute_del(struct channel_oil *c_oil, const char *name);
 
 void pim_mroute_update_counters(struct channel_oil *c_oil);
+void pim_mroute_update_counters_cached(struct channel_oil *c_oil);
+void pim_mroute_update_counters_bulk(struct pim_instance *pim, pim_sgaddr *sg,
+				     const struct channel_counts *cc);
 bool pim_mroute_allow_iif_in_oil(struct channel_oil *c_oil,
 		int oif_index);
 int pim_mroute_msg(struct pim_instance *pim, const char *buf, size_t buf_size,
@@ -252,8 +252,8 @@ static struct pim_msdp_sa *pim_msdp_sa_new(struct pim_instance *pim,
 	sa->uptime = pim_time_monotonic_sec();
 
 	/* insert into misc tables for easy access */
-	sa = hash_get(pim->msdp.sa_hash, sa, hash_alloc_intern);
-	listnode_add_sort(pim->msdp.sa_list, sa);
+	msdp_sa_tree_add(pim->msdp.sa_tree, sa);
+	msdp_sa_rp_add(pim->msdp.sa_rp, sa);
 
 	if (pim_msdp_log_sa_events(pim))
 		zlog_info("MSDP SA %s created", sa->sg_str);
@@ -267,7 +267,18 @@ static struct pim_msdp_sa *pim_msdp_sa_find(struct pim_instance *pim,
 	struct pim_msdp_sa lookup;
 
 	lookup.sg = *sg;
-	return hash_lookup(pim->msdp.sa_hash, &lookup);
+	return msdp_sa_tree_find(pim->msdp.sa_tree, &lookup);
+}
+
+/* the RP index is keyed on sa->rp, so it has to be re-inserted on change */
+static void pim_msdp_sa_rp_set(struct pim_msdp_sa *sa, struct in_addr rp)
+{
+	if (sa->rp.s_addr == rp.s_addr)
+		return;
+
+	msdp_sa_rp_del(sa->pim->msdp.sa_rp, sa);
+	sa->rp = rp;
+	msdp_sa_rp_add(sa->pim->msdp.sa_rp, sa);
 }
 
 static struct pim_msdp_sa *pim_msdp_sa_add(struct pim_instance *pim,
@@ -293,8 +304,8 @@ static void pim_msdp_sa_del(struct pim_msdp_sa *sa)
 	pim_msdp_sa_state_timer_setup(sa, false /* start */);
 
 	/* remove the entry from various tables */
-	listnode_delete(sa->pim->msdp.sa_list, sa);
-	hash_release(sa->pim->msdp.sa_hash, sa);
+	msdp_sa_tree_del(sa->pim->msdp.sa_tree, sa);
+	msdp_sa_rp_del(sa->pim->msdp.sa_rp, sa);
 
 	if (pim_msdp_log_sa_events(sa->pim))
 		zlog_info("MSDP SA %s deleted", sa->sg_str);
@@ -328,7 +339,7 @@ static void pim_msdp_sa_peer_ip_set(struct pim_msdp_sa *sa,
 	} else {
 		sa->peer.s_addr = PIM_NET_INADDR_ANY;
 	}
-	sa->rp = rp;
+	pim_msdp_sa_rp_set(sa, rp);
 }
 
 /* When a local active-source is removed there is no way to withdraw the
@@ -385,6 +396,7 @@ void pim_msdp_sa_ref(struct pim_instance *pim, struct pim_msdp_peer *mp,
 		     pim_sgaddr *sg, struct in_addr rp)
 {
 	struct pim_msdp_sa *sa;
+	struct in_addr originator;
 	struct prefix grp;
 
 	/* Check peer SA limit. */
@@ -425,8 +437,9 @@ void pim_msdp_sa_ref(struct pim_instance *pim, struct pim_msdp_peer *mp,
 
 			/* send an immediate SA update to peers */
 			pim_addr_to_prefix(&grp, sa->sg.grp);
-			pim_msdp_originator_id(pim, &grp, &sa->rp);
-			pim_msdp_pkt_sa_tx_one(sa);
+			pim_msdp_originator_id(pim, &grp, &originator);
+			pim_msdp_sa_rp_set(sa, originator);
+			pim_msdp_pkt_sa_tx_new(sa);
 		}
 		sa->flags &= ~PIM_MSDP_SAF_STALE;
 	}
@@ -575,8 +588,6 @@ static void pim_msdp_sa_local_setup(struct pim_instance *pim)
 /* XXX: needs to be tested */
 void pim_msdp_i_am_rp_changed(struct pim_instance *pim)
 {
-	struct listnode *sanode;
-	struct listnode *nextnode;
 	struct pim_msdp_sa *sa;
 
 	if (!(pim->msdp.flags & PIM_MSDPF_ENABLE)) {
@@ -589,7 +600,7 @@ void pim_msdp_i_am_rp_changed(struct pim_instance *pim)
 	}
 
 	/* mark all local entries as stale */
-	for (ALL_LIST_ELEMENTS_RO(pim->msdp.sa_list, sanode, sa)) {
+	frr_each (msdp_sa_tree, pim->msdp.sa_tree, sa) {
 		if (sa->flags & PIM_MSDP_SAF_LOCAL) {
 			sa->flags |= PIM_MSDP_SAF_STALE;
 		}
@@ -598,7 +609,7 @@ void pim_msdp_i_am_rp_changed(struct pim_instance *pim)
 	/* re-setup local SA entries */
 	pim_msdp_sa_local_setup(pim);
 
-	for (ALL_LIST_ELEMENTS(pim->msdp.sa_list, sanode, nextnode, sa)) {
+	frr_each_safe (msdp_sa_tree, pim->msdp.sa_tree, sa) {
 		/* purge stale SA entries */
 		if (sa->flags & PIM_MSDP_SAF_STALE) {
 			/* clear the stale flag; the entry may be kept even
@@ -620,11 +631,36 @@ void pim_msdp_i_am_rp_changed(struct pim_instance *pim)
 /* We track the join state of (*, G) entries. If G has sources in the SA-cache
  * we need to setup or teardown SPT when the JoinDesired status changes for
  * (*, G) */
+/* The SA tree is ordered by group first, so a group's SAs are adjacent */
+static struct pim_msdp_sa *pim_msdp_sa_group_first(struct pim_instance *pim,
+						   pim_addr grp)
+{
+	struct pim_msdp_sa lookup = {};
+	struct pim_msdp_sa *sa;
+
+	lookup.sg.grp = grp;
+	sa = msdp_sa_tree_find_gteq(pim->msdp.sa_tree, &lookup);
+	if (sa && pim_addr_cmp(sa->sg.grp, grp))
+		return NULL;
+
+	return sa;
+}
+
+static struct pim_msdp_sa *pim_msdp_sa_group_next(struct pim_instance *pim,
+						  struct pim_msdp_sa *sa)
+{
+	struct pim_msdp_sa *next = msdp_sa_tree_next(pim->msdp.sa_tree, sa);
+
+	if (next && pim_addr_cmp(next->sg.grp, sa->sg.grp))
+		return NULL;
+
+	return next;
+}
+
 void pim_msdp_up_join_state_changed(struct pim_instance *pim,
 				    struct pim_upstream *xg_up)
 {
-	struct listnode *sanode;
-	struct pim_msdp_sa *sa;
+	struct pim_msdp_sa *sa, *next;
 
 	if (PIM_DEBUG_MSDP_INTERNAL) {
 		zlog_debug("MSDP join state changed for %s", xg_up->sg_str);
@@ -635,20 +671,15 @@ void pim_msdp_up_join_state_changed(struct pim_instance *pim,
 		return;
 	}
 
-	/* XXX: Need to maintain SAs per-group to avoid all this unnecessary
-	 * walking */
-	for (ALL_LIST_ELEMENTS_RO(pim->msdp.sa_list, sanode, sa)) {
-		if (pim_addr_cmp(sa->sg.grp, xg_up->sg.grp)) {
-			continue;
-		}
+	for (sa = pim_msdp_sa_group_first(pim, xg_up->sg.grp); sa; sa = next) {
+		next = pim_msdp_sa_group_next(pim, sa);
 		pim_msdp_sa_upstream_update(sa, xg_up, "up-jp-change");
 	}
 }
 
 static void pim_msdp_up_xg_del(struct pim_instance *pim, pim_sgaddr *sg)
 {
-	struct listnode *sanode;
-	struct pim_msdp_sa *sa;
+	struct pim_msdp_sa *sa, *next;
 
 	if (PIM_DEBUG_MSDP_INTERNAL) {
 		zlog_debug("MSDP %pSG del", sg);
@@ -659,12 +690,8 @@ static void pim_msdp_up_xg_del(struct pim_instance *pim, pim_sgaddr *sg)
 		return;
 	}
 
-	/* XXX: Need to maintain SAs per-group to avoid all this unnecessary
-	 * walking */
-	for (ALL_LIST_ELEMENTS_RO(pim->msdp.sa_list, sanode, sa)) {
-		if (pim_addr_cmp(sa->sg.grp, sg->grp)) {
-			continue;
-		}
+	for (sa = pim_msdp_sa_group_first(pim, sg->grp); sa; sa = next) {
+		next = pim_msdp_sa_group_next(pim, sa);
 		pim_msdp_sa_upstream_update(sa, NULL /* xg */, "up-jp-change");
 	}
 }
@@ -681,26 +708,20 @@ void pim_msdp_up_del(struct pim_instance *pim, pim_sgaddr *sg)
 	}
 }
 
-/* sa hash and peer list helpers */
-static unsigned int pim_msdp_sa_hash_key_make(const void *p)
-{
-	const struct pim_msdp_sa *sa = p;
-
-	return pim_sgaddr_hash(sa->sg, 0);
-}
-
-static bool pim_msdp_sa_hash_eq(const void *p1, const void *p2)
+/* sa tree and peer list helpers */
+int pim_msdp_sa_cmp(const struct pim_msdp_sa *sa1,
+		    const struct pim_msdp_sa *sa2)
 {
-	const struct pim_msdp_sa *sa1 = p1;
-	const struct pim_msdp_sa *sa2 = p2;
-
-	return !pim_sgaddr_cmp(sa1->sg, sa2->sg);
+	return pim_sgaddr_cmp(sa1->sg, sa2->sg);
 }
 
-static int pim_msdp_sa_comp(const void *p1, const void *p2)
+int pim_msdp_sa_rp_cmp(const struct pim_msdp_sa *sa1,
+		       const struct pim_msdp_sa *sa2)
 {
-	const struct pim_msdp_sa *sa1 = p1;
-	const struct pim_msdp_sa *sa2 = p2;
+	if (ntohl(sa1->rp.s_addr) < ntohl(sa2->rp.s_addr))
+		return -1;
+	if (ntohl(sa1->rp.s_addr) > ntohl(sa2->rp.s_addr))
+		return 1;
 
 	return pim_sgaddr_cmp(sa1->sg, sa2->sg);
 }
@@ -1550,13 +1571,8 @@ void pim_msdp_init(struct pim_instance *pim, struct event_loop *master)
 	pim->msdp.peer_list->del = (void (*)(void *))pim_msdp_peer_free;
 	pim->msdp.peer_list->cmp = (int (*)(void *, void *))pim_msdp_peer_comp;
 
-	snprintf(hash_name, sizeof(hash_name), "PIM %s MSDP SA Hash",
-		 pim->vrf->name);
-	pim->msdp.sa_hash = hash_create(pim_msdp_sa_hash_key_make,
-					pim_msdp_sa_hash_eq, hash_name);
-	pim->msdp.sa_list = list_new();
-	pim->msdp.sa_list->del = (void (*)(void *))pim_msdp_sa_free;
-	pim->msdp.sa_list->cmp = (int (*)(void *, void *))pim_msdp_sa_comp;
+	msdp_sa_tree_init(pim->msdp.sa_tree);
+	msdp_sa_rp_init(pim->msdp.sa_rp);
 
 	/* MSDP global timer defaults. */
 	pim->msdp.hold_time = PIM_MSDP_PEER_HOLD_TIME;
@@ -1570,6 +1586,7 @@ void pim_msdp_init(struct pim_instance *pim, struct event_loop *master)
 void pim_msdp_exit(struct pim_instance *pim)
 {
 	struct pim_msdp_mg *mg;
+	struct pim_msdp_sa *sa;
 
 	msdp_rp_cache_clear(pim);
 
@@ -1585,11 +1602,14 @@ void pim_msdp_exit(struct pim_instance *pim)
 		list_delete(&pim->msdp.peer_list);
 	}
 
-	hash_clean_and_free(&pim->msdp.sa_hash, NULL);
-
-	if (pim->msdp.sa_list) {
-		list_delete(&pim->msdp.sa_list);
+	while ((sa = msdp_sa_tree_pop(pim->msdp.sa_tree))) {
+		msdp_sa_rp_del(pim->msdp.sa_rp, sa);
+		pim_msdp_sa_free(sa);
 	}
+	msdp_sa_tree_fini(pim->msdp.sa_tree);
+	msdp_sa_rp_fini(pim->msdp.sa_rp);
+
+	pim_msdp_pkt_sa_tx_new_clear(pim);
 
 	if (pim->msdp.work_obuf)
 		stream_free(pim->msdp.work_obuf);
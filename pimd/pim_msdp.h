@@ -62,9 +62,17 @@ enum pim_msdp_sa_flags {
 	PIM_MSDP_SAF_UP_DEL_IN_PROG = (1 << 3)
 };
 
+PREDECL_RBTREE_UNIQ(msdp_sa_tree);
+PREDECL_RBTREE_UNIQ(msdp_sa_rp);
+
 struct pim_msdp_sa {
 	struct pim_instance *pim;
 
+	/* pim_msdp.sa_tree, by (S,G) */
+	struct msdp_sa_tree_item sa_item;
+	/* pim_msdp.sa_rp, by RP then (S,G) */
+	struct msdp_sa_rp_item rp_item;
+
 	pim_sgaddr sg;
 	char sg_str[PIM_SG_LEN];
 	struct in_addr rp;   /* Last RP address associated with this SA */
@@ -80,6 +88,15 @@ struct pim_msdp_sa {
 	struct pim_upstream *up;
 };
 
+int pim_msdp_sa_cmp(const struct pim_msdp_sa *sa1,
+		    const struct pim_msdp_sa *sa2);
+DECLARE_RBTREE_UNIQ(msdp_sa_tree, struct pim_msdp_sa, sa_item,
+		    pim_msdp_sa_cmp);
+int pim_msdp_sa_rp_cmp(const struct pim_msdp_sa *sa1,
+		       const struct pim_msdp_sa *sa2);
+DECLARE_RBTREE_UNIQ(msdp_sa_rp, struct pim_msdp_sa, rp_item,
+		    pim_msdp_sa_rp_cmp);
+
 enum pim_msdp_peer_flags {
 	PIM_MSDP_PEERF_NONE = 0,
 	PIM_MSDP_PEERF_LISTENER = (1 << 0),
@@ -214,10 +231,16 @@ struct pim_msdp {
 /* MSDP active-source info */
 #define PIM_MSDP_SA_ADVERTISMENT_TIME 60
 	struct event *sa_adv_timer; // 5.6
-	struct hash *sa_hash;
-	struct list *sa_list;
+	struct msdp_sa_tree_head sa_tree[1];
+	struct msdp_sa_rp_head sa_rp[1];
 	uint32_t local_cnt;
 
+	/* new local SAs, flooded together on the next event loop pass */
+	struct event *sa_new_timer;
+	pim_sgaddr *sa_new;
+	uint32_t sa_new_cnt;
+	uint32_t sa_new_max;
+
 	/* keep a scratch pad for building SA TLVs */
 	struct stream *work_obuf;
 
@@ -25,6 +25,8 @@
 #include "pim_msdp_packet.h"
 #include "pim_msdp_socket.h"
 
+DEFINE_MTYPE_STATIC(PIMD, MSDP_SA_TX, "MSDP SA advertisement scratch");
+
 static char *pim_msdp_pkt_type_dump(enum pim_msdp_tlv type, char *buf,
 				    int buf_size)
 {
@@ -340,35 +342,34 @@ static void pim_msdp_pkt_sa_push(struct pim_instance *pim,
 	}
 }
 
-static int pim_msdp_pkt_sa_fill_hdr(struct pim_instance *pim, int local_cnt,
-				    struct in_addr rp)
+/* the entry count is only known once the TLV is filled, see fill_done */
+static void pim_msdp_pkt_sa_fill_hdr(struct pim_instance *pim,
+				     struct in_addr rp)
 {
-	int curr_tlv_ecnt;
-
 	stream_reset(pim->msdp.work_obuf);
-	curr_tlv_ecnt = local_cnt > PIM_MSDP_SA_MAX_ENTRY_CNT
-				? PIM_MSDP_SA_MAX_ENTRY_CNT
-				: local_cnt;
-	local_cnt -= curr_tlv_ecnt;
 	stream_putc(pim->msdp.work_obuf, PIM_MSDP_V4_SOURCE_ACTIVE);
-	stream_putw(pim->msdp.work_obuf,
-		    PIM_MSDP_SA_ENTRY_CNT2SIZE(curr_tlv_ecnt));
-	stream_putc(pim->msdp.work_obuf, curr_tlv_ecnt);
+	stream_putw(pim->msdp.work_obuf, 0 /* length */);
+	stream_putc(pim->msdp.work_obuf, 0 /* entry count */);
 	stream_put_ipv4(pim->msdp.work_obuf, rp.s_addr);
+}
 
-	return local_cnt;
+static void pim_msdp_pkt_sa_fill_one(struct pim_instance *pim,
+				     const pim_sgaddr *sg)
+{
+	stream_put3(pim->msdp.work_obuf, 0 /* reserved */);
+	stream_putc(pim->msdp.work_obuf, 32 /* sprefix len */);
+	stream_put_ipv4(pim->msdp.work_obuf, sg->grp.s_addr);
+	stream_put_ipv4(pim->msdp.work_obuf, sg->src.s_addr);
 }
 
-static void pim_msdp_pkt_sa_fill_one(struct pim_msdp_sa *sa)
+static void pim_msdp_pkt_sa_fill_done(struct pim_instance *pim, int cnt)
 {
-	stream_put3(sa->pim->msdp.work_obuf, 0 /* reserved */);
-	stream_putc(sa->pim->msdp.work_obuf, 32 /* sprefix len */);
-	stream_put_ipv4(sa->pim->msdp.work_obuf, sa->sg.grp.s_addr);
-	stream_put_ipv4(sa->pim->msdp.work_obuf, sa->sg.src.s_addr);
+	stream_putw_at(pim->msdp.work_obuf, 1, PIM_MSDP_SA_ENTRY_CNT2SIZE(cnt));
+	stream_putc_at(pim->msdp.work_obuf, 3, cnt);
 }
 
-bool msdp_peer_sa_filter(const struct pim_msdp_peer *mp,
-			 const struct pim_msdp_sa *sa)
+static bool msdp_peer_sg_filter(const struct pim_msdp_peer *mp,
+				const pim_sgaddr *sg)
 {
 	struct access_list *acl;
 
@@ -378,87 +379,89 @@ bool msdp_peer_sa_filter(const struct pim_msdp_peer *mp,
 
 	/* Find access list and test it. */
 	acl = access_list_lookup(AFI_IP, mp->acl_out);
-	if (pim_access_list_apply(acl, &sa->sg.src, &sa->sg.grp) == FILTER_DENY)
+	if (pim_access_list_apply(acl, &sg->src, &sg->grp) == FILTER_DENY)
 		return true;
 
 	return false;
 }
 
-/** Count the number of SAs to be sent for a specific peer. */
-static size_t pim_msdp_peer_sa_count(const struct pim_instance *pim,
-				     const struct pim_msdp_peer *peer)
+bool msdp_peer_sa_filter(const struct pim_msdp_peer *mp,
+			 const struct pim_msdp_sa *sa)
+{
+	return msdp_peer_sg_filter(mp, &sa->sg);
+}
+
+/*
+ * Fill the scratch pad with one SA TLV; with mp set its output filter is
+ * applied.  Returns the number of entries that made it in.
+ */
+static int pim_msdp_pkt_sa_encode(struct pim_instance *pim,
+				  struct pim_msdp_peer *mp, struct in_addr rp,
+				  const pim_sgaddr *sgs, int cnt)
 {
-	const struct pim_msdp_sa *sa;
-	const struct listnode *node;
-	size_t sa_count = 0;
+	int sa_count = 0;
+	int i;
 
-	for (ALL_LIST_ELEMENTS_RO(pim->msdp.sa_list, node, sa)) {
-		if (!CHECK_FLAG(sa->flags, PIM_MSDP_SAF_LOCAL))
-			continue;
-		if (msdp_peer_sa_filter(peer, sa))
+	pim_msdp_pkt_sa_fill_hdr(pim, rp);
+	for (i = 0; i < cnt; i++) {
+		if (mp && msdp_peer_sg_filter(mp, &sgs[i])) {
+			if (pim_msdp_log_sa_events(pim))
+				zlog_info("MSDP peer %pI4 filter SA out (%pI4, %pI4)",
+					  &mp->peer, &sgs[i].src, &sgs[i].grp);
+
+			mp->acl_out_count++;
 			continue;
+		}
 
+		pim_msdp_pkt_sa_fill_one(pim, &sgs[i]);
 		sa_count++;
 	}
+	pim_msdp_pkt_sa_fill_done(pim, sa_count);
 
 	return sa_count;
 }
 
-static void pim_msdp_pkt_sa_gen(struct pim_instance *pim,
-				struct pim_msdp_peer *mp)
+/*
+ * Send SAs for one RP to the given peers.  Each TLV is encoded once and
+ * copied to all the peers without an output filter; only peers with a
+ * filter get a TLV of their own.
+ */
+static void pim_msdp_pkt_sa_tx_peers(struct pim_instance *pim,
+				     struct list *peers, struct in_addr rp,
+				     const pim_sgaddr *sgs, int cnt)
 {
-	struct listnode *sanode;
-	struct pim_msdp_sa *sa;
-	struct prefix group_all;
-	struct in_addr rp;
-	int sa_count;
-	int local_cnt = pim_msdp_peer_sa_count(pim, mp);
-
-	sa_count = 0;
-	if (PIM_DEBUG_MSDP_INTERNAL) {
-		zlog_debug("  sa gen  %d", local_cnt);
-	}
-
-	pim_get_all_mcast_group(&group_all);
-	pim_msdp_originator_id(pim, &group_all, &rp);
-	local_cnt = pim_msdp_pkt_sa_fill_hdr(pim, local_cnt, rp);
+	struct pim_msdp_peer *mp;
+	struct listnode *node;
+	bool encoded;
+	int i, n;
 
-	for (ALL_LIST_ELEMENTS_RO(pim->msdp.sa_list, sanode, sa)) {
-		if (!(sa->flags & PIM_MSDP_SAF_LOCAL)) {
-			/* current implementation of MSDP is for anycast i.e.
-			 * full mesh. so
-			 * no re-forwarding of SAs that we learnt from other
-			 * peers */
-			continue;
-		}
+	if (PIM_DEBUG_MSDP_INTERNAL)
+		zlog_debug("  sa gen %d rp %pI4", cnt, &rp);
 
-		if (msdp_peer_sa_filter(mp, sa)) {
-			if (pim_msdp_log_sa_events(pim))
-				zlog_info("MSDP peer %pI4 filter SA out %s", &mp->peer, sa->sg_str);
+	for (i = 0; i < cnt; i += n) {
+		n = MIN(cnt - i, PIM_MSDP_SA_MAX_ENTRY_CNT);
 
-			mp->acl_out_count++;
-			continue;
-		}
+		encoded = false;
+		for (ALL_LIST_ELEMENTS_RO(peers, node, mp)) {
+			if (mp->state != PIM_MSDP_ESTABLISHED || mp->acl_out)
+				continue;
 
-		/* add sa into scratch pad */
-		pim_msdp_pkt_sa_fill_one(sa);
-		++sa_count;
-		if (sa_count >= PIM_MSDP_SA_MAX_ENTRY_CNT) {
-			pim_msdp_pkt_sa_push(pim, mp);
-			/* reset headers */
-			sa_count = 0;
-			if (PIM_DEBUG_MSDP_INTERNAL) {
-				zlog_debug("  sa gen for remainder %d",
-					   local_cnt);
+			if (!encoded) {
+				pim_msdp_pkt_sa_encode(pim, NULL, rp, sgs + i,
+						       n);
+				encoded = true;
 			}
-			local_cnt = pim_msdp_pkt_sa_fill_hdr(pim, local_cnt, rp);
+			pim_msdp_pkt_sa_push(pim, mp);
 		}
-	}
 
-	if (sa_count) {
-		pim_msdp_pkt_sa_push(pim, mp);
+		for (ALL_LIST_ELEMENTS_RO(peers, node, mp)) {
+			if (mp->state != PIM_MSDP_ESTABLISHED || !mp->acl_out)
+				continue;
+
+			if (pim_msdp_pkt_sa_encode(pim, mp, rp, sgs + i, n))
+				pim_msdp_pkt_sa_push(pim, mp);
+		}
 	}
-	return;
 }
 
 static void pim_msdp_pkt_sa_tx_done(struct pim_instance *pim)
@@ -476,72 +479,145 @@ static void pim_msdp_pkt_sa_tx_done(struct pim_instance *pim)
 	}
 }
 
-void pim_msdp_pkt_sa_tx(struct pim_instance *pim)
+/* Advertise the local SAs to peers, all under one originator */
+static void pim_msdp_pkt_sa_tx_local(struct pim_instance *pim,
+				     struct list *peers)
 {
-	struct pim_msdp_peer *mp;
-	struct listnode *node;
-
-	for (ALL_LIST_ELEMENTS_RO(pim->msdp.peer_list, node, mp))
-		pim_msdp_pkt_sa_gen(pim, mp);
-
-	pim_msdp_pkt_sa_tx_done(pim);
-}
-
-void pim_msdp_pkt_sa_tx_one(struct pim_msdp_sa *sa)
-{
-	struct pim_msdp_peer *mp;
-	struct listnode *node;
+	struct pim_msdp_sa *sa;
+	struct prefix group_all;
+	struct in_addr rp;
+	pim_sgaddr *sgs;
+	int cnt = 0;
 
-	pim_msdp_pkt_sa_fill_hdr(sa->pim, 1 /* cnt */, sa->rp);
-	pim_msdp_pkt_sa_fill_one(sa);
-	for (ALL_LIST_ELEMENTS_RO(sa->pim->msdp.peer_list, node, mp)) {
-		if (msdp_peer_sa_filter(mp, sa)) {
-			if (pim_msdp_log_sa_events(sa->pim))
-				zlog_info("MSDP peer %pI4 filter SA out %s", &mp->peer, sa->sg_str);
+	if (!pim->msdp.local_cnt)
+		return;
 
-			mp->acl_out_count++;
+	sgs = XMALLOC(MTYPE_MSDP_SA_TX, pim->msdp.local_cnt * sizeof(*sgs));
+	frr_each (msdp_sa_tree, pim->msdp.sa_tree, sa) {
+		if (!(sa->flags & PIM_MSDP_SAF_LOCAL)) {
+			/* current implementation of MSDP is for anycast i.e.
+			 * full mesh. so
+			 * no re-forwarding of SAs that we learnt from other
+			 * peers */
 			continue;
 		}
+		if (cnt == (int)pim->msdp.local_cnt)
+			break;
 
-		pim_msdp_pkt_sa_push(sa->pim, mp);
+		sgs[cnt++] = sa->sg;
 	}
-	pim_msdp_pkt_sa_tx_done(sa->pim);
+
+	pim_get_all_mcast_group(&group_all);
+	pim_msdp_originator_id(pim, &group_all, &rp);
+	pim_msdp_pkt_sa_tx_peers(pim, peers, rp, sgs, cnt);
+
+	XFREE(MTYPE_MSDP_SA_TX, sgs);
+}
+
+void pim_msdp_pkt_sa_tx(struct pim_instance *pim)
+{
+	pim_msdp_pkt_sa_tx_local(pim, pim->msdp.peer_list);
+	pim_msdp_pkt_sa_tx_done(pim);
 }
 
 /* when a connection is first established we push all SAs immediately */
 void pim_msdp_pkt_sa_tx_to_one_peer(struct pim_msdp_peer *mp)
 {
-	pim_msdp_pkt_sa_gen(mp->pim, mp);
+	struct list peers;
+
+	memset(&peers, 0, sizeof(peers));
+	listnode_add(&peers, mp);
+
+	pim_msdp_pkt_sa_tx_local(mp->pim, &peers);
 	pim_msdp_pkt_sa_tx_done(mp->pim);
+
+	list_delete_all_node(&peers);
 }
 
-void pim_msdp_pkt_sa_tx_one_to_one_peer(struct pim_msdp_peer *mp,
-					struct in_addr rp, pim_sgaddr sg)
+static int pim_msdp_pkt_sa_rp_cmp(const void *p1, const void *p2)
 {
-	struct pim_msdp_sa sa;
-
-	/* Fills the SA header. */
-	pim_msdp_pkt_sa_fill_hdr(mp->pim, 1, rp);
+	const struct pim_msdp_sa *const *sa1 = p1;
+	const struct pim_msdp_sa *const *sa2 = p2;
 
-	/* Fills the message contents. */
-	sa.pim = mp->pim;
-	sa.sg = sg;
+	return pim_msdp_sa_rp_cmp(*sa1, *sa2);
+}
 
-	/* Don't push it if filtered. */
-	if (msdp_peer_sa_filter(mp, &sa)) {
-		if (pim_msdp_log_sa_events(mp->pim))
-			zlog_info("MSDP peer %pI4 filter SA out (%pI4, %pI4)", &mp->peer,
-				  &sa.sg.src, &sa.sg.grp);
+/* flood the SAs that became local since the last pass, a TLV per RP */
+static void pim_msdp_pkt_sa_tx_new_cb(struct event *t)
+{
+	struct pim_instance *pim = EVENT_ARG(t);
+	struct pim_msdp *msdp = &pim->msdp;
+	struct pim_msdp_sa **sas;
+	struct pim_msdp_sa lookup;
+	struct pim_msdp_sa *sa;
+	uint32_t i, n = 0;
+	uint32_t start;
 
-		mp->acl_out_count++;
+	if (!msdp->sa_new_cnt)
 		return;
+
+	sas = XMALLOC(MTYPE_MSDP_SA_TX, msdp->sa_new_cnt * sizeof(*sas));
+	for (i = 0; i < msdp->sa_new_cnt; i++) {
+		lookup.sg = msdp->sa_new[i];
+		sa = msdp_sa_tree_find(msdp->sa_tree, &lookup);
+		/* gone, or no longer local, by now */
+		if (!sa || !(sa->flags & PIM_MSDP_SAF_LOCAL))
+			continue;
+
+		sas[n++] = sa;
 	}
+	msdp->sa_new_cnt = 0;
 
-	pim_msdp_pkt_sa_fill_one(&sa);
+	qsort(sas, n, sizeof(*sas), pim_msdp_pkt_sa_rp_cmp);
 
-	/* Pushes the message. */
-	pim_msdp_pkt_sa_push(sa.pim, mp);
-	pim_msdp_pkt_sa_tx_done(sa.pim);
+	/* msdp->sa_new is reused to hold each RP's (S,G)s */
+	for (start = 0, i = 0; i < n; i++) {
+		if (i && sas[i] == sas[i - 1])
+			continue;
+
+		if (msdp->sa_new_cnt &&
+		    sas[i]->rp.s_addr != sas[start]->rp.s_addr) {
+			pim_msdp_pkt_sa_tx_peers(pim, msdp->peer_list,
+						 sas[start]->rp, msdp->sa_new,
+						 msdp->sa_new_cnt);
+			msdp->sa_new_cnt = 0;
+		}
+		if (!msdp->sa_new_cnt)
+			start = i;
+
+		msdp->sa_new[msdp->sa_new_cnt++] = sas[i]->sg;
+	}
+	if (msdp->sa_new_cnt)
+		pim_msdp_pkt_sa_tx_peers(pim, msdp->peer_list, sas[start]->rp,
+					 msdp->sa_new, msdp->sa_new_cnt);
+	msdp->sa_new_cnt = 0;
+
+	XFREE(MTYPE_MSDP_SA_TX, sas);
+	pim_msdp_pkt_sa_tx_done(pim);
+}
+
+void pim_msdp_pkt_sa_tx_new(struct pim_msdp_sa *sa)
+{
+	struct pim_msdp *msdp = &sa->pim->msdp;
+
+	if (msdp->sa_new_cnt == msdp->sa_new_max) {
+		msdp->sa_new_max = MAX(64, msdp->sa_new_max * 2);
+		msdp->sa_new = XREALLOC(MTYPE_MSDP_SA_TX, msdp->sa_new,
+					msdp->sa_new_max *
+						sizeof(*msdp->sa_new));
+	}
+	msdp->sa_new[msdp->sa_new_cnt++] = sa->sg;
+
+	event_add_event(msdp->master, pim_msdp_pkt_sa_tx_new_cb, sa->pim, 0,
+			&msdp->sa_new_timer);
+}
+
+void pim_msdp_pkt_sa_tx_new_clear(struct pim_instance *pim)
+{
+	event_cancel(&pim->msdp.sa_new_timer);
+	XFREE(MTYPE_MSDP_SA_TX, pim->msdp.sa_new);
+	pim->msdp.sa_new_cnt = 0;
+	pim->msdp.sa_new_max = 0;
 }
 
 static void pim_msdp_pkt_rxed_with_fatal_error(struct pim_msdp_peer *mp)
@@ -559,13 +635,13 @@ static void pim_msdp_pkt_ka_rx(struct pim_msdp_peer *mp, int len)
 	pim_msdp_peer_pkt_rxed(mp);
 }
 
-static void pim_msdp_pkt_sa_rx_one(struct pim_msdp_peer *mp, struct in_addr rp)
+/* returns whether the SA was accepted, and so is to be forwarded */
+static bool pim_msdp_pkt_sa_rx_one(struct pim_msdp_peer *mp, struct in_addr rp,
+				   pim_sgaddr *sgp)
 {
 	struct access_list *acl;
 	int prefix_len;
 	pim_sgaddr sg;
-	struct listnode *peer_node;
-	struct pim_msdp_peer *peer;
 
 	/* just throw away the three reserved bytes */
 	stream_get3(mp->ibuf);
@@ -580,7 +656,7 @@ static void pim_msdp_pkt_sa_rx_one(struct pim_msdp_peer *mp, struct in_addr rp)
 		flog_err(EC_PIM_MSDP_PACKET,
 			 "rxed sa update with invalid prefix length %d",
 			 prefix_len);
-		return;
+		return false;
 	}
 	if (PIM_DEBUG_MSDP_PACKETS) {
 		zlog_debug("  sg %pSG", &sg);
@@ -595,16 +671,32 @@ static void pim_msdp_pkt_sa_rx_one(struct pim_msdp_peer *mp, struct in_addr rp)
 					  &sg.src, &sg.grp);
 
 			mp->acl_in_count++;
-			return;
+			return false;
 		}
 	}
 
 	pim_msdp_sa_ref(mp->pim, mp, &sg, rp);
 
-	/* Forwards the SA to the peers that are not in the RPF to the RP nor in
-	 * the same mesh group as the peer from which we received the message.
-	 * If the message group is not set, i.e. "default", then we assume that
-	 * the message must be forwarded.*/
+	*sgp = sg;
+	return true;
+}
+
+/* Forwards the SAs to the peers that are not in the RPF to the RP nor in
+ * the same mesh group as the peer from which we received the message.
+ * If the message group is not set, i.e. "default", then we assume that
+ * the message must be forwarded. All of that only depends on the RP, so the
+ * whole TLV goes out in one go. */
+static void pim_msdp_pkt_sa_fwd(struct pim_msdp_peer *mp, struct in_addr rp,
+				const pim_sgaddr *sgs, int cnt)
+{
+	struct listnode *peer_node;
+	struct pim_msdp_peer *peer;
+	struct list peers;
+
+	if (!cnt)
+		return;
+
+	memset(&peers, 0, sizeof(peers));
 	for (ALL_LIST_ELEMENTS_RO(mp->pim->msdp.peer_list, peer_node, peer)) {
 		/* Not a RPF peer, so skip it. */
 		if (pim_msdp_peer_rpf_check(peer, rp))
@@ -614,14 +706,21 @@ static void pim_msdp_pkt_sa_rx_one(struct pim_msdp_peer *mp, struct in_addr rp)
 		    && strcmp(mp->mesh_group_name, peer->mesh_group_name) == 0)
 			continue;
 
-		pim_msdp_pkt_sa_tx_one_to_one_peer(peer, rp, sg);
+		listnode_add(&peers, peer);
 	}
+
+	pim_msdp_pkt_sa_tx_peers(mp->pim, &peers, rp, sgs, cnt);
+	pim_msdp_pkt_sa_tx_done(mp->pim);
+
+	list_delete_all_node(&peers);
 }
 
 static void pim_msdp_pkt_sa_rx(struct pim_msdp_peer *mp, int len)
 {
 	int entry_cnt;
 	int i;
+	int fwd_cnt = 0;
+	pim_sgaddr fwd[UINT8_MAX];
 	struct in_addr rp; /* Last RP address associated with this SA */
 	struct pim_msdp_mg *mg;
 	struct pim_instance *pim = mp->pim;
@@ -676,8 +775,11 @@ static void pim_msdp_pkt_sa_rx(struct pim_msdp_peer *mp, int len)
 
 	/* update SA cache */
 	for (i = 0; i < entry_cnt; ++i) {
-		pim_msdp_pkt_sa_rx_one(mp, rp);
+		if (pim_msdp_pkt_sa_rx_one(mp, rp, &fwd[fwd_cnt]))
+			fwd_cnt++;
 	}
+
+	pim_msdp_pkt_sa_fwd(mp, rp, fwd, fwd_cnt);
 }
 
 static void pim_msdp_pkt_rx(struct pim_msdp_peer *mp)
@@ -53,10 +53,9 @@
 void pim_msdp_pkt_ka_tx(struct pim_msdp_peer *mp);
 void pim_msdp_read(struct event *event);
 void pim_msdp_pkt_sa_tx(struct pim_instance *pim);
-void pim_msdp_pkt_sa_tx_one(struct pim_msdp_sa *sa);
+void pim_msdp_pkt_sa_tx_new(struct pim_msdp_sa *sa);
+void pim_msdp_pkt_sa_tx_new_clear(struct pim_instance *pim);
 void pim_msdp_pkt_sa_tx_to_one_peer(struct pim_msdp_peer *mp);
-void pim_msdp_pkt_sa_tx_one_to_one_peer(struct pim_msdp_peer *mp,
-					struct in_addr rp, pim_sgaddr sg);
 bool msdp_peer_sa_filter(const struct pim_msdp_peer *mp,
 			 const struct pim_msdp_sa *sa);
 
@@ -301,6 +301,9 @@ pim_neighbor_new(struct interface *ifp, pim_addr source_addr,
 		(void (*)(void *))pim_jp_agg_group_list_free;
 	pim_neighbor_start_jp_timer(neigh);
 
+	neigh->upstream_jp_trigger = list_new();
+	neigh->upstream_jp_trigger->cmp = pim_jp_agg_group_list_cmp;
+
 	pim_neighbor_timer_reset(neigh, holdtime);
 	/*
 	 * The pim_ifstat_hello_sent variable is used to decide if
@@ -391,6 +394,9 @@ void pim_neighbor_free(struct pim_neighbor *neigh)
 	list_delete(&neigh->upstream_jp_agg);
 	event_cancel(&neigh->jp_timer);
 
+	pim_jp_agg_trigger_clear(neigh);
+	list_delete(&neigh->upstream_jp_trigger);
+
 	bfd_sess_free(&neigh->bfd_session);
 
 	XFREE(MTYPE_PIM_NEIGHBOR, neigh);
@@ -32,6 +32,19 @@ struct pim_neighbor {
 
 	struct event *jp_timer;
 	struct list *upstream_jp_agg;
+
+	/* Triggered J/Ps, coalesced for PIM_JP_TRIGGER_DELAY_MSEC */
+	struct event *jp_trigger_timer;
+	struct list *upstream_jp_trigger;
+	int64_t jp_trigger_since;
+	struct {
+		uint32_t queued;
+		uint32_t packets;
+		uint32_t runs;
+		uint64_t latency_sum;
+		uint32_t latency_max;
+	} jp_trigger_stats;
+
 	struct bfd_session_params *bfd_session;
 };
 
@@ -649,6 +649,7 @@ static void pim_nht_drop_maybe(struct pim_instance *pim, struct pim_nexthop_cach
 		struct zclient *zclient = pim_zebra_zclient_get();
 
 		pim_sendmsg_zebra_rnh(pim, zclient, pnc->addr, ZEBRA_NEXTHOP_UNREGISTER);
+		zclient_lookup_nexthop_forget(pim, pnc->addr);
 
 		list_delete(&pnc->rp_list);
 
@@ -1244,8 +1245,36 @@ static bool pim_ecmp_nexthop_search(struct pim_instance *pim, struct pim_nexthop
 	return found;
 }
 
-bool pim_nht_lookup_ecmp(struct pim_instance *pim, struct pim_nexthop *nexthop, pim_addr src,
-			 struct prefix *grp, bool neighbor_needed)
+static void pim_nht_lookup_resume(struct event *t)
+{
+	struct pim_instance *pim = EVENT_ARG(t);
+
+	pim_zebra_update_all_interfaces(pim);
+}
+
+/* An asynchronous lookup started by pim_nht_lookup_ecmp_async() is answered */
+static void pim_nht_lookup_done(struct pim_instance *pim, pim_addr addr)
+{
+	struct pim_nexthop_cache *pnc;
+
+	pnc = pim_nexthop_cache_find(pim, addr);
+	if (!pnc) {
+		zclient_lookup_nexthop_forget(pim, addr);
+		return;
+	}
+
+	if (PIM_DEBUG_PIM_NHT)
+		zlog_debug("%s: lookup for %pPA(%s) answered, upstreams %ld", __func__, &addr,
+			   pim->vrf->name, pnc->upstream_hash->count);
+
+	/* Same as an NHT update, but sending joins is done once per batch */
+	hash_walk(pnc->upstream_hash, pim_update_upstream_nh_helper, pim);
+	event_add_event(router->master, pim_nht_lookup_resume, pim, 0, &pim->nht_lookup_resume);
+}
+
+static enum pim_nht_lookup_result
+pim_nht_lookup_ecmp_common(struct pim_instance *pim, struct pim_nexthop *nexthop, pim_addr src,
+			   struct prefix *grp, bool neighbor_needed, bool wait)
 {
 	struct pim_nexthop_cache *pnc;
 	int num_ifindex;
@@ -1274,15 +1303,28 @@ bool pim_nht_lookup_ecmp(struct pim_instance *pim, struct pim_nexthop *nexthop,
 	pnc = pim_nexthop_cache_find(pim, src);
 	if (pnc) {
 		if (pim_nht_pnc_has_answer(pim, pnc, group))
-			return pim_ecmp_nexthop_search(pim, pnc, nexthop, src, grp, neighbor_needed);
+			return pim_ecmp_nexthop_search(pim, pnc, nexthop, src, grp, neighbor_needed)
+				       ? PIM_NHT_LOOKUP_FOUND
+				       : PIM_NHT_LOOKUP_FAILED;
 	}
 
-	num_ifindex = zclient_lookup_nexthop(&args, PIM_NEXTHOP_LOOKUP_MAX);
+	/* Only tracked addresses go async, their answers are dropped on NHT updates */
+	if (!wait && pnc)
+		num_ifindex = zclient_lookup_nexthop_async(&args, PIM_NEXTHOP_LOOKUP_MAX,
+							   pim_nht_lookup_done);
+	else
+		num_ifindex = zclient_lookup_nexthop(&args, PIM_NEXTHOP_LOOKUP_MAX);
+	if (num_ifindex == 0) {
+		if (PIM_DEBUG_PIM_NHT_DETAIL)
+			zlog_debug("%s: lookup for %pPA(%s) in progress", __func__, &src,
+				   pim->vrf->name);
+		return PIM_NHT_LOOKUP_PENDING;
+	}
 	if (num_ifindex < 1) {
 		if (PIM_DEBUG_PIM_NHT)
 			zlog_warn("%s: could not find nexthop ifindex for address %pPA(%s)",
 				  __func__, &src, pim->vrf->name);
-		return false;
+		return PIM_NHT_LOOKUP_FAILED;
 	}
 
 	/* Count the number of neighbors for ECMP computation */
@@ -1308,7 +1350,7 @@ bool pim_nht_lookup_ecmp(struct pim_instance *pim, struct pim_nexthop *nexthop,
 			consider = num_nbrs;
 
 		if (consider == 0)
-			return false;
+			return PIM_NHT_LOOKUP_FAILED;
 
 		pim_addr_to_prefix(&src_pfx, src);
 		hash_val = pim_compute_ecmp_hash(&src_pfx, grp);
@@ -1379,7 +1421,21 @@ bool pim_nht_lookup_ecmp(struct pim_instance *pim, struct pim_nexthop *nexthop,
 		}
 	}
 
-	return found;
+	return found ? PIM_NHT_LOOKUP_FOUND : PIM_NHT_LOOKUP_FAILED;
+}
+
+bool pim_nht_lookup_ecmp(struct pim_instance *pim, struct pim_nexthop *nexthop, pim_addr src,
+			 struct prefix *grp, bool neighbor_needed)
+{
+	return pim_nht_lookup_ecmp_common(pim, nexthop, src, grp, neighbor_needed, true) ==
+	       PIM_NHT_LOOKUP_FOUND;
+}
+
+enum pim_nht_lookup_result pim_nht_lookup_ecmp_async(struct pim_instance *pim,
+						      struct pim_nexthop *nexthop, pim_addr src,
+						      struct prefix *grp, bool neighbor_needed)
+{
+	return pim_nht_lookup_ecmp_common(pim, nexthop, src, grp, neighbor_needed, false);
 }
 
 bool pim_nht_lookup(struct pim_instance *pim, struct pim_nexthop *nexthop, pim_addr addr,
@@ -1629,6 +1685,9 @@ void pim_nexthop_update(struct vrf *vrf, struct prefix *match, struct zapi_route
 		return;
 	}
 
+	/* NHT has the answer now, and it supersedes any earlier lookup */
+	zclient_lookup_nexthop_forget(pim, addr);
+
 	if (nhr->safi == SAFI_UNICAST)
 		pnc_rib = &pnc->urib;
 	else if (nhr->safi == SAFI_MULTICAST)
@@ -1836,6 +1895,9 @@ void pim_nht_init(struct pim_instance *pim)
 
 void pim_nht_terminate(struct pim_instance *pim)
 {
+	event_cancel(&pim->nht_lookup_resume);
+	zclient_lookup_nexthop_flush(pim);
+
 	/* Traverse and cleanup nht_hash */
 	hash_clean_and_free(&pim->nht_hash, (void *)pim_nht_hash_clean);
 
@@ -128,6 +128,21 @@ void pim_nht_upstream_if_update(struct pim_instance *pim, struct interface *ifp)
 bool pim_nht_lookup_ecmp(struct pim_instance *pim, struct pim_nexthop *nexthop, pim_addr src,
 			 struct prefix *grp, bool neighbor_needed);
 
+enum pim_nht_lookup_result {
+	PIM_NHT_LOOKUP_FAILED = 0,
+	PIM_NHT_LOOKUP_FOUND,
+	PIM_NHT_LOOKUP_PENDING,
+};
+
+/* Same as pim_nht_lookup_ecmp, but if src is tracked and NHT has no answer yet, the
+ * lookup is sent to zebra without waiting for it and PIM_NHT_LOOKUP_PENDING is
+ * returned, leaving nexthop untouched.  The upstreams tracking src are updated again
+ * once the answer arrives.
+ */
+enum pim_nht_lookup_result pim_nht_lookup_ecmp_async(struct pim_instance *pim,
+						      struct pim_nexthop *nexthop, pim_addr src,
+						      struct prefix *grp, bool neighbor_needed);
+
 /* Very similar to pim_nht_lookup_ecmp, but does not check the nht cache and only does
  * a synchronous lookup. No ECMP decision is made.
  */
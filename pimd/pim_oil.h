@@ -94,9 +94,15 @@ struct channel_oil {
 	int oil_inherited_rescan;
 	int oil_size;
 	int oil_ref_count;
-	time_t oif_creation[MAXVIFS];
-	uint32_t oif_flags[MAXVIFS];
+	/*
+	 * One of these per (S,G), and MAXVIFS is large for IPv6: keep the
+	 * per vif data small.  Creation is pim_time_monotonic_sec().
+	 */
+	uint32_t oif_creation[MAXVIFS];
+	uint8_t oif_flags[MAXVIFS];
 	struct channel_counts cc;
+	/* cc was refreshed by a bulk dump and not looked at since */
+	bool cc_fresh;
 	struct pim_upstream *up;
 	time_t mroute_creation;
 };
@@ -83,6 +83,7 @@ enum pim_rpf_result pim_rpf_update(struct pim_instance *pim,
 	struct prefix grp;
 	bool neigh_needed = true;
 	uint32_t saved_mrib_route_metric;
+	enum pim_nht_lookup_result lookup;
 
 	if (PIM_UPSTREAM_FLAG_TEST_STATIC_IIF(up->flags))
 		return PIM_RPF_OK;
@@ -109,7 +110,15 @@ enum pim_rpf_result pim_rpf_update(struct pim_instance *pim,
 		neigh_needed = false;
 
 	pim_nht_find_or_track(pim, up->upstream_addr, up, NULL, NULL);
-	if (!pim_nht_lookup_ecmp(pim, &rpf->source_nexthop, src, &grp, neigh_needed)) {
+	lookup = pim_nht_lookup_ecmp_async(pim, &rpf->source_nexthop, src, &grp, neigh_needed);
+	if (lookup == PIM_NHT_LOOKUP_PENDING) {
+		/* Keep the current RPF until zebra answers, the answer updates us again */
+		if (PIM_DEBUG_ZEBRA)
+			zlog_debug("%s(%s): RPF lookup for %s in progress", __func__, caller,
+				   up->sg_str);
+		return PIM_RPF_PENDING;
+	}
+	if (lookup == PIM_NHT_LOOKUP_FAILED) {
 		/* Route is Deleted in Zebra, reset the stored NH data */
 		pim_upstream_rpf_clear(pim, up);
 		pim_rpf_cost_change(pim, up, saved_mrib_route_metric);
@@ -40,7 +40,13 @@ struct pim_rpf {
 	pim_addr rpf_addr; /* RPF'(S,G) */
 };
 
-enum pim_rpf_result { PIM_RPF_OK = 0, PIM_RPF_CHANGED, PIM_RPF_FAILURE };
+/* PIM_RPF_PENDING: the lookup is still in flight, the current RPF is kept */
+enum pim_rpf_result {
+	PIM_RPF_OK = 0,
+	PIM_RPF_CHANGED,
+	PIM_RPF_FAILURE,
+	PIM_RPF_PENDING,
+};
 
 /* RPF lookup behaviour */
 enum pim_rpf_lookup_mode {
@@ -21,8 +21,10 @@
  * (,) = 3
  * NULL Character at end = 1
  * (123.123.123.123,123.123.123.123)
+ *
+ * Every upstream and ifchannel carries one, so don't size it for IPv6.
  */
-#define PIM_SG_LEN PREFIX_SG_STR_LEN
+#define PIM_SG_LEN 36
 #else
 /*
  * Longest possible length of a IPV6 (S,G) string is 94 bytes
@@ -13,6 +13,7 @@
 #include "log.h"
 #include "frrevent.h"
 #include "lib_errors.h"
+#include "jhash.h"
 
 #include "pim_time.h"
 
@@ -162,3 +163,66 @@ long pim_time_timer_remain_msec(struct event *t_timer)
 
 	return t_timer ? event_timer_remain_msec(t_timer) : 0;
 }
+
+/*
+ * Timers that are only pushed out on refresh keep their event armed at the
+ * old expiry and carry the real one in a separate timeval; the event handler
+ * re-arms itself until the expiry is reached.  These report the real expiry
+ * while the timer is running.
+ */
+long pim_time_expiry_remain_msec(struct event *t_timer,
+				 const struct timeval *expiry)
+{
+	int64_t remain;
+
+	if (!t_timer)
+		return 0;
+
+	remain = monotime_until(expiry, NULL) / 1000;
+	return remain > 0 ? remain : 0;
+}
+
+void pim_time_expiry_to_mmss(char *buf, int buf_size, struct event *t_timer,
+			     const struct timeval *expiry)
+{
+	if (t_timer)
+		pim_time_mmss(buf, buf_size,
+			      pim_time_expiry_remain_msec(t_timer, expiry) /
+				      1000);
+	else
+		snprintf(buf, buf_size, "--:--");
+}
+
+void pim_time_expiry_to_hhmmss(char *buf, int buf_size, struct event *t_timer,
+			       const struct timeval *expiry)
+{
+	if (t_timer)
+		pim_time_hhmmss(buf, buf_size,
+				pim_time_expiry_remain_msec(t_timer, expiry) /
+					1000);
+	else
+		snprintf(buf, buf_size, "--:--:--");
+}
+
+/*
+ * Delay until the next point in time that is at a per-key phase offset
+ * within interval_msec.  Periodic timers (general queries) rescheduled with
+ * this keep firing once per interval, but different keys are spread out over
+ * the interval instead of all firing in lockstep after a restart.  The
+ * result is in (0, interval_msec], so an interval only ever gets shorter.
+ */
+long pim_time_phase_msec(uint32_t key, long interval_msec)
+{
+	int64_t now_msec;
+	long phase, wait;
+
+	if (interval_msec <= 0)
+		return 0;
+
+	now_msec = monotime(NULL) / 1000;
+	phase = jhash_1word(key, 0) % interval_msec;
+	wait = (phase - now_msec % interval_msec + interval_msec) %
+	       interval_msec;
+
+	return wait ? wait : interval_msec;
+}
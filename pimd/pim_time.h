@@ -21,5 +21,12 @@ void pim_time_timer_to_hhmmss(char *buf, int buf_size, struct event *t);
 void pim_time_uptime(char *buf, int buf_size, int64_t uptime_sec);
 void pim_time_uptime_begin(char *buf, int buf_size, int64_t now, int64_t begin);
 long pim_time_timer_remain_msec(struct event *t_timer);
+void pim_time_expiry_to_mmss(char *buf, int buf_size, struct event *t_timer,
+			     const struct timeval *expiry);
+void pim_time_expiry_to_hhmmss(char *buf, int buf_size, struct event *t_timer,
+			       const struct timeval *expiry);
+long pim_time_expiry_remain_msec(struct event *t_timer,
+				 const struct timeval *expiry);
+long pim_time_phase_msec(uint32_t key, long interval_msec);
 
 #endif /* PIM_TIME_H */
@@ -85,28 +85,27 @@ static void pim_upstream_remove_children(struct pim_instance *pim,
  * A (*,G) or a (*,*) is being created
  * Find the children that would point
  * at us.
+ *
+ * The tree is sorted by group first and the (*,G) sorts ahead of all of
+ * its (S,G)s, so they are the entries right after us.
  */
 static void pim_upstream_find_new_children(struct pim_instance *pim,
 					   struct pim_upstream *up)
 {
 	struct pim_upstream *child;
 
-	if (!pim_addr_is_any(up->sg.src) && !pim_addr_is_any(up->sg.grp))
-		return;
-
-	if (pim_addr_is_any(up->sg.src) && pim_addr_is_any(up->sg.grp))
+	if (!pim_addr_is_any(up->sg.src) || pim_addr_is_any(up->sg.grp))
 		return;
 
-	frr_each (rb_pim_upstream, &pim->upstream_head, child) {
-		if (!pim_addr_is_any(up->sg.grp) &&
-		    !pim_addr_cmp(child->sg.grp, up->sg.grp) && (child != up)) {
-			child->parent = up;
-			listnode_add_sort(up->sources, child);
-			if (PIM_UPSTREAM_FLAG_TEST_USE_RPT(child->flags))
-				pim_upstream_mroute_iif_update(
-						child->channel_oil,
-						__func__);
-		}
+	for (child = rb_pim_upstream_next(&pim->upstream_head, up);
+	     child && !pim_addr_cmp(child->sg.grp, up->sg.grp);
+	     child = rb_pim_upstream_next(&pim->upstream_head, child)) {
+		child->parent = up;
+		/* in order already */
+		listnode_add(up->sources, child);
+		if (PIM_UPSTREAM_FLAG_TEST_USE_RPT(child->flags))
+			pim_upstream_mroute_iif_update(child->channel_oil,
+						       __func__);
 	}
 }
 
@@ -203,6 +202,8 @@ struct pim_upstream *pim_upstream_del(struct pim_instance *pim,
 	if (up->ref_count >= 1)
 		return up;
 
+	pim_jp_agg_trigger_upstream_del(pim, up);
+
 	if (PIM_DEBUG_TRACE)
 		zlog_debug("pim_upstream free vrf:%s %s flags 0x%x",
 			   pim->vrf->name, up->sg_str, up->flags);
@@ -303,7 +304,7 @@ void pim_upstream_send_join(struct pim_upstream *up)
 	}
 
 	/* send Join(S,G) to the current upstream neighbor */
-	pim_jp_agg_single_upstream_send(&up->rpf, up, 1 /* join */);
+	pim_jp_agg_upstream_trigger(&up->rpf, up, 1 /* join */);
 }
 
 static void on_graft_timer(struct event *t)
@@ -988,7 +989,7 @@ void pim_upstream_switch(struct pim_instance *pim, struct pim_upstream *up,
 				!I_am_RP(pim, up->sg.grp))
 			send_xg_jp = true;
 
-		pim_jp_agg_single_upstream_send(&up->rpf, up, 0 /* prune */);
+		pim_jp_agg_upstream_trigger(&up->rpf, up, 0 /* prune */);
 
 		if (send_xg_jp) {
 			if (PIM_DEBUG_PIM_TRACE_DETAIL)
@@ -1000,9 +1001,9 @@ void pim_upstream_switch(struct pim_instance *pim, struct pim_upstream *up,
 				  up->rpf.source_nexthop.interface ?
 				  up->rpf.source_nexthop.interface->name :
 				  "Unknown");
-			pim_jp_agg_single_upstream_send(&up->parent->rpf,
-							up->parent,
-							1 /* (W,G) Join */);
+			pim_jp_agg_upstream_trigger(&up->parent->rpf,
+						    up->parent,
+						    1 /* (W,G) Join */);
 		}
 		join_timer_stop(up);
 	}
@@ -1675,8 +1676,8 @@ struct pim_upstream *pim_upstream_keep_alive_timer_proc(
 		up = pim_upstream_del(pim, up, __func__);
 
 		if (parent) {
-			pim_jp_agg_single_upstream_send(&parent->rpf, parent,
-							true);
+			pim_jp_agg_upstream_trigger(&parent->rpf, parent,
+						    true);
 		}
 	}
 
@@ -1825,7 +1826,7 @@ void pim_upstream_set_sptbit(struct pim_upstream *up,
 				__func__, up->sg_str);
 		up->sptbit = PIM_UPSTREAM_SPTBIT_TRUE;
 
-		pim_jp_agg_single_upstream_send(&starup->rpf, starup, true);
+		pim_jp_agg_upstream_trigger(&starup->rpf, starup, true);
 		return;
 	}
 
@@ -2170,6 +2171,7 @@ void pim_upstream_terminate(struct pim_instance *pim)
 
 	rb_pim_upstream_fini(&pim->upstream_head);
 
+	event_cancel(&pim->t_sg_stats);
 	if (pim->upstream_sg_wheel)
 		wheel_delete(pim->upstream_sg_wheel);
 	pim->upstream_sg_wheel = NULL;
@@ -2298,7 +2300,7 @@ static bool pim_upstream_sg_running_proc(struct pim_upstream *up)
 	if (!up->channel_oil->installed)
 		return rv;
 
-	pim_mroute_update_counters(up->channel_oil);
+	pim_mroute_update_counters_cached(up->channel_oil);
 
 	// Have we seen packets?
 	if ((up->channel_oil->cc.oldpktcnt >= up->channel_oil->cc.pktcnt)
@@ -2452,14 +2454,31 @@ void pim_upstream_remove_lhr_star_pimreg(struct pim_instance *pim,
 	}
 }
 
+/*
+ * Fetch the counters of every mroute in one go ahead of the wheel going
+ * around, so the per (S,G) checks don't each need a kernel round trip.
+ */
+static void pim_upstream_sg_stats_timer(struct event *t)
+{
+	struct pim_instance *pim = EVENT_ARG(t);
+
+	if (!pim->sg_stats_pending && rb_pim_oil_count(&pim->channel_oil_head))
+		pim->sg_stats_pending = !pim_zlookup_sg_statistics_bulk(pim);
+
+	event_add_timer_msec(router->master, pim_upstream_sg_stats_timer, pim,
+			     PIM_UPSTREAM_SG_WHEEL_PERIOD, &pim->t_sg_stats);
+}
+
 void pim_upstream_init(struct pim_instance *pim)
 {
 	char name[64];
 
 	snprintf(name, sizeof(name), "PIM %s Timer Wheel", pim->vrf->name);
 	pim->upstream_sg_wheel =
-		wheel_init(router->master, 31000, 100, pim_upstream_hash_key,
-			   pim_upstream_sg_running, name);
+		wheel_init(router->master, PIM_UPSTREAM_SG_WHEEL_PERIOD, 100,
+			   pim_upstream_hash_key, pim_upstream_sg_running, name);
+	event_add_timer_msec(router->master, pim_upstream_sg_stats_timer, pim,
+			     PIM_UPSTREAM_SG_WHEEL_PERIOD, &pim->t_sg_stats);
 
 	rb_pim_upstream_init(&pim->upstream_head);
 }
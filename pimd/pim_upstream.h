@@ -238,8 +238,8 @@ struct pim_upstream {
 	pim_addr upstream_addr;		  /* Who we are talking to */
 	pim_addr upstream_register;       /*Who we received a register from*/
 	pim_sgaddr sg;			  /* (S,G) group key */
-	char sg_str[PIM_SG_LEN];
 	uint32_t flags;
+	char sg_str[PIM_SG_LEN];
 	struct channel_oil *channel_oil;
 	struct list *sources;
 	struct list *ifchannels;
@@ -252,10 +252,10 @@ struct pim_upstream {
 
 	int ref_count;
 
-	struct pim_rpf rpf;
-
 	struct pim_up_mlag mlag;
 
+	struct pim_rpf rpf;
+
 	struct event *t_join_timer;
 	struct event *t_prune_timer;
 	struct event *t_staterefresh_timer;
@@ -287,6 +287,9 @@ struct pim_upstream {
 	int64_t state_transition; /* Record current state uptime */
 };
 
+/* Every (S,G) is checked for traffic once per period, in msec */
+#define PIM_UPSTREAM_SG_WHEEL_PERIOD (31000)
+
 static inline bool pim_upstream_is_kat_running(struct pim_upstream *up)
 {
 	return (up->t_ka_timer != NULL);
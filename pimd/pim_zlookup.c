@@ -15,6 +15,9 @@
 #include "prefix.h"
 #include "vty.h"
 #include "lib_errors.h"
+#include "buffer.h"
+#include "jhash.h"
+#include "typesafe.h"
 
 #include "pimd.h"
 #include "pim_instance.h"
@@ -25,12 +28,113 @@
 #include "pim_oil.h"
 #include "pim_zlookup.h"
 #include "pim_addr.h"
+#include "pim_nht.h"
+#include "pim_mroute.h"
+
+DEFINE_MTYPE_STATIC(PIMD, PIM_ZLOOKUP_ENTRY, "PIM nexthop lookup");
+DEFINE_MTYPE_STATIC(PIMD, PIM_ZLOOKUP_WORK, "PIM nexthop lookup state");
+DEFINE_MTYPE_STATIC(PIMD, PIM_ZLOOKUP_NEXTHOPS, "PIM nexthop lookup result");
 
 static struct zclient *pim_zlookup = NULL;
 struct event *zlookup_read;
 
+/*
+ * Asynchronous nexthop lookups.
+ *
+ * These use a second zebra connection, so they never interleave with the
+ * request/reply exchanges on pim_zlookup.  Zebra answers
+ * ZEBRA_NEXTHOP_LOOKUP requests in order, so the queries on the wire are
+ * kept in a ring and matched against the replies as they come back.
+ * Lookups are deduplicated per address and their answers are kept until
+ * NHT reports a change for that address.
+ */
+#define ZLOOKUP_PIPELINE_MAX 1024
+
+PREDECL_HASH(zlookup_cache);
+PREDECL_DLIST(zlookup_queue);
+
+enum zlookup_state {
+	ZLOOKUP_QUEUED,
+	ZLOOKUP_SENT,
+	ZLOOKUP_DONE,
+};
+
+/* Recursive resolution in progress, [0] is the URIB and [1] the MRIB */
+struct zlookup_work {
+	pim_addr hop;
+	int num[2];
+	struct zclient_next_hop_args args[2];
+};
+
+struct zlookup_entry {
+	struct zlookup_cache_item hitem;
+	struct zlookup_queue_item qitem;
+
+	struct pim_instance *pim;
+	pim_addr address;
+	enum pim_rpf_lookup_mode mode;
+	pim_zlookup_done_cb done;
+
+	enum zlookup_state state;
+	/* Dropped from the cache, freed once its answers are in */
+	bool stale;
+
+	int lookup;
+	int max_lookup;
+	uint8_t outstanding;
+	uint32_t route_metric;
+	uint8_t protocol_distance;
+	struct zlookup_work *work;
+
+	/* Answer, num_ifindex < 1 if there is no usable route */
+	int num_ifindex;
+	uint32_t route_type;
+	uint32_t asn;
+	struct pim_zlookup_nexthop *next_hops;
+};
+
+static int zlookup_cache_cmp(const struct zlookup_entry *a, const struct zlookup_entry *b)
+{
+	if (a->pim != b->pim)
+		return a->pim < b->pim ? -1 : 1;
+
+	return pim_addr_cmp(a->address, b->address);
+}
+
+static uint32_t zlookup_cache_hash(const struct zlookup_entry *e)
+{
+	return jhash(&e->address, sizeof(e->address), (uintptr_t)e->pim);
+}
+
+DECLARE_HASH(zlookup_cache, struct zlookup_entry, hitem, zlookup_cache_cmp, zlookup_cache_hash);
+DECLARE_DLIST(zlookup_queue, struct zlookup_entry, qitem);
+
+struct zlookup_query {
+	struct zlookup_entry *entry;
+	safi_t safi;
+};
+
+static struct {
+	struct zclient *zclient;
+	struct event *t_send;
+
+	struct zlookup_cache_head cache;
+	struct zlookup_queue_head queue;
+
+	/* Queries sent to zebra and not answered yet */
+	struct zlookup_query ring[ZLOOKUP_PIPELINE_MAX];
+	unsigned int ring_head;
+	unsigned int ring_count;
+
+	uint64_t queries;
+	uint64_t answers;
+} zlookup_async;
+
 static void zclient_lookup_sched(struct zclient *zlookup, int delay);
 static void zclient_lookup_read_pipe(struct event *event);
+static void zlookup_async_read(struct event *event);
+static void zlookup_async_send(struct event *event);
+static void zlookup_async_reset(void);
 
 /* Connect to zebra for nexthop lookup. */
 static void zclient_lookup_connect(struct event *t)
@@ -65,6 +169,16 @@ static void zclient_lookup_connect(struct event *t)
 		return;
 	}
 
+	if (zlookup == zlookup_async.zclient) {
+		set_nonblocking(zlookup->sock);
+		event_add_read(router->master, zlookup_async_read, zlookup, zlookup->sock,
+			       &zlookup->t_read);
+		/* Anything queued while we were disconnected */
+		event_add_event(router->master, zlookup_async_send, NULL, 0,
+				&zlookup_async.t_send);
+		return;
+	}
+
 	event_add_timer(router->master, zclient_lookup_read_pipe, zlookup, 60,
 			&zlookup_read);
 }
@@ -101,6 +215,9 @@ static void zclient_lookup_reconnect(struct zclient *zlookup)
 
 static void zclient_lookup_failed(struct zclient *zlookup)
 {
+	if (zlookup == zlookup_async.zclient)
+		zlookup_async_reset();
+
 	if (zlookup->sock >= 0) {
 		if (close(zlookup->sock)) {
 			zlog_warn("%s: closing fd=%d: errno=%d %s", __func__,
@@ -114,10 +231,28 @@ static void zclient_lookup_failed(struct zclient *zlookup)
 
 void zclient_lookup_free(void)
 {
+	struct zlookup_entry *e;
+
 	event_cancel(&zlookup_read);
 	zclient_stop(pim_zlookup);
 	zclient_free(pim_zlookup);
 	pim_zlookup = NULL;
+
+	zlookup_async_reset();
+	event_cancel(&zlookup_async.t_send);
+	zclient_stop(zlookup_async.zclient);
+	zclient_free(zlookup_async.zclient);
+	zlookup_async.zclient = NULL;
+
+	while (zlookup_queue_pop(&zlookup_async.queue))
+		;
+	while ((e = zlookup_cache_pop(&zlookup_async.cache))) {
+		XFREE(MTYPE_PIM_ZLOOKUP_WORK, e->work);
+		XFREE(MTYPE_PIM_ZLOOKUP_NEXTHOPS, e->next_hops);
+		XFREE(MTYPE_PIM_ZLOOKUP_ENTRY, e);
+	}
+	zlookup_queue_fini(&zlookup_async.queue);
+	zlookup_cache_fini(&zlookup_async.cache);
 }
 
 void zclient_lookup_new(void)
@@ -136,55 +271,31 @@ void zclient_lookup_new(void)
 	zclient_lookup_sched_now(pim_zlookup);
 
 	zlog_notice("%s: zclient lookup socket initialized", __func__);
+
+	zlookup_cache_init(&zlookup_async.cache);
+	zlookup_queue_init(&zlookup_async.queue);
+
+	zlookup_async.zclient = zclient_new(router->master, &zclient_options_sync, NULL, 0);
+	zlookup_async.zclient->sock = -1;
+	zlookup_async.zclient->privs = &pimd_privs;
+
+	zclient_lookup_sched_now(zlookup_async.zclient);
 }
 
-static int zclient_read_nexthop(struct zclient_next_hop_args *args)
+/* Decode the body of a ZEBRA_NEXTHOP_LOOKUP answer into args */
+static int zclient_parse_nexthop(struct stream *s, struct zclient_next_hop_args *args)
 {
 	size_t num_ifindex = 0;
-	struct stream *s;
-	uint16_t length;
-	uint8_t marker;
-	uint8_t version;
-	vrf_id_t vrf_id;
-	uint16_t command = 0;
 	struct ipaddr raddr;
 	uint8_t distance;
 	uint32_t metric;
 	uint16_t prefix_len;
 	int nexthop_num;
-	int i, err;
+	int i;
 	uint32_t opaque_data_length;
 	long long first_asn;
 	char opaque_data[ZAPI_MESSAGE_OPAQUE_LENGTH];
 
-	if (PIM_DEBUG_PIM_NHT_DETAIL)
-		zlog_debug("%s: addr=%pPAs(%s)", __func__, &args->address, args->pim->vrf->name);
-
-	if (args->zlookup == NULL)
-		args->zlookup = pim_zlookup;
-
-	s = args->zlookup->ibuf;
-
-	while (command != ZEBRA_NEXTHOP_LOOKUP) {
-		stream_reset(s);
-		err = zclient_read_header(s, args->zlookup->sock, &length, &marker, &version,
-					  &vrf_id, &command);
-		if (err < 0) {
-			flog_err(EC_LIB_ZAPI_MISSMATCH,
-				 "%s: zclient_read_header() failed", __func__);
-			zclient_lookup_failed(args->zlookup);
-			return -1;
-		}
-
-		if (command == ZEBRA_ERROR) {
-			enum zebra_error_types error;
-
-			zapi_error_decode(s, &error);
-			/* Do nothing with it for now */
-			return -1;
-		}
-	}
-
 	stream_get_ipaddr(s, &raddr);
 
 	if (raddr.ipa_type != PIM_IPADDR || pim_addr_cmp(raddr.ipaddr_pim, args->address)) {
@@ -343,6 +454,47 @@ static int zclient_read_nexthop(struct zclient_next_hop_args *args)
 	return num_ifindex;
 }
 
+static int zclient_read_nexthop(struct zclient_next_hop_args *args)
+{
+	struct stream *s;
+	uint16_t length;
+	uint8_t marker;
+	uint8_t version;
+	vrf_id_t vrf_id;
+	uint16_t command = 0;
+	int err;
+
+	if (PIM_DEBUG_PIM_NHT_DETAIL)
+		zlog_debug("%s: addr=%pPAs(%s)", __func__, &args->address, args->pim->vrf->name);
+
+	if (args->zlookup == NULL)
+		args->zlookup = pim_zlookup;
+
+	s = args->zlookup->ibuf;
+
+	while (command != ZEBRA_NEXTHOP_LOOKUP) {
+		stream_reset(s);
+		err = zclient_read_header(s, args->zlookup->sock, &length, &marker, &version,
+					  &vrf_id, &command);
+		if (err < 0) {
+			flog_err(EC_LIB_ZAPI_MISSMATCH,
+				 "%s: zclient_read_header() failed", __func__);
+			zclient_lookup_failed(args->zlookup);
+			return -1;
+		}
+
+		if (command == ZEBRA_ERROR) {
+			enum zebra_error_types error;
+
+			zapi_error_decode(s, &error);
+			/* Do nothing with it for now */
+			return -1;
+		}
+	}
+
+	return zclient_parse_nexthop(s, args);
+}
+
 static int zclient_rib_lookup(struct zclient_next_hop_args *args, safi_t safi)
 {
 	struct stream *s;
@@ -398,31 +550,15 @@ static int zclient_rib_lookup(struct zclient_next_hop_args *args, safi_t safi)
 	return zclient_read_nexthop(args);
 }
 
-static int zclient_lookup_nexthop_once(struct zclient_next_hop_args *args)
+/*
+ * Pick between the URIB and MRIB answers for args->address according to
+ * the lookup mode, copying the winner into args.
+ */
+static int zclient_lookup_choose(struct zclient_next_hop_args *args,
+				 enum pim_rpf_lookup_mode mode,
+				 struct zclient_next_hop_args *unicast_args, int urib_num,
+				 struct zclient_next_hop_args *multicast_args, int mrib_num)
 {
-	enum pim_rpf_lookup_mode mode;
-
-	mode = pim_get_lookup_mode(args->pim, args->group, args->address);
-
-	if (mode == MCAST_MRIB_ONLY)
-		return zclient_rib_lookup(args, SAFI_MULTICAST);
-
-	if (mode == MCAST_URIB_ONLY)
-		return zclient_rib_lookup(args, SAFI_UNICAST);
-
-	/* All other modes require looking up both tables and making a choice */
-	struct zclient_next_hop_args unicast_args = *args;
-	struct zclient_next_hop_args multicast_args = *args;
-	int mrib_num;
-	int urib_num;
-
-	if (PIM_DEBUG_PIM_NHT_DETAIL)
-		zlog_debug("%s: addr=%pPAs(%s), looking up both MRIB and URIB", __func__,
-			   &args->address, args->pim->vrf->name);
-
-	urib_num = zclient_rib_lookup(&unicast_args, SAFI_UNICAST);
-	mrib_num = zclient_rib_lookup(&multicast_args, SAFI_MULTICAST);
-
 	if (PIM_DEBUG_PIM_NHT_DETAIL)
 		zlog_debug("%s: addr=%pPAs(%s), MRIB nexthops=%d, URIB nexthops=%d", __func__,
 			   &args->address, args->pim->vrf->name, mrib_num, urib_num);
@@ -430,14 +566,14 @@ static int zclient_lookup_nexthop_once(struct zclient_next_hop_args *args)
 	/* If only one table has results, use that always */
 	if (mrib_num < 1) {
 		if (urib_num > 0)
-			*args = unicast_args;
+			*args = *unicast_args;
 
 		return urib_num;
 	}
 
 	if (urib_num < 1) {
 		if (mrib_num > 0)
-			*args = multicast_args;
+			*args = *multicast_args;
 
 		return mrib_num;
 	}
@@ -446,19 +582,19 @@ static int zclient_lookup_nexthop_once(struct zclient_next_hop_args *args)
 	/* Both tables have results, so compare them. Distance and prefix length are the same for all
 	 * nexthops, so only compare the first in the list
 	 */
-	if (mode == MCAST_MIX_DISTANCE && multicast_args.next_hops[0].protocol_distance >
-						  unicast_args.next_hops[0].protocol_distance) {
+	if (mode == MCAST_MIX_DISTANCE && multicast_args->next_hops[0].protocol_distance >
+						  unicast_args->next_hops[0].protocol_distance) {
 		if (PIM_DEBUG_PIM_NHT_DETAIL)
 			zlog_debug("%s: addr=%pPAs(%s), URIB has shortest distance", __func__,
 				   &args->address, args->pim->vrf->name);
-		*args = unicast_args;
+		*args = *unicast_args;
 		return urib_num;
 	} else if (mode == MCAST_MIX_PFXLEN &&
-		   multicast_args.next_hops[0].prefix_len < unicast_args.next_hops[0].prefix_len) {
+		   multicast_args->next_hops[0].prefix_len < unicast_args->next_hops[0].prefix_len) {
 		if (PIM_DEBUG_PIM_NHT_DETAIL)
 			zlog_debug("%s: addr=%pPAs(%s), URIB has lengthest prefix length", __func__,
 				   &args->address, args->pim->vrf->name);
-		*args = multicast_args;
+		*args = *multicast_args;
 		return urib_num;
 	}
 
@@ -469,10 +605,39 @@ static int zclient_lookup_nexthop_once(struct zclient_next_hop_args *args)
 	if (PIM_DEBUG_PIM_NHT_DETAIL)
 		zlog_debug("%s: addr=%pPAs(%s), MRIB has nexthops", __func__, &args->address,
 			   args->pim->vrf->name);
-	*args = multicast_args;
+	*args = *multicast_args;
 	return mrib_num;
 }
 
+static int zclient_lookup_nexthop_once(struct zclient_next_hop_args *args)
+{
+	enum pim_rpf_lookup_mode mode;
+
+	mode = pim_get_lookup_mode(args->pim, args->group, args->address);
+
+	if (mode == MCAST_MRIB_ONLY)
+		return zclient_rib_lookup(args, SAFI_MULTICAST);
+
+	if (mode == MCAST_URIB_ONLY)
+		return zclient_rib_lookup(args, SAFI_UNICAST);
+
+	/* All other modes require looking up both tables and making a choice */
+	struct zclient_next_hop_args unicast_args = *args;
+	struct zclient_next_hop_args multicast_args = *args;
+	int mrib_num;
+	int urib_num;
+
+	if (PIM_DEBUG_PIM_NHT_DETAIL)
+		zlog_debug("%s: addr=%pPAs(%s), looking up both MRIB and URIB", __func__,
+			   &args->address, args->pim->vrf->name);
+
+	urib_num = zclient_rib_lookup(&unicast_args, SAFI_UNICAST);
+	mrib_num = zclient_rib_lookup(&multicast_args, SAFI_MULTICAST);
+
+	return zclient_lookup_choose(args, mode, &unicast_args, urib_num, &multicast_args,
+				     mrib_num);
+}
+
 void zclient_lookup_read_pipe(struct event *event)
 {
 	struct zclient_next_hop_args args = {
@@ -490,6 +655,90 @@ void zclient_lookup_read_pipe(struct event *event)
 	event_add_timer(router->master, zclient_lookup_read_pipe, args.zlookup, 60, &zlookup_read);
 }
 
+/*
+ * Evaluate the answer to step "lookup" of a recursive nexthop resolution.
+ * Returns the number of nexthops once a non-recursive nexthop is found, 0
+ * if args->address was replaced by the recursive nexthop which has to be
+ * looked up next, and < 0 on failure.
+ */
+static int zclient_lookup_nexthop_step(struct zclient_next_hop_args *args, int num_ifindex,
+				       int lookup, int max_lookup, uint32_t *route_metric,
+				       uint8_t *protocol_distance)
+{
+	int first_ifindex;
+	pim_addr nexthop_addr;
+
+	if (num_ifindex < 1) {
+		if (PIM_DEBUG_PIM_NHT_DETAIL)
+			zlog_debug("%s: lookup=%d/%d: could not find nexthop ifindex for address %pPA(%s)",
+				   __func__, lookup, max_lookup, &args->address,
+				   args->pim->vrf->name);
+		return -1;
+	}
+
+	if (lookup < 1) {
+		/* this is the non-recursive lookup - save original
+		 * metric/distance */
+		*route_metric = args->next_hops[0].route_metric;
+		*protocol_distance = args->next_hops[0].protocol_distance;
+	}
+
+	/*
+	 * FIXME: Non-recursive nexthop ensured only for first ifindex.
+	 * However, recursive route lookup should really be fixed in
+	 * zebra daemon.
+	 * See also TODO T24.
+	 *
+	 * So Zebra for NEXTHOP_TYPE_IPV4 returns the ifindex now since
+	 * it was being stored.  This Doesn't solve all cases of
+	 * recursive lookup but for the most common types it does.
+	 */
+	first_ifindex = args->next_hops[0].ifindex;
+	nexthop_addr = args->next_hops[0].nexthop_addr;
+	if (first_ifindex > 0) {
+		/* found: first ifindex is non-recursive nexthop */
+
+		if (lookup > 0) {
+			/* Report non-recursive success after first
+			 * lookup */
+			if (PIM_DEBUG_PIM_NHT)
+				zlog_debug("%s: lookup=%d/%d: found non-recursive ifindex=%d for address %pPA(%s) dist=%d met=%d",
+					   __func__, lookup, max_lookup, first_ifindex,
+					   &args->address, args->pim->vrf->name,
+					   args->next_hops[0].protocol_distance,
+					   args->next_hops[0].route_metric);
+
+			/* use last address as nexthop address */
+			args->next_hops[0].nexthop_addr = args->address;
+
+			/* report original route metric/distance */
+			args->next_hops[0].route_metric = *route_metric;
+			args->next_hops[0].protocol_distance = *protocol_distance;
+		}
+
+		return num_ifindex;
+	}
+
+	if (PIM_DEBUG_PIM_NHT)
+		zlog_debug("%s: lookup=%d/%d: zebra returned recursive nexthop %pPAs for address %pPA(%s) dist=%d met=%d",
+			   __func__, lookup, max_lookup, &nexthop_addr, &args->address,
+			   args->pim->vrf->name, args->next_hops[0].protocol_distance,
+			   args->next_hops[0].route_metric);
+
+	args->address = nexthop_addr; /* use nexthop
+				addr for recursive lookup */
+
+	if (lookup + 1 >= max_lookup) {
+		if (PIM_DEBUG_PIM_NHT)
+			zlog_warn("%s: lookup=%d/%d: failure searching recursive nexthop ifindex for address %pPA(%s)",
+				  __func__, lookup + 1, max_lookup, &args->address,
+				  args->pim->vrf->name);
+		return -2;
+	}
+
+	return 0;
+}
+
 int zclient_lookup_nexthop(struct zclient_next_hop_args *args, int max_lookup)
 {
 	int lookup;
@@ -500,77 +749,435 @@ int zclient_lookup_nexthop(struct zclient_next_hop_args *args, int max_lookup)
 
 	for (lookup = 0; lookup < max_lookup; ++lookup) {
 		int num_ifindex;
-		int first_ifindex;
-		pim_addr nexthop_addr;
 
 		num_ifindex = zclient_lookup_nexthop_once(args);
-		if (num_ifindex < 1) {
-			if (PIM_DEBUG_PIM_NHT_DETAIL)
-				zlog_debug("%s: lookup=%d/%d: could not find nexthop ifindex for address %pPA(%s)",
-					   __func__, lookup, max_lookup, &args->address,
-					   args->pim->vrf->name);
-			return -1;
+		num_ifindex = zclient_lookup_nexthop_step(args, num_ifindex, lookup, max_lookup,
+							  &route_metric, &protocol_distance);
+		if (num_ifindex)
+			return num_ifindex;
+	}
+
+	return -2;
+}
+
+static void zlookup_entry_free(struct zlookup_entry *e)
+{
+	XFREE(MTYPE_PIM_ZLOOKUP_WORK, e->work);
+	XFREE(MTYPE_PIM_ZLOOKUP_NEXTHOPS, e->next_hops);
+	XFREE(MTYPE_PIM_ZLOOKUP_ENTRY, e);
+}
+
+/* Drop an entry from the cache; lookups still on the wire are left to drain */
+static void zlookup_entry_forget(struct zlookup_entry *e)
+{
+	zlookup_cache_del(&zlookup_async.cache, e);
+
+	switch (e->state) {
+	case ZLOOKUP_QUEUED:
+		zlookup_queue_del(&zlookup_async.queue, e);
+		zlookup_entry_free(e);
+		break;
+	case ZLOOKUP_SENT:
+		e->stale = true;
+		break;
+	case ZLOOKUP_DONE:
+		zlookup_entry_free(e);
+		break;
+	}
+}
+
+static void zlookup_entry_queue(struct zlookup_entry *e, bool first)
+{
+	e->state = ZLOOKUP_QUEUED;
+	if (first)
+		zlookup_queue_add_head(&zlookup_async.queue, e);
+	else
+		zlookup_queue_add_tail(&zlookup_async.queue, e);
+
+	event_add_event(router->master, zlookup_async_send, NULL, 0, &zlookup_async.t_send);
+}
+
+/* All queries for the current hop of e are answered, move on */
+static void zlookup_entry_step(struct zlookup_entry *e)
+{
+	struct zlookup_work *w = e->work;
+	struct zclient_next_hop_args *args;
+	int num;
+
+	switch (e->mode) {
+	case MCAST_MRIB_ONLY:
+		args = &w->args[1];
+		num = w->num[1];
+		break;
+	case MCAST_URIB_ONLY:
+		args = &w->args[0];
+		num = w->num[0];
+		break;
+	default:
+		args = &w->args[0];
+		num = zclient_lookup_choose(args, e->mode, &w->args[0], w->num[0], &w->args[1],
+					    w->num[1]);
+		break;
+	}
+
+	num = zclient_lookup_nexthop_step(args, num, e->lookup, e->max_lookup, &e->route_metric,
+					  &e->protocol_distance);
+	if (num == 0) {
+		/* Recursive nexthop, resolve it before anything new */
+		e->lookup++;
+		w->hop = args->address;
+		zlookup_entry_queue(e, true);
+		return;
+	}
+
+	e->num_ifindex = num;
+	if (num > 0) {
+		e->route_type = args->route_type;
+		e->asn = args->asn;
+		e->next_hops = XMALLOC(MTYPE_PIM_ZLOOKUP_NEXTHOPS, num * sizeof(*e->next_hops));
+		memcpy(e->next_hops, args->next_hops, num * sizeof(*e->next_hops));
+	}
+	XFREE(MTYPE_PIM_ZLOOKUP_WORK, e->work);
+	e->state = ZLOOKUP_DONE;
+
+	if (PIM_DEBUG_PIM_NHT_DETAIL)
+		zlog_debug("%s: addr=%pPA(%s) answered, num_ifindex=%d", __func__, &e->address,
+			   e->pim->vrf->name, num);
+
+	/* e may be gone after this */
+	if (e->done)
+		e->done(e->pim, e->address);
+}
+
+/* Put the queries of all queued lookups on the wire, as far as the ring allows */
+static void zlookup_async_send(struct event *event)
+{
+	struct zclient *zlookup = zlookup_async.zclient;
+	struct zlookup_entry *e;
+	struct ipaddr ipaddr;
+	struct stream *s;
+
+	if (zlookup->sock < 0)
+		return;
+
+	s = zlookup->obuf;
+	ipaddr.ipa_type = PIM_IPADDR;
+
+	while ((e = zlookup_queue_first(&zlookup_async.queue))) {
+		safi_t safis[2];
+		int i, n = 0;
+
+		if (e->mode != MCAST_MRIB_ONLY)
+			safis[n++] = SAFI_UNICAST;
+		if (e->mode != MCAST_URIB_ONLY)
+			safis[n++] = SAFI_MULTICAST;
+
+		if (zlookup_async.ring_count + n > ZLOOKUP_PIPELINE_MAX)
+			break;
+
+		zlookup_queue_del(&zlookup_async.queue, e);
+		e->state = ZLOOKUP_SENT;
+		e->outstanding = n;
+		ipaddr.ipaddr_pim = e->work->hop;
+
+		for (i = 0; i < n; i++) {
+			struct zlookup_query *q;
+			struct zclient_next_hop_args *args;
+
+			args = &e->work->args[safis[i] == SAFI_MULTICAST];
+			args->pim = e->pim;
+			args->zlookup = zlookup;
+			args->address = e->work->hop;
+
+			stream_reset(s);
+			zclient_create_header(s, ZEBRA_NEXTHOP_LOOKUP, e->pim->vrf->vrf_id);
+			stream_put_ipaddr(s, &ipaddr);
+			stream_putc(s, safis[i]);
+			stream_putw_at(s, 0, stream_get_endp(s));
+			buffer_put(zlookup->wb, STREAM_DATA(s), stream_get_endp(s));
+
+			q = &zlookup_async.ring[(zlookup_async.ring_head + zlookup_async.ring_count) %
+						ZLOOKUP_PIPELINE_MAX];
+			q->entry = e;
+			q->safi = safis[i];
+			zlookup_async.ring_count++;
+			zlookup_async.queries++;
+		}
+	}
+
+	if (event_is_scheduled(zlookup->t_write))
+		return;
+
+	switch (buffer_flush_available(zlookup->wb, zlookup->sock)) {
+	case BUFFER_ERROR:
+		flog_err(EC_LIB_SOCKET, "%s: write failure on zclient async lookup socket: %s",
+			 __func__, safe_strerror(errno));
+		zclient_lookup_failed(zlookup);
+		break;
+	case BUFFER_PENDING:
+		event_add_write(router->master, zlookup_async_send, NULL, zlookup->sock,
+				&zlookup->t_write);
+		break;
+	case BUFFER_EMPTY:
+		break;
+	}
+}
+
+/* Match an answer from zebra against the oldest query on the wire */
+static int zlookup_async_answer(struct stream *s, uint16_t command)
+{
+	struct zlookup_query *q;
+	struct zlookup_entry *e;
+	struct zclient_next_hop_args *args;
+	int idx;
+
+	if (!zlookup_async.ring_count) {
+		zlog_warn("%s: unsolicited nexthop lookup answer", __func__);
+		return -1;
+	}
+
+	q = &zlookup_async.ring[zlookup_async.ring_head];
+	zlookup_async.ring_head = (zlookup_async.ring_head + 1) % ZLOOKUP_PIPELINE_MAX;
+	zlookup_async.ring_count--;
+	zlookup_async.answers++;
+
+	e = q->entry;
+	if (e->stale) {
+		if (--e->outstanding == 0)
+			zlookup_entry_free(e);
+		return 0;
+	}
+
+	idx = q->safi == SAFI_MULTICAST;
+	args = &e->work->args[idx];
+	if (command == ZEBRA_NEXTHOP_LOOKUP)
+		e->work->num[idx] = zclient_parse_nexthop(s, args);
+	else
+		e->work->num[idx] = -1;
+
+	if (--e->outstanding == 0)
+		zlookup_entry_step(e);
+
+	return 0;
+}
+
+/* One part of the answer to pim_zlookup_sg_statistics_bulk() */
+static void zlookup_async_sg_statistics(struct stream *s, vrf_id_t vrf_id)
+{
+	struct pim_instance *pim = pim_get_pim_instance(vrf_id);
+	uint32_t family, count, i;
+	uint8_t flags;
+	int32_t status;
+
+	STREAM_GETL(s, family);
+	STREAM_GETC(s, flags);
+	STREAM_GETL(s, status);
+	STREAM_GETL(s, count);
+
+	if (!pim || family != PIM_AF)
+		return;
+
+	for (i = 0; i < count; i++) {
+		struct channel_counts cc = {};
+		pim_sgaddr sg;
+
+		STREAM_GET(&sg.src, s, sizeof(pim_addr));
+		STREAM_GET(&sg.grp, s, sizeof(pim_addr));
+		STREAM_GETQ(s, cc.lastused);
+		STREAM_GETQ(s, cc.pktcnt);
+		STREAM_GETQ(s, cc.bytecnt);
+		STREAM_GETQ(s, cc.wrong_if);
+
+		pim_mroute_update_counters_bulk(pim, &sg, &cc);
+	}
+
+	if (CHECK_FLAG(flags, ZAPI_IPMR_STATS_BULK_LAST)) {
+		pim->sg_stats_pending = false;
+		if (status < 0 && PIM_DEBUG_ZEBRA)
+			zlog_debug("%s: mroute counters of %s could not be dumped, querying one by one",
+				   __func__, pim->vrf->name);
+	}
+	return;
+
+stream_failure:
+	zlog_warn("%s: unable to parse mroute counters", __func__);
+}
+
+static void zlookup_async_read(struct event *event)
+{
+	struct zclient *zlookup = EVENT_ARG(event);
+	struct stream *s = zlookup->ibuf;
+	ssize_t nbytes;
+
+	nbytes = stream_read_try(s, zlookup->sock, STREAM_WRITEABLE(s));
+	if (nbytes == 0 || nbytes == -1) {
+		flog_err(EC_LIB_ZAPI_SOCKET, "%s: connection closed on zclient async lookup socket",
+			 __func__);
+		zclient_lookup_failed(zlookup);
+		return;
+	}
+
+	while (STREAM_READABLE(s) >= ZEBRA_HEADER_SIZE) {
+		size_t start = stream_get_getp(s);
+		uint16_t length = stream_getw_from(s, start);
+		struct zmsghdr hdr;
+
+		if (length < ZEBRA_HEADER_SIZE || length > STREAM_SIZE(s)) {
+			flog_err(EC_LIB_ZAPI_MISSMATCH, "%s: bad message length %u", __func__,
+				 length);
+			zclient_lookup_failed(zlookup);
+			return;
 		}
 
-		if (lookup < 1) {
-			/* this is the non-recursive lookup - save original
-			 * metric/distance */
-			route_metric = args->next_hops[0].route_metric;
-			protocol_distance = args->next_hops[0].protocol_distance;
+		if (STREAM_READABLE(s) < length)
+			break;
+
+		zapi_parse_header(s, &hdr);
+		if (hdr.marker != ZEBRA_HEADER_MARKER || hdr.version != ZSERV_VERSION) {
+			flog_err(EC_LIB_ZAPI_MISSMATCH, "%s: marker %d version %d mismatch",
+				 __func__, hdr.marker, hdr.version);
+			zclient_lookup_failed(zlookup);
+			return;
 		}
 
-		/*
-		 * FIXME: Non-recursive nexthop ensured only for first ifindex.
-		 * However, recursive route lookup should really be fixed in
-		 * zebra daemon.
-		 * See also TODO T24.
-		 *
-		 * So Zebra for NEXTHOP_TYPE_IPV4 returns the ifindex now since
-		 * it was being stored.  This Doesn't solve all cases of
-		 * recursive lookup but for the most common types it does.
-		 */
-		first_ifindex = args->next_hops[0].ifindex;
-		nexthop_addr = args->next_hops[0].nexthop_addr;
-		if (first_ifindex > 0) {
-			/* found: first ifindex is non-recursive nexthop */
-
-			if (lookup > 0) {
-				/* Report non-recursive success after first
-				 * lookup */
-				if (PIM_DEBUG_PIM_NHT)
-					zlog_debug("%s: lookup=%d/%d: found non-recursive ifindex=%d for address %pPA(%s) dist=%d met=%d",
-						   __func__, lookup, max_lookup, first_ifindex,
-						   &args->address, args->pim->vrf->name,
-						   args->next_hops[0].protocol_distance,
-						   args->next_hops[0].route_metric);
-
-				/* use last address as nexthop address */
-				args->next_hops[0].nexthop_addr = args->address;
-
-				/* report original route metric/distance */
-				args->next_hops[0].route_metric = route_metric;
-				args->next_hops[0].protocol_distance = protocol_distance;
-			}
+		if (hdr.command == ZEBRA_IPMR_ROUTE_STATS_BULK)
+			zlookup_async_sg_statistics(s, hdr.vrf_id);
+		else if ((hdr.command == ZEBRA_NEXTHOP_LOOKUP || hdr.command == ZEBRA_ERROR) &&
+			 zlookup_async_answer(s, hdr.command) < 0) {
+			zclient_lookup_failed(zlookup);
+			return;
+		}
 
-			return num_ifindex;
+		stream_set_getp(s, start + length);
+	}
+
+	stream_pulldown(s);
+	event_add_read(router->master, zlookup_async_read, zlookup, zlookup->sock,
+		       &zlookup->t_read);
+
+	if (zlookup_queue_count(&zlookup_async.queue))
+		event_add_event(router->master, zlookup_async_send, NULL, 0,
+				&zlookup_async.t_send);
+}
+
+/* The connection is gone, queue everything that was on the wire again */
+static void zlookup_async_reset(void)
+{
+	struct zclient *zlookup = zlookup_async.zclient;
+	struct vrf *vrf;
+
+	while (zlookup_async.ring_count) {
+		struct zlookup_entry *e = zlookup_async.ring[zlookup_async.ring_head].entry;
+
+		zlookup_async.ring_head = (zlookup_async.ring_head + 1) % ZLOOKUP_PIPELINE_MAX;
+		zlookup_async.ring_count--;
+
+		if (--e->outstanding)
+			continue;
+
+		if (e->stale)
+			zlookup_entry_free(e);
+		else {
+			e->state = ZLOOKUP_QUEUED;
+			zlookup_queue_add_head(&zlookup_async.queue, e);
 		}
+	}
+	zlookup_async.ring_head = 0;
 
-		if (PIM_DEBUG_PIM_NHT)
-			zlog_debug("%s: lookup=%d/%d: zebra returned recursive nexthop %pPAs for address %pPA(%s) dist=%d met=%d",
-				   __func__, lookup, max_lookup, &nexthop_addr, &args->address,
-				   args->pim->vrf->name, args->next_hops[0].protocol_distance,
-				   args->next_hops[0].route_metric);
+	/* Counters asked for will never come, ask again on the next round */
+	RB_FOREACH (vrf, vrf_name_head, &vrfs_by_name) {
+		struct pim_instance *pim = vrf->info;
 
-		args->address = nexthop_addr; /* use nexthop
-					addr for recursive lookup */
+		if (pim)
+			pim->sg_stats_pending = false;
+	}
 
-	} /* for (max_lookup) */
+	event_cancel(&zlookup->t_read);
+	event_cancel(&zlookup->t_write);
+	stream_reset(zlookup->ibuf);
+	buffer_reset(zlookup->wb);
+}
 
-	if (PIM_DEBUG_PIM_NHT)
-		zlog_warn("%s: lookup=%d/%d: failure searching recursive nexthop ifindex for address %pPA(%s)",
-			  __func__, lookup, max_lookup, &args->address, args->pim->vrf->name);
+int zclient_lookup_nexthop_async(struct zclient_next_hop_args *args, int max_lookup,
+				 pim_zlookup_done_cb done)
+{
+	struct zlookup_entry ref, *e;
+	enum pim_rpf_lookup_mode mode;
 
-	return -2;
+	if (!zlookup_async.zclient || zlookup_async.zclient->sock < 0)
+		return zclient_lookup_nexthop(args, max_lookup);
+
+	if (args->pim->vrf->vrf_id == VRF_UNKNOWN) {
+		zlog_notice("%s: VRF: %s does not fully exist yet, delaying lookup", __func__,
+			    args->pim->vrf->name);
+		return -1;
+	}
+
+	mode = pim_get_lookup_mode(args->pim, args->group, args->address);
+
+	ref.pim = args->pim;
+	ref.address = args->address;
+	e = zlookup_cache_find(&zlookup_async.cache, &ref);
+	if (e && e->mode != mode) {
+		zlookup_entry_forget(e);
+		e = NULL;
+	}
+
+	if (e) {
+		if (e->state != ZLOOKUP_DONE) {
+			args->pim->nexthop_lookups_deduped++;
+			return 0;
+		}
+
+		args->pim->nexthop_lookups_avoided++;
+		if (e->num_ifindex > 0) {
+			args->route_type = e->route_type;
+			args->asn = e->asn;
+			memcpy(args->next_hops, e->next_hops,
+			       e->num_ifindex * sizeof(*e->next_hops));
+		}
+		return e->num_ifindex;
+	}
+
+	args->pim->nexthop_lookups++;
+
+	e = XCALLOC(MTYPE_PIM_ZLOOKUP_ENTRY, sizeof(*e));
+	e->pim = args->pim;
+	e->address = args->address;
+	e->mode = mode;
+	e->done = done;
+	e->max_lookup = max_lookup;
+	e->route_metric = 0xFFFFFFFF;
+	e->protocol_distance = 0xFF;
+	e->work = XCALLOC(MTYPE_PIM_ZLOOKUP_WORK, sizeof(*e->work));
+	e->work->hop = args->address;
+	zlookup_cache_add(&zlookup_async.cache, e);
+
+	if (PIM_DEBUG_PIM_NHT_DETAIL)
+		zlog_debug("%s: addr=%pPA(%s) queued", __func__, &e->address, e->pim->vrf->name);
+
+	zlookup_entry_queue(e, false);
+	return 0;
+}
+
+void zclient_lookup_nexthop_forget(struct pim_instance *pim, pim_addr address)
+{
+	struct zlookup_entry ref, *e;
+
+	ref.pim = pim;
+	ref.address = address;
+	e = zlookup_cache_find(&zlookup_async.cache, &ref);
+	if (e)
+		zlookup_entry_forget(e);
+}
+
+void zclient_lookup_nexthop_flush(struct pim_instance *pim)
+{
+	struct zlookup_entry *e;
+
+	frr_each_safe (zlookup_cache, &zlookup_async.cache, e)
+		if (e->pim == pim)
+			zlookup_entry_forget(e);
 }
 
 void pim_zlookup_show_ip_multicast(struct vty *vty)
@@ -581,6 +1188,40 @@ void pim_zlookup_show_ip_multicast(struct vty *vty)
 	} else {
 		vty_out(vty, "<null zclient>\n");
 	}
+
+	vty_out(vty, "Zclient async lookup socket: ");
+	if (zlookup_async.zclient) {
+		vty_out(vty, "%d failures=%d\n", zlookup_async.zclient->sock,
+			zlookup_async.zclient->fail);
+		vty_out(vty, "Nexthop lookups: %u in flight, %zu queued, %zu known, %" PRIu64
+			" queries, %" PRIu64 " answers\n",
+			zlookup_async.ring_count, zlookup_queue_count(&zlookup_async.queue),
+			zlookup_cache_count(&zlookup_async.cache), zlookup_async.queries,
+			zlookup_async.answers);
+	} else {
+		vty_out(vty, "<null zclient>\n");
+	}
+}
+
+int pim_zlookup_sg_statistics_bulk(struct pim_instance *pim)
+{
+	struct zclient *zlookup = zlookup_async.zclient;
+	struct stream *s;
+
+	if (!zlookup || zlookup->sock < 0 || pim->vrf->vrf_id == VRF_UNKNOWN)
+		return -1;
+
+	/* The vrf goes in the body, zebra answers for an unknown one too */
+	s = zlookup->obuf;
+	stream_reset(s);
+	zclient_create_header(s, ZEBRA_IPMR_ROUTE_STATS_BULK, VRF_DEFAULT);
+	stream_putl(s, PIM_AF);
+	stream_putl(s, pim->vrf->vrf_id);
+	stream_putw_at(s, 0, stream_get_endp(s));
+	buffer_put(zlookup->wb, STREAM_DATA(s), stream_get_endp(s));
+
+	event_add_event(router->master, zlookup_async_send, NULL, 0, &zlookup_async.t_send);
+	return 0;
 }
 
 int pim_zlookup_sg_statistics(struct channel_oil *c_oil)
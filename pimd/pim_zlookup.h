@@ -14,6 +14,7 @@
 #define PIM_NEXTHOP_LOOKUP_MAX (3) /* max. recursive route lookup */
 
 struct channel_oil;
+struct pim_instance;
 
 struct pim_zlookup_nexthop {
 	vrf_id_t vrf_id;
@@ -52,12 +53,34 @@ struct zclient_next_hop_args {
 	struct pim_zlookup_nexthop next_hops[MULTIPATH_NUM];
 };
 
+/* Called when an asynchronous lookup for address has been answered */
+typedef void (*pim_zlookup_done_cb)(struct pim_instance *pim, pim_addr address);
+
 void zclient_lookup_new(void);
 void zclient_lookup_free(void);
 
 int zclient_lookup_nexthop(struct zclient_next_hop_args *args, int max_lookup);
 
+/*
+ * Non-blocking variant of zclient_lookup_nexthop().  Returns the number of
+ * nexthops if an answer for args->address is already known, < 0 if that
+ * answer was a failure, and 0 if the lookup is still in progress; done is
+ * then called once zebra has answered.  Concurrent lookups for the same
+ * address are sent to zebra only once.  Answers are kept until
+ * zclient_lookup_nexthop_forget() is called for the address.
+ */
+int zclient_lookup_nexthop_async(struct zclient_next_hop_args *args, int max_lookup,
+				 pim_zlookup_done_cb done);
+void zclient_lookup_nexthop_forget(struct pim_instance *pim, pim_addr address);
+/* Drop every answer and pending lookup of the given instance */
+void zclient_lookup_nexthop_flush(struct pim_instance *pim);
+
 void pim_zlookup_show_ip_multicast(struct vty *vty);
 
 int pim_zlookup_sg_statistics(struct channel_oil *c_oil);
+/*
+ * Ask zebra for the counters of all mroutes of the instance at once; they
+ * are stored as they come in, see pim_mroute_update_counters_bulk().
+ */
+int pim_zlookup_sg_statistics_bulk(struct pim_instance *pim);
 #endif /* PIM_ZLOOKUP_H */
@@ -0,0 +1,377 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Distributed BFD data plane protocol tests.
+ *
+ * bfdd data plane code talks to a stand-in data plane running in a child
+ * process over a UNIX socket, once announcing bulk messages support and once
+ * as a data plane that only knows the original messages.
+ */
+#include <zebra.h>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+
+#include "frr_pthread.h"
+#include "frrevent.h"
+
+#include "bfdd/bfd.h"
+#include "bfdd/bfddp_packet.h"
+
+#define TEST_SESSIONS 10000
+#define TEST_TIMEOUT  30
+
+/* Sessions that fit in one `DP_ADD_SESSIONS` message. */
+#define TEST_SESSIONS_PER_MSG                                                  \
+	((UINT16_MAX - sizeof(struct bfddp_message_header)                     \
+	  - sizeof(struct bfddp_sessions))                                     \
+	 / sizeof(struct bfddp_session))
+
+/* bfdd.c isn't linked in, provide what it would. */
+struct event_loop *master;
+struct bfd_global bglobal;
+
+const struct bfd_diag_str_list diag_list[] = {
+	{ .str = NULL },
+};
+
+const struct bfd_state_str_list state_list[] = {
+	{ .str = "admin-down", .type = PTM_BFD_ADM_DOWN },
+	{ .str = "down", .type = PTM_BFD_DOWN },
+	{ .str = "init", .type = PTM_BFD_INIT },
+	{ .str = "up", .type = PTM_BFD_UP },
+	{ .str = NULL },
+};
+
+void socket_close(int *s)
+{
+	if (*s <= 0)
+		return;
+
+	close(*s);
+	*s = -1;
+}
+
+static struct bfd_session *sessions[TEST_SESSIONS];
+
+/*
+ * Stand-in data plane.
+ */
+struct standin {
+	int sock;
+	bool bulk;
+
+	uint8_t buf[2 * 65536];
+	size_t len;
+
+	bool known[TEST_SESSIONS + 1];
+	uint32_t nknown;
+
+	uint32_t add_msgs;
+	uint32_t bulk_msgs;
+	uint32_t counters_msgs;
+};
+
+static void standin_send(struct standin *dp, const void *msg, size_t len)
+{
+	const uint8_t *p = msg;
+	ssize_t rv;
+
+	while (len > 0) {
+		rv = write(dp->sock, p, len);
+		if (rv == -1 && errno == EINTR)
+			continue;
+		assert(rv > 0);
+		p += rv;
+		len -= rv;
+	}
+}
+
+static void standin_header(struct bfddp_message_header *bh, uint16_t type,
+			   uint16_t id, size_t len)
+{
+	bh->version = BFD_DP_VERSION;
+	bh->zero = 0;
+	bh->type = htons(type);
+	bh->id = id;
+	bh->length = htons(len);
+}
+
+static void standin_session(struct standin *dp,
+			    const struct bfddp_session *session)
+{
+	uint32_t lid = ntohl(session->lid);
+
+	assert(lid >= 1 && lid <= TEST_SESSIONS);
+	if (!dp->known[lid])
+		dp->nknown++;
+	dp->known[lid] = true;
+}
+
+static void standin_counters(struct standin *dp, uint32_t lid,
+			     struct bfddp_session_counters *counters)
+{
+	memset(counters, 0, sizeof(*counters));
+	counters->lid = htonl(lid);
+	if (lid < 1 || lid > TEST_SESSIONS || !dp->known[lid])
+		return;
+
+	counters->control_input_packets = htobe64(lid);
+	counters->control_output_packets = htobe64(2 * (uint64_t)lid);
+	counters->echo_input_packets = htobe64(3 * (uint64_t)lid);
+	counters->echo_output_packets = htobe64(4 * (uint64_t)lid);
+}
+
+static void standin_handle(struct standin *dp, struct bfddp_message *msg)
+{
+	struct bfddp_message reply = {};
+	const struct bfddp_sessions *bulk;
+	const struct bfddp_request_counters_bulk *req;
+	struct bfddp_message_header *bh;
+	struct bfddp_counters_bulk *counters;
+	size_t len;
+	uint32_t i, count;
+
+	switch (ntohs(msg->header.type)) {
+	case ECHO_REQUEST:
+		len = sizeof(reply.header) + sizeof(reply.data.echo);
+		standin_header(&reply.header, ECHO_REPLY, msg->header.id, len);
+		reply.data.echo = msg->data.echo;
+		standin_send(dp, &reply, len);
+		break;
+
+	case DP_ADD_SESSION:
+		dp->add_msgs++;
+		standin_session(dp, &msg->data.session);
+		break;
+
+	case DP_ADD_SESSIONS:
+		assert(dp->bulk);
+		dp->bulk_msgs++;
+		bulk = (const struct bfddp_sessions *)&msg->data;
+		count = ntohl(bulk->count);
+		assert(ntohs(msg->header.length)
+		       == sizeof(msg->header) + sizeof(*bulk)
+				  + count * sizeof(bulk->sessions[0]));
+		for (i = 0; i < count; i++)
+			standin_session(dp, &bulk->sessions[i]);
+		break;
+
+	case DP_REQUEST_SESSION_COUNTERS:
+		dp->counters_msgs++;
+		len = sizeof(reply.header) + sizeof(reply.data.session_counters);
+		standin_header(&reply.header, BFD_SESSION_COUNTERS,
+			       msg->header.id, len);
+		standin_counters(dp, ntohl(msg->data.counters_req.lid),
+				 &reply.data.session_counters);
+		standin_send(dp, &reply, len);
+		break;
+
+	case DP_REQUEST_COUNTERS_BULK:
+		assert(dp->bulk);
+		dp->counters_msgs++;
+		req = (const struct bfddp_request_counters_bulk *)&msg->data;
+		count = ntohl(req->count);
+		len = sizeof(*bh) + sizeof(*counters)
+		      + count * sizeof(counters->counters[0]);
+		assert(len <= UINT16_MAX);
+
+		bh = XCALLOC(MTYPE_TMP, len);
+		counters = (struct bfddp_counters_bulk *)(bh + 1);
+		standin_header(bh, BFD_COUNTERS_BULK, msg->header.id, len);
+		counters->count = htonl(count);
+		for (i = 0; i < count; i++)
+			standin_counters(dp, ntohl(req->lid[i]),
+					 &counters->counters[i]);
+		standin_send(dp, bh, len);
+		XFREE(MTYPE_TMP, bh);
+		break;
+
+	case DP_DELETE_SESSION:
+	default:
+		assert(!"unexpected message");
+	}
+}
+
+static int standin_run(const char *path, bool bulk)
+{
+	struct sockaddr_un sun = { .sun_family = AF_UNIX };
+	struct bfddp_message msg = {};
+	struct bfddp_message_header *bh;
+	struct standin *dp;
+	size_t len, min_bulk;
+	ssize_t rv;
+	int i, ok;
+
+	dp = XCALLOC(MTYPE_TMP, sizeof(*dp));
+	dp->bulk = bulk;
+	dp->sock = socket(AF_UNIX, SOCK_STREAM, 0);
+	assert(dp->sock != -1);
+	strlcpy(sun.sun_path, path, sizeof(sun.sun_path));
+
+	/* bfdd might not be listening yet. */
+	for (i = 0; connect(dp->sock, (struct sockaddr *)&sun, sizeof(sun));
+	     i++) {
+		assert(i < TEST_TIMEOUT * 100);
+		usleep(10000);
+	}
+
+	/* Announce features before anything else. */
+	if (bulk) {
+		len = sizeof(msg.header) + sizeof(msg.data.capabilities);
+		standin_header(&msg.header, BFD_CAPABILITIES, 0, len);
+		msg.data.capabilities.flags = htonl(CAPABILITY_BULK);
+		standin_send(dp, &msg, len);
+	}
+
+	/* Serve until bfdd goes away. */
+	for (;;) {
+		rv = read(dp->sock, dp->buf + dp->len, sizeof(dp->buf) - dp->len);
+		if (rv == -1 && errno == EINTR)
+			continue;
+		if (rv <= 0)
+			break;
+		dp->len += rv;
+
+		len = 0;
+		while (dp->len - len >= sizeof(*bh)) {
+			bh = (struct bfddp_message_header *)(dp->buf + len);
+			assert(bh->version == BFD_DP_VERSION);
+			assert(ntohs(bh->length) >= sizeof(*bh));
+			if (ntohs(bh->length) > dp->len - len)
+				break;
+
+			standin_handle(dp, (struct bfddp_message *)bh);
+			len += ntohs(bh->length);
+		}
+		memmove(dp->buf, dp->buf + len, dp->len - len);
+		dp->len -= len;
+	}
+
+	printf("  data plane got %u sessions: %u single, %u bulk messages, "
+	       "%u counters requests\n",
+	       dp->nknown, dp->add_msgs, dp->bulk_msgs, dp->counters_msgs);
+
+	min_bulk = (TEST_SESSIONS + TEST_SESSIONS_PER_MSG - 1)
+		   / TEST_SESSIONS_PER_MSG;
+	ok = dp->nknown == TEST_SESSIONS;
+	if (bulk)
+		ok = ok && dp->add_msgs == 0 && dp->bulk_msgs >= min_bulk
+		     && dp->bulk_msgs <= 2 * min_bulk
+		     && dp->counters_msgs < TEST_SESSIONS / 100;
+	else
+		ok = ok && dp->add_msgs == TEST_SESSIONS && dp->bulk_msgs == 0
+		     && dp->counters_msgs == TEST_SESSIONS + 1;
+
+	close(dp->sock);
+	XFREE(MTYPE_TMP, dp);
+	return ok ? 0 : 1;
+}
+
+/*
+ * bfdd side.
+ */
+static void test_timeout(struct event *t)
+{
+	assert(!"data plane test timed out");
+}
+
+static bool sessions_attached(void)
+{
+	for (size_t i = 0; i < TEST_SESSIONS; i++)
+		if (sessions[i]->bdc == NULL)
+			return false;
+
+	return true;
+}
+
+static void bfdd_run(const char *path)
+{
+	struct sockaddr_un sun = { .sun_family = AF_UNIX };
+	struct event *timeout = NULL;
+	struct event thread;
+	struct bfd_session *bs;
+	size_t i;
+
+	master = event_master_create(NULL);
+	frr_pthread_init();
+	bfd_initialize();
+
+	for (i = 0; i < TEST_SESSIONS; i++) {
+		bs = bfd_session_new(BFD_MODE_TYPE_BFD);
+		bs->key.family = AF_INET;
+		bs->key.peer.s6_addr32[0] = htonl(0x0a000000 + i);
+		bs->key.local.s6_addr32[0] = htonl(0x0b000000 + i);
+		bs->discrs.my_discr = i + 1;
+		assert(bfd_id_insert(bs));
+		assert(bfd_key_insert(bs));
+		sessions[i] = bs;
+	}
+
+	strlcpy(sun.sun_path, path, sizeof(sun.sun_path));
+	bfd_dplane_init((struct sockaddr *)&sun, sizeof(sun), false);
+
+	/* Sessions are registered once the data plane answers our echo. */
+	event_add_timer(master, test_timeout, NULL, TEST_TIMEOUT, &timeout);
+	while (!sessions_attached() && event_fetch(master, &thread))
+		event_call(&thread);
+
+	/* Requests are sent after the registrations still buffered. */
+	assert(bfd_dplane_update_counters() == 0);
+	for (i = 0; i < TEST_SESSIONS; i++) {
+		bs = sessions[i];
+		assert(bs->stats.rx_ctrl_pkt == i + 1);
+		assert(bs->stats.tx_ctrl_pkt == 2 * (i + 1));
+		assert(bs->stats.rx_echo_pkt == 3 * (i + 1));
+		assert(bs->stats.tx_echo_pkt == 4 * (i + 1));
+	}
+
+	/* The single session query still works. */
+	sessions[0]->stats.rx_ctrl_pkt = 0;
+	assert(bfd_dplane_update_session_counters(sessions[0]) == 0);
+	assert(sessions[0]->stats.rx_ctrl_pkt == 1);
+
+	/* Exiting closes the connection, the data plane checks what it got. */
+	unlink(path);
+}
+
+static void test_dplane(bool bulk)
+{
+	char path[64];
+	pid_t dp_pid, bfdd_pid;
+	int status;
+
+	printf("Testing %s data plane with %u sessions...\n",
+	       bulk ? "bulk capable" : "legacy", TEST_SESSIONS);
+
+	snprintf(path, sizeof(path), "/tmp/test_bfdd_dplane.%d", getpid());
+	unlink(path);
+	fflush(stdout);
+
+	dp_pid = fork();
+	assert(dp_pid != -1);
+	if (dp_pid == 0)
+		exit(standin_run(path, bulk));
+
+	/* Every run starts with a fresh bfdd. */
+	bfdd_pid = fork();
+	assert(bfdd_pid != -1);
+	if (bfdd_pid == 0) {
+		bfdd_run(path);
+		exit(0);
+	}
+
+	assert(waitpid(bfdd_pid, &status, 0) == bfdd_pid);
+	assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+	assert(waitpid(dp_pid, &status, 0) == dp_pid);
+	assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+}
+
+int main(int argc, char **argv)
+{
+	test_dplane(true);
+	test_dplane(false);
+
+	printf("Done.\n");
+	return 0;
+}
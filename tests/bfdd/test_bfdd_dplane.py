@@ -0,0 +1,9 @@
+# SPDX-License-Identifier: GPL-2.0-or-later
+import frrtest
+
+
+class TestBfddDplane(frrtest.TestMultiOut):
+    program = "./test_bfdd_dplane"
+
+
+TestBfddDplane.exit_cleanly()
@@ -0,0 +1,163 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * BFD packet engine timer wheel and transmit scheduling tests.
+ */
+#include "bfdd/bfd_rt.c"
+
+#define TEST_SESSIONS 2000
+
+/* bfdd.c isn't linked in, provide what it would. */
+struct event_loop *master;
+struct bfd_global bglobal;
+
+const struct bfd_diag_str_list diag_list[] = {
+	{ .str = NULL },
+};
+
+const struct bfd_state_str_list state_list[] = {
+	{ .str = NULL },
+};
+
+void socket_close(int *s)
+{
+	if (*s <= 0)
+		return;
+
+	close(*s);
+	*s = -1;
+}
+
+static struct bfd_rt_session *test_session(uint32_t discr)
+{
+	struct bfd_rt_session *rs = XCALLOC(MTYPE_BFDD_RT_SESSION, sizeof(*rs));
+
+	rs->discr = discr;
+	rs->sd = -1;
+	rs->tx.rs = rs;
+	rs->tx.is_tx = true;
+	rs->detect.rs = rs;
+	return rs;
+}
+
+static void test_wheel_init(struct bfd_rt_wheel *w)
+{
+	memset(w, 0, sizeof(*w));
+	for (size_t i = 0; i < array_size(w->slots); i++)
+		bfd_rt_slot_init(&w->slots[i]);
+}
+
+/* Timers expire at their tick, not before, later rounds wait their turn */
+static void test_expiry(void)
+{
+	struct bfd_rt_wheel *w = &rt.wheel;
+	struct bfd_rt_session *a = test_session(1), *b = test_session(2);
+	struct bfd_rt_session *c = test_session(3), *d = test_session(4);
+	uint64_t start = 1000;
+
+	test_wheel_init(w);
+
+	bfd_rt_wheel_add_at(w, &a->tx, start, start + 5);
+	bfd_rt_wheel_add_at(w, &b->detect, start, start + 5);
+	/* same slot, next turn of the wheel */
+	bfd_rt_wheel_add_at(w, &c->tx, start, start + 5 + BFD_RT_WHEEL_SLOTS);
+	bfd_rt_wheel_add_at(w, &d->detect, start, start + 3000);
+	assert(w->count == 4);
+	assert(w->tx_load[(start + 5) % BFD_RT_WHEEL_SLOTS] == 2);
+
+	/* The engine sleeps until the first timer is due */
+	assert(bfd_rt_wheel_next(w) == start + 5);
+	assert(bfd_rt_wheel_pop(w, start + 4) == NULL);
+	assert(bfd_rt_wheel_next(w) == start + 5);
+
+	assert(bfd_rt_wheel_pop(w, start + 5) == &a->tx);
+	assert(bfd_rt_wheel_pop(w, start + 5) == &b->detect);
+	assert(bfd_rt_wheel_pop(w, start + 5) == NULL);
+	assert(w->tx_load[(start + 5) % BFD_RT_WHEEL_SLOTS] == 1);
+
+	/* Nothing within a turn, look again one turn later */
+	assert(bfd_rt_wheel_next(w) == start + 5 + BFD_RT_WHEEL_SLOTS);
+	assert(bfd_rt_wheel_pop(w, start + 5 + BFD_RT_WHEEL_SLOTS - 1)
+	       == NULL);
+	assert(bfd_rt_wheel_pop(w, start + 5 + BFD_RT_WHEEL_SLOTS) == &c->tx);
+	assert(bfd_rt_wheel_next(w) == start + 3000);
+
+	/* A late wakeup still gets everything that is due */
+	assert(bfd_rt_wheel_pop(w, start + 4000) == &d->detect);
+	assert(w->count == 0);
+
+	/* Disarming takes the timer and its load off the wheel */
+	bfd_rt_wheel_add_at(w, &a->tx, start, start + 10);
+	bfd_rt_wheel_del(w, &a->tx);
+	bfd_rt_wheel_del(w, &a->tx);
+	assert(!a->tx.armed && w->count == 0);
+	assert(w->tx_load[(start + 10) % BFD_RT_WHEEL_SLOTS] == 0);
+
+	XFREE(MTYPE_BFDD_RT_SESSION, a);
+	XFREE(MTYPE_BFDD_RT_SESSION, b);
+	XFREE(MTYPE_BFDD_RT_SESSION, c);
+	XFREE(MTYPE_BFDD_RT_SESSION, d);
+	printf("Timer expiry: OK\n");
+}
+
+/*
+ * Transmissions stay inside the RFC 5880 jitter window and sessions armed
+ * at the same time are spread over it.
+ */
+static void test_tx_spread(void)
+{
+	struct bfd_rt_wheel *w = &rt.wheel;
+	struct bfd_rt_session *rs[TEST_SESSIONS];
+	uint64_t before, after, scheduled = 0;
+	uint32_t busiest = 0, slots = 0;
+
+	test_wheel_init(w);
+
+	before = bfd_rt_now();
+	for (uint32_t i = 0; i < TEST_SESSIONS; i++) {
+		rs[i] = test_session(i + 1);
+		rs[i]->xmt_TO = 100000;
+		rs[i]->detect_mult = 3;
+		bfd_rt_tx_arm(rs[i]);
+	}
+	after = bfd_rt_now();
+
+	for (uint32_t i = 0; i < TEST_SESSIONS; i++) {
+		assert(rs[i]->tx.armed);
+		assert(rs[i]->tx.expire >= before + 75);
+		assert(rs[i]->tx.expire <= after + 100);
+	}
+
+	for (size_t i = 0; i < array_size(w->tx_load); i++) {
+		scheduled += w->tx_load[i];
+		busiest = MAX(busiest, w->tx_load[i]);
+		slots += !!w->tx_load[i];
+	}
+	printf("%u transmissions over %u slots, busiest slot %u\n",
+	       TEST_SESSIONS, slots, busiest);
+	assert(scheduled == TEST_SESSIONS);
+	/* 26 ticks in the window, a single random pick would reach ~100 */
+	assert(busiest <= TEST_SESSIONS / 26 + 8);
+
+	/* Rearming moves the transmission, the load follows */
+	bfd_rt_tx_arm(rs[0]);
+	assert(w->count == TEST_SESSIONS);
+
+	for (uint32_t i = 0; i < TEST_SESSIONS; i++) {
+		bfd_rt_wheel_del(w, &rs[i]->tx);
+		XFREE(MTYPE_BFDD_RT_SESSION, rs[i]);
+	}
+	assert(w->count == 0);
+	for (size_t i = 0; i < array_size(w->tx_load); i++)
+		assert(w->tx_load[i] == 0);
+
+	printf("Transmit spread: OK\n");
+}
+
+int main(int argc, char **argv)
+{
+	test_expiry();
+	test_tx_spread();
+
+	printf("Done.\n");
+	return 0;
+}
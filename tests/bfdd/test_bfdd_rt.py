@@ -0,0 +1,9 @@
+# SPDX-License-Identifier: GPL-2.0-or-later
+import frrtest
+
+
+class TestBfddRt(frrtest.TestMultiOut):
+    program = "./test_bfdd_rt"
+
+
+TestBfddRt.exit_cleanly()
@@ -0,0 +1,213 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Own LSP fragmentation tests.
+ */
+#include <zebra.h>
+
+#include "memory.h"
+#include "stream.h"
+#include "linklist.h"
+
+#include "isisd/isisd.h"
+#include "isisd/isis_mt.h"
+#include "isisd/isis_tlvs.h"
+
+#include "test_common.h"
+
+#define TEST_PREFIXES	  600
+#define TEST_NEIGHBORS	  40
+#define TEST_TLV_SPACE	  1400
+#define TEST_STREAM_SIZE 65536
+
+static const uint8_t salt[] = "secret";
+
+static void add_prefix(struct isis_tlvs *tlvs, uint32_t i, bool ipv4)
+{
+	struct prefix_ipv4 p4 = {
+		.family = AF_INET,
+		.prefixlen = 24,
+		.prefix.s_addr = htonl(0x0a000000 + (i << 8)),
+	};
+	struct prefix_ipv6 p6 = {
+		.family = AF_INET6,
+		.prefixlen = 64,
+	};
+
+	p6.prefix.s6_addr32[0] = htonl(0x20010db8);
+	p6.prefix.s6_addr32[1] = htonl(i);
+
+	if (ipv4)
+		isis_tlvs_add_extended_ip_reach(tlvs, &p4, 10 + i, false,
+						NULL);
+	isis_tlvs_add_ipv6_reach(tlvs,
+				 i % 2 ? ISIS_MT_IPV6_UNICAST
+				       : ISIS_MT_IPV4_UNICAST,
+				 &p6, 10 + i, false, NULL);
+}
+
+/* A large LSP worth of TLVs, without the IPv4 prefix skip */
+static struct isis_tlvs *build_tlvs(uint32_t skip, uint32_t metric)
+{
+	struct isis_tlvs *tlvs = isis_alloc_tlvs();
+	uint8_t id[ISIS_SYS_ID_LEN + 1] = {};
+	struct nlpids nlpids = {
+		.count = 1,
+		.nlpids = { NLPID_IP },
+	};
+
+	isis_tlvs_set_protocols_supported(tlvs, &nlpids);
+	isis_tlvs_set_dynamic_hostname(tlvs, "test");
+
+	for (uint32_t i = 0; i < TEST_NEIGHBORS; i++) {
+		id[ISIS_SYS_ID_LEN - 1] = i;
+		isis_tlvs_add_extended_reach(tlvs, ISIS_MT_IPV4_UNICAST, id,
+					     i == 0 ? metric : 10, NULL);
+	}
+
+	for (uint32_t i = 0; i < TEST_PREFIXES; i++)
+		add_prefix(tlvs, i, i != skip);
+
+	return tlvs;
+}
+
+static struct list *fragment(struct isis_tlvs *tlvs,
+			     struct isis_fragment_state *state)
+{
+	struct list *fragments;
+
+	fragments = isis_fragment_tlvs_stable(tlvs, TEST_TLV_SPACE, state,
+					      salt, sizeof(salt));
+	assert(fragments);
+	isis_free_tlvs(tlvs);
+	return fragments;
+}
+
+/* Packed contents of each fragment, and check they fit */
+static struct stream **pack_fragments(struct list *fragments)
+{
+	struct stream **packed = XCALLOC(MTYPE_TMP, 256 * sizeof(*packed));
+	struct stream *s = stream_new(TEST_STREAM_SIZE);
+	struct isis_tlvs *tlvs;
+	struct listnode *node;
+	unsigned int f = 0;
+
+	for (ALL_LIST_ELEMENTS_RO(fragments, node, tlvs)) {
+		assert(f < 256);
+		stream_reset(s);
+		assert(isis_pack_tlvs(tlvs, s, (size_t)-1, false, true) == 0);
+		assert(stream_get_endp(s) <= TEST_TLV_SPACE);
+		packed[f++] = stream_dup(s);
+		isis_free_tlvs(tlvs);
+	}
+	list_delete(&fragments);
+	stream_free(s);
+	return packed;
+}
+
+static void free_packed(struct stream **packed)
+{
+	for (unsigned int f = 0; f < 256 && packed[f]; f++)
+		stream_free(packed[f]);
+	XFREE(MTYPE_TMP, packed);
+}
+
+static bool same_packed(struct stream *a, struct stream *b)
+{
+	return stream_get_endp(a) == stream_get_endp(b)
+	       && !memcmp(STREAM_DATA(a), STREAM_DATA(b), stream_get_endp(a));
+}
+
+static unsigned int count_fragments(struct stream **packed)
+{
+	unsigned int count = 0;
+
+	while (count < 256 && packed[count])
+		count++;
+	return count;
+}
+
+/*
+ * Regenerate with one change and check that only the fragment holding it
+ * changes, both in contents and in what the state reports.
+ */
+static void check_one_change(struct isis_fragment_state *state,
+			     struct stream **before, struct isis_tlvs *tlvs,
+			     const char *what)
+{
+	struct stream **after = pack_fragments(fragment(tlvs, state));
+	unsigned int count = count_fragments(after), changed = 0;
+
+	assert(count == count_fragments(before));
+	for (unsigned int f = 0; f < count; f++) {
+		bool same = same_packed(before[f], after[f]);
+
+		assert(same == isis_fragment_unchanged(state, f));
+		if (!same)
+			changed++;
+	}
+	printf("%s: %u of %u fragments changed\n", what, changed, count);
+	assert(changed == 1);
+	free_packed(after);
+}
+
+static void test_stable(void)
+{
+	struct isis_fragment_state *state = isis_fragment_state_new();
+	struct isis_tlvs *tlvs;
+	struct stream **first, **again;
+	struct list *fragments;
+	unsigned int count;
+
+	/* The first run fills the fragments like the plain fragmentation */
+	first = pack_fragments(fragment(build_tlvs(0, 10), state));
+	count = count_fragments(first);
+	tlvs = build_tlvs(0, 10);
+	fragments = isis_fragment_tlvs(tlvs, TEST_TLV_SPACE);
+	printf("%u fragments, %u without keeping state\n", count,
+	       listcount(fragments));
+	assert(count > 4);
+	assert(count <= listcount(fragments));
+	free_packed(pack_fragments(fragments));
+	isis_free_tlvs(tlvs);
+
+	/* Nothing changed, nothing is reported as changed */
+	again = pack_fragments(fragment(build_tlvs(0, 10), state));
+	assert(count_fragments(again) == count);
+	for (unsigned int f = 0; f < count; f++) {
+		assert(same_packed(first[f], again[f]));
+		assert(isis_fragment_unchanged(state, f));
+	}
+	free_packed(again);
+
+	/* A changed metric near the start only touches one fragment */
+	check_one_change(state, first, build_tlvs(0, 20), "metric changed");
+	free_packed(first);
+	first = pack_fragments(fragment(build_tlvs(0, 10), state));
+
+	/* So does a prefix added near the start, where the plain
+	 * fragmentation would shift everything after it.
+	 */
+	check_one_change(state, first, build_tlvs(TEST_PREFIXES, 10),
+			 "prefix added");
+
+	/* A different salt changes every fragment */
+	tlvs = build_tlvs(TEST_PREFIXES, 10);
+	fragments = isis_fragment_tlvs_stable(tlvs, TEST_TLV_SPACE, state,
+					      NULL, 0);
+	for (unsigned int f = 0; f < count; f++)
+		assert(!isis_fragment_unchanged(state, f));
+	free_packed(pack_fragments(fragments));
+	isis_free_tlvs(tlvs);
+
+	free_packed(first);
+	isis_fragment_state_free(&state);
+	assert(!state);
+}
+
+int main(int argc, char **argv)
+{
+	test_stable();
+
+	printf("Done.\n");
+	return 0;
+}
@@ -0,0 +1,9 @@
+# SPDX-License-Identifier: GPL-2.0-or-later
+import frrtest
+
+
+class TestIsisFragment(frrtest.TestMultiOut):
+    program = "./test_isis_fragment"
+
+
+TestIsisFragment.exit_cleanly()
@@ -15,6 +15,7 @@
 #include "log.h"
 #include "vrf.h"
 #include "yang.h"
+#include "frr_pthread.h"
 
 #include "isisd/isisd.h"
 #include "isisd/isis_dynhn.h"
@@ -31,6 +32,7 @@ enum test_type {
 	TEST_LFA,
 	TEST_RLFA,
 	TEST_TI_LFA,
+	TEST_TI_LFA_PARALLEL,
 };
 
 #define F_DISPLAY_LSPDB 0x01
@@ -133,7 +135,7 @@ static void test_run_rlfa(struct vty *vty, const struct isis_topology *topology,
 	RB_FOREACH (node, isis_spf_nodes, &spftree_pc->lfa.p_space)
 		vty_out(vty, " %s\n", print_sys_hostname(node->sysid));
 	vty_out(vty, "\n");
-	RB_FOREACH (spf_node, isis_spf_nodes, &spftree_self->adj_nodes) {
+	RB_FOREACH (spf_node, isis_spf_nodes, &spftree_pc->lfa.p_space_adj) {
 		if (RB_EMPTY(isis_spf_nodes, &spf_node->lfa.p_space))
 			continue;
 		vty_out(vty, "P-space (%s):\n",
@@ -211,7 +213,7 @@ static void test_run_ti_lfa(struct vty *vty,
 	RB_FOREACH (node, isis_spf_nodes, &spftree_pc->lfa.p_space)
 		vty_out(vty, " %s\n", print_sys_hostname(node->sysid));
 	vty_out(vty, "\n");
-	RB_FOREACH (spf_node, isis_spf_nodes, &spftree_self->adj_nodes) {
+	RB_FOREACH (spf_node, isis_spf_nodes, &spftree_pc->lfa.p_space_adj) {
 		if (RB_EMPTY(isis_spf_nodes, &spf_node->lfa.p_space))
 			continue;
 		vty_out(vty, "P-space (%s):\n",
@@ -237,6 +239,114 @@ static void test_run_ti_lfa(struct vty *vty,
 	isis_spftree_del(spftree_pc);
 }
 
+static char *test_backup_routes(struct isis_spftree *spftree)
+{
+	struct json_object *json = NULL;
+	char *routes;
+
+	isis_print_routes(NULL, spftree, &json, false, true);
+	routes = XSTRDUP(MTYPE_TMP, json_object_to_json_string(json));
+	json_object_free(json);
+
+	return routes;
+}
+
+static void
+test_run_ti_lfa_parallel(struct vty *vty, const struct isis_topology *topology,
+			 const struct isis_test_node *root,
+			 struct isis_area *area, struct lspdb_head *lspdb,
+			 int level, int tree,
+			 enum lfa_protection_type protection_type)
+{
+	struct isis_spftree *spftree_self;
+	struct isis_spftree *spftree_reverse;
+	struct isis_spftree *spftree_pc;
+	struct isis_spftree *spftree_par;
+	struct lfa_protected_resource *resources;
+	struct isis_spf_node *adj_node;
+	size_t num_resources = 0;
+	char *routes_self, *routes_par;
+	unsigned long saved_debug_lfa, saved_debug_spf_events;
+	uint8_t flags;
+	bool ret;
+
+	/* Run forward SPF in the root node. */
+	flags = F_SPFTREE_NO_ADJACENCIES;
+	spftree_self =
+		isis_spftree_new(area, lspdb, root->sysid, level, tree,
+				 SPF_TYPE_FORWARD, flags, SR_ALGORITHM_SPF);
+	isis_run_spf(spftree_self);
+
+	/* Protect every neighbor of the root node. */
+	RB_FOREACH (adj_node, isis_spf_nodes, &spftree_self->adj_nodes)
+		num_resources++;
+	resources = XCALLOC(MTYPE_TMP, (num_resources + 1) * sizeof(*resources));
+	num_resources = 0;
+	RB_FOREACH (adj_node, isis_spf_nodes, &spftree_self->adj_nodes) {
+		resources[num_resources].type = protection_type;
+		memcpy(resources[num_resources].adjacency, adj_node->sysid,
+		       ISIS_SYS_ID_LEN);
+		num_resources++;
+	}
+
+	/* Compute the TI-LFA repair paths serially. */
+	spftree_reverse = isis_spf_reverse_run(spftree_self);
+	isis_spf_run_neighbors(spftree_self);
+	for (size_t i = 0; i < num_resources; i++) {
+		struct lfa_protected_resource resource = resources[i];
+
+		spftree_pc = isis_tilfa_compute(area, spftree_self,
+						spftree_reverse, &resource);
+		isis_spftree_del(spftree_pc);
+	}
+
+	/*
+	 * Compute them again on the worker pool.  Debug messages aren't
+	 * thread-safe, the daemon doesn't use the pool with debugs enabled
+	 * either.
+	 */
+	spftree_par =
+		isis_spftree_new(area, lspdb, root->sysid, level, tree,
+				 SPF_TYPE_FORWARD, flags, SR_ALGORITHM_SPF);
+	isis_run_spf(spftree_par);
+	saved_debug_lfa = debug_lfa;
+	saved_debug_spf_events = debug_spf_events;
+	debug_lfa = 0;
+	debug_spf_events = 0;
+	ret = isis_tilfa_compute_parallel(area, spftree_par, resources,
+					  num_resources);
+	assert(ret);
+	debug_lfa = saved_debug_lfa;
+	debug_spf_events = saved_debug_spf_events;
+
+	/* Both computations must yield the same backup routing table. */
+	routes_self = test_backup_routes(spftree_self);
+	routes_par = test_backup_routes(spftree_par);
+	if (strcmp(routes_self, routes_par) == 0)
+		vty_out(vty,
+			"IS-IS %s %s: parallel TI-LFA matches the serial one\n",
+			circuit_t2string(level),
+			tree == SPFTREE_IPV4 ? "IPv4" : "IPv6");
+	else {
+		vty_out(vty,
+			"IS-IS %s %s: parallel TI-LFA differs from the serial one\n",
+			circuit_t2string(level),
+			tree == SPFTREE_IPV4 ? "IPv4" : "IPv6");
+		vty_out(vty, "Serial:\n");
+		isis_print_routes(vty, spftree_self, NULL, false, true);
+		vty_out(vty, "Parallel:\n");
+		isis_print_routes(vty, spftree_par, NULL, false, true);
+	}
+
+	/* Cleanup everything. */
+	XFREE(MTYPE_TMP, routes_self);
+	XFREE(MTYPE_TMP, routes_par);
+	XFREE(MTYPE_TMP, resources);
+	isis_spftree_del(spftree_self);
+	isis_spftree_del(spftree_reverse);
+	isis_spftree_del(spftree_par);
+}
+
 static int test_run(struct vty *vty, const struct isis_topology *topology,
 		    const struct isis_test_node *root, enum test_type test_type,
 		    uint8_t flags, enum lfa_protection_type protection_type,
@@ -335,6 +445,12 @@ static int test_run(struct vty *vty, const struct isis_topology *topology,
 						&area->lspdb[level - 1], level,
 						tree, &protected_resource);
 				break;
+			case TEST_TI_LFA_PARALLEL:
+				test_run_ti_lfa_parallel(
+					vty, topology, root, area,
+					&area->lspdb[level - 1], level, tree,
+					protection_type);
+				break;
 			}
 		}
 	}
@@ -353,6 +469,7 @@ DEFUN(test_isis, test_isis_cmd,
 	   |lfa system-id WORD [pseudonode-id <1-255>]\
 	   |remote-lfa system-id WORD [pseudonode-id <1-255>]\
 	   |ti-lfa system-id WORD [pseudonode-id <1-255>] [node-protection]\
+	   |ti-lfa-parallel [node-protection]\
 	 >\
 	 [display-lspdb] [<ipv4-only|ipv6-only>] [<level-1-only|level-2-only>]",
       "Test command\n"
@@ -379,6 +496,8 @@ DEFUN(test_isis, test_isis_cmd,
       "Pseudonode-ID\n"
       "Pseudonode-ID\n"
       "Node protection\n"
+      "Parallel TI-LFA of all neighbors, compared with the serial one\n"
+      "Node protection\n"
       "Display the LSPDB\n"
       "Do IPv4 processing only\n"
       "Do IPv6 processing only\n"
@@ -445,6 +564,13 @@ DEFUN(test_isis, test_isis_cmd,
 			protection_type = LFA_NODE_PROTECTION;
 		else
 			protection_type = LFA_LINK_PROTECTION;
+	} else if (argv_find(argv, argc, "ti-lfa-parallel", &idx)) {
+		test_type = TEST_TI_LFA_PARALLEL;
+
+		if (argv_find(argv, argc, "node-protection", &idx))
+			protection_type = LFA_NODE_PROTECTION;
+		else
+			protection_type = LFA_LINK_PROTECTION;
 	} else
 		return CMD_WARNING;
 
@@ -468,6 +594,7 @@ static void vty_do_exit(int isexit)
 {
 	printf("\nend.\n");
 
+	frr_pthread_finish();
 	cmd_terminate();
 	vty_terminate();
 	yang_terminate();
@@ -558,6 +685,10 @@ int main(int argc, char **argv)
 	debug_events |= DEBUG_EVENTS;
 	debug_rte_events |= DEBUG_RTE_EVENTS;
 
+	/* Use more than one LFA worker, whatever the number of CPUs. */
+	frr_pthread_init();
+	isis_lfa_pool_start(3);
+
 	/* Install test command. */
 	install_element(VIEW_NODE, &test_isis_cmd);
 
@@ -0,0 +1,189 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Compacted TLV storage tests.
+ */
+#include <zebra.h>
+
+#include "memory.h"
+#include "stream.h"
+
+#include "isisd/isisd.h"
+#include "isisd/isis_mt.h"
+#include "isisd/isis_tlvs.h"
+
+#include "test_common.h"
+
+#define TEST_PREFIXES	  2000
+#define TEST_NEIGHBORS	  100
+#define TEST_STREAM_SIZE 65536
+
+struct mem_usage {
+	size_t allocs;
+	size_t bytes;
+};
+
+static int mem_usage_walk(void *arg, struct memgroup *mg, struct memtype *mt)
+{
+	struct mem_usage *usage = arg;
+
+	if (!mt || strcmp(mg->name, "isisd"))
+		return 0;
+
+	usage->allocs += mt->n_alloc;
+	usage->bytes += mt->total;
+	return 0;
+}
+
+static struct mem_usage mem_usage(void)
+{
+	struct mem_usage usage = {};
+
+	qmem_walk(mem_usage_walk, &usage);
+	return usage;
+}
+
+static struct mem_usage mem_usage_since(const struct mem_usage *base)
+{
+	struct mem_usage usage = mem_usage();
+
+	usage.allocs -= base->allocs;
+	usage.bytes -= base->bytes;
+	return usage;
+}
+
+/* A large LSP worth of reachability, some of it with sub-TLVs */
+static struct stream *build_pdu(void)
+{
+	struct isis_tlvs *tlvs = isis_alloc_tlvs();
+	struct stream *s = stream_new(TEST_STREAM_SIZE);
+	uint8_t id[ISIS_SYS_ID_LEN + 1] = {};
+
+	for (uint32_t i = 0; i < TEST_PREFIXES; i++) {
+		struct prefix_ipv4 p4 = {
+			.family = AF_INET,
+			.prefixlen = 24 + i % 9,
+			.prefix.s_addr = htonl(0x0a000000 + (i << 8)),
+		};
+		struct prefix_ipv6 p6 = {
+			.family = AF_INET6,
+			.prefixlen = 64,
+		};
+
+		p6.prefix.s6_addr32[0] = htonl(0x20010db8);
+		p6.prefix.s6_addr32[1] = htonl(i);
+
+		isis_tlvs_add_extended_ip_reach(tlvs, &p4, 10 + i, false,
+						NULL);
+		isis_tlvs_add_ipv6_reach(tlvs,
+					 i % 2 ? ISIS_MT_IPV6_UNICAST
+					       : ISIS_MT_IPV4_UNICAST,
+					 &p6, 10 + i, false, NULL);
+		if (i % 4 == 0)
+			isis_tlvs_add_oldstyle_ip_reach(tlvs, &p4, i % 64);
+	}
+
+	for (uint32_t i = 0; i < TEST_NEIGHBORS; i++) {
+		struct isis_ext_subtlvs *exts = NULL;
+
+		id[ISIS_SYS_ID_LEN - 1] = i;
+		if (i % 2) {
+			exts = isis_alloc_ext_subtlvs();
+			exts->te_metric = i;
+			SET_SUBTLV(exts, EXT_TE_METRIC);
+		}
+		isis_tlvs_add_extended_reach(tlvs, ISIS_MT_IPV4_UNICAST, id,
+					     10, exts);
+		isis_tlvs_add_oldstyle_reach(tlvs, id, 10);
+	}
+
+	assert(isis_pack_tlvs(tlvs, s, (size_t)-1, false, false) == 0);
+	isis_free_tlvs(tlvs);
+	return s;
+}
+
+static struct isis_tlvs *unpack_pdu(struct stream *s)
+{
+	struct isis_tlvs *tlvs;
+	const char *log;
+
+	stream_set_getp(s, 0);
+	assert(isis_unpack_tlvs(STREAM_READABLE(s), s, &tlvs, &log) == 0);
+	return tlvs;
+}
+
+static char *format(struct isis_tlvs *tlvs)
+{
+	return XSTRDUP(MTYPE_TMP, isis_format_tlvs(tlvs, NULL));
+}
+
+static void test_compact(void)
+{
+	struct stream *pdu = build_pdu();
+	struct stream *s1 = stream_new(TEST_STREAM_SIZE);
+	struct stream *s2 = stream_new(TEST_STREAM_SIZE);
+	struct isis_tlvs *plain, *compact, *copy;
+	struct mem_usage start, base, plain_usage, compact_usage, usage;
+	char *plain_fmt, *compact_fmt, *copy_fmt;
+
+	start = mem_usage();
+	base = start;
+	plain = unpack_pdu(pdu);
+	plain_usage = mem_usage_since(&base);
+
+	base = mem_usage();
+	compact = unpack_pdu(pdu);
+	isis_tlvs_compact(compact);
+	compact_usage = mem_usage_since(&base);
+
+	printf("Unpacked %zu bytes of TLVs:\n", stream_get_endp(pdu));
+	printf("  plain:     %zu allocations\n", plain_usage.allocs);
+	printf("  compacted: %zu allocations\n", compact_usage.allocs);
+#ifdef HAVE_MALLOC_USABLE_SIZE
+	printf("  plain:     %zu bytes\n", plain_usage.bytes);
+	printf("  compacted: %zu bytes\n", compact_usage.bytes);
+	assert(compact_usage.bytes < plain_usage.bytes);
+#endif
+	assert(compact_usage.allocs < plain_usage.allocs / 4);
+
+	/* compacting again does nothing */
+	base = mem_usage();
+	isis_tlvs_compact(compact);
+	usage = mem_usage_since(&base);
+	assert(usage.allocs == 0);
+
+	printf("Validating contents...\n");
+	plain_fmt = format(plain);
+	compact_fmt = format(compact);
+	assert(!strcmp(plain_fmt, compact_fmt));
+
+	assert(isis_pack_tlvs(plain, s1, (size_t)-1, false, false) == 0);
+	assert(isis_pack_tlvs(compact, s2, (size_t)-1, false, false) == 0);
+	assert(stream_get_endp(s1) == stream_get_endp(s2));
+	assert(!memcmp(STREAM_DATA(s1), STREAM_DATA(s2), stream_get_endp(s1)));
+
+	copy = isis_copy_tlvs(compact);
+	copy_fmt = format(copy);
+	assert(!strcmp(plain_fmt, copy_fmt));
+
+	/* nothing is left behind */
+	isis_free_tlvs(copy);
+	isis_free_tlvs(compact);
+	isis_free_tlvs(plain);
+	usage = mem_usage_since(&start);
+	assert(usage.allocs == 0 && usage.bytes == 0);
+
+	XFREE(MTYPE_TMP, plain_fmt);
+	XFREE(MTYPE_TMP, compact_fmt);
+	XFREE(MTYPE_TMP, copy_fmt);
+	stream_free(pdu);
+	stream_free(s1);
+	stream_free(s2);
+}
+
+int main(int argc, char **argv)
+{
+	test_compact();
+
+	printf("Done.\n");
+	return 0;
+}
@@ -0,0 +1,9 @@
+# SPDX-License-Identifier: GPL-2.0-or-later
+import frrtest
+
+
+class TestIsisTlvsCompact(frrtest.TestMultiOut):
+    program = "./test_isis_tlvs_compact"
+
+
+TestIsisTlvsCompact.exit_cleanly()
@@ -0,0 +1,146 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * iobuf chain tests.
+ */
+#include <zebra.h>
+#include <memory.h>
+#include "iobuf.h"
+#include "buffer.h"
+
+static void validate(const struct iobuf *iob, const char *expect)
+{
+	char tmp[256];
+	size_t len = strlen(expect);
+
+	assert(iobuf_len(iob) == len);
+	assert(iobuf_copyout(iob, 0, tmp, sizeof(tmp)) == len);
+	assert(!memcmp(tmp, expect, len));
+}
+
+static struct stream *mkstream(const char *str)
+{
+	struct stream *s = stream_new(strlen(str) + 16);
+
+	stream_put(s, str, strlen(str));
+	return s;
+}
+
+int main(int argc, char **argv)
+{
+	struct iobuf *iob, *clone, *slice;
+	struct stream *s;
+	struct iovec iov[8];
+	struct buffer *b, *b2;
+	char tmp[64];
+	int fds[2];
+	ssize_t nrd;
+
+	printf("Validating put...\n");
+	iob = iobuf_new();
+	assert(iobuf_empty(iob));
+	iobuf_put(iob, "hello ", 6);
+	iobuf_put(iob, "world", 5);
+	validate(iob, "hello world");
+	/* both puts fit into the first segment */
+	assert(iob->nslices == 1);
+
+	printf("Validating stream adoption...\n");
+	s = mkstream("XXpayload");
+	stream_forward_getp(s, 2);
+	iobuf_put_stream(iob, s);
+	validate(iob, "hello worldpayload");
+	assert(iob->nslices == 2);
+
+	/* appending after a stream slice must not write into the stream */
+	iobuf_put(iob, "!", 1);
+	validate(iob, "hello worldpayload!");
+	assert(iob->nslices == 3);
+
+	printf("Validating clone...\n");
+	clone = iobuf_clone(iob);
+	validate(clone, "hello worldpayload!");
+
+	/* segments are shared now, puts must go into a new segment */
+	iobuf_put(clone, "?", 1);
+	validate(clone, "hello worldpayload!?");
+	validate(iob, "hello worldpayload!");
+
+	printf("Validating slice...\n");
+	slice = iobuf_slice(iob, 6, 9);
+	validate(slice, "worldpayl");
+	assert(slice->nslices == 2);
+	iobuf_free(slice);
+
+	slice = iobuf_slice(iob, 15, 100);
+	validate(slice, "oad!");
+	iobuf_free(slice);
+
+	printf("Validating drain...\n");
+	iobuf_drain(clone, 8);
+	validate(clone, "rldpayload!?");
+	iobuf_drain(clone, 3);
+	validate(clone, "payload!?");
+	assert(clone->nslices == 3);
+	iobuf_drain(clone, 1000);
+	assert(iobuf_empty(clone));
+
+	/* original is unaffected by draining the clone */
+	validate(iob, "hello worldpayload!");
+
+	printf("Validating iov...\n");
+	assert(iobuf_iov(iob, iov, array_size(iov)) == 3);
+	assert(iov[0].iov_len == 11);
+	assert(!memcmp(iov[1].iov_base, "payload", 7));
+	assert(iobuf_iov(iob, iov, 1) == 1);
+
+	printf("Validating concat...\n");
+	iobuf_append(clone, iob);
+	iobuf_append(clone, iob);
+	validate(clone, "hello worldpayload!hello worldpayload!");
+	iobuf_free(clone);
+
+	printf("Validating writev...\n");
+	assert(pipe(fds) == 0);
+	assert(iobuf_writev(iob, fds[1]) == 19);
+	assert(iobuf_empty(iob));
+	nrd = read(fds[0], tmp, sizeof(tmp));
+	assert(nrd == 19);
+	assert(!memcmp(tmp, "hello worldpayload!", 19));
+
+	printf("Validating buffer integration...\n");
+	b = buffer_new(0);
+	buffer_putstr(b, "a");
+	buffer_put_iobuf(b, iobuf_from_stream(mkstream("bcd")));
+	buffer_put_iobuf(b, iobuf_from_stream(mkstream("ef")));
+	buffer_putstr(b, "g");
+	{
+		char *str = buffer_getstr(b);
+
+		assert(!strcmp(str, "abcdefg"));
+		XFREE(MTYPE_TMP, str);
+	}
+	assert(buffer_flush_all(b, fds[1]) == BUFFER_EMPTY);
+	nrd = read(fds[0], tmp, sizeof(tmp));
+	assert(nrd == 7);
+	assert(!memcmp(tmp, "abcdefg", 7));
+
+	printf("Validating fan-out...\n");
+	iobuf_put(iob, "xyz", 3);
+	b2 = buffer_new(0);
+	buffer_put_iobuf(b, iobuf_clone(iob));
+	buffer_put_iobuf(b2, iobuf_clone(iob));
+	iobuf_free(iob);
+	assert(buffer_flush_all(b, fds[1]) == BUFFER_EMPTY);
+	assert(buffer_flush_all(b2, fds[1]) == BUFFER_EMPTY);
+	nrd = read(fds[0], tmp, sizeof(tmp));
+	assert(nrd == 6);
+	assert(!memcmp(tmp, "xyzxyz", 6));
+
+	buffer_free(b);
+	buffer_free(b2);
+	close(fds[0]);
+	close(fds[1]);
+
+	printf("Done.\n");
+	return 0;
+}
@@ -0,0 +1,9 @@
+# SPDX-License-Identifier: GPL-2.0-or-later
+import frrtest
+
+
+class TestIobuf(frrtest.TestMultiOut):
+    program = "./test_iobuf"
+
+
+TestIobuf.exit_cleanly()
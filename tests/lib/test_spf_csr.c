@@ -0,0 +1,218 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * SPF kernel tests.
+ */
+#include <zebra.h>
+
+#include "memory.h"
+#include "network.h"
+#include "spf_csr.h"
+
+/*
+ *      1     1
+ *   0 --- 1 --- 3
+ *   |           |
+ *   | 1       1 |     4 has two equal cost parents, 3 and 2,
+ *   |     1     |     6 isn't reachable
+ *   2 --------- 4 --- 5
+ *                  2
+ */
+static void test_ecmp(struct spf_csr *csr)
+{
+	static const uint32_t edges[][3] = {
+		{ 0, 1, 1 }, { 1, 0, 1 }, { 0, 2, 1 }, { 2, 0, 1 },
+		{ 1, 3, 1 }, { 3, 1, 1 }, { 2, 4, 2 }, { 4, 2, 2 },
+		{ 3, 4, 1 }, { 4, 3, 1 }, { 4, 5, 2 }, { 5, 4, 2 },
+		{ 6, 5, 1 },
+	};
+	static const uint32_t dist[] = { 0, 1, 1, 2, 3, 5, SPF_CSR_INFINITY };
+	uint32_t i, v, e, nparents;
+
+	printf("Validating ECMP...\n");
+	spf_csr_reset(csr, 7);
+	for (i = 0; i < array_size(edges); i++)
+		spf_csr_add_edge(csr, edges[i][0], edges[i][1], edges[i][2], i);
+	spf_csr_finalize(csr);
+	spf_csr_run(csr, 0);
+
+	for (v = 0; v < 7; v++)
+		assert(spf_csr_dist(csr, v) == dist[v]);
+	assert(csr->norder == 6);
+	assert(csr->order[0] == 0);
+
+	/* 4 has two parents, 3 (1 + 1 + 1) and 2 (1 + 2), in settle order */
+	nparents = 0;
+	spf_csr_foreach_parent (csr, 4, e) {
+		assert(csr->cookie[e] == (nparents == 0 ? 6 : 8));
+		nparents++;
+	}
+	assert(nparents == 2);
+
+	/* 5 is at distance 5, a limit of 4 leaves it out */
+	spf_csr_set_max_dist(csr, 4);
+	spf_csr_run(csr, 0);
+	assert(spf_csr_dist(csr, 4) == 3);
+	assert(spf_csr_dist(csr, 5) == SPF_CSR_INFINITY);
+	assert(csr->norder == 5);
+}
+
+static void test_tiebreak(struct spf_csr *csr)
+{
+	uint32_t i, v;
+
+	printf("Validating tiebreak...\n");
+	spf_csr_reset(csr, 4);
+	for (v = 3; v > 0; v--)
+		spf_csr_add_edge(csr, 0, v, 10, v);
+	spf_csr_set_tiebreak(csr, 1, 1);
+	spf_csr_set_tiebreak(csr, 3, 1);
+	spf_csr_finalize(csr);
+	spf_csr_run(csr, 0);
+
+	/* equal distances: lower tiebreak first, then the one reached first */
+	static const uint32_t order[] = { 0, 2, 3, 1 };
+
+	spf_csr_foreach_settled (csr, i, v)
+		assert(v == order[i]);
+}
+
+/*
+ * 0 reaches 2 and then 1 at distance 10, 3 at 17 over 2 and 4 at 15 over 1.
+ * The better path to 3 over 5 (10 + 1 + 4) is found after 4 got its
+ * distance, so 4 is settled first among the two.
+ */
+static void test_fifo(struct spf_csr *csr)
+{
+	static const uint32_t edges[][3] = {
+		{ 0, 2, 10 }, { 0, 1, 10 }, { 2, 3, 7 }, { 1, 4, 5 },
+		{ 1, 5, 1 }, { 5, 3, 4 },
+	};
+	static const uint32_t order[] = { 0, 2, 1, 5, 4, 3 };
+	uint32_t i, v, e, nparents;
+
+	printf("Validating FIFO ties...\n");
+	spf_csr_reset(csr, 5);
+	v = spf_csr_add_vertex(csr);
+	assert(v == 5);
+	for (i = 0; i < array_size(edges); i++)
+		spf_csr_add_edge(csr, edges[i][0], edges[i][1], edges[i][2], i);
+	spf_csr_finalize(csr);
+	spf_csr_run(csr, 0);
+
+	spf_csr_foreach_settled (csr, i, v)
+		assert(v == order[i]);
+
+	/* the parent found over 2 was dropped */
+	nparents = 0;
+	spf_csr_foreach_parent (csr, 3, e) {
+		assert(csr->src[e] == 5);
+		nparents++;
+	}
+	assert(nparents == 1);
+}
+
+/* plain O(n^2) Dijkstra to check against */
+static void naive_spf(uint32_t n, const uint32_t *cost, uint32_t root,
+		      uint32_t *dist)
+{
+	bool done[n];
+
+	for (uint32_t v = 0; v < n; v++) {
+		dist[v] = SPF_CSR_INFINITY;
+		done[v] = false;
+	}
+	dist[root] = 0;
+
+	for (;;) {
+		uint32_t best = SPF_CSR_NONE;
+
+		for (uint32_t v = 0; v < n; v++)
+			if (!done[v] && dist[v] != SPF_CSR_INFINITY
+			    && (best == SPF_CSR_NONE || dist[v] < dist[best]))
+				best = v;
+		if (best == SPF_CSR_NONE)
+			break;
+		done[best] = true;
+
+		for (uint32_t w = 0; w < n; w++) {
+			uint32_t c = cost[best * n + w];
+
+			if (c && dist[best] + c < dist[w])
+				dist[w] = dist[best] + c;
+		}
+	}
+}
+
+static void test_random(struct spf_csr *csr, uint32_t n, uint32_t degree)
+{
+	uint32_t *cost = XCALLOC(MTYPE_TMP, n * n * sizeof(*cost));
+	uint32_t *dist = XCALLOC(MTYPE_TMP, n * sizeof(*dist));
+	uint32_t i, v, e, prev;
+
+	printf("Validating random graph (%u vertices)...\n", n);
+	spf_csr_reset(csr, n);
+	for (v = 0; v < n; v++) {
+		for (i = 0; i < degree; i++) {
+			uint32_t w = frr_weak_random() % n;
+
+			if (w == v || cost[v * n + w])
+				continue;
+			/* few distinct metrics, lots of ECMP */
+			cost[v * n + w] = 1 + frr_weak_random() % 4;
+			spf_csr_add_edge(csr, v, w, cost[v * n + w], w);
+		}
+	}
+	spf_csr_finalize(csr);
+	spf_csr_run(csr, 0);
+	naive_spf(n, cost, 0, dist);
+
+	prev = 0;
+	spf_csr_foreach_settled (csr, i, v) {
+		assert(spf_csr_dist(csr, v) >= prev);
+		prev = spf_csr_dist(csr, v);
+	}
+
+	for (v = 0; v < n; v++) {
+		uint32_t nparents = 0, expect = 0;
+
+		assert(spf_csr_dist(csr, v) == dist[v]);
+		if (v == 0 || dist[v] == SPF_CSR_INFINITY)
+			continue;
+
+		/* every shortest path edge is a parent, and only those */
+		spf_csr_foreach_parent (csr, v, e) {
+			assert(csr->dst[e] == v);
+			assert(dist[csr->src[e]] + csr->cost[e] == dist[v]);
+			nparents++;
+		}
+		for (uint32_t u = 0; u < n; u++)
+			if (cost[u * n + v] && dist[u] != SPF_CSR_INFINITY
+			    && dist[u] + cost[u * n + v] == dist[v])
+				expect++;
+		assert(nparents == expect);
+	}
+
+	XFREE(MTYPE_TMP, cost);
+	XFREE(MTYPE_TMP, dist);
+}
+
+int main(int argc, char **argv)
+{
+	struct spf_csr csr;
+
+	spf_csr_init(&csr);
+
+	test_ecmp(&csr);
+	test_tiebreak(&csr);
+	test_fifo(&csr);
+	/* the same instance is reused with bigger and smaller graphs */
+	test_random(&csr, 50, 3);
+	test_random(&csr, 1000, 4);
+	test_random(&csr, 20, 2);
+	test_ecmp(&csr);
+
+	spf_csr_fini(&csr);
+
+	printf("Done.\n");
+	return 0;
+}
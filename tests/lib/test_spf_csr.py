@@ -0,0 +1,9 @@
+# SPDX-License-Identifier: GPL-2.0-or-later
+import frrtest
+
+
+class TestSpfCsr(frrtest.TestMultiOut):
+    program = "./test_spf_csr"
+
+
+TestSpfCsr.exit_cleanly()
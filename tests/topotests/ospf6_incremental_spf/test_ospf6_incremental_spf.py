@@ -0,0 +1,192 @@
+#!/usr/bin/env python
+# SPDX-License-Identifier: ISC
+
+"""
+Test that OSPFv3 keeps the RIB right when a topology change only moves a
+few vertices, so the intra-area routes are recalculated for the changed
+vertices instead of fully.
+
+Four routers in a ring of point-to-point links:
+
+    r1 --- r2
+    |       |
+    r4 --- r3
+
+r1 reaches r3 over both r2 and r4.  Raising r2's cost towards r3 only
+changes the r3 vertex as seen from r1, which must then be reached over r4
+alone, and the r2-r3 link prefix must move from r2 to r3.
+"""
+
+import os
+import sys
+import json
+import pytest
+import functools
+
+pytestmark = pytest.mark.ospf6d
+
+CWD = os.path.dirname(os.path.realpath(__file__))
+sys.path.append(os.path.join(CWD, "../"))
+
+# pylint: disable=C0413
+from lib import topotest
+from lib.topogen import Topogen, get_topogen
+
+
+def setup_module(mod):
+    topodef = {
+        "s1": ("r1", "r2"),
+        "s2": ("r2", "r3"),
+        "s3": ("r3", "r4"),
+        "s4": ("r4", "r1"),
+    }
+    tgen = Topogen(topodef, mod.__name__)
+    tgen.start_topology()
+
+    router_list = tgen.routers()
+
+    for _, (rname, router) in enumerate(router_list.items(), 1):
+        router.load_frr_config(os.path.join(CWD, "{}/frr.conf".format(rname)))
+
+    tgen.start_router()
+
+
+def teardown_module():
+    tgen = get_topogen()
+    tgen.stop_topology()
+
+
+def _intra_calculations(router):
+    output = json.loads(router.vtysh_cmd("show ipv6 ospf6 json"))
+    area = output["areas"]["0.0.0.0"]
+    return (
+        area["intraRouteCalculationsFull"],
+        area["intraRouteCalculationsChanged"],
+    )
+
+
+def _check_route(router, prefix, metric, interfaces):
+    output = json.loads(router.vtysh_cmd("show ipv6 route {} json".format(prefix)))
+    expected = {prefix: [{"protocol": "ospf6", "metric": metric, "installed": True}]}
+    result = topotest.json_cmp(output, expected)
+    if result is not None:
+        return result
+
+    nexthops = output[prefix][0]["nexthops"]
+    installed = sorted(
+        nh["interfaceName"] for nh in nexthops if nh.get("fib") and nh.get("active")
+    )
+    if installed != sorted(interfaces):
+        return "{} installed via {}, expected {}".format(prefix, installed, interfaces)
+    return None
+
+
+def _check_routes(router, routes):
+    for prefix, metric, interfaces in routes:
+        result = _check_route(router, prefix, metric, interfaces)
+        if result is not None:
+            return result
+    return None
+
+
+def test_ospf6_converged():
+    tgen = get_topogen()
+
+    if tgen.routers_have_failure():
+        pytest.skip(tgen.errors)
+
+    r1 = tgen.gears["r1"]
+
+    test_func = functools.partial(
+        _check_routes,
+        r1,
+        [
+            ("2001:db8::2/128", 10, ["r1-eth0"]),
+            ("2001:db8::3/128", 20, ["r1-eth0", "r1-eth1"]),
+            ("2001:db8::4/128", 10, ["r1-eth1"]),
+            ("2001:db8:2::/64", 20, ["r1-eth0"]),
+        ],
+    )
+    _, result = topotest.run_and_expect(test_func, None, count=60, wait=1)
+    assert result is None, "r1 did not converge: {}".format(result)
+
+
+def test_ospf6_incremental_cost_change():
+    tgen = get_topogen()
+
+    if tgen.routers_have_failure():
+        pytest.skip(tgen.errors)
+
+    r1 = tgen.gears["r1"]
+    r2 = tgen.gears["r2"]
+
+    _, changed_before = _intra_calculations(r1)
+
+    r2.vtysh_cmd(
+        """
+        configure terminal
+        interface r2-eth1
+         ipv6 ospf6 cost 100
+        """
+    )
+
+    test_func = functools.partial(
+        _check_routes,
+        r1,
+        [
+            ("2001:db8::2/128", 10, ["r1-eth0"]),
+            ("2001:db8::3/128", 20, ["r1-eth1"]),
+            ("2001:db8::4/128", 10, ["r1-eth1"]),
+            ("2001:db8:2::/64", 30, ["r1-eth1"]),
+        ],
+    )
+    _, result = topotest.run_and_expect(test_func, None, count=60, wait=1)
+    assert result is None, "r1 RIB wrong after cost change: {}".format(result)
+
+    _, changed_after = _intra_calculations(r1)
+    assert (
+        changed_after > changed_before
+    ), "r1 did not recalculate intra-area routes for the changed vertices only"
+
+
+def test_ospf6_incremental_cost_revert():
+    tgen = get_topogen()
+
+    if tgen.routers_have_failure():
+        pytest.skip(tgen.errors)
+
+    r1 = tgen.gears["r1"]
+    r2 = tgen.gears["r2"]
+
+    _, changed_before = _intra_calculations(r1)
+
+    r2.vtysh_cmd(
+        """
+        configure terminal
+        interface r2-eth1
+         no ipv6 ospf6 cost
+        """
+    )
+
+    test_func = functools.partial(
+        _check_routes,
+        r1,
+        [
+            ("2001:db8::2/128", 10, ["r1-eth0"]),
+            ("2001:db8::3/128", 20, ["r1-eth0", "r1-eth1"]),
+            ("2001:db8::4/128", 10, ["r1-eth1"]),
+            ("2001:db8:2::/64", 20, ["r1-eth0"]),
+        ],
+    )
+    _, result = topotest.run_and_expect(test_func, None, count=60, wait=1)
+    assert result is None, "r1 RIB wrong after cost revert: {}".format(result)
+
+    _, changed_after = _intra_calculations(r1)
+    assert (
+        changed_after > changed_before
+    ), "r1 did not recalculate intra-area routes for the changed vertices only"
+
+
+if __name__ == "__main__":
+    args = ["-s"] + sys.argv[1:]
+    sys.exit(pytest.main(args))
@@ -0,0 +1,236 @@
+#!/usr/bin/env python
+# SPDX-License-Identifier: ISC
+
+#
+# test_pim_igmp_report_storm.py
+#
+
+"""
+test_pim_igmp_report_storm.py: Flood a querier with IGMPv3 reports for a
+large number of groups, report how long it takes to absorb them, and check
+that the group timers are refreshed and expire correctly.  Also checks that
+interfaces sharing a query interval don't all query at the same time.
+"""
+
+import os
+import sys
+import time
+import pytest
+from functools import partial
+
+CWD = os.path.dirname(os.path.realpath(__file__))
+sys.path.append(os.path.join(CWD, "../"))
+
+# pylint: disable=C0413
+from lib import topotest
+from lib.topogen import Topogen, TopoRouter, get_topogen
+from lib.topolog import logger
+
+pytestmark = [pytest.mark.pimd]
+
+# Groups are 225.1.x.y, reported from h1 on r1-eth0
+GROUPS = 1000
+GROUPS_PER_PACKET = 100
+ROUNDS = 10
+RECEIVER_LANS = 4
+
+# ip igmp query-interval 60, default robustness and max response time
+GMI = 2 * 60 + 10
+STARTUP_QUERY_INTERVAL = 60 // 4
+
+# IGMPv3 record types
+MODE_IS_EXCLUDE = 2
+CHANGE_TO_INCLUDE = 3
+
+
+def build_topo(tgen):
+    "Build function"
+
+    tgen.add_router("r1")
+
+    for i in range(1, RECEIVER_LANS + 1):
+        sw = tgen.add_switch("sw{}".format(i))
+        sw.add_link(tgen.gears["r1"])
+
+    tgen.add_host("h1", "10.0.1.10/24", "via 10.0.1.1")
+    tgen.gears["sw1"].add_link(tgen.gears["h1"])
+
+
+def setup_module(mod):
+    "Sets up the pytest environment"
+    tgen = Topogen(build_topo, mod.__name__)
+    tgen.start_topology()
+
+    for rname, router in tgen.routers().items():
+        router.load_frr_config(
+            os.path.join(CWD, "{}/frr.conf".format(rname)),
+            [(TopoRouter.RD_ZEBRA, None), (TopoRouter.RD_PIM, None)],
+        )
+
+    tgen.start_router()
+
+
+def teardown_module():
+    "Teardown the pytest environment"
+    tgen = get_topogen()
+    tgen.stop_topology()
+
+
+def group(i):
+    return "225.1.{}.{}".format(i // 256, i % 256)
+
+
+def send_reports(rtype, rounds):
+    "Send one record per group, each packet repeated `rounds` times"
+    tgen = get_topogen()
+    h1 = tgen.gears["h1"]
+
+    for first in range(0, GROUPS, GROUPS_PER_PACKET):
+        command = "python3 {}/../lib/packet/igmp/igmp_v3.py".format(CWD)
+        command += " --src_ip=10.0.1.10 --iface=h1-eth0"
+        command += " --rtype={} --count={}".format(rtype, rounds)
+        command += " --enable_router_alert"
+        for g in range(first, min(first + GROUPS_PER_PACKET, GROUPS)):
+            command += " --maddr={}".format(group(g))
+        h1.run(command)
+
+
+def reports_received(router):
+    out = router.vtysh_cmd("show ip igmp statistics json", isjson=True)
+    return out["global"]["reportV3"]
+
+
+def hhmmss(timer):
+    h, m, s = (int(x) for x in timer.split(":"))
+    return h * 3600 + m * 60 + s
+
+
+def igmp_groups(router):
+    "Groups on r1-eth0 as {group: json}"
+    out = router.vtysh_cmd("show ip igmp groups json", isjson=True)
+    groups = out.get("r1-eth0", {}).get("groups", [])
+    return {g["group"]: g for g in groups}
+
+
+def wait_groups(router, count):
+    def expect_groups():
+        return len(igmp_groups(router))
+
+    start = time.time()
+    _, result = topotest.run_and_expect(expect_groups, count, count=120, wait=1)
+    assert result == count, "expected {} groups, have {}".format(count, result)
+    return time.time() - start
+
+
+def refreshed_groups(router, slack):
+    "Number of groups in EXCLUDE mode with their timer within slack of GMI"
+    count = 0
+    for g in igmp_groups(router).values():
+        if g["mode"] == "EXCLUDE" and GMI - slack < hhmmss(g["timer"]) <= GMI:
+            count += 1
+    return count
+
+
+def test_pim_igmp_report_storm_join():
+    "Report every group ROUNDS times over"
+    tgen = get_topogen()
+    if tgen.routers_have_failure():
+        pytest.skip(tgen.errors)
+
+    r1 = tgen.gears["r1"]
+
+    before = reports_received(r1)
+    start = time.time()
+    send_reports(MODE_IS_EXCLUDE, ROUNDS)
+    elapsed = time.time() - start
+    elapsed += wait_groups(r1, GROUPS)
+
+    logger.info(
+        "{} groups joined from {} reports in {:.2f}s".format(
+            GROUPS, reports_received(r1) - before, elapsed
+        )
+    )
+    assert refreshed_groups(r1, 30) == GROUPS
+
+
+def test_pim_igmp_report_storm_refresh():
+    "Refresh all groups once more, their timers go back up to GMI"
+    tgen = get_topogen()
+    if tgen.routers_have_failure():
+        pytest.skip(tgen.errors)
+
+    r1 = tgen.gears["r1"]
+
+    # let the timers run down far enough to tell a refresh apart
+    time.sleep(30)
+    assert refreshed_groups(r1, 20) == 0
+
+    before = reports_received(r1)
+    start = time.time()
+    send_reports(MODE_IS_EXCLUDE, ROUNDS)
+    test_func = partial(refreshed_groups, r1, 20)
+    _, result = topotest.run_and_expect(test_func, GROUPS, count=20, wait=1)
+    assert result == GROUPS, "only {} groups refreshed".format(result)
+    logger.info(
+        "{} groups refreshed from {} reports in {:.2f}s".format(
+            GROUPS, reports_received(r1) - before, time.time() - start
+        )
+    )
+
+
+def test_pim_igmp_report_storm_leave():
+    "Leave all groups, they are gone after LMQT"
+    tgen = get_topogen()
+    if tgen.routers_have_failure():
+        pytest.skip(tgen.errors)
+
+    r1 = tgen.gears["r1"]
+
+    start = time.time()
+    send_reports(CHANGE_TO_INCLUDE, 1)
+    elapsed = time.time() - start
+    elapsed += wait_groups(r1, 0)
+    logger.info("{} groups left in {:.2f}s".format(GROUPS, elapsed))
+
+
+def test_pim_igmp_query_spread():
+    "Interfaces past their startup queries don't query in lockstep"
+    tgen = get_topogen()
+    if tgen.routers_have_failure():
+        pytest.skip(tgen.errors)
+
+    r1 = tgen.gears["r1"]
+
+    def startup_done():
+        out = r1.vtysh_cmd("show ip igmp interface detail json", isjson=True)
+        return all(
+            out.get("r1-eth{}".format(i), {}).get("queryStartCount", 1) == 0
+            for i in range(RECEIVER_LANS)
+        )
+
+    _, result = topotest.run_and_expect(startup_done, True, count=60, wait=1)
+    assert result, "interfaces still sending startup queries"
+
+    # the last startup query interval is the same everywhere
+    time.sleep(STARTUP_QUERY_INTERVAL + 1)
+
+    out = r1.vtysh_cmd("show ip igmp interface detail json", isjson=True)
+    timers = [
+        out["r1-eth{}".format(i)]["queryQueryTimer"] for i in range(RECEIVER_LANS)
+    ]
+    logger.info("next general queries in {}".format(", ".join(timers)))
+    assert len(set(timers)) > 1, "all interfaces query at the same time"
+
+
+def test_memory_leak():
+    "Run the memory leak test and report results."
+    tgen = get_topogen()
+    if not tgen.is_memleak_enabled():
+        pytest.skip("Memory leak test/report is disabled")
+
+    tgen.report_memory_leaks()
+
+
+if __name__ == "__main__":
+    args = ["-s"] + sys.argv[1:]
+    sys.exit(pytest.main(args))
@@ -0,0 +1,209 @@
+#!/usr/bin/env python
+# SPDX-License-Identifier: ISC
+
+#
+# test_pim_sg_scale.py
+#
+
+"""
+test_pim_sg_scale.py: Create a large number of (S,G) and (*,G) states on
+a single router and report how long it takes and how much memory the
+upstream, ifchannel and channel oil records use.
+"""
+
+import os
+import re
+import sys
+import time
+import pytest
+from functools import partial
+
+CWD = os.path.dirname(os.path.realpath(__file__))
+sys.path.append(os.path.join(CWD, "../"))
+
+# pylint: disable=C0413
+from lib import topotest
+from lib.topogen import Topogen, TopoRouter, get_topogen
+from lib.topolog import logger
+
+pytestmark = [pytest.mark.pimd]
+
+# Groups are 225.1.x.y, sources are on r1-eth1
+GROUPS = 250
+SOURCES = 16
+
+MTYPES = {
+    "upstream": "PIM upstream (S,G) state",
+    "ifchannel": "PIM interface (S,G) state",
+    "oil": "PIM SSM (S,G) channel OIL",
+}
+
+
+def build_topo(tgen):
+    "Build function"
+
+    tgen.add_router("r1")
+
+    # receivers
+    sw = tgen.add_switch("sw1")
+    sw.add_link(tgen.gears["r1"])
+
+    # sources
+    sw = tgen.add_switch("sw2")
+    sw.add_link(tgen.gears["r1"])
+
+
+def setup_module(mod):
+    "Sets up the pytest environment"
+    tgen = Topogen(build_topo, mod.__name__)
+    tgen.start_topology()
+
+    for rname, router in tgen.routers().items():
+        router.load_frr_config(
+            os.path.join(CWD, "{}/frr.conf".format(rname)),
+            [(TopoRouter.RD_ZEBRA, None), (TopoRouter.RD_PIM, None)],
+        )
+
+    tgen.start_router()
+
+
+def teardown_module():
+    "Teardown the pytest environment"
+    tgen = get_topogen()
+    tgen.stop_topology()
+
+
+def group(i):
+    return "225.1.{}.{}".format(i // 256, i % 256)
+
+
+def source(i):
+    return "10.0.2.{}".format(10 + i)
+
+
+def static_groups(sources, no=False):
+    "Configuration for a static group per group and source"
+    cmds = ["configure terminal", "interface r1-eth0"]
+    prefix = "no " if no else ""
+
+    for g in range(GROUPS):
+        if sources:
+            for s in range(SOURCES):
+                cmds.append(
+                    "{}ip igmp static-group {} {}".format(prefix, group(g), source(s))
+                )
+        else:
+            cmds.append("{}ip igmp static-group {}".format(prefix, group(g)))
+
+    return "\n".join(cmds)
+
+
+def memory_usage(router):
+    "Current allocations and size of the (S,G) records"
+    output = router.vtysh_cmd("show memory pimd")
+    usage = {}
+
+    for key, name in MTYPES.items():
+        m = re.search(
+            r"^{}\s*:\s+(\d+)\s+(\d+)".format(re.escape(name)), output, re.MULTILINE
+        )
+        usage[key] = (int(m.group(1)), int(m.group(2))) if m else (0, 0)
+
+    return usage
+
+
+def wait_mroutes(router, starg, sg):
+    expected = {"wildcardGroup": {"total": starg}, "sourceGroup": {"total": sg}}
+    test_func = partial(
+        topotest.router_json_cmp, router, "show ip mroute summary json", expected
+    )
+    start = time.time()
+    _, result = topotest.run_and_expect(test_func, None, count=300, wait=1)
+    assert result is None, "mroute count mismatch: {}".format(result)
+    return time.time() - start
+
+
+def report(router, what, elapsed):
+    logger.info("{} in {:.2f}s".format(what, elapsed))
+    for key, (count, size) in memory_usage(router).items():
+        logger.info("  {:<10} {:>8} allocations of {} bytes".format(key, count, size))
+
+
+def test_pim_sg_scale_create():
+    "Create (S,G) state for every group and source"
+    tgen = get_topogen()
+    if tgen.routers_have_failure():
+        pytest.skip(tgen.errors)
+
+    r1 = tgen.gears["r1"]
+
+    start = time.time()
+    r1.vtysh_multicmd(static_groups(True), pretty_output=False)
+    elapsed = time.time() - start
+    elapsed += wait_mroutes(r1, 0, GROUPS * SOURCES)
+    report(r1, "{} (S,G) created".format(GROUPS * SOURCES), elapsed)
+
+    usage = memory_usage(r1)
+    assert usage["upstream"][0] >= GROUPS * SOURCES
+    assert usage["ifchannel"][0] >= GROUPS * SOURCES
+
+
+def test_pim_sg_scale_parents():
+    "Add the (*,G) of every group, each picks up its existing (S,G)s"
+    tgen = get_topogen()
+    if tgen.routers_have_failure():
+        pytest.skip(tgen.errors)
+
+    r1 = tgen.gears["r1"]
+
+    start = time.time()
+    r1.vtysh_multicmd(static_groups(False), pretty_output=False)
+    elapsed = time.time() - start
+    elapsed += wait_mroutes(r1, GROUPS, GROUPS * SOURCES)
+    report(r1, "{} (*,G) created".format(GROUPS), elapsed)
+
+    # every (S,G) hangs off its (*,G)
+    out = r1.vtysh_cmd("show ip pim upstream json", isjson=True)
+    for g in range(GROUPS):
+        entries = out[group(g)]
+        assert "*" in entries, "no (*,{})".format(group(g))
+        assert len(entries) == SOURCES + 1
+        for s in range(SOURCES):
+            parent = entries[source(s)].get("parent")
+            assert parent == "(*,{})".format(group(g)), "({},{}) parent {}".format(
+                source(s), group(g), parent
+            )
+
+
+def test_pim_sg_scale_delete():
+    "Remove all state, nothing is left behind"
+    tgen = get_topogen()
+    if tgen.routers_have_failure():
+        pytest.skip(tgen.errors)
+
+    r1 = tgen.gears["r1"]
+
+    start = time.time()
+    r1.vtysh_multicmd(static_groups(False, no=True), pretty_output=False)
+    r1.vtysh_multicmd(static_groups(True, no=True), pretty_output=False)
+    elapsed = time.time() - start
+    elapsed += wait_mroutes(r1, 0, 0)
+    report(r1, "all state removed", elapsed)
+
+    usage = memory_usage(r1)
+    assert usage["upstream"][0] == 0
+    assert usage["ifchannel"][0] == 0
+
+
+def test_memory_leak():
+    "Run the memory leak test and report results."
+    tgen = get_topogen()
+    if not tgen.is_memleak_enabled():
+        pytest.skip("Memory leak test/report is disabled")
+
+    tgen.report_memory_leaks()
+
+
+if __name__ == "__main__":
+    args = ["-s"] + sys.argv[1:]
+    sys.exit(pytest.main(args))
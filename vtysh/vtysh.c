@@ -3172,6 +3172,42 @@ DEFUN (vtysh_show_event,
 	return show_per_daemon(vty, argv, argc, "Event statistics for %s:\n");
 }
 
+DEFUN (vtysh_show_event_cpu_histogram,
+       vtysh_show_event_cpu_histogram_cmd,
+       "show event cpu histogram [detail] [FILTER]",
+       SHOW_STR
+       "Event information\n"
+       "Event CPU usage\n"
+       "Wallclock runtime distribution per event handler\n"
+       "Show histogram buckets\n"
+       "Display filter (rwtexb)\n")
+{
+	return show_per_daemon(vty, argv, argc,
+			       "Event runtime histogram for %s:\n");
+}
+
+DEFUN (vtysh_show_event_cpu_folded,
+       vtysh_show_event_cpu_folded_cmd,
+       "show event cpu folded",
+       SHOW_STR
+       "Event information\n"
+       "Event CPU usage\n"
+       "Wallclock totals in folded stack format (for flamegraph.pl)\n")
+{
+	return show_per_daemon(vty, argv, argc, "");
+}
+
+DEFUN (vtysh_show_event_stalls,
+       vtysh_show_event_stalls_cmd,
+       "show event stalls [folded]",
+       SHOW_STR
+       "Event information\n"
+       "Event handlers caught by the watchdog, with backtraces\n"
+       "Folded stack format (for flamegraph.pl)\n")
+{
+	return show_per_daemon(vty, argv, argc, "Event stalls for %s:\n");
+}
+
 DEFUN (vtysh_show_work_queues,
        vtysh_show_work_queues_cmd,
        "show work-queues",
@@ -5757,6 +5793,9 @@ void vtysh_init_vty(void)
 	install_element(VIEW_NODE, &vtysh_show_work_queues_cmd);
 	install_element(VIEW_NODE, &vtysh_show_work_queues_daemon_cmd);
 	install_element(VIEW_NODE, &vtysh_show_event_cpu_cmd);
+	install_element(VIEW_NODE, &vtysh_show_event_cpu_histogram_cmd);
+	install_element(VIEW_NODE, &vtysh_show_event_cpu_folded_cmd);
+	install_element(VIEW_NODE, &vtysh_show_event_stalls_cmd);
 	install_element(VIEW_NODE, &vtysh_show_event_poll_cmd);
 	install_element(VIEW_NODE, &vtysh_show_event_timer_cmd);
 
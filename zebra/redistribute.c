@@ -83,7 +83,7 @@ static void zebra_redistribute_default(struct zserv *client, vrf_id_t vrf_id)
 		RNODE_FOREACH_RE (rn, newre) {
 			if (CHECK_FLAG(newre->flags, ZEBRA_FLAG_SELECTED))
 				zsend_redistribute_route(ZEBRA_REDISTRIBUTE_ROUTE_ADD, client, rn,
-							 newre, NULL);
+							 newre, NULL, NULL);
 		}
 
 		route_unlock_node(rn);
@@ -105,7 +105,7 @@ static void redistribute_table_direct(struct zserv *client, int type, const stru
 		if (table->table_id != (int)re->table)
 			continue;
 
-		zsend_redistribute_route(type, client, rn, re, &table->vrf_id);
+		zsend_redistribute_route(type, client, rn, re, &table->vrf_id, NULL);
 	}
 }
 
@@ -159,7 +159,7 @@ static void zebra_redistribute(struct zserv *client, int type,
 							  newre);
 			else
 				zsend_redistribute_route(ZEBRA_REDISTRIBUTE_ROUTE_ADD, client, rn,
-							 newre, NULL);
+							 newre, NULL, NULL);
 		}
 }
 
@@ -244,6 +244,8 @@ void redistribute_update(const struct route_node *rn,
 			 const struct route_entry *prev_re)
 {
 	struct zserv *client;
+	/* encoded once, sent to all clients by reference */
+	struct iobuf *add_msg = NULL, *del_msg = NULL;
 
 	if (IS_ZEBRA_DEBUG_RIB)
 		zlog_debug(
@@ -273,16 +275,19 @@ void redistribute_update(const struct route_node *rn,
 							  re);
 			else
 				zsend_redistribute_route(ZEBRA_REDISTRIBUTE_ROUTE_ADD, client, rn,
-							 re, NULL);
+							 re, NULL, &add_msg);
 		} else if (zebra_redistribute_check(rn, prev_re, client)) {
 			if (zebra_redistribute_is_table_direct(prev_re))
 				redistribute_table_direct(client, ZEBRA_REDISTRIBUTE_ROUTE_DEL, rn,
 							  prev_re);
 			else
 				zsend_redistribute_route(ZEBRA_REDISTRIBUTE_ROUTE_DEL, client, rn,
-							 prev_re, NULL);
+							 prev_re, NULL, &del_msg);
 		}
 	}
+
+	iobuf_free(add_msg);
+	iobuf_free(del_msg);
 }
 
 /*
@@ -298,6 +303,7 @@ void redistribute_delete(const struct route_node *rn,
 			 const struct route_entry *new_re)
 {
 	struct zserv *client;
+	struct iobuf *del_msg = NULL;
 	vrf_id_t vrfid;
 
 	if (old_re)
@@ -366,9 +372,11 @@ void redistribute_delete(const struct route_node *rn,
 							  old_re);
 			else
 				zsend_redistribute_route(ZEBRA_REDISTRIBUTE_ROUTE_DEL, client, rn,
-							 old_re, NULL);
+							 old_re, NULL, &del_msg);
 		}
 	}
+
+	iobuf_free(del_msg);
 }
 
 
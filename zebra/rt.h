@@ -79,6 +79,9 @@ void kernel_router_terminate(void);
 
 extern uint32_t kernel_get_speed(struct interface *ifp, int *error);
 extern int kernel_get_ipmr_sg_stats(struct zebra_vrf *zvrf, void *mroute);
+/* Walk all mroutes of the vrf, calling cb with a filled in mcast_route_data */
+extern int kernel_dump_ipmr_sg_stats(struct zebra_vrf *zvrf, int family,
+				     void (*cb)(void *mroute, void *arg), void *arg);
 
 /*
  * Southbound Initialization routines to get initial starting
@@ -2897,6 +2897,29 @@ ssize_t netlink_route_multipath_msg_encode(int cmd, struct zebra_dplane_ctx *ctx
 	return NLMSG_ALIGN(req->n.nlmsg_len);
 }
 
+static uint32_t netlink_ipmr_table(struct zebra_vrf *zvrf, int family)
+{
+	/*
+	 * What?
+	 *
+	 * So during the namespace cleanup we started storing
+	 * the zvrf table_id for the default table as RT_TABLE_MAIN
+	 * which is what the normal routing table for ip routing is.
+	 * This change caused this to break our lookups of sg data
+	 * because prior to this change the zvrf->table_id was 0
+	 * and when the pim multicast kernel code saw a 0,
+	 * it was auto-translated to RT_TABLE_DEFAULT.  But since
+	 * we are now passing in RT_TABLE_MAIN there is no auto-translation
+	 * and the kernel goes screw you and the delicious cookies you
+	 * are trying to give me.  So now we have this little hack.
+	 */
+	if (family == AF_INET)
+		return (zvrf->table_id == rt_table_main_id) ? RT_TABLE_DEFAULT
+							    : zvrf->table_id;
+
+	return zvrf->table_id;
+}
+
 int kernel_get_ipmr_sg_stats(struct zebra_vrf *zvrf, void *in)
 {
 	uint32_t actual_table;
@@ -2952,26 +2975,7 @@ int kernel_get_ipmr_sg_stats(struct zebra_vrf *zvrf, void *in)
 		}
 	}
 
-	/*
-	 * What?
-	 *
-	 * So during the namespace cleanup we started storing
-	 * the zvrf table_id for the default table as RT_TABLE_MAIN
-	 * which is what the normal routing table for ip routing is.
-	 * This change caused this to break our lookups of sg data
-	 * because prior to this change the zvrf->table_id was 0
-	 * and when the pim multicast kernel code saw a 0,
-	 * it was auto-translated to RT_TABLE_DEFAULT.  But since
-	 * we are now passing in RT_TABLE_MAIN there is no auto-translation
-	 * and the kernel goes screw you and the delicious cookies you
-	 * are trying to give me.  So now we have this little hack.
-	 */
-	if (mroute->family == AF_INET)
-		actual_table = (zvrf->table_id == rt_table_main_id)
-				       ? RT_TABLE_DEFAULT
-				       : zvrf->table_id;
-	else
-		actual_table = zvrf->table_id;
+	actual_table = netlink_ipmr_table(zvrf, mroute->family);
 
 	if (!nl_attr_put32(&req.n, sizeof(req), RTA_TABLE, actual_table)) {
 		zlog_err("%s: Failed to put RTA_TABLE nl attribute", __func__);
@@ -2985,6 +2989,99 @@ int kernel_get_ipmr_sg_stats(struct zebra_vrf *zvrf, void *in)
 	return suc;
 }
 
+static struct {
+	uint32_t table;
+	void (*cb)(void *mroute, void *arg);
+	void *arg;
+} mroute_dump;
+
+static int netlink_route_read_multicast_stats(struct nlmsghdr *h, ns_id_t ns_id, int startup)
+{
+	struct rtmsg *rtm = NLMSG_DATA(h);
+	struct rtattr *tb[RTA_MAX + 1];
+	struct mcast_route_data m = {};
+	uint32_t table;
+	int len;
+
+	if (h->nlmsg_type != RTM_NEWROUTE)
+		return 0;
+
+	len = h->nlmsg_len - NLMSG_LENGTH(sizeof(struct rtmsg));
+	if (len < 0)
+		return -1;
+
+	netlink_parse_rtattr(tb, RTA_MAX, RTM_RTA(rtm), len);
+
+	if (tb[RTA_TABLE])
+		table = *(uint32_t *)RTA_DATA(tb[RTA_TABLE]);
+	else
+		table = rtm->rtm_table;
+
+	if (table != mroute_dump.table || !tb[RTA_SRC] || !tb[RTA_DST])
+		return 0;
+
+	switch (rtm->rtm_family) {
+	case RTNL_FAMILY_IPMR:
+		m.family = AF_INET;
+		SET_IPADDR_V4(&m.src);
+		SET_IPADDR_V4(&m.grp);
+		memcpy(&m.src.ipaddr_v4, RTA_DATA(tb[RTA_SRC]), sizeof(m.src.ipaddr_v4));
+		memcpy(&m.grp.ipaddr_v4, RTA_DATA(tb[RTA_DST]), sizeof(m.grp.ipaddr_v4));
+		break;
+	case RTNL_FAMILY_IP6MR:
+		m.family = AF_INET6;
+		SET_IPADDR_V6(&m.src);
+		SET_IPADDR_V6(&m.grp);
+		memcpy(&m.src.ipaddr_v6, RTA_DATA(tb[RTA_SRC]), sizeof(m.src.ipaddr_v6));
+		memcpy(&m.grp.ipaddr_v6, RTA_DATA(tb[RTA_DST]), sizeof(m.grp.ipaddr_v6));
+		break;
+	default:
+		return 0;
+	}
+
+	if (tb[RTA_IIF])
+		m.ifindex = *(int *)RTA_DATA(tb[RTA_IIF]);
+
+	if (tb[RTA_EXPIRES])
+		memcpy(&m.lastused, RTA_DATA(tb[RTA_EXPIRES]), sizeof(m.lastused));
+
+	if (tb[RTA_MFC_STATS]) {
+		struct rta_mfc_stats stats;
+
+		memcpy(&stats, RTA_DATA(tb[RTA_MFC_STATS]), sizeof(stats));
+		m.pktcnt = stats.mfcs_packets;
+		m.bytecnt = stats.mfcs_bytes;
+		m.wrong_if = stats.mfcs_wrong_if;
+	}
+
+	mroute_dump.cb(&m, mroute_dump.arg);
+	return 0;
+}
+
+int kernel_dump_ipmr_sg_stats(struct zebra_vrf *zvrf, int family,
+			      void (*cb)(void *mroute, void *arg), void *arg)
+{
+	struct zebra_ns *zns = zvrf->zns;
+	struct zebra_dplane_info dp_info;
+	int ret;
+
+	mroute_dump.table = netlink_ipmr_table(zvrf, family);
+	mroute_dump.cb = cb;
+	mroute_dump.arg = arg;
+
+	zebra_dplane_info_from_zns(&dp_info, zns, true /*is_cmd*/);
+
+	ret = netlink_request_route(zns, family == AF_INET ? RTNL_FAMILY_IPMR : RTNL_FAMILY_IP6MR,
+				    RTM_GETROUTE);
+	if (ret >= 0)
+		ret = netlink_parse_info(netlink_route_read_multicast_stats, &zns->netlink_cmd,
+					 &dp_info, 0, false);
+
+	mroute_dump.cb = NULL;
+	mroute_dump.arg = NULL;
+	return ret;
+}
+
 /* Char length to debug ID with */
 #define ID_LENGTH 10
 
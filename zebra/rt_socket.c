@@ -369,6 +369,12 @@ extern int kernel_get_ipmr_sg_stats(struct zebra_vrf *zvrf, void *mroute)
 	return 0;
 }
 
+extern int kernel_dump_ipmr_sg_stats(struct zebra_vrf *zvrf, int family,
+				     void (*cb)(void *mroute, void *arg), void *arg)
+{
+	return -1;
+}
+
 /*
  * Update MAC, using dataplane context object. No-op here for now.
  */
@@ -510,8 +510,15 @@ int zsend_interface_update(int cmd, struct zserv *client, struct interface *ifp)
 	return zserv_send_message(client, s);
 }
 
+/*
+ * If shared is set, the encoded message is kept there and sent by
+ * reference to the next clients the same route is sent to.  The caller
+ * frees it once done with all clients.  This does not work with to_vrf,
+ * which makes the message differ between clients.
+ */
 int zsend_redistribute_route(int cmd, struct zserv *client, const struct route_node *rn,
-			     const struct route_entry *re, vrf_id_t *to_vrf)
+			     const struct route_entry *re, vrf_id_t *to_vrf,
+			     struct iobuf **shared)
 {
 	struct zapi_route api;
 	struct zapi_nexthop *api_nh;
@@ -520,19 +527,9 @@ int zsend_redistribute_route(int cmd, struct zserv *client, const struct route_n
 	uint16_t count = 0;
 	afi_t afi;
 
-	zapi_route_init(&api);
-	srcdest_rnode_prefixes(rn, &p, &src_p);
+	assert(!shared || !to_vrf);
 
-	api.vrf_id = re->vrf_id;
-	api.type = re->type;
-	api.safi = SAFI_UNICAST;
-	if (to_vrf != NULL) {
-		api.instance = re->table;
-		api.type = ZEBRA_ROUTE_TABLE_DIRECT;
-		api.vrf_id = *to_vrf;
-	} else
-		api.instance = re->instance;
-	api.flags = re->flags;
+	srcdest_rnode_prefixes(rn, &p, &src_p);
 
 	afi = family2afi(p->family);
 	switch (afi) {
@@ -554,6 +551,28 @@ int zsend_redistribute_route(int cmd, struct zserv *client, const struct route_n
 		break;
 	}
 
+	if (shared && *shared) {
+		if (IS_ZEBRA_DEBUG_SEND)
+			zlog_debug("%s: %s to client %s: type %s, vrf_id %d, p %pFX (shared)",
+				   __func__, zserv_command_string(cmd),
+				   zebra_route_string(client->proto),
+				   zebra_route_string(re->type), re->vrf_id, p);
+		return zserv_send_message_shared(client, *shared);
+	}
+
+	zapi_route_init(&api);
+
+	api.vrf_id = re->vrf_id;
+	api.type = re->type;
+	api.safi = SAFI_UNICAST;
+	if (to_vrf != NULL) {
+		api.instance = re->table;
+		api.type = ZEBRA_ROUTE_TABLE_DIRECT;
+		api.vrf_id = *to_vrf;
+	} else
+		api.instance = re->instance;
+	api.flags = re->flags;
+
 	/* Prefix. */
 	api.prefix = *p;
 	if (src_p) {
@@ -625,6 +644,13 @@ int zsend_redistribute_route(int cmd, struct zserv *client, const struct route_n
 		zlog_debug("%s: %s to client %s: type %s, vrf_id %d, table %u, p %pFX", __func__,
 			   zserv_command_string(cmd), zebra_route_string(client->proto),
 			   zebra_route_string(api.type), api.vrf_id, api.tableid, &api.prefix);
+
+	if (shared) {
+		stream_resize_inplace(&s, stream_get_endp(s));
+		*shared = iobuf_from_stream(s);
+		return zserv_send_message_shared(client, *shared);
+	}
+
 	return zserv_send_message(client, s);
 }
 
@@ -4177,6 +4203,7 @@ void (*const zserv_handlers[])(ZAPI_HANDLER_ARGS) = {
 	[ZEBRA_MPLS_LABELS_DELETE] = zread_mpls_labels_delete,
 	[ZEBRA_MPLS_LABELS_REPLACE] = zread_mpls_labels_replace,
 	[ZEBRA_IPMR_ROUTE_STATS] = zebra_ipmr_route_stats,
+	[ZEBRA_IPMR_ROUTE_STATS_BULK] = zebra_ipmr_route_stats_bulk,
 	[ZEBRA_LABEL_MANAGER_CONNECT] = zread_label_manager_request,
 	[ZEBRA_LABEL_MANAGER_CONNECT_ASYNC] = zread_label_manager_request,
 	[ZEBRA_GET_LABEL_CHUNK] = zread_label_manager_request,
@@ -85,3 +85,113 @@ stream_failure:
 	stream_putw_at(s, 0, stream_get_endp(s));
 	zserv_send_message(client, s);
 }
+
+struct ipmr_route_stats_bulk {
+	struct zserv *client;
+	vrf_id_t vrf_id;
+	int family;
+
+	struct stream *s;
+	size_t flagsp;
+	size_t statusp;
+	size_t countp;
+	uint32_t count;
+};
+
+static void zebra_ipmr_route_stats_bulk_start(struct ipmr_route_stats_bulk *b)
+{
+	b->s = stream_new(ZEBRA_MAX_PACKET_SIZ);
+
+	zclient_create_header(b->s, ZEBRA_IPMR_ROUTE_STATS_BULK, b->vrf_id);
+	stream_putl(b->s, b->family);
+	b->flagsp = stream_get_endp(b->s);
+	stream_putc(b->s, 0);
+	b->statusp = stream_get_endp(b->s);
+	stream_putl(b->s, 0);
+	b->countp = stream_get_endp(b->s);
+	stream_putl(b->s, 0);
+	b->count = 0;
+}
+
+static void zebra_ipmr_route_stats_bulk_send(struct ipmr_route_stats_bulk *b, bool last,
+					     int status)
+{
+	if (last)
+		stream_putc_at(b->s, b->flagsp, ZAPI_IPMR_STATS_BULK_LAST);
+	stream_putl_at(b->s, b->statusp, (uint32_t)status);
+	stream_putl_at(b->s, b->countp, b->count);
+	stream_putw_at(b->s, 0, stream_get_endp(b->s));
+
+	zserv_send_message(b->client, b->s);
+	b->s = NULL;
+}
+
+static void zebra_ipmr_route_stats_bulk_add(void *in, void *arg)
+{
+	struct mcast_route_data *mroute = in;
+	struct ipmr_route_stats_bulk *b = arg;
+	size_t addrlen;
+
+	if (mroute->family != b->family)
+		return;
+
+	addrlen = b->family == AF_INET ? sizeof(mroute->src.ipaddr_v4)
+				       : sizeof(mroute->src.ipaddr_v6);
+	if (STREAM_WRITEABLE(b->s) < 2 * addrlen + 4 * sizeof(uint64_t)) {
+		zebra_ipmr_route_stats_bulk_send(b, false, 0);
+		zebra_ipmr_route_stats_bulk_start(b);
+	}
+
+	if (b->family == AF_INET) {
+		stream_write(b->s, &mroute->src.ipaddr_v4, addrlen);
+		stream_write(b->s, &mroute->grp.ipaddr_v4, addrlen);
+	} else {
+		stream_write(b->s, &mroute->src.ipaddr_v6, addrlen);
+		stream_write(b->s, &mroute->grp.ipaddr_v6, addrlen);
+	}
+	stream_putq(b->s, mroute->lastused);
+	stream_putq(b->s, mroute->pktcnt);
+	stream_putq(b->s, mroute->bytecnt);
+	stream_putq(b->s, mroute->wrong_if);
+	b->count++;
+}
+
+/*
+ * Counters of all mroutes of a vrf from a single kernel dump.  The vrf is
+ * carried in the message body so an unknown vrf is reported in the answer
+ * rather than through ZEBRA_ERROR.
+ */
+void zebra_ipmr_route_stats_bulk(ZAPI_HANDLER_ARGS)
+{
+	struct ipmr_route_stats_bulk b = { .client = client };
+	struct zebra_vrf *target;
+	int suc = -1;
+
+	STREAM_GETL(msg, b.family);
+	STREAM_GETL(msg, b.vrf_id);
+
+	if (b.family != AF_INET && b.family != AF_INET6) {
+		zlog_warn("%s: Invalid address family received while parsing",
+			  __func__);
+		return;
+	}
+
+	zebra_ipmr_route_stats_bulk_start(&b);
+
+	target = zebra_vrf_lookup_by_id(b.vrf_id);
+	if (target) {
+		if (IS_ZEBRA_DEBUG_KERNEL)
+			zlog_debug("Asking for all %s mroute information of %s(%u)",
+				   b.family == AF_INET ? "IPv4" : "IPv6",
+				   target->vrf->name, target->vrf->vrf_id);
+
+		suc = kernel_dump_ipmr_sg_stats(target, b.family,
+						zebra_ipmr_route_stats_bulk_add, &b);
+	}
+
+	zebra_ipmr_route_stats_bulk_send(&b, true, suc);
+	return;
+
+stream_failure:
+	zlog_warn("%s: Unable to parse request", __func__);
+}
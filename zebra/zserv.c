@@ -23,6 +23,7 @@
 #include "lib/buffer.h"           /* for BUFFER_EMPTY, BUFFER_ERROR, BUFFE... */
 #include "lib/command.h"          /* for vty, install_element, CMD_SUCCESS... */
 #include "lib/hook.h"             /* for DEFINE_HOOK, DEFINE_KOOH, hook_call */
+#include "lib/iobuf.h"            /* for iobuf_put_stream, iobuf_append */
 #include "lib/libfrr.h"           /* for frr_zclient_addr */
 #include "lib/log.h"              /* for zlog_warn, zlog_debug, safe_strerror */
 #include "lib/memory.h"           /* for MTYPE_TMP, XCALLOC, XFREE */
@@ -223,9 +224,8 @@ static void zserv_client_fail(struct zserv *client)
 static void zserv_write(struct event *event)
 {
 	struct zserv *client = EVENT_ARG(event);
-	struct stream *msg;
+	struct iobuf *msgs = NULL;
 	uint32_t wcmd = 0;
-	struct stream_fifo *cache;
 	uint64_t time_now = monotime(NULL);
 
 	/* If we have any data pending, try to flush it first */
@@ -242,27 +242,19 @@ static void zserv_write(struct event *event)
 		break;
 	}
 
-	cache = stream_fifo_new();
-
 	frr_with_mutex (&client->obuf_mtx) {
-		while (stream_fifo_head(client->obuf_fifo))
-			stream_fifo_push(cache,
-					 stream_fifo_pop(client->obuf_fifo));
-	}
-
-	if (cache->tail) {
-		msg = cache->tail;
-		stream_set_getp(msg, 0);
-		wcmd = stream_getw_from(msg, ZAPI_HEADER_CMD_LOCATION);
+		if (!iobuf_empty(client->obuf)) {
+			msgs = client->obuf;
+			client->obuf = iobuf_new();
+			wcmd = client->obuf_last_cmd;
+		}
+		atomic_store_explicit(&client->obuf_count, 0,
+				      memory_order_relaxed);
 	}
 
-	while (stream_fifo_head(cache)) {
-		msg = stream_fifo_pop(cache);
-		buffer_put(client->wb, STREAM_DATA(msg), stream_get_endp(msg));
-		stream_free(msg);
-	}
-
-	stream_fifo_free(cache);
+	/* the queued messages are handed to the buffer by reference */
+	if (msgs)
+		buffer_put_iobuf(client->wb, msgs);
 
 	/* If we have any data pending, try to flush it first */
 	switch (buffer_flush_all(client->wb, client->sock)) {
@@ -575,6 +567,31 @@ static void zserv_process_messages(struct event *event)
 	zserv_client_event(client, ZSERV_CLIENT_READ);
 }
 
+/*
+ * Queue a message by reference.  Streams are trimmed to their contents
+ * first, so a backlog on a slow client pins no more than it holds.
+ *
+ * Must be called with obuf_mtx held.
+ */
+static void zserv_obuf_put(struct zserv *client, struct stream *msg)
+{
+	size_t count;
+
+	client->obuf_last_cmd = stream_getw_from(msg, ZAPI_HEADER_CMD_LOCATION);
+
+	if (stream_get_endp(msg) < STREAM_SIZE(msg))
+		stream_resize_inplace(&msg, stream_get_endp(msg));
+	stream_set_getp(msg, 0);
+	iobuf_put_stream(client->obuf, msg);
+
+	count = atomic_fetch_add_explicit(&client->obuf_count, 1,
+					  memory_order_relaxed) + 1;
+	if (count > atomic_load_explicit(&client->obuf_max_count,
+					 memory_order_relaxed))
+		atomic_store_explicit(&client->obuf_max_count, count,
+				      memory_order_relaxed);
+}
+
 int zserv_send_message(struct zserv *client, struct stream *msg)
 {
 	/* Don't continue if zclient is being freed/shut */
@@ -582,7 +599,7 @@ int zserv_send_message(struct zserv *client, struct stream *msg)
 		goto done;
 
 	frr_with_mutex (&client->obuf_mtx) {
-		stream_fifo_push(client->obuf_fifo, msg);
+		zserv_obuf_put(client, msg);
 	}
 
 	zserv_client_event(client, ZSERV_CLIENT_WRITE);
@@ -605,7 +622,7 @@ int zserv_send_batch(struct zserv *client, struct stream_fifo *fifo)
 	frr_with_mutex (&client->obuf_mtx) {
 		msg = stream_fifo_pop(fifo);
 		while (msg) {
-			stream_fifo_push(client->obuf_fifo, msg);
+			zserv_obuf_put(client, msg);
 			msg = stream_fifo_pop(fifo);
 		}
 	}
@@ -616,6 +633,36 @@ done:
 	return 0;
 }
 
+int zserv_send_message_shared(struct zserv *client, const struct iobuf *msg)
+{
+	uint16_t cmd;
+	size_t count;
+
+	/* Don't continue if zclient is being freed/shut */
+	if (client->pthread == NULL)
+		return 0;
+
+	if (iobuf_copyout(msg, ZAPI_HEADER_CMD_LOCATION, &cmd, sizeof(cmd))
+	    != sizeof(cmd))
+		return -1;
+
+	frr_with_mutex (&client->obuf_mtx) {
+		client->obuf_last_cmd = ntohs(cmd);
+		iobuf_append(client->obuf, msg);
+
+		count = atomic_fetch_add_explicit(&client->obuf_count, 1,
+						  memory_order_relaxed) + 1;
+		if (count > atomic_load_explicit(&client->obuf_max_count,
+						 memory_order_relaxed))
+			atomic_store_explicit(&client->obuf_max_count, count,
+					      memory_order_relaxed);
+	}
+
+	zserv_client_event(client, ZSERV_CLIENT_WRITE);
+
+	return 0;
+}
+
 /* Hooks for client connect / disconnect */
 DEFINE_HOOK(zserv_client_connect, (struct zserv *client), (client));
 DEFINE_KOOH(zserv_client_close, (struct zserv *client), (client));
@@ -677,8 +724,7 @@ static void zserv_client_free(struct zserv *client)
 		stream_free(client->obuf_work);
 	if (client->ibuf_fifo)
 		stream_fifo_free(client->ibuf_fifo);
-	if (client->obuf_fifo)
-		stream_fifo_free(client->obuf_fifo);
+	iobuf_free(client->obuf);
 	if (client->wb)
 		buffer_free(client->wb);
 
@@ -804,7 +850,7 @@ static struct zserv *zserv_client_create(int sock)
 	/* Make client input/output buffer. */
 	client->sock = sock;
 	client->ibuf_fifo = stream_fifo_new();
-	client->obuf_fifo = stream_fifo_new();
+	client->obuf = iobuf_new();
 	client->ibuf_work = stream_new(stream_size);
 	client->obuf_work = stream_new(stream_size);
 	client->connect_time = monotime(NULL);
@@ -1337,8 +1383,8 @@ static void zebra_show_client_detail(struct vty *vty, struct zserv *client, json
 		json_fifo = json_object_new_object();
 		json_object_int_add(json_fifo, "inputCount", client->ibuf_fifo->count);
 		json_object_int_add(json_fifo, "inputMaxCount", client->ibuf_fifo->max_count);
-		json_object_int_add(json_fifo, "outputCount", client->obuf_fifo->count);
-		json_object_int_add(json_fifo, "outputMaxCount", client->obuf_fifo->max_count);
+		json_object_int_add(json_fifo, "outputCount", client->obuf_count);
+		json_object_int_add(json_fifo, "outputMaxCount", client->obuf_max_count);
 		json_object_object_add(json_client, "fifo", json_fifo);
 
 		/* Add this client to the JSON array */
@@ -1461,7 +1507,7 @@ static void zebra_show_client_detail(struct vty *vty, struct zserv *client, json
 
 		vty_out(vty, "Input Fifo: %zu:%zu Output Fifo: %zu:%zu\n",
 			client->ibuf_fifo->count, client->ibuf_fifo->max_count,
-			client->obuf_fifo->count, client->obuf_fifo->max_count);
+			client->obuf_count, client->obuf_max_count);
 
 		vty_out(vty, "\n");
 	}
@@ -19,6 +19,7 @@
 #include "lib/vrf.h"          /* for vrf_bitmap_t */
 #include "lib/zclient.h"      /* for redist_proto */
 #include "lib/stream.h"       /* for stream, stream_fifo */
+#include "lib/iobuf.h"        /* for iobuf */
 #include "frrevent.h"            /* for thread, thread_master */
 #include "lib/linklist.h"     /* for list */
 #include "lib/workqueue.h"    /* for work_queue */
@@ -100,7 +101,15 @@ struct zserv {
 	pthread_mutex_t ibuf_mtx;
 	struct stream_fifo *ibuf_fifo;
 	pthread_mutex_t obuf_mtx;
-	struct stream_fifo *obuf_fifo;
+	/*
+	 * Messages queued for the client pthread.  They are kept by
+	 * reference, so a message fanned out to several clients is only
+	 * held once.
+	 */
+	struct iobuf *obuf;
+	atomic_size_t obuf_count;
+	atomic_size_t obuf_max_count;
+	uint16_t obuf_last_cmd;
 
 	/* Private I/O buffers */
 	struct stream *ibuf_work;
@@ -314,6 +323,21 @@ extern int zserv_send_message(struct zserv *client, struct stream *msg);
  */
 extern int zserv_send_batch(struct zserv *client, struct stream_fifo *fifo);
 
+/*
+ * Send a message that is also sent to other clients.
+ *
+ * Only a reference to the message's bytes is queued, the caller keeps
+ * msg and frees it once it has been sent to every client.
+ *
+ * client
+ *    the client to send to
+ *
+ * msg
+ *    the message to send
+ */
+extern int zserv_send_message_shared(struct zserv *client,
+				     const struct iobuf *msg);
+
 /*
  * Retrieve a client by its protocol and instance number.
  *